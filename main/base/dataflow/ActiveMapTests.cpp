@@ -0,0 +1,161 @@
+// Tests for the V2 consumer active map and the producer's cached
+// free space.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+#include <ErrnoException.h>
+
+#include <CRingBuffer.h>
+#include <ringbufint.h>
+#include <string>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "testcommon.h"
+
+using namespace std;
+
+
+class ActiveMapTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ActiveMapTest);
+  CPPUNIT_TEST(empty);
+  CPPUNIT_TEST(attachdetach);
+  CPPUNIT_TEST(forcerelease);
+  CPPUNIT_TEST(highslot);
+  CPPUNIT_TEST(fillsup);
+  CPPUNIT_TEST(v1fillsup);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  std::string SHM_TESTFILE;
+  unsigned    m_originalFormat;
+  pRingBuffer m_pBuffer;
+public:
+  void setUp() {
+    SHM_TESTFILE = uniqueRing("activemap");
+    m_originalFormat = CRingBuffer::getDefaultFormat();
+    CRingBuffer::setDefaultFormat(RING_FORMAT_V2);
+    CRingBuffer::create(SHM_TESTFILE);
+    m_pBuffer = reinterpret_cast<pRingBuffer>(mapRingBuffer(SHM_TESTFILE.c_str()));
+  }
+  void tearDown() {
+    munmap(m_pBuffer, m_pBuffer->s_header.s_topOffset+1);
+    CRingBuffer::setDefaultFormat(m_originalFormat);
+    try {
+      CRingBuffer::remove(SHM_TESTFILE);
+    }
+    catch(...) {
+    }
+  }
+protected:
+  void empty();
+  void attachdetach();
+  void forcerelease();
+  void highslot();
+  void fillsup();
+  void v1fillsup();
+private:
+  pActiveMapWord activeMap() {
+    return reinterpret_cast<pActiveMapWord>(
+      reinterpret_cast<pRingWakeup>(&(m_pBuffer->s_header) + 1) + 1
+    );
+  }
+  void fill(CRingBuffer& prod, CRingBuffer& cons);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ActiveMapTest);
+
+// A freshly formatted ring has no active consumers.
+
+void ActiveMapTest::empty()
+{
+  size_t words = ACTIVE_MAP_WORDS(m_pBuffer->s_header.s_maxConsumer);
+  for (int i = 0; i < words; i++) {
+    EQ((uint64_t)0, (uint64_t)activeMap()[i]);
+  }
+}
+// Attaching a consumer sets its bit, detaching clears it.
+
+void ActiveMapTest::attachdetach()
+{
+  {
+    CRingBuffer c0(SHM_TESTFILE);
+    CRingBuffer c1(SHM_TESTFILE);
+    EQ((off_t)0, c0.getSlot());
+    EQ((off_t)1, c1.getSlot());
+    EQ((uint64_t)3, (uint64_t)activeMap()[0]);
+  }
+  EQ((uint64_t)0, (uint64_t)activeMap()[0]);
+}
+// Forcing a consumer release clears its bit.
+
+void ActiveMapTest::forcerelease()
+{
+  CRingBuffer c0(SHM_TESTFILE);
+  CRingBuffer mgr(SHM_TESTFILE, CRingBuffer::manager);
+
+  mgr.forceConsumerRelease(0);
+  EQ((uint64_t)0, (uint64_t)activeMap()[0]);
+}
+// Slots past the first map word land in the right word.
+
+void ActiveMapTest::highslot()
+{
+  CRingBuffer* consumers[70];
+  for (int i = 0; i < 70; i++) {
+    consumers[i] = new CRingBuffer(SHM_TESTFILE);
+  }
+  EQ(~(uint64_t)0,   (uint64_t)activeMap()[0]);
+  EQ((uint64_t)0x3f, (uint64_t)activeMap()[1]);
+
+  delete consumers[65];
+  EQ((uint64_t)0x3d, (uint64_t)activeMap()[1]);
+
+  for (int i = 0; i < 70; i++) {
+    if (i != 65) delete consumers[i];
+  }
+}
+// Fill the ring with a consumer attached.  The producer must stop exactly
+// when the ring is full and be able to put again once the consumer
+// frees space.
+
+void ActiveMapTest::fill(CRingBuffer& prod, CRingBuffer& cons)
+{
+  char buffer[1000];
+  memset(buffer, 0, sizeof(buffer));
+
+  size_t total = 0;
+  while (prod.put(buffer, sizeof(buffer), 0) == sizeof(buffer)) {
+    total += sizeof(buffer);
+  }
+  size_t dataBytes = m_pBuffer->s_header.s_dataBytes;
+  EQ((dataBytes - 1)/sizeof(buffer), total/sizeof(buffer));
+  EQ(total, cons.availableData());
+
+  cons.get(buffer, sizeof(buffer));
+  EQ(sizeof(buffer), prod.put(buffer, sizeof(buffer), 0));
+  EQ((size_t)0,      prod.put(buffer, sizeof(buffer), 0));
+}
+
+void ActiveMapTest::fillsup()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+  fill(prod, cons);
+}
+// Same as fillsup but for a V1 ring which has no active map.
+
+void ActiveMapTest::v1fillsup()
+{
+  CRingBuffer::setDefaultFormat(RING_FORMAT_V1);
+  CRingBuffer::format(SHM_TESTFILE);
+
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+  EQ((unsigned)RING_FORMAT_V1, prod.getFormat());
+  fill(prod, cons);
+}
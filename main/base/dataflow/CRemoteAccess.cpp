@@ -20,9 +20,12 @@
 
 #include "CRingBuffer.h"
 #include "CRingMaster.h"
+#include "CRingTcpTransport.h"
 #include "ringbufint.h"
 
 #include <URL.h>
+#include <Exception.h>
+#include <ErrnoException.h>
 #include <os.h>
 #include <stdio.h>
 #include <iostream>
@@ -37,6 +40,7 @@
 #include <netdb.h>
 
 
+
 using namespace std;
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -73,6 +77,18 @@ data that can be gotten from the remote host, regardless of size.
 */
 unsigned CRingAccess::m_Timeout(2);
 
+/*!
+   True if proxy rings are fed by the native transport when the remote
+   ring master supports it.  See set/getNativeTransport.
+*/
+bool CRingAccess::m_nativeTransport(true);
+
+/*!
+   Socket buffer size requested for native transport connections.
+   See set/getSocketBufferSize.
+*/
+size_t CRingAccess::m_socketBufferSize(4*K*K);
+
 ///////////////////////////////////////////////////////////////////////////////////////
 //  Member functions that manipulate the defaults.
 
@@ -189,6 +205,52 @@ CRingAccess::getTimeout()
 {
   return m_Timeout;
 }
+/*!
+  Select whether proxy rings started from now on are fed by the native
+  transport (true) or by the ringtostdout | stdintoring pipeline (false).
+  \param useNative - new value for the parameter.
+  \return bool
+  \retval prior value of the parameter.
+*/
+bool
+CRingAccess::setNativeTransport(bool useNative)
+{
+  bool oldNative    = m_nativeTransport;
+  m_nativeTransport = useNative;
+  return oldNative;
+}
+/*!
+   \return bool
+   \retval true if the native transport will be tried.
+*/
+bool
+CRingAccess::getNativeTransport()
+{
+  return m_nativeTransport;
+}
+/*!
+  Set the socket buffer size requested for native transport connections.
+  The kernel may limit this (see net.core.rmem_max).
+  \param newSize - new buffer size in bytes.
+  \return size_t
+  \retval prior value of the parameter.
+*/
+size_t
+CRingAccess::setSocketBufferSize(size_t newSize)
+{
+  size_t oldSize     = m_socketBufferSize;
+  m_socketBufferSize = newSize;
+  return oldSize;
+}
+/*!
+   \return size_t
+   \retval the socket buffer size requested for native transport connections.
+*/
+size_t
+CRingAccess::getSocketBufferSize()
+{
+  return m_socketBufferSize;
+}
 /*!
   This is the flagship entry of the class.  Connects to a ring buffer either local or remote,
   the ring buffer is designated by a URI of the form:
@@ -207,7 +269,9 @@ tcp://somehost/ringname
   be sent a REMOTE request we will creae the proxy ring here as described above, and
   create a deteched stdintoring process that will catch the remote data and feed it into the
   proxy ring from the socket the ringmaster (well really a ringtostdout instance) will use 
-  to send data to this host.
+  to send data to this host.  With the native transport (the default, see
+  setNativeTransport), the remote ringmaster sends the data itself and a detached
+  receiver process started here feeds the proxy ring instead.
   
   \param uri - The Universal Resource Identifier that identifies the ring from which
                we would like to take data.
@@ -278,7 +342,22 @@ CRingAccess::daqConsumeFrom(string uri)
 void
 CRingAccess::startPipeline(string hostName, string remoteRingname, string localRingname)
 {
-  // The ring is remote.  We need help from the remote ringmaster:
+  // The ring is remote.  We need help from the remote ringmaster.
+  // Prefer the native transport; ringmasters that don't know about it
+  // drop the connection so a fresh one is needed for the pipeline request.
+
+  if (m_nativeTransport) {
+    try {
+      CRingMaster streamMaster(hostName);
+      int socket = streamMaster.requestStream(remoteRingname);
+      startReceiver(localRingname, socket);
+      return;
+    }
+    catch (string msg) {
+    }
+    catch (CException& e) {            // e.g. connect or fork failures.
+    }
+  }
 
   int socket;
   CRingMaster master(hostName);
@@ -292,6 +371,61 @@ CRingAccess::startPipeline(string hostName, string remoteRingname, string localR
 
 }
 
+/****************************************************************************/
+/* Start feeding the proxy ring from a native transport socket:            */
+/* - fork, parent closes its copy of the socket and returns.                */
+/* - the child daemonizes, as the stdintoring feeder does, so the proxy     */
+/*   ring keeps being fed after the process that started it exits.          */
+/****************************************************************************/
+void
+CRingAccess::startReceiver(string proxyName, int socket)
+{
+  pid_t pid = fork();
+  if (pid < 0) {
+    int err = errno;
+    close(socket);
+    errno = err;
+    throw CErrnoException("CRingAccess::startReceiver - fork failed");
+  }
+  if (pid) {
+    close(socket);
+    return;
+  }
+
+  close(STDIN_FILENO);
+  close(STDOUT_FILENO);
+  if (daemon(1,1)) {
+    int err = errno;
+    cerr << "Unable to daemonize the proxy ring receiver. " << strerror(err) << endl;
+    _exit(-1);
+  }
+  runReceiver(proxyName, socket, m_socketBufferSize);
+  _exit(0);			// Not exit: the parent's atexit handlers aren't ours.
+}
+/****************************************************************************/
+/* Body of the receiver process.  Errors just end the transfer the way a   */
+/* dying stdintoring would.                                                 */
+/****************************************************************************/
+void
+CRingAccess::runReceiver(string proxyName, int socket, size_t bufferSize)
+{
+  CRingBuffer* pRing;
+  try {
+    pRing = new CRingBuffer(proxyName, CRingBuffer::producer);
+  }
+  catch (...) {
+    close(socket);
+    return;
+  }
+  try {
+    CRingTcpReceiver receiver(*pRing, socket, bufferSize); // Owns the socket.
+    receiver();
+  }
+  catch (...) {
+  }
+  delete pRing;
+}
+
 /****************************************************************************/
 /* Start the feeder process for the ringbuffer:                             */
 /* - fork, parent returns, child does the work.                             */
@@ -45,6 +45,16 @@ class CRingBuffer;
   The effect is for there to aggregate the transfer of data from a remote system
   to all the clients of a ring in this system.
 
+  By default the native transport is used instead (see CRingTcpTransport.h).
+  The remote RingMaster is sent a STREAM request and sends the data from a thread
+  of its own, while a detached receiver process forked from this one puts the data
+  in the proxy ring:
+
+  remotering -> RingMaster |network| receiver process -> proxyring.
+
+  Like stdintoring, the receiver outlives the process that started it.  If the remote
+  RingMaster does not understand STREAM requests, the pipeline is used.
+
 */
 class CRingAccess {
   // Static class members. These define the parameters for stdintoring and the proxy
@@ -54,6 +64,8 @@ private:
   static size_t   m_proxyMaxConsumers;
   static size_t   m_minData;
   static unsigned m_Timeout;
+  static bool     m_nativeTransport;
+  static size_t   m_socketBufferSize;
   // Public interface:
 public:
   static size_t setProxyRingSize(size_t newSize);
@@ -68,6 +80,12 @@ public:
   static unsigned setTimeout(unsigned newTimeout);
   static unsigned getTimeout();
 
+  static bool setNativeTransport(bool useNative);
+  static bool getNativeTransport();
+
+  static size_t setSocketBufferSize(size_t newSize);
+  static size_t getSocketBufferSize();
+
 
   static CRingBuffer* daqConsumeFrom(std::string uri);
   static bool local(std::string host);  
@@ -75,6 +93,8 @@ public:
   // Utilities
 private:
   static void startFeeder(std::string proxyName, int socket);
+  static void startReceiver(std::string proxyName, int socket);
+  static void runReceiver(std::string proxyName, int socket, size_t bufferSize);
   static void startPipeline(std::string hostName, 
 			    std::string remoteRingname, 
 			    std::string localRingname);
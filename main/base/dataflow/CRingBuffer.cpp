@@ -33,6 +33,10 @@
 #include <string.h>
 #include <time.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <limits.h>
 
 #include <CPortManager.h>
 #include <sys/types.h>
@@ -42,6 +46,7 @@
 #include <daqshm.h>
 
 #include <iostream>
+#include <mutex>
 
 
 using namespace std;
@@ -50,6 +55,25 @@ using namespace std;
 
 static string localhost("127.0.0.1");
 
+/*
+   Futex helpers.  The ring is shared between processes so the
+   non-private futex operations are used.
+*/
+static void
+futexWait(volatile uint32_t* pWord, uint32_t expected, unsigned long ms)
+{
+  struct timespec timeout;
+  timeout.tv_sec  = ms/1000;
+  timeout.tv_nsec = (ms % 1000)*1000000;
+  syscall(SYS_futex, pWord, FUTEX_WAIT, expected, &timeout, NULL, 0);
+}
+
+static void
+futexWake(volatile uint32_t* pWord)
+{
+  syscall(SYS_futex, pWord, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
 /*
   This file implements the CRingBuffer class.  
 
@@ -60,10 +84,18 @@ static string localhost("127.0.0.1");
 
 size_t CRingBuffer::m_defaultDataSize(DEFAULT_DATASIZE);
 size_t CRingBuffer::m_defaultMaxConsumers(DEFAULT_MAX_CONSUMERS);
+unsigned CRingBuffer::m_defaultFormat(DEFAULT_FORMAT);
+bool   CRingBuffer::m_defaultMirrored(false);
 
 CRingMaster* CRingBuffer::m_pMaster(NULL);
 pid_t        CRingBuffer::m_myPid(-1); // no pid has this.
 
+// Record locks only exclude other processes.  Threads of a process that
+// attach/detach rings (e.g. the ring to ring transports) are serialized by
+// this, which also protects the shared ring master connection.
+
+static std::mutex attachMutex;
+
 
 //////////////////////////////////////////////////////////////////////////////
 // 
@@ -130,10 +162,10 @@ CRingBuffer::create(std::string name,
 
     // Figure out the entire size of the shared memory region and truncate the file to that
     // size:
-    size_t headerSize = sizeof(RingHeader) +
-      sizeof(ClientInformation)*(maxConsumer+1);
+    size_t headerSize = headerBytes(m_defaultFormat, maxConsumer);
 
-    size_t rawSize   = dataBytes + headerSize;
+    size_t rawSize   = dataBytes +
+      dataSegmentOffset(m_defaultFormat, maxConsumer, m_defaultMirrored);
 
     long   pageSize  = sysconf(_SC_PAGESIZE);
     size_t pages     = (rawSize + (pageSize-1))/pageSize;
@@ -313,6 +345,9 @@ CRingBuffer::remove(string name)
    - Format the front of the ring so that there's no producer or consumers.
    - So that the header matches the layout of the buffer.
 
+   The ring is laid out according to the default format version
+   (see setDefaultFormat).
+
    \param name         - Name of the ring buffer. (a / will be prepended).
    \param maxConsumers - Maximum number of supported consumers.
 
@@ -331,33 +366,42 @@ void CRingBuffer::unsynchedFormat(std::string name, size_t maxConsumer)
 
     // Map the ring:
 
+    unsigned           version   = m_defaultFormat;
     pRingHeader        pHeader   = reinterpret_cast<pRingHeader>(pRing);
-    pClientInformation pProducer = reinterpret_cast<pClientInformation>(pHeader + 1);
-    pClientInformation pClients  = pProducer + 1;
+    char*              pBase     = reinterpret_cast<char*>(pRing);
+    size_t             stride    = clientStride(version);
+    off_t              producer  = producerOffset(version, maxConsumer);
+
+    // Version 2 and later rings have a wakeup block and active map between
+    // the header and the client information.  Clearing everything from the
+    // end of the header to the producer clears those and any padding:
+
+    memset(pBase + sizeof(RingHeader), 0, producer - sizeof(RingHeader));
 
     // Fill in the header:
 
-    strcpy(pHeader->s_magicString, MAGICSTRING);
+    const char* magic = MAGICSTRING;
+    if (version == RING_FORMAT_V2) magic = MAGICSTRING_V2;
+    if (version == RING_FORMAT_V3) magic = MAGICSTRING_V3;
+    strcpy(pHeader->s_magicString, magic);
 
     pHeader->s_maxConsumer       = maxConsumer;
-    pHeader->s_producerInfo      = (reinterpret_cast<char*>(pProducer) -
-                    reinterpret_cast<char*>(pHeader));
-    pHeader->s_firstConsumer     = (reinterpret_cast<char*>(pClients) -
-                    reinterpret_cast<char*>(pHeader));
+    pHeader->s_producerInfo      = producer;
+    pHeader->s_firstConsumer     = producer + stride;
     pHeader->s_topOffset         = memSize-1;
-    pHeader->s_dataOffset        = sizeof(RingHeader) +
-                                   sizeof(ClientInformation)*(maxConsumer+1);
+    pHeader->s_dataOffset        = dataSegmentOffset(version, maxConsumer,
+						     m_defaultMirrored);
     pHeader->s_dataBytes         = memSize - pHeader->s_dataOffset;
 
-    // Fill in the client information data structures:
+    // Fill in the client information data structures (the producer is
+    // followed by the consumers):
 
-    pProducer->s_offset          = pHeader->s_dataOffset;
-    pProducer->s_pid             = -1;
-
-    for (int i=0; i < maxConsumer; i++) {
-      pClients->s_offset         = pHeader->s_dataOffset;
-      pClients->s_pid            = -1;
-      pClients++;
+    for (int i=0; i <= maxConsumer; i++) {
+      pClientInformation pClient =
+	reinterpret_cast<pClientInformation>(pBase + producer + i*stride);
+      memset(pClient, 0, stride);
+      pClient->s_offset          = pHeader->s_dataOffset;
+      pClient->s_pid             = -1;
     }
     CDAQShm::detach(pRing, fullName, memSize);
 }
@@ -383,8 +427,7 @@ CRingBuffer::format(std::string name,
 		    size_t maxConsumer)
 {
   // lock
-    size_t headerSize = sizeof(RingHeader) +
-      sizeof(ClientInformation)*(maxConsumer+1);
+    size_t headerSize = headerBytes(m_defaultFormat, maxConsumer);
     CScopedDAQShm shmemFile(shmName(name), O_RDWR);
     DAQ::OS::CPosixBlockingRecordLock lock(shmemFile.getFd(),
                                   DAQ::OS::CPosixBlockingRecordLock::Write,
@@ -460,6 +503,54 @@ CRingBuffer::getDefaultMaxConsumers()
   return m_defaultMaxConsumers;
 }
 
+/*!
+  Set the default format version.  This determines the layout of rings
+  that are subsequently created or formatted.
+  \param version - RING_FORMAT_V1 ... RING_FORMAT_V3 (see ringbufint.h).
+
+  \throw CRangeError - unsupported format version.
+*/
+void
+CRingBuffer::setDefaultFormat(unsigned version)
+{
+  if ((version < RING_FORMAT_V1) || (version > RING_FORMAT_V3)) {
+    throw CRangeError(RING_FORMAT_V1, RING_FORMAT_V3, version,
+		      "CRingBuffer::setDefaultFormat");
+  }
+  m_defaultFormat = version;
+}
+/*!
+   \return unsigned
+   \retval The format version used when creating or formatting rings.
+*/
+unsigned
+CRingBuffer::getDefaultFormat()
+{
+  return m_defaultFormat;
+}
+/*!
+  Select whether rings that are subsequently created or formatted have
+  their data segment page aligned.  Clients map the data segment of
+  such rings twice, back to back, so that no item ever wraps (see
+  isMirrored).  The rings remain usable by clients that don't mirror
+  them.
+  \param mirrored - true to page align the data segment.
+*/
+void
+CRingBuffer::setDefaultMirrored(bool mirrored)
+{
+  m_defaultMirrored = mirrored;
+}
+/*!
+   \return bool
+   \retval true if new rings will be mirrorable.
+*/
+bool
+CRingBuffer::getDefaultMirrored()
+{
+  return m_defaultMirrored;
+}
+
 /**
  * Return the name of the default ring.  This is the name of the logged in
  * user.
@@ -508,8 +599,8 @@ CRingBuffer::defaultRingUrl()
 void CRingBuffer::attach() {
 
   if (m_mode == producer) {
-    if (m_pRing->s_producer.s_pid == -1) {
-      m_pClientInfo         = &(m_pRing->s_producer);
+    if (producerInfo()->s_pid == -1) {
+      m_pClientInfo         = producerInfo();
       m_pClientInfo->s_pid  = getpid(); // leave the offset where it was.
       __sync_synchronize();		  // And flush to shm.
     }
@@ -555,7 +646,13 @@ CRingBuffer::CRingBuffer(string name, CRingBuffer::ClientMode mode) :
   m_pClientInfo(0),
   m_mode(mode),
   m_pollInterval(DEFAULT_POLLMS),
-  m_ringName(name)
+  m_ringName(name),
+  m_pPutWakeup(0),
+  m_pGetWakeup(0),
+  m_pActiveMap(0),
+  m_slowestConsumer(-1),
+  m_mirroredMapSize(0),
+  m_clientStride(sizeof(ClientInformation))
 {
 
     if (!isRing(name)) {
@@ -566,10 +663,39 @@ CRingBuffer::CRingBuffer(string name, CRingBuffer::ClientMode mode) :
     if (m_pRing == nullptr) {
       throw std::string("CRingBuffer::CRingBuffer - failed to map shared memory region.");
     }
+    // If the data segment is page aligned, replace the mapping with one in
+    // which the data segment appears twice.  If that fails just use the
+    // ring unmirrored:
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if ((m_pRing->s_header.s_dataOffset % pageSize) == 0) {
+      std::string fullName = shmName(name);
+      size_t mapSize = m_pRing->s_header.s_topOffset + 1 +
+	m_pRing->s_header.s_dataBytes;
+      RingBuffer* pMirror = reinterpret_cast<RingBuffer*>(
+        CDAQShm::attachMirrored(fullName, m_pRing->s_header.s_dataOffset)
+      );
+      if (pMirror) {
+	unMapRing();
+	m_pRing           = pMirror;
+	m_mirroredMapSize = mapSize;
+      }
+    }
+    unsigned version = formatVersion(m_pRing);
+    char*    pBase   = reinterpret_cast<char*>(m_pRing);
+    if (version >= RING_FORMAT_V2) {
+      m_pPutWakeup = reinterpret_cast<pRingWakeupSide>(pBase + wakeupOffset(version));
+      m_pGetWakeup = (version >= RING_FORMAT_V3) ?
+	reinterpret_cast<pRingWakeupSide>(pBase + wakeupOffset(version) + RING_CACHE_LINE) :
+	m_pPutWakeup + 1;
+      m_pActiveMap = reinterpret_cast<pActiveMapWord>(pBase + activeMapOffset(version));
+    }
+    m_clientStride = clientStride(version);
 
     if (m_mode == manager) return;
 
     // lock
+    std::lock_guard<std::mutex> threadLock(attachMutex);
     size_t headerSize = sizeof(RingHeader) +
       sizeof(ClientInformation)*(m_defaultMaxConsumers+1);
     CScopedDAQShm shmemFile(shmName(name), O_RDWR);
@@ -598,6 +724,9 @@ CRingBuffer::CRingBuffer(string name, CRingBuffer::ClientMode mode) :
       // on any failure, we give up the ring and throw:
 
       m_pClientInfo->s_pid = -1;
+      if (m_mode == consumer) {
+	setActive(getSlot(), false);
+      }
       unMapRing();
       throw;
     }
@@ -614,6 +743,7 @@ CRingBuffer::~CRingBuffer()
 
   if (m_mode != manager) {
     //lock
+    std::lock_guard<std::mutex> threadLock(attachMutex);
     size_t headerSize = sizeof(RingHeader) +
       sizeof(ClientInformation)*(m_defaultMaxConsumers+1);
     CScopedDAQShm shmemFile(shmName(m_ringName), O_RDWR);
@@ -624,6 +754,9 @@ CRingBuffer::~CRingBuffer()
 
     string ringname = m_ringName;
     m_pClientInfo->s_pid = -1;
+    if (m_mode == consumer) {
+      setActive(getSlot(), false);
+    }
     // Let the ringmaster know we're disconnecting.
     // the client pointer is still valid as is the map so the notification
     // can still find the 'slot number.
@@ -679,61 +812,103 @@ CRingBuffer::~CRingBuffer()
 size_t
 CRingBuffer::put(const void* pBuffer, size_t nBytes, unsigned long timeout)
 {
-  validateTransferAccess(producer, "CRingBuffer::put");
-
-  // Ensure the ring is big enough for the data:
-
-  if (nBytes > m_pRing->s_header.s_dataBytes) {
-    throw CRangeError(0, m_pRing->s_header.s_dataBytes, nBytes,
-		      "CRingBuffer::put");
-
-  }
-  // Block until we have space. 
-
-  CRingFreeSpacePredicate condition(nBytes);
-  int status = blockWhile(condition, timeout);
-  if (status) {
+  Reservation space;
+  if (reserve(nBytes, space, timeout) != nBytes) {
     return 0;			// timed out.
   }
-  // Now we need to figure out how to put the data in the ring.
-  // We may need to wrap the data across the top of the buffer.
-  //
+  space.copyIn(0, pBuffer, nBytes);
+  commit(nBytes);
 
-  off_t ringBase = m_pRing->s_header.s_dataOffset;
-  off_t ringTop  = m_pRing->s_header.s_topOffset;
-  char* pDataBase= reinterpret_cast<char*>(m_pRing) + ringBase;
-  char* pPut     = reinterpret_cast<char*>(m_pRing) + m_pClientInfo->s_offset;
+  return nBytes;
+}
+/*!
+   Reserve space in the ring for in place writes by the producer.
+   - Block until there's sufficient space.
+   - Describe the space, which may wrap at the top of the ring.
 
-  if ((m_pClientInfo->s_offset + nBytes) <=  (ringTop+1)) {
+   The producer may then write any number of items into the space
+   and publish all of them at once with commit().  Nothing is visible
+   to consumers until commit is called.  A subsequent reserve returns
+   the same space (plus any additional space) so a partially written
+   reservation can be extended.
 
-    // Can move all at once...
+   \note  The ring buffer must have been attached to in producer mode or
+          a CStateException will be thrown.
 
-    memcpy(pPut, pBuffer, nBytes);
+   \param nBytes  - Number of bytes to reserve.
+   \param space   - Filled in with the description of the reserved space.
+   \param timeout - Seconds to block for space (see put).
 
+   \return size_t
+   \retval nBytes - The space was reserved.
+   \retval 0      - Wait for available space timed out.
 
-  }
-  else {
-    // Need to move in two chunks:
+   \throw CRangeException - nBytes is larger than the ring data segment.
+   \throw CStateException - This CRingBuffer object is not open for producer use.
+*/
+size_t
+CRingBuffer::reserve(size_t nBytes, Reservation& space, unsigned long timeout)
+{
+  validateTransferAccess(producer, "CRingBuffer::reserve");
 
-    size_t firstSize = ringTop+1 - m_pClientInfo->s_offset;
-    size_t secondSize= nBytes - firstSize;
+  // Ensure the ring is big enough for the data.  A full ring can't be
+  // told from an empty one so there's always at least a byte free:
 
-    
+  if (nBytes >= m_pRing->s_header.s_dataBytes) {
+    throw CRangeError(0, m_pRing->s_header.s_dataBytes-1, nBytes,
+		      "CRingBuffer::reserve");
 
-    memcpy(pPut, pBuffer, firstSize);                     // Move the first chunk.
+  }
+  // Block until we have space.  The consumers can only have freed space since
+  // we last looked so the scan of the consumers is only needed if our cached
+  // idea of the free space is too small.
+
+  if (cachedPutSpace() < nBytes) {
+    CRingFreeSpacePredicate condition(nBytes);
+    int status = blockWhile(condition, timeout);
+    if (status) {
+      return 0;			// timed out.
+    }
+  }
+  // Describe the space, we may need to wrap across the top of the buffer.
 
-    const char* pSecond = reinterpret_cast<const char*>(pBuffer) + firstSize;
-    memcpy(pDataBase, pSecond, secondSize);              // Move the second chunk. 
+  off_t ringBase = m_pRing->s_header.s_dataOffset;
+  off_t ringTop  = m_pRing->s_header.s_topOffset;
+  off_t putOffset= m_pClientInfo->s_offset;
+  char* pDataBase= reinterpret_cast<char*>(m_pRing) + ringBase;
 
+  space.s_pFirst = reinterpret_cast<char*>(m_pRing) + putOffset;
+  if (isMirrored() || ((putOffset + nBytes) <= (ringTop+1))) {
+    space.s_firstBytes  = nBytes;
+    space.s_pSecond     = 0;
+    space.s_secondBytes = 0;
+  } else {
+    space.s_firstBytes  = ringTop+1 - putOffset;
+    space.s_pSecond     = pDataBase;
+    space.s_secondBytes = nBytes - space.s_firstBytes;
   }
-  Skip(nBytes);
-
-  // If we got this far success... issue a memory barrier to ensure this all is
-  // written to the shm:
+  return nBytes;
+}
+/*!
+   Publish data the producer has written in place.  The put pointer is
+   advanced with a single store which releases all of the data written
+   before it to the consumers.
 
-  __sync_synchronize();
+   \param nBytes - Number of bytes to publish.  This should not be more
+                   than was reserved.
 
-  return nBytes;
+   \throw CRangeException - nBytes is larger than the ring data segment.
+   \throw CStateException - This CRingBuffer object is not open for producer use.
+*/
+void
+CRingBuffer::commit(size_t nBytes)
+{
+  validateTransferAccess(producer, "CRingBuffer::commit");
+  if (nBytes >= m_pRing->s_header.s_dataBytes) {
+    throw CRangeError(0, m_pRing->s_header.s_dataBytes-1, nBytes,
+		      "CRingBuffer::commit");
+  }
+  Skip(nBytes);
 }
 
 /*!
@@ -842,7 +1017,7 @@ CRingBuffer::peek(void*   pBuffer,
 
   // Decide if this can be transferred in one or two chunks:
 
-  if (m_pClientInfo->s_offset + transferSize <= (ringTop+1)) {
+  if (isMirrored() || (m_pClientInfo->s_offset + transferSize <= (ringTop+1))) {
 
     // only need a single transfer:
 
@@ -946,25 +1121,62 @@ CRingBuffer::getPointer()
 bool
 CRingBuffer::wouldWrap(size_t nBytes)
 {
+ if (isMirrored()) return false;
  off_t ringTop  = m_pRing->s_header.s_topOffset;
  off_t desiredTop = m_pClientInfo->s_offset + nBytes;
  return desiredTop > ringTop;
 }
 
 /**
- * @return size_t - number of bytes from get pointer to top.
+ * @return size_t - number of bytes from get pointer to top.  For mirrored
+ *                  rings this is the size of the data segment as that
+ *                  much data is always contiguous.
  */
+bool
+CRingBuffer::isMirrored() const
+{
+  return m_mirroredMapSize != 0;
+}
+
 size_t
 CRingBuffer::bytesToTop()
 {
+  if (isMirrored()) {
+    return m_pRing->s_header.s_dataBytes;
+  }
   return m_pRing->s_header.s_topOffset - m_pClientInfo->s_offset + 1;
 }
+/**
+ * getOffset
+ *    Offsets in the ring are offsets into the shared memory segment so
+ *    this can be used to transfer data directly from the segment's file
+ *    (e.g. with sendfile(2)).  Note that the file itself is not mirrored.
+ *
+ * @return off_t - offset of the get (put for producers) pointer relative
+ *                 to the start of the shared memory segment.
+ */
+off_t
+CRingBuffer::getOffset()
+{
+  return m_pClientInfo->s_offset;
+}
+/**
+ * @return std::string - name of the ring this object is attached to.
+ */
+std::string
+CRingBuffer::getName() const
+{
+  return m_ringName;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 //  Inquiry member functions.
 
 
 /*!
+   For a producer, this also refreshes the cached offset of the slowest
+   consumer that put uses to avoid scanning the consumers on every put.
+
    \return size_t
    \retval the number of bytes of space available in which to put new data in
            the ring buffer.
@@ -974,32 +1186,54 @@ CRingBuffer::availablePutSpace()
 {
   pRingHeader pHeader   = reinterpret_cast<pRingHeader>(m_pRing);
   size_t      consumers = pHeader->s_maxConsumer;
-
-  pClientInformation pClients = reinterpret_cast<pClientInformation>(reinterpret_cast<char*>(m_pRing) + 
-								      pHeader->s_firstConsumer);
+  size_t      words     = ACTIVE_MAP_WORDS(consumers);
 
   // figure out the minimum free space:
 
-  size_t minFree =  pHeader->s_dataBytes-1;
-  for (int i = 0; i < consumers;  i++) {
-    // If the ring is in transition (a new consumer joining)... we need to 
-    // wait a bit and try again so that we are not looking at get pointers in flux.
-    //
-    if (pClients->s_pid == 0) {
-      Os::usleep(100);		// Wait 100usec.
-      i = 0;			// and reset the loop.
-      minFree  = pHeader->s_dataBytes-1;
-      pClients = reinterpret_cast<pClientInformation>(reinterpret_cast<char*>(m_pRing) + 
-						      pHeader->s_firstConsumer);
-    }
+  size_t minFree;
+  off_t  slowest;
+  bool   inTransition;
+  do {
+    minFree      = pHeader->s_dataBytes-1;
+    slowest      = producerInfo()->s_offset;
+    inTransition = false;
+    for (size_t w = 0; (w < words) && !inTransition; w++) {
+
+      // V2 rings tell us which slots are in use so we can skip
+      // unused ones a word at a time.  V1 rings have to look at all slots.
+
+      uint64_t active  = m_pActiveMap ? m_pActiveMap[w] : ~static_cast<uint64_t>(0);
+      while (active) {
+	size_t slot = w*64 + __builtin_ctzll(active);
+	active     &= active - 1;
+	if (slot >= consumers) break;
+
+	pClientInformation pClient = consumerInfo(slot);
+
+	// If the ring is in transition (a new consumer joining)... we need to 
+	// wait a bit and try again so that we are not looking at get pointers in flux.
+	//
+	if (pClient->s_pid == 0) {
+	  Os::usleep(100);		// Wait 100usec.
+	  inTransition = true;		// and restart the scan.
+	  break;
+	}
     
-    if(pClients->s_pid > 0) {	// -1  - unused 0 - initializing > 0 fully  in use.
-      size_t avail     = availableData(pClients);
-      size_t freeBytes = pHeader->s_dataBytes - avail - 1; // 
-      if (freeBytes < minFree) minFree = freeBytes;
+	if(pClient->s_pid > 0) {	// -1  - unused 0 - initializing > 0 fully  in use.
+	  off_t  offset    = pClient->s_offset;
+	  size_t avail     = difference(producerInfo()->s_offset, offset);
+	  size_t freeBytes = pHeader->s_dataBytes - avail - 1; // 
+	  if (freeBytes < minFree) {
+	    minFree = freeBytes;
+	    slowest = offset;
+	  }
+	}
+      }
     }
+  } while (inTransition);
 
-    pClients++;
+  if (m_mode == producer) {
+    m_slowestConsumer = slowest;
   }
   return minFree;
 }
@@ -1037,8 +1271,7 @@ CRingBuffer::getUsage()
 {
 
   pRingHeader         pHead      = &(m_pRing->s_header);
-  pClientInformation  pProducer  = &(m_pRing->s_producer);
-  pClientInformation  pConsumers = m_pRing->s_consumers;
+  pClientInformation  pProducer  = producerInfo();
 
   Usage  result;
   result.s_bufferSpace = pHead->s_dataBytes;
@@ -1049,13 +1282,13 @@ CRingBuffer::getUsage()
   // Get information about all the consumers:
 
   for (int i =0; i < result.s_maxConsumers; i++) {
-    if (pConsumers->s_pid != -1) {
+    pClientInformation pConsumer = consumerInfo(i);
+    if (pConsumer->s_pid != -1) {
       pair<pid_t, size_t> info;
-      info.first  = pConsumers->s_pid;
-      info.second = difference(*pProducer, *pConsumers);
+      info.first  = pConsumer->s_pid;
+      info.second = difference(*pProducer, *pConsumer);
       result.s_consumers.push_back(info);
     }
-    pConsumers++;
   }
   // Figure out the max/min data available.
   // Special case of no consumers means that the 0 space is available for both.
@@ -1090,11 +1323,20 @@ CRingBuffer::getSlot()
   if (m_mode == manager)  return -1;
 
   for (int i = 0; i < m_pRing->s_header.s_maxConsumer; i++) {
-    pClientInformation p = &(m_pRing->s_consumers[i]);
+    pClientInformation p = consumerInfo(i);
     if (p == m_pClientInfo) return i;
   }
   return -2;			// Really 'impossible'.
 }
+/*!
+  \return unsigned
+  \retval The format version of the ring we are attached to.
+*/
+unsigned
+CRingBuffer::getFormat()
+{
+  return formatVersion(m_pRing);
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 //  Blocking functions:
@@ -1120,12 +1362,31 @@ CRingBuffer::blockWhile(CRingBuffer::CRingBufferPredicate& pred, unsigned long t
   // Lower the latencey by special casing the timeout == 0:
 
   if (timeout) {
-    time_t start = time(NULL);
-    while (pred(*this)) {
+    time_t   start = time(NULL);
+    unsigned spins = 0;
+    while (true) {
+      // Rings with a wakeup block let us sleep until the other side
+      // moves its pointer.  The sequence must be sampled before the
+      // predicate is evaluated so that no wakeup can be lost:
+
+      uint32_t sequence = m_pPutWakeup ? *wakeupSequence(m_mode) : 0;
+      if (!pred(*this)) break;
+
       time_t now = time(NULL);
       if ((now - start) >= timeout) 
         return -1; // timeout
-      pollblock(); // wait a bit before checking condition.
+      if (m_pPutWakeup) {
+	// At high rates the condition usually clears in a few microseconds.
+	// Spinning that long first saves both sides the futex system calls.
+
+	if (spins++ < DEFAULT_SPINS) {
+	  sched_yield();
+	  continue;
+	}
+	waitForChange(m_mode, sequence);
+      } else {
+	pollblock(); // wait a bit before checking condition.
+      }
     }
     
     return 0;			// condition no longer true.
@@ -1151,12 +1412,15 @@ CRingBuffer::While(CRingBuffer::CRingBufferPredicate& pred)
 }
 
 /*!
-  Block for the polling interval
+  Block for the current poll interval.  For rings with a wakeup block,
+  the block ends early if the other side of the ring moves its pointer.
 */
 void
 CRingBuffer::pollblock()
 {
-  if (m_pollInterval> 0) {
+  if (m_pPutWakeup) {
+    waitForChange(m_mode, *wakeupSequence(m_mode));
+  } else if (m_pollInterval> 0) {
     Os::usleep(m_pollInterval * 1000); // wait a bit before checking condition.
   }
 }
@@ -1175,7 +1439,7 @@ CRingBuffer::forceProducerRelease()
     throw CStateException(modeString().c_str(), "manager",
 			  "CRingBuffer::forceProducerRelease");
   }
-  m_pRing->s_producer.s_pid = -1;
+  producerInfo()->s_pid = -1;
 }
 
 /*!
@@ -1198,7 +1462,8 @@ CRingBuffer::forceConsumerRelease(unsigned slot)
 		      slot,
 		      "CRingBuffer::forceConsumerRelease");
   }
-  m_pRing->s_consumers[slot].s_pid = -1;
+  consumerInfo(slot)->s_pid = -1;
+  setActive(slot, false);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1255,7 +1520,12 @@ void
 CRingBuffer::unMapRing()
 {
   std::string fullName = shmName(m_ringName);
-  CDAQShm::detach(m_pRing, fullName, CDAQShm::size(fullName));
+  if (isMirrored()) {
+    CDAQShm::detachMirrored(m_pRing, fullName, m_mirroredMapSize);
+    m_mirroredMapSize = 0;
+  } else {
+    CDAQShm::detach(m_pRing, fullName, CDAQShm::size(fullName));
+  }
   
 }
 /******************************************************************/
@@ -1279,6 +1549,7 @@ CRingBuffer::allocateConsumer()
     if (p->s_pid == -1) {
       p->s_pid = 0;		// Claim it as in use but not active.
       __sync_synchronize();	// Flush to shm as well.
+      setActive(i, true);	// Producer must now consider us.
 
       // The loop below deals with any cases where the put pointer moved
       // While we were joining up.
@@ -1294,7 +1565,7 @@ CRingBuffer::allocateConsumer()
       return;
     }
 
-    p++;
+    p = consumerInfo(i+1);
   }
   errno = ENOMEM;
   throw CErrnoException("CRingBuffer::allocateConsumer");
@@ -1307,11 +1578,16 @@ CRingBuffer::allocateConsumer()
 
 size_t
 CRingBuffer::difference(ClientInformation& producer, ClientInformation& consumer)
+{
+  return difference(producer.s_offset, consumer.s_offset);
+}
+size_t
+CRingBuffer::difference(off_t putOffset, off_t getOffset)
 {
   // If the producer is bigger than the consumer it's a simple difference:
 
-  if (producer.s_offset >= consumer.s_offset) {
-    return producer.s_offset - consumer.s_offset;
+  if (putOffset >= getOffset) {
+    return putOffset - getOffset;
   }
   // Otherwise, the answer is the sum of how far the consumer offset is from the
   // top of the ring and how far the producer is from the bottom.
@@ -1321,10 +1597,40 @@ CRingBuffer::difference(ClientInformation& producer, ClientInformation& consumer
   // The + 1 below.. If my offset is right at the top,
   // I have one byte..the byte I point to but the difference is 0.
 
-  size_t topSize = pHeader->s_topOffset - consumer.s_offset +1 ;
-  size_t botSize = producer.s_offset   - pHeader->s_dataOffset;
+  size_t topSize = pHeader->s_topOffset - getOffset +1 ;
+  size_t botSize = putOffset   - pHeader->s_dataOffset;
   return topSize + botSize;
 }
+/******************************************************************/
+/* Producer's lower bound on the put space. This is computed from */
+/* the offset of the slowest consumer as of the last full scan.   */
+/* Consumers only free space and new consumers join at the put    */
+/* pointer, so this never overstates the free space.              */
+/******************************************************************/
+size_t
+CRingBuffer::cachedPutSpace()
+{
+  if (m_slowestConsumer < 0) return 0; // Never scanned.
+
+  size_t used = difference(m_pClientInfo->s_offset, m_slowestConsumer);
+  return m_pRing->s_header.s_dataBytes - used - 1;
+}
+/******************************************************************/
+/* Set or clear a consumer slot's bit in the active map.  This is */
+/* a no-op for V1 rings which don't have one.                     */
+/******************************************************************/
+void
+CRingBuffer::setActive(size_t slot, bool active)
+{
+  if (!m_pActiveMap) return;
+
+  uint64_t bit = static_cast<uint64_t>(1) << (slot % 64);
+  if (active) {
+    __sync_fetch_and_or(&m_pActiveMap[slot/64], bit);
+  } else {
+    __sync_fetch_and_and(&m_pActiveMap[slot/64], ~bit);
+  }
+}
 
 /******************************************************************/
 /* Move the object's pointer ahead the designated number of bytes */
@@ -1335,14 +1641,127 @@ CRingBuffer::Skip(size_t nBytes)
 {
   pRingHeader pHeader = &(m_pRing->s_header);
 
-  m_pClientInfo->s_offset += nBytes;
-  if (m_pClientInfo->s_offset > pHeader->s_topOffset) {
-    m_pClientInfo->s_offset = (m_pClientInfo->s_offset - pHeader->s_topOffset) +
-                              pHeader->s_dataOffset - 1;
+  off_t offset = m_pClientInfo->s_offset + nBytes;
+  if (offset > pHeader->s_topOffset) {
+    offset = (offset - pHeader->s_topOffset) + pHeader->s_dataOffset - 1;
+  }
+  // A single release store publishes everything written before it and
+  // ensures the other side never sees an unwrapped offset.
+
+  __atomic_store_n(&(m_pClientInfo->s_offset), offset, __ATOMIC_RELEASE);
+  signalChange();
+}
+
+/*!
+   Copy data into a reservation, wrapping into the second span as needed.
+   \param offset - Offset into the reservation at which to start.
+   \param pData  - Data to copy.
+   \param nBytes - Number of bytes to copy.
+*/
+void
+CRingBuffer::Reservation::copyIn(size_t offset, const void* pData, size_t nBytes)
+{
+  const char* pSrc = reinterpret_cast<const char*>(pData);
+  if (offset < s_firstBytes) {
+    size_t n = s_firstBytes - offset;
+    if (n > nBytes) n = nBytes;
+    memcpy(reinterpret_cast<char*>(s_pFirst) + offset, pSrc, n);
+    pSrc   += n;
+    nBytes -= n;
+    offset  = 0;
+  } else {
+    offset -= s_firstBytes;
+  }
+  if (nBytes) {
+    memcpy(reinterpret_cast<char*>(s_pSecond) + offset, pSrc, nBytes);
+  }
+}
+/*!
+   Copy data out of a reservation, e.g. to look at an item header that
+   may straddle the wrap.
+   \param offset - Offset into the reservation at which to start.
+   \param pData  - Where to put the data.
+   \param nBytes - Number of bytes to copy.
+*/
+void
+CRingBuffer::Reservation::copyOut(size_t offset, void* pData, size_t nBytes) const
+{
+  char* pDest = reinterpret_cast<char*>(pData);
+  if (offset < s_firstBytes) {
+    size_t n = s_firstBytes - offset;
+    if (n > nBytes) n = nBytes;
+    memcpy(pDest, reinterpret_cast<const char*>(s_pFirst) + offset, n);
+    pDest  += n;
+    nBytes -= n;
+    offset  = 0;
+  } else {
+    offset -= s_firstBytes;
   }
-  // Issue a memory barrier to ensure this is flushed out to the shared memory?
+  if (nBytes) {
+    memcpy(pDest, reinterpret_cast<const char*>(s_pSecond) + offset, nBytes);
+  }
+}
+
+/******************************************************************/
+/* Locate the producer's client information.                      */
+/******************************************************************/
+ClientInformation*
+CRingBuffer::producerInfo()
+{
+  return reinterpret_cast<pClientInformation>(reinterpret_cast<char*>(m_pRing) +
+					      m_pRing->s_header.s_producerInfo);
+}
+/******************************************************************/
+/* Locate the client information for a consumer slot.             */
+/******************************************************************/
+ClientInformation*
+CRingBuffer::consumerInfo(size_t slot)
+{
+  return reinterpret_cast<pClientInformation>(reinterpret_cast<char*>(m_pRing) +
+					      m_pRing->s_header.s_firstConsumer +
+					      slot*m_clientStride);
+}
+/******************************************************************/
+/* Return the wakeup sequence a client in the given mode blocks   */
+/* on.  Consumers wait for the producer to put, producers wait    */
+/* for consumers to get.                                          */
+/******************************************************************/
+volatile uint32_t*
+CRingBuffer::wakeupSequence(ClientMode mode)
+{
+  return (mode == producer) ? &(m_pGetWakeup->s_sequence) :
+                              &(m_pPutWakeup->s_sequence);
+}
+/******************************************************************/
+/* Block for at most the poll interval or until the sequence we   */
+/* wait on is no longer the value passed in.  A poll interval of  */
+/* zero means spin, as it always has.                             */
+/******************************************************************/
+void
+CRingBuffer::waitForChange(ClientMode mode, uint32_t sequence)
+{
+  if (m_pollInterval == 0) return;
+
+  volatile uint32_t* pWaiters = (mode == producer) ?
+    &(m_pGetWakeup->s_waiters) : &(m_pPutWakeup->s_waiters);
 
-  __sync_synchronize();
+  __sync_fetch_and_add(pWaiters, 1);
+  futexWait(wakeupSequence(mode), sequence, m_pollInterval);
+  __sync_fetch_and_sub(pWaiters, 1);
+}
+/******************************************************************/
+/* Let clients blocked on the other side of the ring know our     */
+/* pointer moved.  The wake system call is only made if someone   */
+/* is waiting.                                                    */
+/******************************************************************/
+void
+CRingBuffer::signalChange()
+{
+  if (!m_pPutWakeup) return;
+
+  pRingWakeupSide pSide = (m_mode == producer) ? m_pPutWakeup : m_pGetWakeup;
+  __sync_fetch_and_add(&(pSide->s_sequence), 1);
+  if (pSide->s_waiters) futexWake(&(pSide->s_sequence));
 }
 /***************************************************************/
 /* Return the stringified mode                                 */
@@ -1422,8 +1841,91 @@ CRingBuffer::notifyDisconnection()
 bool
 CRingBuffer::ringHeader(RingBuffer* p)
 {
-return strcmp(p->s_header.s_magicString, 
-	       MAGICSTRING) == 0;
+  return formatVersion(p) != 0;
+}
+/**********************************************************************/
+/* Return the format version of the ring whose header is pointed to  */
+/* by p. 0 is returned if p does not point to a ring header.          */
+/**********************************************************************/
+unsigned
+CRingBuffer::formatVersion(RingBuffer* p)
+{
+  if (strcmp(p->s_header.s_magicString, MAGICSTRING) == 0) {
+    return RING_FORMAT_V1;
+  }
+  if (strcmp(p->s_header.s_magicString, MAGICSTRING_V2) == 0) {
+    return RING_FORMAT_V2;
+  }
+  if (strcmp(p->s_header.s_magicString, MAGICSTRING_V3) == 0) {
+    return RING_FORMAT_V3;
+  }
+  return 0;
+}
+/**********************************************************************/
+/* Return the number of bytes that precede the data segment in a ring */
+/* of the given format version with maxConsumer consumer slots.       */
+/**********************************************************************/
+size_t
+CRingBuffer::headerBytes(unsigned version, size_t maxConsumer)
+{
+  return producerOffset(version, maxConsumer) +
+    clientStride(version)*(maxConsumer+1);
+}
+/**********************************************************************/
+/* Return the distance between client descriptors.                    */
+/**********************************************************************/
+size_t
+CRingBuffer::clientStride(unsigned version)
+{
+  return (version >= RING_FORMAT_V3) ?
+    RING_CACHE_ALIGN(sizeof(ClientInformation)) : sizeof(ClientInformation);
+}
+/**********************************************************************/
+/* Return the offset of the wakeup block (V2 and later).              */
+/**********************************************************************/
+size_t
+CRingBuffer::wakeupOffset(unsigned version)
+{
+  return (version >= RING_FORMAT_V3) ?
+    RING_CACHE_ALIGN(sizeof(RingHeader)) : sizeof(RingHeader);
+}
+/**********************************************************************/
+/* Return the offset of the consumer active map (V2 and later).       */
+/**********************************************************************/
+size_t
+CRingBuffer::activeMapOffset(unsigned version)
+{
+  return wakeupOffset(version) +
+    ((version >= RING_FORMAT_V3) ? 2*RING_CACHE_LINE : sizeof(RingWakeup));
+}
+/**********************************************************************/
+/* Return the offset of the producer descriptor.                      */
+/**********************************************************************/
+size_t
+CRingBuffer::producerOffset(unsigned version, size_t maxConsumer)
+{
+  if (version < RING_FORMAT_V2) {
+    return sizeof(RingHeader);
+  }
+  size_t mapBytes = ACTIVE_MAP_WORDS(maxConsumer)*sizeof(ActiveMapWord);
+  if (version >= RING_FORMAT_V3) {
+    mapBytes = RING_CACHE_ALIGN(mapBytes);
+  }
+  return activeMapOffset(version) + mapBytes;
+}
+/**********************************************************************/
+/* Return the offset of the data segment.  If the ring is to be       */
+/* mirrored this is the header size rounded up to a page.             */
+/**********************************************************************/
+size_t
+CRingBuffer::dataSegmentOffset(unsigned version, size_t maxConsumer, bool mirrored)
+{
+  size_t result = headerBytes(version, maxConsumer);
+  if (mirrored) {
+    long pageSize = sysconf(_SC_PAGESIZE);
+    result = ((result + pageSize - 1)/pageSize)*pageSize;
+  }
+  return result;
 }
 /**
  * validateTransferAccess
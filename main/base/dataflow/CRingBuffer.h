@@ -21,11 +21,13 @@
 #include <string>
 #include <vector>
 #include <limits.h>
+#include <stdint.h>
 
 // Forward class/struct definitions.
 
 typedef struct __RingBuffer        RingBuffer;
 typedef struct __ClientInformation ClientInformation;
+typedef struct __RingWakeupSide    RingWakeupSide;
 class CRingMaster;
 
 /*!
@@ -57,10 +59,26 @@ public:
   public:
     virtual bool operator()(CRingBuffer& ring) = 0;
   };
+
+  // Space reserved by a producer for in place writes.  The space may
+  // wrap at the top of the ring so it's described by up to two spans
+  // (always one for mirrored rings).
+
+  struct Reservation {
+    void*    s_pFirst;
+    size_t   s_firstBytes;
+    void*    s_pSecond;		// Null if the space does not wrap.
+    size_t   s_secondBytes;
+
+    void copyIn(size_t offset, const void* pData, size_t nBytes);
+    void copyOut(size_t offset, void* pData, size_t nBytes) const;
+  };
   // Class data
 private:
   static size_t m_defaultDataSize;     // Default ring buffer data segment size. 
   static size_t m_defaultMaxConsumers; // Default for maximun consumers allowed.
+  static unsigned m_defaultFormat;     // Default format version for new rings.
+  static bool   m_defaultMirrored;     // New rings have page aligned data segments.
   static CRingMaster* m_pMaster;	       // Connection to the ring master daemon.
   static pid_t        m_myPid;	       // Pid so forks will make new ringmaster conns.
   // Member data
@@ -70,6 +88,12 @@ private:
   ClientMode          m_mode;	       // What sort of client this is.
   unsigned long       m_pollInterval;  // ms between blocking polls.
   std::string         m_ringName;      // Name of ring we're connected to.
+  RingWakeupSide*     m_pPutWakeup;    // Futex wakeup block put side (null for V1 rings).
+  RingWakeupSide*     m_pGetWakeup;    // Futex wakeup block get side (null for V1 rings).
+  volatile uint64_t*  m_pActiveMap;    // Consumer active map (null for V1 rings).
+  off_t               m_slowestConsumer; // Producer: cached slowest get offset.
+  size_t              m_mirroredMapSize; // Size of mirrored mapping, 0 if not mirrored.
+  size_t              m_clientStride;  // Bytes between client descriptors.
 
   // Static member functions,
 public:
@@ -91,6 +115,10 @@ public:
   static size_t getDefaultRingSize();
   static void   setDefaultMaxConsumers(size_t numConsumers);
   static size_t getDefaultMaxConsumers();
+  static void   setDefaultFormat(unsigned version);
+  static unsigned getDefaultFormat();
+  static void   setDefaultMirrored(bool mirrored);
+  static bool   getDefaultMirrored();
   static std::string defaultRing();
   static std::string defaultRingUrl();
 
@@ -114,6 +142,12 @@ public:
   virtual size_t peek(void* pBuffer, size_t maxbytes);
   virtual void   skip(size_t nBytes);
 
+  // Producer in place writes; several items can be written into one
+  // reservation and published with a single commit.
+
+  size_t reserve(size_t nBytes, Reservation& space, unsigned long timeout=ULONG_MAX);
+  void   commit(size_t nBytes);
+
   unsigned long setPollInterval(unsigned long newValue);
   unsigned long getPollInterval();
   
@@ -122,6 +156,10 @@ public:
   void*  getPointer();                  // Return ring item get pointer.k
   bool   wouldWrap(size_t nBytes);      // True if nbytes from get pointer wraps.
   size_t bytesToTop();                  // Bytes from get pointer to ring buffer top.
+  bool   isMirrored() const;            // Data segment mapped twice - nothing wraps.
+  off_t  getOffset();                   // Offset of the get/put pointer in the shm segment.
+  std::string getName() const;          // Name of the ring we're attached to.
+  static std::string shmName(std::string rawName); // Shared memory segment of a ring.
   
   // Inquiry functions.
 
@@ -131,6 +169,7 @@ public:
   Usage getUsage();
 
   off_t getSlot();
+  unsigned getFormat();
 
   // blocking.
 
@@ -153,11 +192,26 @@ private:
   void        unMapRing();
   void        allocateConsumer();
   size_t      difference(ClientInformation& producer, ClientInformation& consumer);
+  size_t      difference(off_t putOffset, off_t getOffset);
+  size_t      cachedPutSpace();
+  void        setActive(size_t slot, bool active);
   void        Skip(size_t nBytes);
+  ClientInformation* producerInfo();
+  ClientInformation* consumerInfo(size_t slot);
+  volatile uint32_t* wakeupSequence(ClientMode mode);
+  void        waitForChange(ClientMode mode, uint32_t sequence);
+  void        signalChange();
 
-  static std::string shmName(std::string rawName);
   static RingBuffer* mapRingBuffer(std::string fullName);
   static bool        ringHeader(RingBuffer* p);
+  static unsigned    formatVersion(RingBuffer* p);
+  static size_t      headerBytes(unsigned version, size_t maxConsumer);
+  static size_t      clientStride(unsigned version);
+  static size_t      wakeupOffset(unsigned version);
+  static size_t      activeMapOffset(unsigned version);
+  static size_t      producerOffset(unsigned version, size_t maxConsumer);
+  static size_t      dataSegmentOffset(unsigned version, size_t maxConsumer,
+				       bool mirrored);
 
   std::string        modeString() const;
 
@@ -16,10 +16,17 @@
 #include <config.h>
 #include "CRingCommand.h"
 #include "CRingMaster.h"
+#include "CRingTcpTransport.h"
 #include <CRingBuffer.h>
+#include <CRemoteAccess.h>
 #include <Exception.h>
 #include <ErrnoException.h>
 #include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <tcl.h>
+#include <thread>
 
 #include "TCLInterpreter.h"
 #include "TCLObject.h"
@@ -28,6 +35,51 @@
 
 using namespace std;
 
+// Overrides the ring layout defaults for the lifetime of the object.
+// The format is set first as it's the one that can throw.
+
+namespace {
+  class LayoutDefaults {
+    unsigned m_format;
+    bool     m_mirrored;
+  public:
+    LayoutDefaults(unsigned format, bool mirrored) :
+      m_format(CRingBuffer::getDefaultFormat()),
+      m_mirrored(CRingBuffer::getDefaultMirrored())
+    {
+      CRingBuffer::setDefaultFormat(format);
+      CRingBuffer::setDefaultMirrored(mirrored);
+    }
+    ~LayoutDefaults() {
+      CRingBuffer::setDefaultFormat(m_format);
+      CRingBuffer::setDefaultMirrored(m_mirrored);
+    }
+  };
+
+  // Body of a stream sender thread.  Exceptions can't leave the thread
+  // so errors just end the stream.  The consumer is attached here rather
+  // than in the command so a ring master can serve its own CONNECT.
+
+  void runSender(string name, int socket, size_t bufferSize)
+  {
+    CRingBuffer* pRing;
+    try {
+      pRing = new CRingBuffer(name, CRingBuffer::consumer);
+    }
+    catch (...) {
+      close(socket);
+      return;
+    }
+    try {
+      CRingTcpSender sender(*pRing, socket, bufferSize);
+      sender();
+    }
+    catch (...) {
+    }
+    delete pRing;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 // Constructors and implemented canonicals:
 
@@ -108,6 +160,8 @@ CRingCommand::operator()(CTCLInterpreter&    interp,
     return remove(interp,objv);
   } else if (subCommand == string("list")) {
     return list(interp, objv);
+  } else if (subCommand == string("stream")) {
+    return stream(interp, objv);
   } else {
     string result;
     result += "Invalid subCommand keyword: ";
@@ -127,10 +181,13 @@ CRingCommand::operator()(CTCLInterpreter&    interp,
 
 /*************************************************************************/
 /* create a new ring buffer:                                             */
-/*  ringbuffer create  name ?size ?maxconsumers??                        */
+/*  ringbuffer create  name ?size ?maxconsumers ?mirrored ?version????   */
 /*  name - the name of the ring buffer.                                  */
 /*  size - the optional size specification                               */
 /*  maxconsumers - the optional maximum consumer count.                  */
+/*  mirrored - optional, nonzero to page align the data segment so that  */
+/*             clients can map it mirrored.                              */
+/*  version  - optional ring format version.                             */
 /*                                                                       */
 /* Result:                                                               */
 /*   An error message if an error occurs.                                */
@@ -143,7 +200,7 @@ CRingCommand::create(CTCLInterpreter& interp,
 {
   // Validate the command count:
 
-  if ((objv.size() < 3) || (objv.size() > 5)) {
+  if ((objv.size() < 3) || (objv.size() > 7)) {
     string result;
     result += "Incorrect number of parameters for ringbuffer create\n";
     result += CommandUsage();
@@ -155,6 +212,8 @@ CRingCommand::create(CTCLInterpreter& interp,
   string name      = objv[2];
   size_t size      = CRingBuffer::getDefaultRingSize();
   size_t consumers = CRingBuffer::getDefaultMaxConsumers();
+  int    mirrored  = 0;
+  int    version   = CRingBuffer::getDefaultFormat();
 
   // If present, update the size from the objv:
 
@@ -172,7 +231,7 @@ CRingCommand::create(CTCLInterpreter& interp,
   }
   // If present, update consumers from the objv:
 
-  if (objv.size() == 5) {
+  if (objv.size() > 4) {
     try {
       consumers = (int)(objv[4]);
     }
@@ -185,9 +244,38 @@ CRingCommand::create(CTCLInterpreter& interp,
        
     }
   }
+  // If present, get the mirrored flag:
+
+  if (objv.size() > 5) {
+    try {
+      mirrored = (int)(objv[5]);
+    }
+    catch(...) {
+      string result;
+      result += "Optional mirrored parameter must be numeric\n";
+      result += CommandUsage();
+      interp.setResult(result);
+      return TCL_ERROR;
+    }
+  }
+  // If present, get the format version:
+
+  if (objv.size() == 7) {
+    try {
+      version = (int)(objv[6]);
+    }
+    catch(...) {
+      string result;
+      result += "Optional version parameter must be numeric\n";
+      result += CommandUsage();
+      interp.setResult(result);
+      return TCL_ERROR;
+    }
+  }
   // Create the ring buffer:
 
   try {
+    LayoutDefaults layout(version, mirrored != 0);
     CRingBuffer::create(name, size, consumers);
   }
   catch (CException& reason) {
@@ -226,7 +314,7 @@ CRingCommand::create(CTCLInterpreter& interp,
 }
 /**********************************************************************/
 /* format a ring buffer that already exists.                          */
-/* ringbuffer format name ?maxconsumers?                              */
+/* ringbuffer format name ?maxconsumers ?mirrored ?version???         */
 /*                                                                    */
 /* Result;                                                            */
 /*  On TCL_OK - the name of the ring buffer is returned.              */
@@ -238,9 +326,9 @@ CRingCommand::format(CTCLInterpreter& interp,
 		     vector<CTCLObject>& objv)
 {
 
-  // We need 3 or 4 parameters:
+  // We need 3 to 6 parameters:
 
-  if ((objv.size() < 3) || (objv.size() > 4)) {
+  if ((objv.size() < 3) || (objv.size() > 6)) {
     string result;
     result += "Incorrect number of command parameters\n";
     result += CommandUsage();
@@ -252,10 +340,12 @@ CRingCommand::format(CTCLInterpreter& interp,
 
   string name      = objv[2];
   size_t consumers = CRingBuffer::getDefaultMaxConsumers();
+  int    mirrored  = 0;
+  int    version   = CRingBuffer::getDefaultFormat();
 
   // If we have a maxconsumers attempt to decode it:
 
-  if (objv.size() == 4) {
+  if (objv.size() > 3) {
     try {
       consumers = (int)(objv[3]);
     }
@@ -268,9 +358,48 @@ CRingCommand::format(CTCLInterpreter& interp,
       return TCL_ERROR;
     }
   }
+  // If we have a mirrored flag decode it too:
+
+  if (objv.size() > 4) {
+    try {
+      mirrored = (int)(objv[4]);
+    }
+    catch (...) {
+      string result;
+      result += "Invalid mirrored value, must be an integer, was: ";
+      result += (string)(objv[4]);
+      result += '\n';
+      interp.setResult(result);
+      return TCL_ERROR;
+    }
+  }
+  // Same for the format version.  If not given the ring keeps the version
+  // it has now:
+
+  if (objv.size() == 6) {
+    try {
+      version = (int)(objv[5]);
+    }
+    catch (...) {
+      string result;
+      result += "Invalid version value, must be an integer, was: ";
+      result += (string)(objv[5]);
+      result += '\n';
+      interp.setResult(result);
+      return TCL_ERROR;
+    }
+  } else {
+    try {
+      CRingBuffer ring(name, CRingBuffer::manager);
+      version = ring.getFormat();
+    }
+    catch (...) {                // Not a ring: format will say so.
+    }
+  }
   //  Attempt the format:
 
   try {
+    LayoutDefaults layout(version, mirrored != 0);
     CRingBuffer::format(name, consumers);
   }
   catch (CException& reason) {
@@ -727,6 +856,66 @@ CRingCommand::remove(CTCLInterpreter&    interp,
 
 }
 
+/**************************************************************************/
+/*  Stream a ring to a socket with the native transport:                  */
+/*  ringbuffer stream name channel                                        */
+/*  channel is a connected Tcl socket; the data are sent from a thread    */
+/*  on a duplicate of its descriptor so the caller can close the channel. */
+/**************************************************************************/
+int
+CRingCommand::stream(CTCLInterpreter&    interp,
+		     vector<CTCLObject>& objv)
+{
+  if (objv.size() != 4) {
+    string result;
+    result += "Incorrect number of command parameters for stream\n";
+    result += CommandUsage();
+    interp.setResult(result);
+    return TCL_ERROR;
+  }
+  string name        = objv[2];
+  string channelName = objv[3];
+
+  if (!CRingBuffer::isRing(name)) {
+    string result;
+    result += "Ring buffer ";
+    result += name;
+    result += " does not exist";
+    interp.setResult(result);
+    return TCL_ERROR;
+  }
+
+  int         mode;
+  ClientData  handle;
+  Tcl_Channel channel = Tcl_GetChannel(interp.getInterpreter(), channelName.c_str(), &mode);
+  if (!channel) {
+    return TCL_ERROR;		// Tcl set the result.
+  }
+  if (Tcl_GetChannelHandle(channel, TCL_WRITABLE, &handle) != TCL_OK) {
+    string result;
+    result += channelName;
+    result += " is not a writable file channel";
+    interp.setResult(result);
+    return TCL_ERROR;
+  }
+  int socket = dup(static_cast<int>(reinterpret_cast<intptr_t>(handle)));
+  if (socket < 0) {
+    string result;
+    result += "Unable to duplicate ";
+    result += channelName;
+    result += ": ";
+    result += strerror(errno);
+    interp.setResult(result);
+    return TCL_ERROR;
+  }
+
+  std::thread sender(runSender, name, socket, CRingAccess::getSocketBufferSize());
+  sender.detach();
+
+  interp.setResult(name);
+  return TCL_OK;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // Private utility functions.
 
@@ -739,18 +928,25 @@ CRingCommand::CommandUsage()
 {
   string usage;
   usage += "Usage:\n";
-  usage += "  ringbuffer create name ?size ?maxconsumers??\n";
-  usage += "  ringbuffer format name ?maxconsumers?\n";
+  usage += "  ringbuffer create name ?size ?maxconsumers ?mirrored ?version????\n";
+  usage += "  ringbuffer format name ?maxconsumers ?mirrored ?version???\n";
   usage += "  ringbuffer disconnect producer name\n";
   usage += "  ringbuffer disconnect consumer name index\n";
   usage += "  ringbuffer usage ?name?\n";
   usage += "  ringbuffer list\n";
   usage += "  ringbuffer remove name\n";
+  usage += "  ringbuffer stream name channel\n";
   usage += "Where\n";
   usage += "  name         - Is the name of a ring buffer\n";
   usage += "  size         - Is the number of data bytes a ring buffer can have\n";
   usage += "  maxconsumers - Is the maximum number of conumser clients that can connect\n";
+  usage += "  mirrored     - Nonzero to page align the data segment so clients can\n";
+  usage += "                 map it twice and never see wrapped data\n";
+  usage += "  version      - Ring format version (1 is readable by all software,\n";
+  usage += "                 3 has cache line padded client descriptors).\n";
+  usage += "                 format keeps the ring's current version by default\n";
   usage += "  index        - Is the consumer index for a connected consumer\n";
+  usage += "  channel      - Is a connected socket to stream the ring's data to\n";
   usage += "And anything bracketed with ?'s is an optional parameter.\n";
 
 
@@ -33,6 +33,7 @@ class CTCLObject;
    ringbuffer disconnect consumer name index
    ringbuffer usage name
    ringbuffer remove name
+   ringbuffer stream name channel
 \endverbatim
 
   The meaning of these should be reasonably obvious...though the actual data returned by the
@@ -84,6 +85,8 @@ protected:
 	     std::vector<CTCLObject>& objv);
   int list(CTCLInterpreter& interp,
 	   std::vector<CTCLObject>& objv);
+  int stream(CTCLInterpreter& interp,
+	     std::vector<CTCLObject>& objv);
 
   // private utilities:
 private:
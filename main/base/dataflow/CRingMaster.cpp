@@ -290,6 +290,46 @@ CRingMaster::requestData(string ringname)
   }
  
 }
+/*!
+   Request a native data stream from the ring master.  This is like
+   requestData, however the ring master sends the data from a thread of its own
+   (see CRingTcpSender) rather than a ringtostdout process.  The socket then
+   carries the credit based protocol CRingTcpReceiver speaks.
+
+   Ring masters that predate this request close the connection when they
+   get it, in which case an exception is thrown and the caller should use a
+   new CRingMaster object to fall back on requestData.
+
+   \param ringname - name of the ring from which we want data.
+
+   \return int
+   \retval the socket on which data will be received.
+
+   \note error handling and socket ownership are as for requestData.
+*/
+int
+CRingMaster::requestStream(string ringname)
+{
+  transactionOk();
+
+  string message;
+  message += "STREAM ";
+  message += ringname;
+  message += "\n";
+  sendLine(message);
+  string reply  = getLine();
+
+  if (reply == "OK STREAM FOLLOWS\r\n") {
+    m_isDataConnection = true;
+    return m_socket;
+  } 
+  else {
+    string exception;
+    exception += "On request stream transaction, expected reply OK got : ";
+    exception += reply;
+    throw exception;
+  }
+}
 /**
  * requestUsage
  *    Return the usage string.  This is the output of the LIST command to the
@@ -415,6 +455,9 @@ CRingMaster::getLine()
     else if (status < 0) {
       throwIfBadErrno();
     }
+    else if (status == 0) {
+      throw string("CRingMaster - the ring master closed the connection");
+    }
   }
 }
 
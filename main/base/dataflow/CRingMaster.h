@@ -67,6 +67,7 @@ public:
   void notifyCreate(std::string ringname);
   void notifyDestroy(std::string ringname);
   int  requestData(std::string ringname);
+  int  requestStream(std::string ringname);
   std::string requestUsage();
   
   // Utilities:
@@ -0,0 +1,303 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+#include <config.h>
+#include "CRingTcpTransport.h"
+#include "CRingBuffer.h"
+
+#include <ErrnoException.h>
+#include <daqshm.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <errno.h>
+#include <string.h>
+
+#include <algorithm>
+
+using namespace std;
+
+// Time (ms) we wait for socket traffic before re-examining the ring.
+
+static const int SOCKET_WAIT_MS(100);
+
+/*
+** Set the socket buffer sizes and turn off Nagle.  Failures are not fatal;
+** the kernel clamps the buffer sizes to its limits, and TCP_NODELAY fails for
+** non TCP sockets (e.g. socket pairs).
+*/
+static void
+configureSocket(int socket, size_t bufferSize)
+{
+  int size = bufferSize;
+  setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+  setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+  int on = 1;
+  setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+/*
+** True if errno indicates the peer is gone rather than a real error.
+*/
+static bool
+peerGone()
+{
+  return (errno == EPIPE) || (errno == ECONNRESET);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CRingTcpSender implementation.
+
+/*!
+   Construct the sender.
+   \param ring             - Consumer attached to the ring to send.
+   \param socket           - Socket connected to the receiver.  This object
+                             owns the socket from now on.
+   \param socketBufferSize - Requested socket buffer sizes.
+
+   \throw CErrnoException - if the ring's shared memory can't be opened.
+*/
+CRingTcpSender::CRingTcpSender(CRingBuffer& ring, int socket, size_t socketBufferSize) :
+  m_ring(ring),
+  m_socket(socket),
+  m_shmFd(-1),
+  m_shmSize(0),
+  m_credit(0),
+  m_partialBytes(0)
+{
+  configureSocket(m_socket, socketBufferSize);
+
+  m_shmFd = CDAQShm::open(CRingBuffer::shmName(ring.getName()), O_RDONLY);
+  struct stat info;
+  if ((m_shmFd < 0) || fstat(m_shmFd, &info)) {
+    int e = errno;
+    if (m_shmFd >= 0) close(m_shmFd);
+    close(m_socket);
+    errno = e;
+    throw CErrnoException("CRingTcpSender - opening ring shared memory");
+  }
+  m_shmSize = info.st_size;
+}
+/*!
+   Close the socket and the shared memory file.
+*/
+CRingTcpSender::~CRingTcpSender()
+{
+  close(m_shmFd);
+  close(m_socket);
+}
+
+/*!
+   Send data until the receiver closes its end of the connection.
+   Writing to a socket whose peer is gone raises SIGPIPE in the writing
+   thread; it's blocked here so that we see EPIPE instead.
+*/
+void
+CRingTcpSender::operator()()
+{
+  sigset_t pipeSignal;
+  sigemptyset(&pipeSignal);
+  sigaddset(&pipeSignal, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipeSignal, NULL);
+
+  while (1) {
+    if (!readCredits(m_credit ? 0 : SOCKET_WAIT_MS)) return;
+    if (!m_credit) continue;
+
+    size_t available = m_ring.availableData();
+    if (!available) {
+      m_ring.pollblock();
+      continue;
+    }
+    if (!send(min(static_cast<uint64_t>(available), m_credit))) return;
+  }
+}
+/*
+** Collect any credits the receiver has sent.
+**
+** Parameters:
+**   timeout - ms to wait for credits to arrive (0 just looks).
+** Returns:
+**   false if the receiver closed the connection.
+*/
+bool
+CRingTcpSender::readCredits(int timeout)
+{
+  struct pollfd fd = {m_socket, POLLIN, 0};
+  int status = poll(&fd, 1, timeout);
+  if (status < 0) {
+    if (errno == EINTR) return true;
+    throw CErrnoException("CRingTcpSender - polling for credits");
+  }
+  if (status == 0) return true;
+
+  uint8_t buffer[64*sizeof(uint64_t)];
+  ssize_t nRead = recv(m_socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+  if (nRead == 0) return false;
+  if (nRead < 0) {
+    if ((errno == EINTR) || (errno == EAGAIN)) return true;
+    if (peerGone()) return false;
+    throw CErrnoException("CRingTcpSender - reading credits");
+  }
+
+  for (ssize_t i = 0; i < nRead; i++) {
+    m_partial[m_partialBytes++] = buffer[i];
+    if (m_partialBytes == sizeof(uint64_t)) {
+      uint64_t credit;
+      memcpy(&credit, m_partial, sizeof(credit));
+      m_credit      += be64toh(credit);
+      m_partialBytes = 0;
+    }
+  }
+  return true;
+}
+/*
+** Send nBytes from the ring straight from the shared memory file.
+** Ring offsets are file offsets; the file is not mirrored so data that
+** wraps takes two trips around the loop.
+**
+** Returns:
+**   false if the receiver closed the connection.
+*/
+bool
+CRingTcpSender::send(size_t nBytes)
+{
+  while (nBytes) {
+    off_t  offset = m_ring.getOffset();
+    size_t chunk  = min(nBytes, static_cast<size_t>(m_shmSize - offset));
+    ssize_t sent  = sendfile(m_socket, m_shmFd, &offset, chunk);
+    if (sent < 0) {
+      if (errno == EINTR) continue;
+      if (peerGone()) return false;
+      throw CErrnoException("CRingTcpSender - sending ring data");
+    }
+    m_ring.skip(sent);
+    m_credit -= sent;
+    nBytes   -= sent;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CRingTcpReceiver implementation.
+
+/*!
+   Construct the receiver.
+   \param ring             - Producer attached to the proxy ring.
+   \param socket           - Socket connected to the sender.  This object
+                             owns the socket from now on.
+   \param socketBufferSize - Requested socket buffer sizes.
+*/
+CRingTcpReceiver::CRingTcpReceiver(CRingBuffer& ring, int socket, size_t socketBufferSize) :
+  m_ring(ring),
+  m_socket(socket),
+  m_granted(0),
+  m_grantSize(max(ring.getUsage().s_bufferSpace/4, static_cast<size_t>(1)))
+{
+  configureSocket(m_socket, socketBufferSize);
+}
+/*!
+  Close the socket.
+*/
+CRingTcpReceiver::~CRingTcpReceiver()
+{
+  close(m_socket);
+}
+
+/*!
+   Receive data into the ring until the sender closes the connection.
+*/
+void
+CRingTcpReceiver::operator()()
+{
+  while (1) {
+    grant();
+    if (!m_granted) {
+      m_ring.pollblock();	// Wait for consumers to free space.
+      continue;
+    }
+
+    struct pollfd fd = {m_socket, POLLIN, 0};
+    int status = poll(&fd, 1, SOCKET_WAIT_MS);
+    if (status < 0) {
+      if (errno == EINTR) continue;
+      throw CErrnoException("CRingTcpReceiver - polling for data");
+    }
+    if ((status > 0) && !receive()) return;
+  }
+}
+/*
+** Grant the sender all the free ring space it does not already hold
+** credit for, once that is at least m_grantSize bytes.
+*/
+void
+CRingTcpReceiver::grant()
+{
+  size_t space = m_ring.availablePutSpace();
+  if ((space <= m_granted) || ((space - m_granted) < m_grantSize)) return;
+
+  uint64_t credit = htobe64(space - m_granted);
+  uint8_t* p      = reinterpret_cast<uint8_t*>(&credit);
+  size_t   nBytes = sizeof(credit);
+  while (nBytes) {
+    ssize_t sent = ::send(m_socket, p, nBytes, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) continue;
+      if (peerGone()) return;	// receive() will see the close.
+      throw CErrnoException("CRingTcpReceiver - sending credit");
+    }
+    p      += sent;
+    nBytes -= sent;
+  }
+  m_granted = space;
+}
+/*
+** Read what's available from the socket directly into the ring.  The
+** reservation can't block as the space was free when it was granted.
+**
+** Returns:
+**   false if the sender closed the connection.
+*/
+bool
+CRingTcpReceiver::receive()
+{
+  CRingBuffer::Reservation space;
+  m_ring.reserve(m_granted, space);
+
+  struct iovec parts[2] = {
+    {space.s_pFirst,  space.s_firstBytes},
+    {space.s_pSecond, space.s_secondBytes}
+  };
+  ssize_t nRead = readv(m_socket, parts, space.s_pSecond ? 2 : 1);
+  if (nRead == 0) return false;
+  if (nRead < 0) {
+    if ((errno == EINTR) || (errno == EAGAIN)) return true;
+    if (peerGone()) return false;
+    throw CErrnoException("CRingTcpReceiver - reading ring data");
+  }
+  m_ring.commit(nRead);
+  m_granted -= nRead;
+  return true;
+}
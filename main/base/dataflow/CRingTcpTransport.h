@@ -0,0 +1,97 @@
+#ifndef CRINGTCPTRANSPORT_H
+#define CRINGTCPTRANSPORT_H
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+#include <unistd.h>
+#include <stdint.h>
+#include <string>
+
+class CRingBuffer;
+
+/*!
+  Native ring to ring transport.  This replaces the
+
+  remotering -> ringtostdout |network| stdintoring -> proxyring
+
+  pipeline with a pair of objects that each run in a thread of an existing
+  process:
+
+  - CRingTcpSender is a consumer of the ring being hoisted.  It sends
+    data from the ring's shared memory segment directly to the socket
+    with sendfile(2) so the data is never copied through user space.
+  - CRingTcpReceiver is the producer of the proxy ring.  It reads the
+    socket directly into space reserved in the ring.
+
+  The data are sent as an unframed byte stream.  Flow control is credit
+  based:  the receiver sends 64 bit byte counts (network byte order) to the
+  sender as space in the proxy ring becomes free, and the sender never
+  sends more than it has been granted.  The data in flight therefore always
+  fits in the proxy ring and the receiver never blocks on the ring with
+  data pending in the socket.  All data that is available (and granted) is
+  sent at once so the transfer naturally batches when the source ring is
+  busy.
+
+  Both objects own their socket and close it when destroyed.  The
+  operator() runs the transfer until the peer closes its end.
+*/
+class CRingTcpSender
+{
+private:
+  CRingBuffer& m_ring;		// Consumer on the ring we send.
+  int          m_socket;	// Connected to the receiver.
+  int          m_shmFd;		// Ring shared memory file (source of sendfile).
+  off_t        m_shmSize;	// Size of that file.
+  uint64_t     m_credit;	// Bytes we can still send.
+  uint8_t      m_partial[sizeof(uint64_t)]; // Credit message being assembled.
+  size_t       m_partialBytes;
+
+public:
+  CRingTcpSender(CRingBuffer& ring, int socket, size_t socketBufferSize);
+  ~CRingTcpSender();
+private:
+  CRingTcpSender(const CRingTcpSender&);
+  CRingTcpSender& operator=(const CRingTcpSender&);
+
+public:
+  void operator()();
+
+private:
+  bool readCredits(int timeout);
+  bool send(size_t nBytes);
+};
+
+class CRingTcpReceiver
+{
+private:
+  CRingBuffer& m_ring;		// Producer on the proxy ring.
+  int          m_socket;	// Connected to the sender.
+  size_t       m_granted;	// Credit granted but not yet received.
+  size_t       m_grantSize;	// Don't send credits smaller than this.
+
+public:
+  CRingTcpReceiver(CRingBuffer& ring, int socket, size_t socketBufferSize);
+  ~CRingTcpReceiver();
+private:
+  CRingTcpReceiver(const CRingTcpReceiver&);
+  CRingTcpReceiver& operator=(const CRingTcpReceiver&);
+
+public:
+  void operator()();
+
+private:
+  void grant();
+  bool receive();
+};
+
+#endif
@@ -0,0 +1,181 @@
+// Tests for mirrored (page aligned data segment) rings.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include <CRingBuffer.h>
+#include <ringbufint.h>
+#include <string>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "testcommon.h"
+
+using namespace std;
+
+
+class MirrorTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MirrorTest);
+  CPPUNIT_TEST(notmirrored);
+  CPPUNIT_TEST(aligned);
+  CPPUNIT_TEST(contiguous);
+  CPPUNIT_TEST(getwrapped);
+  CPPUNIT_TEST(reserve);
+  CPPUNIT_TEST(v2);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  std::string SHM_TESTFILE;
+  bool        m_originalMirrored;
+  unsigned    m_originalFormat;
+public:
+  void setUp() {
+    SHM_TESTFILE       = uniqueRing("mirror");
+    m_originalMirrored = CRingBuffer::getDefaultMirrored();
+    m_originalFormat   = CRingBuffer::getDefaultFormat();
+    CRingBuffer::setDefaultMirrored(true);
+    CRingBuffer::create(SHM_TESTFILE);
+  }
+  void tearDown() {
+    CRingBuffer::setDefaultMirrored(m_originalMirrored);
+    CRingBuffer::setDefaultFormat(m_originalFormat);
+    try {
+      CRingBuffer::remove(SHM_TESTFILE);
+    }
+    catch(...) {
+    }
+  }
+protected:
+  void notmirrored();
+  void aligned();
+  void contiguous();
+  void getwrapped();
+  void reserve();
+  void v2();
+private:
+  void wrapPointers(CRingBuffer& prod, CRingBuffer& cons, size_t toTop);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MirrorTest);
+
+// Advance the producer and consumer so that they are toTop bytes from
+// the top of the ring.
+
+void
+MirrorTest::wrapPointers(CRingBuffer& prod, CRingBuffer& cons, size_t toTop)
+{
+  size_t filler = prod.getUsage().s_bufferSpace - toTop;
+  prod.skip(filler);
+  cons.skip(filler);
+}
+
+// Rings formatted the old way are not mirrored.
+
+void MirrorTest::notmirrored()
+{
+  CRingBuffer::setDefaultMirrored(false);
+  CRingBuffer::format(SHM_TESTFILE);
+
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  ASSERT(!prod.isMirrored());
+  ASSERT(prod.wouldWrap(prod.bytesToTop() + 1));
+}
+// Mirrored rings have a page aligned data segment.
+
+void MirrorTest::aligned()
+{
+  CRingBuffer ring(SHM_TESTFILE, CRingBuffer::producer);
+  ASSERT(ring.isMirrored());
+
+  pRingBuffer pBuffer = reinterpret_cast<pRingBuffer>(mapRingBuffer(SHM_TESTFILE.c_str()));
+  pRingHeader pHeader = &(pBuffer->s_header);
+  long        pageSize = sysconf(_SC_PAGESIZE);
+  EQ((off_t)0, pHeader->s_dataOffset % pageSize);
+  EQ((off_t)0, (pHeader->s_topOffset + 1) % pageSize);
+  ASSERT(pHeader->s_dataBytes >= CRingBuffer::getDefaultRingSize());
+
+  munmap(pBuffer, pHeader->s_topOffset+1);
+}
+// Data that wraps is contiguous at the get pointer.
+
+void MirrorTest::contiguous()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+  wrapPointers(prod, cons, 10);
+
+  char data[100];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+  prod.put(data, sizeof(data));
+
+  ASSERT(!cons.wouldWrap(sizeof(data)));
+  ASSERT(cons.bytesToTop() >= sizeof(data));
+  EQ(0, memcmp(data, cons.getPointer(), sizeof(data)));
+}
+// get/peek of wrapped data work.
+
+void MirrorTest::getwrapped()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+  wrapPointers(prod, cons, 10);
+
+  char data[100];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+  prod.put(data, sizeof(data));
+
+  char rdbuffer[100];
+  EQ(sizeof(rdbuffer), cons.peek(rdbuffer, sizeof(rdbuffer)));
+  EQ(0, memcmp(data, rdbuffer, sizeof(data)));
+  memset(rdbuffer, 0, sizeof(rdbuffer));
+  EQ(sizeof(rdbuffer), cons.get(rdbuffer, sizeof(rdbuffer)));
+  EQ(0, memcmp(data, rdbuffer, sizeof(data)));
+}
+// Reservations in mirrored rings are always a single span.
+
+void MirrorTest::reserve()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+  wrapPointers(prod, cons, 10);
+
+  CRingBuffer::Reservation space;
+  prod.reserve(100, space);
+  EQ((size_t)100, space.s_firstBytes);
+  ASSERT(!space.s_pSecond);
+  memset(space.s_pFirst, 0x5a, 100);
+  prod.commit(100);
+
+  char rdbuffer[100];
+  cons.get(rdbuffer, sizeof(rdbuffer));
+  for (int i = 0; i < sizeof(rdbuffer); i++) {
+    EQ((char)0x5a, rdbuffer[i]);
+  }
+}
+// Mirroring is independent of the format version.
+
+void MirrorTest::v2()
+{
+  CRingBuffer::setDefaultFormat(RING_FORMAT_V2);
+  CRingBuffer::format(SHM_TESTFILE);
+
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+  EQ((unsigned)RING_FORMAT_V2, prod.getFormat());
+  ASSERT(prod.isMirrored());
+
+  wrapPointers(prod, cons, 10);
+  char data[100];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+  prod.put(data, sizeof(data));
+  EQ(0, memcmp(data, cons.getPointer(), sizeof(data)));
+}
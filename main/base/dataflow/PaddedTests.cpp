@@ -0,0 +1,199 @@
+// Tests for format version 3 rings (cache line padded descriptors).
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+#include <ErrnoException.h>
+
+#include <CRingBuffer.h>
+#include <ringbufint.h>
+#include <string>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "testcommon.h"
+
+using namespace std;
+
+
+class PaddedTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PaddedTest);
+  CPPUNIT_TEST(layout);
+  CPPUNIT_TEST(descriptors);
+  CPPUNIT_TEST(transfer);
+  CPPUNIT_TEST(usage);
+  CPPUNIT_TEST(activemap);
+  CPPUNIT_TEST(wakeup);
+  CPPUNIT_TEST(fillsup);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  std::string SHM_TESTFILE;
+  unsigned    m_originalFormat;
+  pRingBuffer m_pBuffer;
+public:
+  void setUp() {
+    SHM_TESTFILE = uniqueRing("padded");
+    m_originalFormat = CRingBuffer::getDefaultFormat();
+    CRingBuffer::setDefaultFormat(RING_FORMAT_V3);
+    CRingBuffer::create(SHM_TESTFILE);
+    m_pBuffer = reinterpret_cast<pRingBuffer>(mapRingBuffer(SHM_TESTFILE.c_str()));
+  }
+  void tearDown() {
+    munmap(m_pBuffer, m_pBuffer->s_header.s_topOffset+1);
+    CRingBuffer::setDefaultFormat(m_originalFormat);
+    try {
+      CRingBuffer::remove(SHM_TESTFILE);
+    }
+    catch(...) {
+    }
+  }
+protected:
+  void layout();
+  void descriptors();
+  void transfer();
+  void usage();
+  void activemap();
+  void wakeup();
+  void fillsup();
+private:
+  char* base() {
+    return reinterpret_cast<char*>(m_pBuffer);
+  }
+  pRingWakeupSide putWakeup() {
+    return reinterpret_cast<pRingWakeupSide>(base() + RING_CACHE_ALIGN(sizeof(RingHeader)));
+  }
+  pRingWakeupSide getWakeup() {
+    return reinterpret_cast<pRingWakeupSide>(base() + RING_CACHE_ALIGN(sizeof(RingHeader)) +
+					     RING_CACHE_LINE);
+  }
+  pActiveMapWord activeMap() {
+    return reinterpret_cast<pActiveMapWord>(base() + RING_CACHE_ALIGN(sizeof(RingHeader)) +
+					    2*RING_CACHE_LINE);
+  }
+  pClientInformation client(int i) {	// -1 is the producer.
+    return reinterpret_cast<pClientInformation>(base() + m_pBuffer->s_header.s_firstConsumer +
+						i*RING_CACHE_LINE);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PaddedTest);
+
+// Everything written by a different party starts on its own cache line.
+
+void PaddedTest::layout()
+{
+  CRingBuffer ring(SHM_TESTFILE, CRingBuffer::manager);
+  EQ((unsigned)RING_FORMAT_V3, ring.getFormat());
+
+  pRingHeader pHeader = &(m_pBuffer->s_header);
+  EQ(string(MAGICSTRING_V3), string(pHeader->s_magicString));
+
+  size_t mapBytes = RING_CACHE_ALIGN(ACTIVE_MAP_WORDS(pHeader->s_maxConsumer)*
+				     sizeof(ActiveMapWord));
+  EQ((off_t)(RING_CACHE_ALIGN(sizeof(RingHeader)) + 2*RING_CACHE_LINE + mapBytes),
+     pHeader->s_producerInfo);
+  EQ((off_t)(pHeader->s_producerInfo + RING_CACHE_LINE), pHeader->s_firstConsumer);
+  EQ((off_t)(pHeader->s_firstConsumer + pHeader->s_maxConsumer*RING_CACHE_LINE),
+     pHeader->s_dataOffset);
+  EQ((off_t)0, pHeader->s_producerInfo % RING_CACHE_LINE);
+}
+// Descriptors are formatted as unused, pointing at the data segment.
+
+void PaddedTest::descriptors()
+{
+  pRingHeader pHeader = &(m_pBuffer->s_header);
+  for (int i = -1; i < (int)pHeader->s_maxConsumer; i++) {
+    EQ(-1, client(i)->s_pid);
+    EQ(pHeader->s_dataOffset, client(i)->s_offset);
+  }
+}
+// Data moves through the ring and the offsets land in the padded
+// descriptors.
+
+void PaddedTest::transfer()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons1(SHM_TESTFILE);
+  CRingBuffer cons2(SHM_TESTFILE);
+
+  char buffer[100];
+  for (int i = 0; i < sizeof(buffer); i++) {
+    buffer[i] = i;
+  }
+  prod.put(buffer, sizeof(buffer));
+
+  off_t data = m_pBuffer->s_header.s_dataOffset;
+  EQ((off_t)(data + sizeof(buffer)), client(-1)->s_offset);
+
+  char rdbuffer[100];
+  EQ(sizeof(rdbuffer), cons2.get(rdbuffer, sizeof(rdbuffer)));
+  EQ(0, memcmp(buffer, rdbuffer, sizeof(buffer)));
+  EQ(data, client(0)->s_offset);
+  EQ((off_t)(data + sizeof(buffer)), client(1)->s_offset);
+  EQ(getpid(), client(1)->s_pid);
+}
+
+void PaddedTest::usage()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons1(SHM_TESTFILE);
+  CRingBuffer cons2(SHM_TESTFILE);
+  EQ((off_t)1, cons2.getSlot());
+
+  char buffer[100];
+  memset(buffer, 0, sizeof(buffer));
+  prod.put(buffer, sizeof(buffer));
+  cons1.skip(50);
+
+  CRingBuffer::Usage use = prod.getUsage();
+  EQ((size_t)2, use.s_consumers.size());
+  EQ((size_t)50,  use.s_consumers[0].second);
+  EQ((size_t)100, use.s_consumers[1].second);
+  EQ((size_t)100, use.s_maxGetSpace);
+  EQ((size_t)50,  use.s_minGetSpace);
+}
+
+void PaddedTest::activemap()
+{
+  {
+    CRingBuffer cons1(SHM_TESTFILE);
+    CRingBuffer cons2(SHM_TESTFILE);
+    EQ((uint64_t)3, (uint64_t)activeMap()[0]);
+  }
+  EQ((uint64_t)0, (uint64_t)activeMap()[0]);
+}
+// Puts bump the put side, gets the get side.
+
+void PaddedTest::wakeup()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+
+  uint32_t put = putWakeup()->s_sequence;
+  uint32_t get = getWakeup()->s_sequence;
+
+  char buffer[100];
+  memset(buffer, 0, sizeof(buffer));
+  prod.put(buffer, sizeof(buffer));
+  cons.get(buffer, sizeof(buffer));
+
+  EQ(put+1, (uint32_t)putWakeup()->s_sequence);
+  EQ(get+1, (uint32_t)getWakeup()->s_sequence);
+}
+// The producer sees space freed by the consumer.
+
+void PaddedTest::fillsup()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+
+  size_t ringSize = prod.getUsage().s_bufferSpace;
+  prod.skip(ringSize - 10);
+  EQ((size_t)9, prod.availablePutSpace());
+  cons.skip(ringSize - 10);
+  EQ(ringSize - 1, prod.availablePutSpace());
+}
@@ -0,0 +1,164 @@
+// Tests for producer in place writes (reserve/commit).
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+#include <RangeError.h>
+#include <StateException.h>
+
+#include <CRingBuffer.h>
+#include <string>
+#include <string.h>
+
+#include "testcommon.h"
+
+using namespace std;
+
+
+class ReserveTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ReserveTest);
+  CPPUNIT_TEST(notproducer);
+  CPPUNIT_TEST(toobig);
+  CPPUNIT_TEST(invisible);
+  CPPUNIT_TEST(batch);
+  CPPUNIT_TEST(wrap);
+  CPPUNIT_TEST(timeout);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  std::string SHM_TESTFILE;
+public:
+  void setUp() {
+    SHM_TESTFILE = uniqueRing("reserve");
+    CRingBuffer::create(SHM_TESTFILE);
+  }
+  void tearDown() {
+    try {
+      CRingBuffer::remove(SHM_TESTFILE);
+    }
+    catch(...) {
+    }
+  }
+protected:
+  void notproducer();
+  void toobig();
+  void invisible();
+  void batch();
+  void wrap();
+  void timeout();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReserveTest);
+
+// Only producers can reserve/commit.
+
+void ReserveTest::notproducer()
+{
+  CRingBuffer ring(SHM_TESTFILE);
+  CRingBuffer::Reservation space;
+  EXCEPTION(ring.reserve(100, space), CStateException);
+  EXCEPTION(ring.commit(100), CStateException);
+}
+// Can't reserve or commit more than the ring holds, and a ring can never
+// be completely full.
+
+void ReserveTest::toobig()
+{
+  CRingBuffer ring(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer::Reservation space;
+  EXCEPTION(ring.reserve(ring.getUsage().s_bufferSpace+1, space), CRangeError);
+  EXCEPTION(ring.reserve(ring.getUsage().s_bufferSpace, space), CRangeError);
+  EXCEPTION(ring.commit(ring.getUsage().s_bufferSpace), CRangeError);
+}
+// Reserved data is not visible to consumers until committed.
+
+void ReserveTest::invisible()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+
+  CRingBuffer::Reservation space;
+  EQ((size_t)100, prod.reserve(100, space));
+  EQ((size_t)100, space.s_firstBytes);
+  EQ((size_t)0,   space.s_secondBytes);
+  ASSERT(!space.s_pSecond);
+  memset(space.s_pFirst, 0x5a, 100);
+  EQ((size_t)0, cons.availableData());
+
+  prod.commit(100);
+  EQ((size_t)100, cons.availableData());
+  char buffer[100];
+  cons.get(buffer, sizeof(buffer));
+  for (int i = 0; i < sizeof(buffer); i++) {
+    EQ((char)0x5a, buffer[i]);
+  }
+}
+// Several items written into one reservation are published by a
+// single commit.
+
+void ReserveTest::batch()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+
+  CRingBuffer::Reservation space;
+  prod.reserve(10*sizeof(int), space);
+  for (int i = 0; i < 10; i++) {
+    space.copyIn(i*sizeof(int), &i, sizeof(int));
+  }
+  prod.commit(10*sizeof(int));
+
+  EQ(10*sizeof(int), cons.availableData());
+  for (int i = 0; i < 10; i++) {
+    int item;
+    cons.get(&item, sizeof(int));
+    EQ(i, item);
+  }
+}
+// A reservation that straddles the top of the ring is described by two
+// spans and copyIn/copyOut handle the wrap.
+
+void ReserveTest::wrap()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+
+  size_t ringSize = prod.getUsage().s_bufferSpace;
+  size_t filler   = ringSize - 50;
+  prod.skip(filler);
+  cons.skip(filler);
+
+  char data[100];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+  CRingBuffer::Reservation space;
+  EQ(sizeof(data), prod.reserve(sizeof(data), space));
+  EQ(sizeof(data), space.s_firstBytes + space.s_secondBytes);
+  ASSERT(space.s_pSecond);
+  ASSERT(space.s_secondBytes > 0);
+
+  space.copyIn(0, data, sizeof(data));
+  char check[100];
+  space.copyOut(0, check, sizeof(check));
+  EQ(0, memcmp(data, check, sizeof(data)));
+
+  prod.commit(sizeof(data));
+  char rdbuffer[100];
+  EQ(sizeof(rdbuffer), cons.get(rdbuffer, sizeof(rdbuffer)));
+  EQ(0, memcmp(data, rdbuffer, sizeof(data)));
+}
+// Reserve times out if a consumer does not free space.
+
+void ReserveTest::timeout()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+
+  size_t ringSize = prod.getUsage().s_bufferSpace;
+  prod.skip(ringSize - 10);
+
+  CRingBuffer::Reservation space;
+  EQ((size_t)0, prod.reserve(100, space, 1));
+}
@@ -48,6 +48,9 @@ exec tclsh ${0} ${@}
 #     Reports the deletion of an existing ring.
 #  REMOTE ring
 #     Requests ring from the data to be hoisted via a socket.
+#  STREAM ring
+#     Like REMOTE but the data are sent by a thread of the ring master using
+#     the native (credit flow controlled) ring to ring transport.
 #
 #  On success, CONNECT and DISCONNECT reply with
 #    "OK\n"
@@ -230,6 +233,44 @@ proc RemoteHoist {socket client tail} {
     }
 
 
+}
+#-------------------------------------------------------------------------------
+#
+# Start streaming data to a remote client.  The remote client has specified
+# STREAM ringname.  If the ring exists, a sender thread is started on the
+# socket (ringbuffer stream).  The thread has its own copy of the socket so
+# once started we rundown all the resources associated with the socket and
+# close it.
+#
+# Parameters:
+#   socket    - The socket requesting remote access to the ring data.
+#   client    - The IP address of the client.
+#   tail      - The command.. should look like STREAM ringname.
+#
+proc StreamHoist {socket client tail} {
+    emitLogMsg debug "StreamHoist $socket $client '$tail'"
+    emitLogMsg info "STREAM request from $client"
+
+    if {[llength $tail] != 2} {
+	emitLogMsg error "'$tail' is not a valid request"
+	puts $socket "ERROR Invalid message format"
+	releaseResources $socket $client
+	return
+    }
+    set ringname [lindex $tail 1]
+    if {[lsearch -exact $::knownRings $ringname] == -1} {
+	emitLogMsg error "$ringname is not a known ringbuffer. stream cannot be started."
+	puts $socket "ERROR $ringname does not exist"
+    } else {
+	puts $socket "OK STREAM FOLLOWS"
+	flush $socket
+	if {[catch {ringbuffer stream $ringname $socket} msg]} {
+	    emitLogMsg error "Unable to stream ring(=$ringname) to host(=$client): $msg"
+	} else {
+	    emitLogMsg info "stream started to send data from local ring(=$ringname) to host(=$client)"
+	}
+	releaseResources $socket $client
+    }
 }
 #------------------------------------------------------------------------------
 # Kill clients of a specified ring.  This is done when a ring is being unregistered.
@@ -259,12 +300,13 @@ proc killClients ringName {
       emitLogMsg debug "Killing producer: $producerPID"
       catch {exec -- kill -9 $producerPID}
     }
-    # Now the consumers:
+    # Now the consumers.  Our own stream senders are consumers too (with
+    # our pid); they end when their receivers disconnect.
 
     set consumerInfo [lindex $ringUsage 6]
     foreach client $consumerInfo {
       set pid [lindex $client 0]
-      if {$pid != -1} {;	# Should not need this but...
+      if {($pid != -1) && ($pid != [pid])} {;	# Should not need this but...
 	    emitLogMsg debug "Killing consumer: $pid"
 	    catch {exec -- kill -9 $pid}
 	}
@@ -665,6 +707,8 @@ proc onMessage {socket client} {
 	Unregister $socket $client $message
     } elseif {$command eq "REMOTE"} {
 	RemoteHoist $socket $client $message
+    } elseif {$command eq "STREAM"} {
+	StreamHoist $socket $client $message
     } elseif {$command eq "DEBUG"} {
 	# Enable/disable debug logging.
 	set state [lindex $message 1]
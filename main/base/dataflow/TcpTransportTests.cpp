@@ -0,0 +1,236 @@
+// Tests for the native ring to ring transport.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include <CRingBuffer.h>
+#include <CRingTcpTransport.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <string.h>
+#include <stdint.h>
+#include <endian.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "testcommon.h"
+
+using namespace std;
+
+
+class TcpTransportTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TcpTransportTest);
+  CPPUNIT_TEST(transfer);
+  CPPUNIT_TEST(wrapped);
+  CPPUNIT_TEST(bulk);
+  CPPUNIT_TEST(credit);
+  CPPUNIT_TEST(senderEnds);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  std::string m_source;
+  std::string m_proxy;
+  int         m_sockets[2];	// [0] sender end, [1] receiver end.
+public:
+  void setUp() {
+    m_source = uniqueRing("tcpsource");
+    m_proxy  = uniqueRing("tcpproxy");
+    CRingBuffer::create(m_source);
+    CRingBuffer::create(m_proxy);
+    socketpair(AF_UNIX, SOCK_STREAM, 0, m_sockets);
+  }
+  void tearDown() {
+    try {
+      CRingBuffer::remove(m_source);
+    }
+    catch(...) {
+    }
+    try {
+      CRingBuffer::remove(m_proxy);
+    }
+    catch(...) {
+    }
+  }
+protected:
+  void transfer();
+  void wrapped();
+  void bulk();
+  void credit();
+  void senderEnds();
+private:
+  static void runSender(CRingBuffer* pRing, int socket);
+  static void runReceiver(CRingBuffer* pRing, int socket);
+  void getAll(CRingBuffer& ring, void* pData, size_t nBytes);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TcpTransportTest);
+
+void
+TcpTransportTest::runSender(CRingBuffer* pRing, int socket)
+{
+  CRingTcpSender sender(*pRing, socket, 64*1024);
+  sender();
+}
+void
+TcpTransportTest::runReceiver(CRingBuffer* pRing, int socket)
+{
+  CRingTcpReceiver receiver(*pRing, socket, 64*1024);
+  receiver();
+}
+void
+TcpTransportTest::getAll(CRingBuffer& ring, void* pData, size_t nBytes)
+{
+  char* p = reinterpret_cast<char*>(pData);
+  while (nBytes) {
+    size_t got = ring.get(p, nBytes, 1, 10);
+    ASSERT(got);
+    p      += got;
+    nBytes -= got;
+  }
+}
+
+// Data put in the source ring show up in the proxy ring.
+
+void TcpTransportTest::transfer()
+{
+  CRingBuffer source(m_source, CRingBuffer::producer);
+  CRingBuffer proxy(m_proxy, CRingBuffer::producer);
+  CRingBuffer consumer(m_proxy);
+  CRingBuffer hoister(m_source);
+
+  thread sender(runSender, &hoister, m_sockets[0]);
+  thread receiver(runReceiver, &proxy, m_sockets[1]);
+
+  char data[1000];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+  source.put(data, sizeof(data));
+
+  char rdbuffer[1000];
+  getAll(consumer, rdbuffer, sizeof(rdbuffer));
+  EQ(0, memcmp(data, rdbuffer, sizeof(data)));
+
+  shutdown(m_sockets[0], SHUT_RDWR);
+  sender.join();
+  receiver.join();
+}
+// Data that wrap in the source ring (sent from the file in two pieces)
+// and in the proxy ring (received into two spans) arrive intact.
+
+void TcpTransportTest::wrapped()
+{
+  CRingBuffer source(m_source, CRingBuffer::producer);
+  CRingBuffer proxy(m_proxy, CRingBuffer::producer);
+  CRingBuffer consumer(m_proxy);
+  CRingBuffer hoister(m_source);
+
+  size_t filler = source.getUsage().s_bufferSpace - 50;
+  source.skip(filler);
+  hoister.skip(filler);
+  proxy.skip(filler - 20);
+  consumer.skip(filler - 20);
+
+  thread sender(runSender, &hoister, m_sockets[0]);
+  thread receiver(runReceiver, &proxy, m_sockets[1]);
+
+  char data[100];
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = i;
+  }
+  source.put(data, sizeof(data));
+
+  char rdbuffer[100];
+  getAll(consumer, rdbuffer, sizeof(rdbuffer));
+  EQ(0, memcmp(data, rdbuffer, sizeof(data)));
+
+  shutdown(m_sockets[0], SHUT_RDWR);
+  sender.join();
+  receiver.join();
+}
+// Several ring fulls go through; the credits keep the proxy from overflowing.
+
+void TcpTransportTest::bulk()
+{
+  CRingBuffer source(m_source, CRingBuffer::producer);
+  CRingBuffer proxy(m_proxy, CRingBuffer::producer);
+  CRingBuffer consumer(m_proxy);
+  CRingBuffer hoister(m_source);
+
+  thread sender(runSender, &hoister, m_sockets[0]);
+  thread receiver(runReceiver, &proxy, m_sockets[1]);
+
+  size_t total = 4*source.getUsage().s_bufferSpace;
+  vector<uint32_t> chunk(16*1024);
+  uint32_t next = 0;
+  uint32_t expected = 0;
+  thread producer([&]() {
+      for (size_t sent = 0; sent < total; sent += chunk.size()*sizeof(uint32_t)) {
+	for (int i = 0; i < chunk.size(); i++) chunk[i] = next++;
+	source.put(&chunk[0], chunk.size()*sizeof(uint32_t));
+      }
+    });
+
+  vector<uint32_t> rdchunk(chunk.size());
+  bool ok = true;
+  for (size_t got = 0; got < total; got += rdchunk.size()*sizeof(uint32_t)) {
+    getAll(consumer, &rdchunk[0], rdchunk.size()*sizeof(uint32_t));
+    for (int i = 0; i < rdchunk.size(); i++) {
+      if (rdchunk[i] != expected++) ok = false;
+    }
+  }
+  producer.join();
+  ASSERT(ok);
+
+  shutdown(m_sockets[0], SHUT_RDWR);
+  sender.join();
+  receiver.join();
+}
+// The sender never sends more than it was granted.
+
+void TcpTransportTest::credit()
+{
+  CRingBuffer source(m_source, CRingBuffer::producer);
+  CRingBuffer hoister(m_source);
+  thread sender(runSender, &hoister, m_sockets[0]);
+
+  char data[1000];
+  memset(data, 0x5a, sizeof(data));
+  source.put(data, sizeof(data));
+
+  uint64_t credit = htobe64(100);
+  EQ((ssize_t)sizeof(credit), write(m_sockets[1], &credit, sizeof(credit)));
+
+  char rdbuffer[1000];
+  size_t got = 0;
+  while (got < 100) {
+    ssize_t n = read(m_sockets[1], rdbuffer + got, sizeof(rdbuffer) - got);
+    ASSERT(n > 0);
+    got += n;
+  }
+  usleep(100*1000);
+  EQ((size_t)100, got);
+  EQ((ssize_t)-1, recv(m_sockets[1], rdbuffer, sizeof(rdbuffer), MSG_DONTWAIT));
+  EQ((size_t)900, hoister.availableData());
+
+  close(m_sockets[1]);
+  sender.join();
+}
+// When the sending side closes the receiver returns.
+
+void TcpTransportTest::senderEnds()
+{
+  CRingBuffer proxy(m_proxy, CRingBuffer::producer);
+  thread receiver(runReceiver, &proxy, m_sockets[1]);
+
+  uint64_t credit;
+  EQ((ssize_t)sizeof(credit), read(m_sockets[0], &credit, sizeof(credit)));
+  EQ((uint64_t)proxy.availablePutSpace(), be64toh(credit));
+
+  close(m_sockets[0]);
+  receiver.join();
+}
@@ -0,0 +1,178 @@
+// Tests for format version 2 rings (futex wakeups).
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+#include <ErrnoException.h>
+#include <RangeError.h>
+
+#include <CRingBuffer.h>
+#include <ringbufint.h>
+#include <string>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "testcommon.h"
+
+using namespace std;
+
+
+class WakeupTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(WakeupTest);
+  CPPUNIT_TEST(badformat);
+  CPPUNIT_TEST(layout);
+  CPPUNIT_TEST(sequence);
+  CPPUNIT_TEST(wakesconsumer);
+  CPPUNIT_TEST(v1stillpolls);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  std::string SHM_TESTFILE;
+  unsigned    m_originalFormat;
+public:
+  void setUp() {
+    SHM_TESTFILE = uniqueRing("wakeup");
+    m_originalFormat = CRingBuffer::getDefaultFormat();
+    CRingBuffer::setDefaultFormat(RING_FORMAT_V2);
+    CRingBuffer::create(SHM_TESTFILE);
+  }
+  void tearDown() {
+    CRingBuffer::setDefaultFormat(m_originalFormat);
+    try {
+      CRingBuffer::remove(SHM_TESTFILE);
+    }
+    catch(...) {
+    }
+  }
+protected:
+  void badformat();
+  void layout();
+  void sequence();
+  void wakesconsumer();
+  void v1stillpolls();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(WakeupTest);
+
+// Only known format versions can be selected.
+
+void WakeupTest::badformat()
+{
+  EXCEPTION(CRingBuffer::setDefaultFormat(0), CRangeError);
+  EXCEPTION(CRingBuffer::setDefaultFormat(RING_FORMAT_V3+1), CRangeError);
+  EQ((unsigned)RING_FORMAT_V2, CRingBuffer::getDefaultFormat());
+}
+
+// A V2 ring has the V2 magic string and a wakeup block and consumer
+// active map between the header and the producer descriptor.
+
+void WakeupTest::layout()
+{
+  CRingBuffer ring(SHM_TESTFILE, CRingBuffer::manager);
+  EQ((unsigned)RING_FORMAT_V2, ring.getFormat());
+
+  pRingBuffer pBuffer = reinterpret_cast<pRingBuffer>(mapRingBuffer(SHM_TESTFILE.c_str()));
+  pRingHeader pHeader = &(pBuffer->s_header);
+
+  EQ(string(MAGICSTRING_V2), string(pHeader->s_magicString));
+  EQ((off_t)(sizeof(RingHeader) + sizeof(RingWakeup) +
+	     ACTIVE_MAP_WORDS(pHeader->s_maxConsumer)*sizeof(ActiveMapWord)),
+     pHeader->s_producerInfo);
+  EQ((off_t)(pHeader->s_producerInfo + sizeof(ClientInformation)),
+     pHeader->s_firstConsumer);
+  EQ((off_t)(pHeader->s_firstConsumer +
+	     pHeader->s_maxConsumer*sizeof(ClientInformation)),
+     pHeader->s_dataOffset);
+
+  munmap(pBuffer, pHeader->s_topOffset+1);
+}
+// Puts bump the put sequence, gets bump the get sequence.
+
+void WakeupTest::sequence()
+{
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+
+  pRingBuffer pBuffer = reinterpret_cast<pRingBuffer>(mapRingBuffer(SHM_TESTFILE.c_str()));
+  pRingWakeup pWakeup = reinterpret_cast<pRingWakeup>(&(pBuffer->s_header) + 1);
+
+  uint32_t put = pWakeup->s_putSequence;
+  uint32_t get = pWakeup->s_getSequence;
+
+  char buffer[100];
+  memset(buffer, 0, sizeof(buffer));
+  prod.put(buffer, sizeof(buffer));
+  EQ(put+1, (uint32_t)pWakeup->s_putSequence);
+  EQ(get,   (uint32_t)pWakeup->s_getSequence);
+
+  cons.get(buffer, sizeof(buffer));
+  EQ(put+1, (uint32_t)pWakeup->s_putSequence);
+  EQ(get+1, (uint32_t)pWakeup->s_getSequence);
+
+  munmap(pBuffer, pBuffer->s_header.s_topOffset+1);
+}
+// With a very long poll interval, a blocked consumer must still wake
+// promptly when data is put.
+
+void WakeupTest::wakesconsumer()
+{
+  pid_t pid = fork();
+
+  if (pid) {			// parent - consumer.
+    CRingBuffer ring(SHM_TESTFILE);
+    ring.setPollInterval(10000);	// 10 seconds.
+
+    char buffer[100];
+    time_t start = time(NULL);
+    size_t nread = ring.get(buffer, sizeof(buffer), sizeof(buffer));
+    time_t end   = time(NULL);
+    EQ(sizeof(buffer), nread);
+    ASSERT((end - start) < 5);
+  }
+  else {			// child - producer.
+    {
+      CRingBuffer ring(SHM_TESTFILE, CRingBuffer::producer);
+      CRingBuffer::Usage used = ring.getUsage();
+      while (used.s_consumers.size() == 0) {
+	usleep(1000);
+	used = ring.getUsage();
+      }
+      sleep(1);			// Let the consumer block.
+      char buffer[100];
+      memset(buffer, 0, sizeof(buffer));
+      ring.put(buffer, sizeof(buffer));
+    }
+    exit(0);
+  }
+  int status;
+  waitpid(pid, &status, 0);
+  ASSERT(WIFEXITED(status));
+  EQ(0, WEXITSTATUS(status));
+}
+// Reformatting with the old version gives a V1 ring that still works.
+
+void WakeupTest::v1stillpolls()
+{
+  CRingBuffer::setDefaultFormat(RING_FORMAT_V1);
+  CRingBuffer::format(SHM_TESTFILE);
+
+  CRingBuffer prod(SHM_TESTFILE, CRingBuffer::producer);
+  CRingBuffer cons(SHM_TESTFILE);
+  EQ((unsigned)RING_FORMAT_V1, prod.getFormat());
+
+  char buffer[100];
+  for (int i =0; i < sizeof(buffer); i++) {
+    buffer[i] = i;
+  }
+  prod.put(buffer, sizeof(buffer));
+
+  char rdbuffer[100];
+  EQ(sizeof(rdbuffer), cons.get(rdbuffer, sizeof(rdbuffer), sizeof(rdbuffer), 1));
+  EQ(0, memcmp(buffer, rdbuffer, sizeof(buffer)));
+}
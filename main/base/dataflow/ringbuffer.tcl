@@ -22,8 +22,8 @@ exec tclsh ${0} ${@}
 #   command.  The ringbuffer command is a utility that provides
 #   shell access to ring buffer management.
 #   The following syntaxes are supported:
-#    ringbuffer create ?--datasize=n? ?--maxconsumers=n?   name
-#    ringbuffer format ?--maxconsumers=n?                  name
+#    ringbuffer create ?--datasize=n? ?--maxconsumers=n? ?--mirrored? ?--format=n? name
+#    ringbuffer format ?--maxconsumers=n? ?--mirrored? ?--format=n?                name
 #    ringbuffer delete                                     name
 #    ringbuffer status ?--host=hostname?                  ?pattern?
 #    ringbuffer list   ?--host=hostname?
@@ -34,6 +34,10 @@ exec tclsh ${0} ${@}
 #                of 1024*1024 (e.g. 100m).
 #  --maxconsumers - sets the maximum number of cnosumers that can attach
 #                to the ring at any given time.
+#  --mirrored  - page align the data region so clients can map it twice
+#                and never see wrapped data.
+#  --format    - ring format version.  create defaults to 1, which all
+#                software can read; format keeps the ring's current version.
 #  --host      - Sets the name of the host that is the target of the
 #                query.
 #  name        - The name of a ring buffer.
@@ -63,6 +67,7 @@ package require report
 
 set defaultDataSize     8m
 set defaultMaxConsumers 100
+set defaultFormat       1
 set defaultHostname     localhost
 
 
@@ -93,8 +98,8 @@ set defaultHostname     localhost
 #
 proc usage {} {
     puts stderr "Usage"
-    puts stderr " ringbuffer create ?--datasize=n? ?--maxconsumers=n?   name"
-    puts stderr " ringbuffer format ?--maxconsumers=n?                  name"
+    puts stderr " ringbuffer create ?--datasize=n? ?--maxconsumers=n? ?--mirrored? ?--format=n? name"
+    puts stderr " ringbuffer format ?--maxconsumers=n? ?--mirrored? ?--format=n?                name"
     puts stderr " ringbuffer delete                                     name"
     puts stderr " ringbuffer status ?--host=hostname? ?--all? ?--user=user1,..?  ?name?"
     puts stderr " ringbuffer list   ?--host=hostname?"
@@ -326,7 +331,9 @@ proc filterRingStats {ringList opts}  {
 proc createRing tail {
     set options [list                                           \
 		     --datasize=$::defaultDataSize              \
-		     --maxconsumers=$::defaultMaxConsumers]
+		     --maxconsumers=$::defaultMaxConsumers      \
+		     --mirrored                                 \
+		     --format=$::defaultFormat]
 
     set tail [lrange $tail 1 end]
     array set parse [decodeArgs $tail $options]
@@ -335,7 +342,8 @@ proc createRing tail {
 	usage
 	exit -1
     }
-    ringbuffer create $parse(Parameters) [size $parse(--datasize)] $parse(--maxconsumers)
+    ringbuffer create $parse(Parameters) [size $parse(--datasize)] $parse(--maxconsumers) \
+	[expr {$parse(--mirrored) ? 1 : 0}] $parse(--format)
 }
 
 #--------------------------------------------------------------------------
@@ -348,15 +356,24 @@ proc createRing tail {
 #
 proc formatRing tail {
     set options [list                               \
-		     --maxconsumers=$::defaultMaxConsumers]
+		     --maxconsumers=$::defaultMaxConsumers  \
+		     --mirrored                             \
+		     --format]
     set tail [lrange $tail 1 end]
     array set parse [decodeArgs $tail $options]
    
-    if {[llength $parse(Parameters)] != 1} {
+    if {([llength $parse(Parameters)] != 1) || ($parse(--format) eq "true")} {
 	usage
 	exit -1
     }
-    ringbuffer format $parse(Parameters) $parse(--maxconsumers)
+    # Without --format the ring keeps the version it has:
+
+    set command [list ringbuffer format $parse(Parameters) $parse(--maxconsumers) \
+		     [expr {$parse(--mirrored) ? 1 : 0}]]
+    if {$parse(--format) ne "false"} {
+	lappend command $parse(--format)
+    }
+    {*}$command
 }
 
 #--------------------------------------------------------------------------
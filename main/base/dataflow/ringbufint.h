@@ -23,6 +23,7 @@
   be installed if possible.
 */
 #include <unistd.h>
+#include <stdint.h>
 
 
 /* constants - These are defined in this way so that they
@@ -41,13 +42,34 @@
 #define DEFAULT_POLLMS 3
 #endif
 
+#ifndef DEFAULT_SPINS
+#define DEFAULT_SPINS 100	/* Yielding predicate checks before a futex wait. */
+#endif
+
+/*
+   Ring format versions.  Version 1 is the original layout and is still
+   the default so that rings remain usable by older software.  Later versions
+   are identified by their magic string so that older software will refuse to
+   attach to a ring whose layout it does not understand.
+*/
+
+#define RING_FORMAT_V1   1	/* Original layout; clients poll.           */
+#define RING_FORMAT_V2   2	/* Adds the RingWakeup (futex) block.       */
+#define RING_FORMAT_V3   3	/* V2 with cache line padded descriptors.   */
+
+#ifndef DEFAULT_FORMAT
+#define DEFAULT_FORMAT RING_FORMAT_V1
+#endif
+
 /*
    The front of each ring buffer consists of a header.
    The header helps the software locate important segments of the
    buffer as well as to know how big the buffer itself is:
 */
 
-#define MAGICSTRING "NSCLRing"
+#define MAGICSTRING    "NSCLRing"	/* Format version 1 */
+#define MAGICSTRING_V2 "NSCLRing-v2"	/* Format version 2 */
+#define MAGICSTRING_V3 "NSCLRing-v3"	/* Format version 3 */
 
 typedef struct __RingHeader {
    char       s_magicString[32];	/* Should contain the text "NSCLRing" */
@@ -59,6 +81,44 @@ typedef struct __RingHeader {
   volatile off_t      s_topOffset;	/* Offset to the top of the storage.             */
 } RingHeader, *pRingHeader;
 
+/*
+  In format version 2 and later, the header is immediately followed by
+  a wakeup block.  The producer bumps s_putSequence each time it advances the
+  put pointer and consumers bump s_getSequence each time they advance their get
+  pointers.  Clients that must block do a futex wait on the sequence they
+  are interested in rather than sleeping for the poll interval.  The waiter
+  counts allow the side advancing a pointer to skip the wake system call
+  when nobody is waiting.
+*/
+
+typedef struct __RingWakeup {
+  volatile uint32_t   s_putSequence;	/* Bumped on each producer put.    */
+  volatile uint32_t   s_putWaiters;	/* Consumers waiting for data.     */
+  volatile uint32_t   s_getSequence;	/* Bumped on each consumer skip.   */
+  volatile uint32_t   s_getWaiters;	/* Producers waiting for space.    */
+} RingWakeup, *pRingWakeup;
+
+/*
+  One side (put or get) of the wakeup block.  In version 2 rings the put
+  side is immediately followed by the get side.
+*/
+typedef struct __RingWakeupSide {
+  volatile uint32_t   s_sequence;
+  volatile uint32_t   s_waiters;
+} RingWakeupSide, *pRingWakeupSide;
+
+/*
+  In format version 2 and later, the wakeup block is followed by the
+  consumer active map.  This is a bitmap with one bit per consumer slot
+  (bit i%64 of word i/64 is slot i).  A consumer sets its bit when it claims
+  a slot and clears it when it releases the slot so that the producer's
+  free space computation only needs to look at slots that are in use.
+*/
+
+typedef volatile uint64_t ActiveMapWord, *pActiveMapWord;
+
+#define ACTIVE_MAP_WORDS(maxConsumer) (((maxConsumer) + 63)/64)
+
 /*
   Each client is described by the following data structure.  Both producers and
   consumers have a descriptor like this:
@@ -69,10 +129,28 @@ typedef struct __ClientInformation {
   volatile pid_t      s_pid;		/* Process Id of the client.                    */
 } ClientInformation, *pClientInformation;
 
+/*
+  Format version 3 has the same parts as version 2 but puts everything
+  that is written by a different party on its own cache line so that,
+  e.g., a producer moving its put pointer does not invalidate the line
+  consumers read their own get pointers from:
+    - The read-mostly header is padded to a cache line multiple.
+    - The put and get sides of the wakeup block each get a cache line.
+    - The active map is padded to a cache line multiple.
+    - The producer and each consumer descriptor get a cache line each
+      (i.e. descriptors are RING_CACHE_LINE bytes apart).
+*/
+#define RING_CACHE_LINE 64
+#define RING_CACHE_ALIGN(n) ((((n) + RING_CACHE_LINE - 1)/RING_CACHE_LINE)*RING_CACHE_LINE)
+
 /*
    This is the Ring buffer structure itself.  The only thing we won't be able
    to show is the data region because where that starts depends on the size of
    the consumer information array, and that's indefinite.
+
+   This structure only describes format version 1 rings.  Code that must
+   deal with any ring format should locate the client information
+   using the s_producerInfo and s_firstConsumer header offsets.
 */
 typedef struct __RingBuffer {
   RingHeader         s_header;	     /* the ring buffer header.                     */
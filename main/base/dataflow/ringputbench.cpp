@@ -0,0 +1,140 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+// Benchmark of the producer side of the ring buffer.
+// For each consumer count, a scratch ring is created, that many consumer
+// processes are forked off to drain it, and the producer puts fixed
+// size items as fast as it can for a fixed time.  The put rate is
+// reported as a function of the number of consumers.
+//
+// Usage:
+//    ringputbench ?format? ?itemsize? ?seconds? ?maxconsumers?
+//      format       - Ring format version (default 1).
+//      itemsize     - Bytes per put (default 64).
+//      seconds      - Measurement time per consumer count (default 2).
+//      maxconsumers - Consumer slots in the ring (default 100).
+//
+#include <CRingBuffer.h>
+#include <Exception.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+using namespace std;
+
+static double
+now()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1.0e-9;
+}
+
+// Drain the ring until the parent kills us.
+
+static void
+consume(string ringname)
+{
+  CRingBuffer ring(ringname, CRingBuffer::consumer);
+  char buffer[64*1024];
+  while (1) {
+    ring.get(buffer, sizeof(buffer), 1, 1);
+  }
+}
+
+// Run a single measurement with nConsumers consumers.  Returns puts/sec.
+
+static double
+measure(string ringname, int nConsumers, size_t itemSize, double seconds)
+{
+  vector<pid_t> children;
+  for (int i = 0; i < nConsumers; i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      try {
+	consume(ringname);
+      }
+      catch (...) {}
+      _exit(0);
+    }
+    children.push_back(pid);
+  }
+
+  CRingBuffer ring(ringname, CRingBuffer::producer);
+  while (ring.getUsage().s_consumers.size() < nConsumers) {
+    usleep(1000);
+  }
+
+  vector<char> item(itemSize, 0);
+  size_t puts  = 0;
+  double start = now();
+  double end   = start;
+  while ((end - start) < seconds) {
+    for (int i = 0; i < 1000; i++) {
+      ring.put(&item[0], itemSize);
+    }
+    puts += 1000;
+    end   = now();
+  }
+
+  for (int i = 0; i < children.size(); i++) {
+    kill(children[i], SIGKILL);
+    waitpid(children[i], NULL, 0);
+  }
+  return puts/(end - start);
+}
+
+int main(int argc, char** argv)
+{
+  unsigned format       = (argc > 1) ? atoi(argv[1]) : 1;
+  size_t   itemSize     = (argc > 2) ? atoi(argv[2]) : 64;
+  double   seconds      = (argc > 3) ? atof(argv[3]) : 2.0;
+  size_t   maxConsumers = (argc > 4) ? atoi(argv[4]) : 100;
+
+  char ringname[100];
+  sprintf(ringname, "ringputbench_%d", getpid());
+
+  int counts[] = {0, 1, 2, 4, 8, 16, 32, 64};
+
+  try {
+    CRingBuffer::setDefaultFormat(format);
+    CRingBuffer::create(ringname, CRingBuffer::getDefaultRingSize(), maxConsumers);
+
+    cout << "Format " << format << " item size " << itemSize
+	 << " max consumers " << maxConsumers << endl;
+    cout << "consumers      puts/sec      MB/sec" << endl;
+    for (int i = 0; i < sizeof(counts)/sizeof(int); i++) {
+      if (counts[i] > maxConsumers) break;
+      CRingBuffer::format(ringname, maxConsumers);
+      double rate = measure(ringname, counts[i], itemSize, seconds);
+      printf("%9d %13.0f %11.1f\n", counts[i], rate, rate*itemSize/(1024.0*1024.0));
+    }
+    CRingBuffer::remove(ringname);
+  }
+  catch (CException& e) {
+    cerr << "ringputbench failed: " << e.ReasonText() << endl;
+    try { CRingBuffer::remove(ringname); } catch (...) {}
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+void* gpTCLApplication(0);
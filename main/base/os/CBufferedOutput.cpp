@@ -31,6 +31,11 @@
 #include <unistd.h>
 
 namespace io {
+
+// Number of buffers in the pool; there's never more in either queue.
+
+static const size_t BufferCount(10);
+
 /**
  * constructor
  *    - Create the buffer.
@@ -43,7 +48,9 @@ namespace io {
  */
 CBufferedOutput::CBufferedOutput(int fd, size_t nBytes) :
     m_nFd(fd), m_pBuffer(nullptr), m_pInsert(nullptr), m_nBytesInBuffer(0),
-    m_nBufferSize(nBytes), m_nTimeout(0), m_pOutputThread(nullptr), m_halting(false)
+    m_nBufferSize(nBytes), m_nTimeout(0), m_pCurrent(nullptr),
+    m_freeBuffers(0, BufferCount), m_queuedBuffers(0, BufferCount),
+    m_pOutputThread(nullptr), m_halting(false)
 {
     createFreeBuffers();         // Creates the free buffer pool.
     reset();                     // gets a buffer and resets all the book keeping.
@@ -239,7 +246,7 @@ void
 CBufferedOutput::createFreeBuffers()
 {
     
-    for (int i =0; i < 10; i++) {        // Probably really only need 2...
+    for (int i =0; i < BufferCount; i++) { // Probably really only need 2...
         QueueElement* pEl = new QueueElement;
         pEl->s_nBufferSize = m_nBufferSize;
         pEl->s_nBytesInBuffer = 0;
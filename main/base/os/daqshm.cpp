@@ -239,6 +239,98 @@ CDAQShm::attach(std::string name)
   return pMemory;
 }
 
+/**
+ *  Connect the program with a shared memory region, mapping the part of
+ *  the region from offset to its end a second time immediately after
+ *  the region.  Data that runs off the end of the region therefore
+ *  continues, contiguously, in the part that starts at offset.  Ring
+ *  buffers use this so that items that wrap need not be copied.
+ *
+ *  Mirrored mappings are reference counted separately from the mappings
+ *  made by attach.
+ *
+ * @param name   - Name of the shared memory region.
+ * @param offset - Offset of the part to mirror.  Both this and the size
+ *                 of the region must be multiples of the page size.
+ *
+ * @return void*
+ * @retval 0 - Error, see lastError() for reason.
+ * @retval non-zero - pointer to the base of the mapping which is
+ *                    size(name) + size(name) - offset bytes long.
+ */
+void*
+CDAQShm::attachMirrored(std::string name, size_t offset)
+{
+  m_nLastError = Success;
+
+  std::string key = mirrorKey(name);
+  if (m_attachMap.find(key) != m_attachMap.end()) {
+    m_attachMap[key].refcount++;
+    return m_attachMap[key].pMappingAddress;
+  }
+
+  int  prot = PROT_READ | PROT_WRITE;
+  int  fd   = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    fd   = shm_open(name.c_str(), O_RDONLY, 0);
+    prot = PROT_READ;
+  }
+  if (fd < 0) {
+    setLastErrorFromErrno();
+    return 0;
+  }
+  ssize_t fileSize = fdSize(fd);
+  long    pageSize = sysconf(_SC_PAGESIZE);
+  if ((fileSize < 0) || (offset >= static_cast<size_t>(fileSize)) ||
+      (offset % pageSize) || (fileSize % pageSize)) {
+    if (fileSize >= 0) {
+      errno = EINVAL;
+      setLastErrorFromErrno();
+    }
+    close(fd);
+    return 0;
+  }
+  size_t mirrorSize = fileSize - offset;
+  size_t mapSize    = fileSize + mirrorSize;
+
+  // Reserve the address range then map the region and the mirror into it:
+
+  char* pMemory = static_cast<char*>(mmap(NULL, mapSize, PROT_NONE,
+					  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if ((pMemory == MAP_FAILED) ||
+      (mmap(pMemory, fileSize, prot, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) ||
+      (mmap(pMemory + fileSize, mirrorSize, prot, MAP_SHARED | MAP_FIXED,
+	    fd, offset) == MAP_FAILED)) {
+    int e = errno;
+    if (pMemory != MAP_FAILED) munmap(pMemory, mapSize);
+    close(fd);
+    errno = e;
+    setLastErrorFromErrno();
+    return 0;
+  }
+  close(fd);
+
+  attachInformation initialInfo = {pMemory, mapSize, 1};
+  m_attachMap[key] = initialInfo;
+
+  return pMemory;
+}
+/**
+ * Detach a mapping made by attachMirrored.
+ *
+ * @param p    - Pointer to mapped virtual address.
+ * @param name - Name of shared memory region.
+ * @param size - Size of the mapping (not of the region).
+ *
+ * @return bool
+ * @retval false - success.
+ * @retval true  - Some sort of failure that can be analyzed by lastError().
+ */
+bool
+CDAQShm::detachMirrored(void* p, std::string name, size_t size)
+{
+  return detach(p, mirrorKey(name), size);
+}
 /**
  * Return the number of bytes in a shared memory region:
  *
@@ -401,6 +493,17 @@ CDAQShm::fdSize(int fd)
   size_t fileSize = fileInfo.st_size;
   return fileSize;
 }
+/**
+ * Return the attach map key for mirrored mappings of a region.
+ * Shared memory names can't have embedded slashes so this can't collide
+ * with the name of a region.
+ */
+std::string
+CDAQShm::mirrorKey(std::string name)
+{
+  return name + "/mirrored";
+}
+
 /**
  * setLastErrorFromErrno
  *    Sets the m_nLastError from the current value of errno.
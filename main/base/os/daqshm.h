@@ -63,6 +63,8 @@ public:
   static bool        create(std::string name, size_t size, unsigned int flags);
   static void*       attach(std::string name);
   static bool        detach(void* pSharedMemory, std::string name, size_t size);
+  static void*       attachMirrored(std::string name, size_t offset);
+  static bool        detachMirrored(void* pSharedMemory, std::string name, size_t size);
   static bool        remove(std::string name);
   static ssize_t     size(std::string name);
   static int         lastError();
@@ -74,6 +76,7 @@ public:
 private:
   static ssize_t fdSize(int fd);
   static void setLastErrorFromErrno();
+  static std::string mirrorKey(std::string name);
 public:
   static const int Success;
   static const int Exists;
@@ -0,0 +1,104 @@
+// Tests for mirrored shared memory mappings.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+#include "daqshm.h"
+#include <string.h>
+#include <unistd.h>
+
+
+class mirrorTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(mirrorTests);
+  CPPUNIT_TEST(noShm);
+  CPPUNIT_TEST(badOffset);
+  CPPUNIT_TEST(mirrored);
+  CPPUNIT_TEST(refcount);
+  CPPUNIT_TEST(separate);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  static const char* shmName;
+  size_t m_pageSize;
+public:
+  void setUp() {
+    m_pageSize = sysconf(_SC_PAGESIZE);
+    CDAQShm::create(shmName, 4*m_pageSize, 0);
+  }
+  void tearDown() {
+    CDAQShm::remove(shmName);
+  }
+protected:
+  void noShm();
+  void badOffset();
+  void mirrored();
+  void refcount();
+  void separate();
+};
+
+const char* mirrorTests::shmName="/testmirror";
+CPPUNIT_TEST_SUITE_REGISTRATION(mirrorTests);
+
+void mirrorTests::noShm()
+{
+  std::string noSuch(shmName);
+  noSuch += "-nosuchmemory";
+
+  EQ((void*)0, CDAQShm::attachMirrored(noSuch, m_pageSize));
+  EQ(CDAQShm::NonExistent, CDAQShm::lastError());
+}
+// The offset must be page aligned and inside the region:
+
+void mirrorTests::badOffset()
+{
+  EQ((void*)0, CDAQShm::attachMirrored(shmName, 100));
+  EQ(CDAQShm::CheckOSError, CDAQShm::lastError());
+  EQ((void*)0, CDAQShm::attachMirrored(shmName, 4*m_pageSize));
+}
+// Writes past the end of the region land at the mirror offset and
+// vice versa.
+
+void mirrorTests::mirrored()
+{
+  char* p = static_cast<char*>(CDAQShm::attachMirrored(shmName, m_pageSize));
+  ASSERT(p);
+
+  size_t regionSize = 4*m_pageSize;
+  memset(p + regionSize - 10, 0x5a, 20);
+  for (int i = 0; i < 10; i++) {
+    EQ((char)0x5a, p[m_pageSize + i]);
+  }
+  p[m_pageSize + 100] = 0x12;
+  EQ((char)0x12, p[regionSize + 100]);
+
+  ASSERT(!CDAQShm::detachMirrored(p, shmName, regionSize + 3*m_pageSize));
+}
+
+void mirrorTests::refcount()
+{
+  size_t mapSize = 4*m_pageSize + 3*m_pageSize;
+  void* p1 = CDAQShm::attachMirrored(shmName, m_pageSize);
+  void* p2 = CDAQShm::attachMirrored(shmName, m_pageSize);
+  EQ(p1, p2);
+
+  ASSERT(!CDAQShm::detachMirrored(p1, shmName, mapSize));
+  ASSERT(!CDAQShm::detachMirrored(p1, shmName, mapSize));
+  ASSERT(CDAQShm::detachMirrored(p1, shmName, mapSize));  // gone.
+}
+// Mirrored and plain mappings are independent of each other but see
+// the same memory:
+
+void mirrorTests::separate()
+{
+  char* pPlain  = static_cast<char*>(CDAQShm::attach(shmName));
+  char* pMirror = static_cast<char*>(CDAQShm::attachMirrored(shmName, m_pageSize));
+  ASSERT(pPlain != pMirror);
+
+  pPlain[m_pageSize] = 0x34;
+  EQ((char)0x34, pMirror[4*m_pageSize]);
+
+  ASSERT(CDAQShm::detach(pMirror, shmName, 7*m_pageSize));
+  ASSERT(!CDAQShm::detachMirrored(pMirror, shmName, 7*m_pageSize));
+  ASSERT(!CDAQShm::detach(pPlain, shmName, 4*m_pageSize));
+}
@@ -0,0 +1,385 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+#define COMPILINGCLOCKFREEQUEUE
+#ifndef CLOCKFREEQUEUE_H
+#include "CLockFreeQueue.h"
+#endif
+
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/*!
+   Construct the queue.
+
+   \param wakeLevel : size_t [default = 0]
+      wait() returns once there are more than this many elements queued.
+      get() is not affected by this.
+   \param capacity : size_t [default = DefaultCapacity]
+      Number of elements the queue can hold.  This is rounded up to
+      a power of two.
+*/
+template<class T, bool multiProducer>
+CLockFreeQueue<T, multiProducer>::CLockFreeQueue(size_t wakeLevel,
+                                                 size_t capacity) :
+  m_nCapacity(2),
+  m_pSlots(0),
+  m_nWakeLevel(wakeLevel),
+  m_tail(0),
+  m_head(0),
+  m_dataEvent(0),
+  m_consumerWaiting(0),
+  m_waitLevel(wakeLevel),
+  m_spaceEvent(0),
+  m_producersWaiting(0)
+{
+  while (m_nCapacity < capacity) {
+    m_nCapacity *= 2;
+  }
+  m_nMask  = m_nCapacity - 1;
+  m_pSlots = new Slot[m_nCapacity];
+  for (size_t i = 0; i < m_nCapacity; i++) {
+    m_pSlots[i].s_sequence.store(0, std::memory_order_relaxed);
+  }
+}
+/*!
+   Destructor - as with CBufferQueue, nobody should be using the queue
+   any more.  Elements still in the queue are not destroyed.
+*/
+template<class T, bool multiProducer>
+CLockFreeQueue<T, multiProducer>::~CLockFreeQueue()
+{
+  delete []m_pSlots;
+}
+
+/*!
+   Enter an element in the queue, blocking while the queue is full.
+
+   \param object : T
+     The object to enter in the queue.
+*/
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::queue(T object)
+{
+  while (!put(&object, 1)) {
+    waitForSpace();
+  }
+}
+/*!
+   Enter several elements in the queue.  They are entered in as few
+   operations as there's room for, blocking while the queue is full.
+   With several producers, the elements of one call may be interleaved
+   with those of others.
+
+   \param objects : const T*
+     The objects to queue.
+   \param n : size_t
+     Number of objects.
+*/
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::queue(const T* objects, size_t n)
+{
+  while (n) {
+    size_t nPut = put(objects, n);
+    if (nPut) {
+      objects += nPut;
+      n       -= nPut;
+    } else {
+      waitForSpace();
+    }
+  }
+}
+/*!
+   Enter an element in the queue if there's room.
+
+   \param object : T
+   \return bool - false if the queue was full.
+*/
+template<class T, bool multiProducer> bool
+CLockFreeQueue<T, multiProducer>::queuenow(T object)
+{
+  return put(&object, 1) == 1;
+}
+
+/*!
+   Remove the front element from the queue, blocking until there is one.
+*/
+template<class T, bool multiProducer> T
+CLockFreeQueue<T, multiProducer>::get()
+{
+  T element;
+  while (!getnow(element)) {
+    waitForData(0, -1);
+  }
+  return element;
+}
+/**
+ * Get an element from the front of the queue without waiting.
+ *
+ * @param element - the object that is gotten from the queue
+ *                  valid only if there is an element.
+ * @return bool   - true if an element was gotten, false otherwise.
+ */
+template<class T, bool multiProducer> bool
+CLockFreeQueue<T, multiProducer>::getnow(T& element)
+{
+  return getnow(&element, 1) == 1;
+}
+/**
+ * Get as many elements as are available (up to a limit) without waiting.
+ * The queue indices are only updated once for the lot.
+ *
+ * @param elements - where the elements go.
+ * @param max      - most elements to get.
+ * @return size_t  - number of elements gotten.
+ */
+template<class T, bool multiProducer> size_t
+CLockFreeQueue<T, multiProducer>::getnow(T* elements, size_t max)
+{
+  size_t head = m_head.load(std::memory_order_relaxed);
+  size_t n    = 0;
+  while (n < max) {
+    Slot& slot(m_pSlots[(head + n) & m_nMask]);
+    if (slot.s_sequence.load(std::memory_order_acquire) != head + n + 1) {
+      break;                    // Empty or not yet filled in.
+    }
+    elements[n] = slot.s_element;
+    n++;
+  }
+  if (n) {
+    m_head.store(head + n, std::memory_order_release);
+    spaceFreed();
+  }
+  return n;
+}
+
+/*!
+    Return a std::list that consists of all elements in the queue.
+    if the queue is empty, this will be an empty list.
+*/
+template<class T, bool multiProducer> std::list<T>
+CLockFreeQueue<T, multiProducer>::getAll()
+{
+  std::list<T> result;
+  T            elements[64];
+  size_t       n;
+  while ((n = getnow(elements, 64)) > 0) {
+    result.insert(result.end(), elements, elements + n);
+  }
+  return result;
+}
+/*!
+   Set the wake level (see the constructor).
+
+   \param level : size_t
+      The new wake level.
+*/
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::setWakeThreshold(size_t level)
+{
+  m_nWakeLevel = level;
+}
+/*!
+   Wait until there are more than the wake level elements in the queue,
+   wake() is called or the timeout expires.  Only the consumer may wait.
+
+   Since producers only wake the consumer once it has said it's waiting
+   there's no lost wakeup, so unlike CBufferQueue a timeout of -1 really
+   means wait forever.
+
+   @param timeout - number of milli-seconds to wait.  -1 means no timeout.
+*/
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::wait(int timeout)
+{
+  waitForData(m_nWakeLevel, timeout);
+}
+/*!
+    Wake the consumer if it's in wait(), e.g. because the producer won't
+    queue anything for a while but the wake level is > 0.
+*/
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::wake()
+{
+  m_dataEvent.fetch_add(1, std::memory_order_release);
+  futexWake(&m_dataEvent);
+}
+/*!
+   Number of elements in the queue.  With several producers this includes
+   elements that are still being entered, and in any event it can be
+   out of date by the time it's returned.
+*/
+template<class T, bool multiProducer> size_t
+CLockFreeQueue<T, multiProducer>::size() const
+{
+  size_t head = m_head.load(std::memory_order_acquire);
+  size_t tail = m_tail.load(std::memory_order_acquire);
+  return (tail > head) ? tail - head : 0;
+}
+
+/*----------------------------------------------------------------------------
+ * Private utilities.
+ */
+
+/**
+ * put
+ *   Enter as many of the objects as there's room for.  Space is claimed
+ *   by advancing the tail (with compare and swap if there are several
+ *   producers); each slot is then filled in and marked full.
+ *
+ * @param objects - the objects.
+ * @param n       - how many.
+ * @return size_t - number entered; 0 if the queue is full.
+ */
+template<class T, bool multiProducer> size_t
+CLockFreeQueue<T, multiProducer>::put(const T* objects, size_t n)
+{
+  size_t tail = m_tail.load(std::memory_order_relaxed);
+  size_t nPut;
+  while (1) {
+    size_t head = m_head.load(std::memory_order_acquire);
+    if (head > tail) {                   // Our tail is stale.
+      tail = m_tail.load(std::memory_order_relaxed);
+      continue;
+    }
+    size_t room = m_nCapacity - (tail - head);
+    if (room == 0) {
+      return 0;
+    }
+    nPut = (n < room) ? n : room;
+    if (!multiProducer) {
+      m_tail.store(tail + nPut, std::memory_order_relaxed);
+      break;
+    }
+    if (m_tail.compare_exchange_weak(tail, tail + nPut,
+                                     std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  for (size_t i = 0; i < nPut; i++) {
+    Slot& slot(m_pSlots[(tail + i) & m_nMask]);
+    slot.s_element = objects[i];
+    slot.s_sequence.store(tail + i + 1, std::memory_order_release);
+  }
+  dataAdded();
+  return nPut;
+}
+/**
+ * waitForData
+ *    Block the consumer until there are more than level elements queued.
+ *    The consumer says it's waiting before it looks at the queue and
+ *    producers look for that after they've entered data so one of them
+ *    always sees the other.  The producer that wakes the consumer clears
+ *    the flag so the others don't make the system call too.
+ *
+ * @param level   - return once there are more than this many elements.
+ * @param timeout - milliseconds, -1 for none.
+ */
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::waitForData(size_t level, int timeout)
+{
+  if (level >= m_nCapacity) {
+    level = m_nCapacity - 1;             // Else we'd wait forever.
+  }
+  m_waitLevel.store(level, std::memory_order_relaxed);
+  uint32_t event = m_dataEvent.load(std::memory_order_acquire);
+  m_consumerWaiting.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (size() <= level) {
+    futexWait(&m_dataEvent, event, timeout);
+  }
+  m_consumerWaiting.store(0, std::memory_order_relaxed);
+}
+/**
+ * dataAdded
+ *    Wake the consumer if it's waiting and there's now enough in the queue.
+ */
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::dataAdded()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_consumerWaiting.load(std::memory_order_relaxed) &&
+      (size() > m_waitLevel.load(std::memory_order_relaxed)) &&
+      m_consumerWaiting.exchange(0)) {
+    m_dataEvent.fetch_add(1, std::memory_order_release);
+    futexWake(&m_dataEvent);
+  }
+}
+/**
+ * spaceFreed
+ *    Wake producers that are blocked on a full queue.  To keep from
+ *    waking them for each element, this is only done once the queue is
+ *    half empty.
+ */
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::spaceFreed()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_producersWaiting.load(std::memory_order_relaxed) &&
+      (size() <= m_nCapacity/2) &&
+      m_producersWaiting.exchange(0)) {
+    m_spaceEvent.fetch_add(1, std::memory_order_release);
+    futexWake(&m_spaceEvent);
+  }
+}
+/**
+ * waitForSpace
+ *    Block until the consumer has made room in a full queue.
+ */
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::waitForSpace()
+{
+  uint32_t event = m_spaceEvent.load(std::memory_order_acquire);
+  m_producersWaiting.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (size() >= m_nCapacity) {
+    futexWait(&m_spaceEvent, event, -1);
+  }
+}
+/**
+ * futexWait
+ *    Block while a futex word still has the expected value.  The queue is
+ *    private to the process so the private futex operations are used.
+ *
+ * @param pWord    - the word.
+ * @param expected - value it had when we decided to block.
+ * @param ms       - timeout in milliseconds, -1 for none.
+ */
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::futexWait(std::atomic<uint32_t>* pWord,
+                                            uint32_t expected, int ms)
+{
+  struct timespec  timeout;
+  struct timespec* pTimeout(0);
+  if (ms >= 0) {
+    timeout.tv_sec  = ms/1000;
+    timeout.tv_nsec = (ms % 1000)*1000000;
+    pTimeout        = &timeout;
+  }
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(pWord), FUTEX_WAIT_PRIVATE,
+          expected, pTimeout, NULL, 0);
+}
+/**
+ * futexWake
+ *    Wake all threads blocked on a futex word.
+ */
+template<class T, bool multiProducer> void
+CLockFreeQueue<T, multiProducer>::futexWake(std::atomic<uint32_t>* pWord)
+{
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(pWord), FUTEX_WAKE_PRIVATE,
+          INT_MAX, NULL, NULL, 0);
+}
@@ -0,0 +1,127 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+
+#ifndef CLOCKFREEQUEUE_H
+#define CLOCKFREEQUEUE_H
+
+#include <atomic>
+#include <list>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*!
+   A bounded, lock free queue with the same interface as CBufferQueue.
+
+   CBufferQueue allocates a list node for each element and takes its mutex
+   for each operation.  This queue is a fixed size ring of slots instead.
+   Each slot carries a sequence number that says whether it is free or
+   full for the current lap of the ring, so producers and the consumer
+   only touch the slots and their own index.
+
+   - There may only be one consumer thread (get, getnow, getAll, wait).
+   - If multiProducer is false there may only be one producer thread at a
+     time as well.  Producers that are serialized by some other lock count
+     as one thread.  If it's true, any number of threads may queue.
+
+   Unlike CBufferQueue the queue has a capacity (rounded up to a power of
+   two).  queue blocks while the queue is full.  The threads only make
+   futex system calls when they have to block, and producers only when
+   the consumer is actually waiting.
+
+   The elements must be default constructible and copy assignable.  In
+   practice they are pointers.
+*/
+template<class T, bool multiProducer = false>
+class CLockFreeQueue
+{
+private:
+  struct Slot {
+    std::atomic<size_t> s_sequence;
+    T                   s_element;
+  };
+
+  size_t                m_nCapacity;
+  size_t                m_nMask;
+  Slot*                 m_pSlots;
+  size_t                m_nWakeLevel;
+
+  // The producer and consumer indices are kept on separate cache lines.
+
+  char                  m_pad1[64];
+  std::atomic<size_t>   m_tail;         // Next slot to fill.
+  char                  m_pad2[64];
+  std::atomic<size_t>   m_head;         // Next slot to empty.
+  char                  m_pad3[64];
+
+  // Futex words and flags that say someone is blocked on them.
+
+  std::atomic<uint32_t> m_dataEvent;    // Bumped to wake the consumer.
+  std::atomic<uint32_t> m_consumerWaiting;
+  std::atomic<size_t>   m_waitLevel;    // What the consumer is waiting for.
+  std::atomic<uint32_t> m_spaceEvent;   // Bumped to wake producers.
+  std::atomic<uint32_t> m_producersWaiting;
+
+public:
+  static const size_t DefaultCapacity = 4096;
+
+  CLockFreeQueue(size_t wakeLevel = 0, size_t capacity = DefaultCapacity);
+  virtual ~CLockFreeQueue();
+
+  // Queues are not copyable.
+private:
+  CLockFreeQueue(const CLockFreeQueue& rhs);
+  CLockFreeQueue& operator=(const CLockFreeQueue& rhs);
+  int operator==(const CLockFreeQueue& rhs) const;
+  int operator!=(const CLockFreeQueue& rhs) const;
+
+public:
+  void queue(T object);		//!< Add object to queue (blocks if full).
+  void queue(const T* objects, size_t n); //!< Add several objects.
+  bool queuenow(T object);      //!< Add object unless the queue is full.
+  T    get();			//!< dequeue object, blocking if needed.
+  bool getnow(T& element);      //!< Get without wait (nowait = now).
+  size_t getnow(T* elements, size_t max); //!< Get up to max without waiting.
+  std::list<T> getAll();	//!< Empty the queue.
+  void setWakeThreshold(size_t level);
+  void wait(int timeout = -1);	//!< Wait for elements.
+  void wake();			//!< Wake the waiting consumer.
+
+  size_t size() const;          //!< Approximate number of elements.
+  size_t capacity() const { return m_nCapacity; }
+
+private:
+  size_t put(const T* objects, size_t n);
+  void   waitForData(size_t level, int timeout);
+  void   dataAdded();
+  void   spaceFreed();
+  void   waitForSpace();
+  static void futexWait(std::atomic<uint32_t>* pWord, uint32_t expected, int ms);
+  static void futexWake(std::atomic<uint32_t>* pWord);
+};
+
+// The usual pairings:
+
+template<class T> using CSPSCQueue = CLockFreeQueue<T, false>;
+template<class T> using CMPSCQueue = CLockFreeQueue<T, true>;
+
+
+// See CBufferQueue.h for why the implementation is included.
+
+#ifndef  COMPILINGCLOCKFREEQUEUE
+#include <CLockFreeQueue.cpp>
+#endif
+
+#endif
@@ -0,0 +1,213 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/*
+** queuebench - compares CBufferQueue with CLockFreeQueue.
+**
+** Producer threads queue elements that are the time at which they were
+** queued; a consumer thread dequeues them and records how long each one
+** spent in the queue.  Elements are queued and dequeued one at a time or,
+** with --batch, in batches (CBufferQueue has no batch queue so it queues
+** the elements of a batch one by one and dequeues with getAll).
+** Operations/sec and the queue latency distribution are reported.
+*/
+#include "queuebenchoptions.h"
+#include <CBufferQueue.h>
+#include <CLockFreeQueue.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+** Nanoseconds on the monotonic clock.
+*/
+static uint64_t
+now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()
+  ).count();
+}
+
+/*
+** Adapters so that the measurement can be a template.
+*/
+static void
+putBatch(CBufferQueue<uint64_t>& q, const uint64_t* p, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    q.queue(p[i]);
+  }
+}
+static size_t
+getBatch(CBufferQueue<uint64_t>& q, std::vector<uint64_t>& elements)
+{
+  if (elements.size() == 1) {
+    elements[0] = q.get();
+    return 1;
+  }
+  std::list<uint64_t> all = q.getAll();
+  if (all.empty()) {
+    q.wait();
+    all = q.getAll();
+  }
+  if (all.size() > elements.size()) {
+    elements.resize(all.size());
+  }
+  std::copy(all.begin(), all.end(), elements.begin());
+  return all.size();
+}
+
+template<bool mp> static void
+putBatch(CLockFreeQueue<uint64_t, mp>& q, const uint64_t* p, size_t n)
+{
+  if (n == 1) {
+    q.queue(*p);
+  } else {
+    q.queue(p, n);
+  }
+}
+template<bool mp> static size_t
+getBatch(CLockFreeQueue<uint64_t, mp>& q, std::vector<uint64_t>& elements)
+{
+  size_t n = elements.size();
+  if (n == 1) {
+    elements[0] = q.get();
+    return 1;
+  }
+  size_t got = q.getnow(elements.data(), n);
+  if (!got) {
+    elements[0] = q.get();
+    got         = 1 + q.getnow(elements.data() + 1, n - 1);
+  }
+  return got;
+}
+
+/*
+** Body of a producer: queue nItems in batches.
+*/
+template<class Q> static void
+produce(Q* pQueue, size_t nItems, size_t batch)
+{
+  std::vector<uint64_t> elements(batch);
+  while (nItems) {
+    size_t n = std::min(nItems, batch);
+    uint64_t stamp = now();
+    std::fill(elements.begin(), elements.begin() + n, stamp);
+    putBatch(*pQueue, elements.data(), n);
+    nItems -= n;
+  }
+}
+
+/*
+** Report a measurement.
+*/
+static void
+report(const char* name, std::vector<uint64_t>& latencies, double seconds,
+       size_t operations)
+{
+  size_t n = latencies.size();
+  std::cout << name << ":\n";
+  std::cout << "  Elements      : " << n << " in " << seconds << " sec\n";
+  if (!n || (seconds <= 0)) return;
+  std::cout << "  Elements/sec  : " << n/seconds << std::endl;
+  std::cout << "  Dequeues/sec  : " << operations/seconds << std::endl;
+
+  std::sort(latencies.begin(), latencies.end());
+  double percentiles[] = {50.0, 90.0, 99.0, 99.9, 99.99};
+  std::cout << "  Latency (ns)  : min " << latencies.front();
+  for (unsigned i = 0; i < sizeof(percentiles)/sizeof(double); i++) {
+    size_t index = static_cast<size_t>(percentiles[i]*(n - 1)/100.0);
+    std::cout << " p" << percentiles[i] << " " << latencies[index];
+  }
+  std::cout << " max " << latencies.back() << std::endl;
+}
+
+/*
+** Measure one kind of queue.
+*/
+template<class Q> static void
+measure(const char* name, Q& queue, size_t nItems, unsigned nProducers,
+        size_t batch)
+{
+  std::vector<uint64_t> latencies;
+  latencies.reserve(nItems);
+  std::vector<uint64_t> elements(batch);   // May grow for CBufferQueue.
+  size_t operations = 0;
+
+  uint64_t start = now();
+  std::vector<std::thread> producers;
+  for (unsigned i = 0; i < nProducers; i++) {
+    size_t n = nItems/nProducers + ((i < nItems % nProducers) ? 1 : 0);
+    producers.push_back(std::thread(produce<Q>, &queue, n, batch));
+  }
+  while (latencies.size() < nItems) {
+    size_t n = getBatch(queue, elements);
+    uint64_t t = now();
+    for (size_t i = 0; i < n; i++) {
+      latencies.push_back(t - elements[i]);
+    }
+    operations++;
+  }
+  double seconds = (now() - start)/1.0e9;
+  for (unsigned i = 0; i < nProducers; i++) {
+    producers[i].join();
+  }
+  report(name, latencies, seconds, operations);
+}
+
+int
+main(int argc, char** argv)
+{
+  queuebench_args_info args;
+  queuebench_parser(argc, argv, &args);
+
+  size_t   nItems     = args.items_arg;
+  unsigned nProducers = args.producers_arg;
+  size_t   batch      = args.batch_arg;
+  size_t   capacity   = args.capacity_arg;
+  std::string which(args.queue_arg);
+  if (!nProducers || !batch) {
+    std::cerr << "--producers and --batch must be at least 1\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout << nProducers << " producer(s), batches of " << batch
+	    << ", lock free queue capacity " << capacity << std::endl;
+
+  if ((which == "buffer") || (which == "all")) {
+    CBufferQueue<uint64_t> queue;
+    measure("CBufferQueue", queue, nItems, nProducers, batch);
+  }
+  if ((which == "spsc") || (which == "all")) {
+    if (nProducers == 1) {
+      CSPSCQueue<uint64_t> queue(0, capacity);
+      measure("CSPSCQueue", queue, nItems, nProducers, batch);
+    } else {
+      std::cout << "CSPSCQueue: skipped, it only allows one producer\n";
+    }
+  }
+  if ((which == "mpsc") || (which == "all")) {
+    CMPSCQueue<uint64_t> queue(0, capacity);
+    measure("CMPSCQueue", queue, nItems, nProducers, batch);
+  }
+  return EXIT_SUCCESS;
+}
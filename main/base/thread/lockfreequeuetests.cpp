@@ -0,0 +1,238 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+// Tests of the lock free queue.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+
+#include "CLockFreeQueue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <list>
+#include <stdint.h>
+#include <unistd.h>
+
+
+class LockFreeQueueTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(LockFreeQueueTests);
+  CPPUNIT_TEST(fifo);
+  CPPUNIT_TEST(wraparound);
+  CPPUNIT_TEST(fullBlocks);
+  CPPUNIT_TEST(emptyBlocks);
+  CPPUNIT_TEST(waitTimeout);
+  CPPUNIT_TEST(multiProducer);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {
+  }
+  void tearDown() {
+  }
+protected:
+  void fifo();
+  void wraparound();
+  void fullBlocks();
+  void emptyBlocks();
+  void waitTimeout();
+  void multiProducer();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LockFreeQueueTests);
+
+// Elements come out in the order they went in, however they're gotten.
+// The capacity is rounded up to a power of two.
+
+void LockFreeQueueTests::fifo()
+{
+  CSPSCQueue<int> q(0, 100);
+  CPPUNIT_ASSERT_EQUAL(size_t(128), q.capacity());
+
+  int element;
+  CPPUNIT_ASSERT(!q.getnow(element));
+
+  for (int i = 0; i < 100; i++) {
+    q.queue(i);
+  }
+  CPPUNIT_ASSERT_EQUAL(size_t(100), q.size());
+  for (int i = 0; i < 10; i++) {
+    CPPUNIT_ASSERT_EQUAL(i, q.get());
+  }
+  for (int i = 10; i < 20; i++) {
+    CPPUNIT_ASSERT(q.getnow(element));
+    CPPUNIT_ASSERT_EQUAL(i, element);
+  }
+  int elements[30];
+  CPPUNIT_ASSERT_EQUAL(size_t(30), q.getnow(elements, 30));
+  for (int i = 0; i < 30; i++) {
+    CPPUNIT_ASSERT_EQUAL(20 + i, elements[i]);
+  }
+  std::list<int> rest = q.getAll();
+  CPPUNIT_ASSERT_EQUAL(size_t(50), rest.size());
+  int expected = 50;
+  for (std::list<int>::iterator p = rest.begin(); p != rest.end(); p++) {
+    CPPUNIT_ASSERT_EQUAL(expected++, *p);
+  }
+  CPPUNIT_ASSERT_EQUAL(size_t(0), q.size());
+  CPPUNIT_ASSERT(!q.getnow(element));
+}
+
+// Many laps of a small ring, with block puts and gets that straddle
+// the end of the slots.
+
+void LockFreeQueueTests::wraparound()
+{
+  CSPSCQueue<int> q(0, 8);
+  CPPUNIT_ASSERT_EQUAL(size_t(8), q.capacity());
+
+  int next     = 0;
+  int expected = 0;
+  for (int lap = 0; lap < 100; lap++) {
+    int in[5];
+    for (int i = 0; i < 5; i++) {
+      in[i] = next++;
+    }
+    q.queue(in, 5);
+    CPPUNIT_ASSERT_EQUAL(size_t(5), q.size());
+
+    int out[8];
+    CPPUNIT_ASSERT_EQUAL(size_t(5), q.getnow(out, 8));
+    for (int i = 0; i < 5; i++) {
+      CPPUNIT_ASSERT_EQUAL(expected++, out[i]);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), q.size());
+  }
+
+  // Fill it exactly, having wrapped:
+
+  for (int i = 0; i < 8; i++) {
+    CPPUNIT_ASSERT(q.queuenow(next++));
+  }
+  CPPUNIT_ASSERT(!q.queuenow(next));
+  for (int i = 0; i < 8; i++) {
+    CPPUNIT_ASSERT_EQUAL(expected++, q.get());
+  }
+}
+
+// A producer blocks on a full queue until the consumer has emptied it
+// to half full, and nothing is lost or reordered.
+
+void LockFreeQueueTests::fullBlocks()
+{
+  CSPSCQueue<int> q(0, 4);
+  for (int i = 0; i < 4; i++) {
+    CPPUNIT_ASSERT(q.queuenow(i));
+  }
+  CPPUNIT_ASSERT(!q.queuenow(4));
+
+  std::atomic<bool> done(false);
+  std::thread producer([&q, &done]() { q.queue(4); done = true; });
+
+  usleep(50*1000);
+  CPPUNIT_ASSERT(!done);
+
+  CPPUNIT_ASSERT_EQUAL(0, q.get());
+  CPPUNIT_ASSERT_EQUAL(1, q.get());
+  producer.join();
+  CPPUNIT_ASSERT(done);
+
+  for (int i = 2; i < 5; i++) {
+    CPPUNIT_ASSERT_EQUAL(i, q.get());
+  }
+}
+
+// The consumer blocks on an empty queue until something is queued.
+
+void LockFreeQueueTests::emptyBlocks()
+{
+  CSPSCQueue<int> q;
+  std::atomic<bool> done(false);
+  int               element(0);
+  std::thread consumer([&q, &done, &element]() {
+    element = q.get();
+    done    = true;
+  });
+
+  usleep(50*1000);
+  CPPUNIT_ASSERT(!done);
+
+  q.queue(42);
+  consumer.join();
+  CPPUNIT_ASSERT(done);
+  CPPUNIT_ASSERT_EQUAL(42, element);
+  CPPUNIT_ASSERT_EQUAL(size_t(0), q.size());
+}
+
+// wait returns on timeout, when wake is called and once there's more
+// than the wake level in the queue.
+
+void LockFreeQueueTests::waitTimeout()
+{
+  CSPSCQueue<int> q(2);
+  q.queue(1);
+  q.queue(2);
+  q.wait(10);                   // Not above the wake level; times out.
+  CPPUNIT_ASSERT_EQUAL(size_t(2), q.size());
+
+  std::thread waker([&q]() { usleep(20*1000); q.wake(); });
+  q.wait();
+  waker.join();
+
+  std::thread producer([&q]() { usleep(20*1000); q.queue(3); });
+  q.wait();
+  producer.join();
+  CPPUNIT_ASSERT_EQUAL(size_t(3), q.size());
+}
+
+// Several producers into a small queue.  Each producer's elements come
+// out in the order it queued them and none are lost.
+
+void LockFreeQueueTests::multiProducer()
+{
+  const unsigned nProducers = 4;
+  const uint32_t nEach      = 20000;
+  CMPSCQueue<uint32_t> q(0, 64);
+
+  std::vector<std::thread> producers;
+  for (uint32_t id = 0; id < nProducers; id++) {
+    producers.push_back(std::thread([&q, id, nEach]() {
+      for (uint32_t i = 0; i < nEach; i++) {
+        uint32_t element = (id << 24) | i;
+        if (i & 1) {
+          q.queue(element);
+        } else {
+          q.queue(&element, 1);
+        }
+      }
+    }));
+  }
+
+  std::vector<uint32_t> next(nProducers, 0);
+  for (uint32_t n = 0; n < nProducers*nEach; n++) {
+    uint32_t element = q.get();
+    uint32_t id      = element >> 24;
+    CPPUNIT_ASSERT(id < nProducers);
+    CPPUNIT_ASSERT_EQUAL(next[id], element & 0xffffff);
+    next[id]++;
+  }
+  for (size_t i = 0; i < producers.size(); i++) {
+    producers[i].join();
+  }
+  for (uint32_t id = 0; id < nProducers; id++) {
+    CPPUNIT_ASSERT_EQUAL(nEach, next[id]);
+  }
+  CPPUNIT_ASSERT_EQUAL(size_t(0), q.size());
+}
@@ -21,6 +21,46 @@
 
 #include <URL.h>
 #include <unistd.h>
+#include <stdlib.h>
+
+/*
+ * Convert the numeric part of a file data source query.
+ */
+static uint64_t
+queryValue(const std::string& value, const std::string& query)
+{
+  char* end;
+  uint64_t result = strtoull(value.c_str(), &end, 0);
+  if (value.empty() || *end) {
+    throw std::string("Invalid number in file data source query: ") + query;
+  }
+  return result;
+}
+/*
+ * Position a file data source as asked by the query part of its URI:
+ *   seek=ts:timestamp  - First item with at least that timestamp.
+ *   event=n            - Item number n.
+ * Several '&' separated positioning requests are done in order.
+ */
+static void
+positionFileSource(CFileDataSource& source, const std::string& query)
+{
+  size_t start = 0;
+  while (start <= query.size()) {
+    size_t end = query.find('&', start);
+    if (end == std::string::npos) end = query.size();
+    std::string request = query.substr(start, end - start);
+
+    if (request.compare(0, 8, "seek=ts:") == 0) {
+      source.seekTimestamp(queryValue(request.substr(8), query));
+    } else if (request.compare(0, 6, "event=") == 0) {
+      source.seekItem(queryValue(request.substr(6), query));
+    } else {
+      throw std::string("Invalid file data source query: ") + query;
+    }
+    start = end + 1;
+  }
+}
 
 /**
  * makeSource
@@ -28,7 +68,10 @@
  *  Creates a dynamically allocated ring item data source and returns a pointer to it
  *  to the caller.  The caller must at some point delete the data source.
  *
- * @param uri  - Uniform resource identifier of the source. 
+ * @param uri  - Uniform resource identifier of the source.  file: URIs can
+ *               have a query that positions the source in the file, e.g.
+ *               file:///path/run-0001-00.evt?seek=ts:123456 or ?event=1000
+ *               (see positionFileSource above).
  * @param sample - Vector of data types that are sampled.  Note that not all data sources
  *                 support sampling (specifically file:/// URI's will ignore this).
  * @param exclude - Vector of data types not to be returned from the source.
@@ -53,13 +96,33 @@ CDataSourceFactory::makeSource(std::string uri,
 
   } else {
     // The source id must have been a uri... do what the protocol 
-    // demands
+    // demands.  The URL class does not understand queries (and would take
+    // the ':' in seek=ts: as a port) so a file query is split off first.
+
+    std::string query;
+    if (uri.compare(0, 5, "file:") == 0) {
+      size_t q = uri.find('?');
+      if (q != std::string::npos) {
+        query = uri.substr(q + 1);
+        uri   = uri.substr(0, q);
+      }
+    }
     URL parsedURI(uri);
 
     if (parsedURI.getProto() == std::string("file")) {
       // File data source:
 
-      pSource = new CFileDataSource(parsedURI, exclude);
+      CFileDataSource* pFileSource = new CFileDataSource(parsedURI, exclude);
+      if (!query.empty()) {
+        try {
+          positionFileSource(*pFileSource, query);
+        }
+        catch (...) {
+          delete pFileSource;
+          throw;
+        }
+      }
+      pSource = pFileSource;
 
     } else if (parsedURI.getProto() == std::string("tcp")) {
       // ringbuffer (local or remote):
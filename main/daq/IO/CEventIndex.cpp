@@ -0,0 +1,165 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CEventIndex.cpp
+ * @brief Implement the event file index reader.
+ */
+
+#include "CEventIndex.h"
+
+#include <DataFormat.h>
+#include <ErrnoException.h>
+#include <io.h>
+
+#include <algorithm>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+const uint64_t CEventIndex::NullTimestamp(0xffffffffffffffffULL);
+
+/**
+ * constructor
+ *    Read the index into memory.  A partial entry at the end of the file
+ *    (e.g. the logger died while writing it) is ignored.
+ *
+ * @param path - Path to the index file.
+ *
+ * @throw CErrnoException - The file can't be opened or read.
+ * @throw std::string     - The file is not an event index.
+ */
+CEventIndex::CEventIndex(const char* path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    throw CErrnoException("Opening event index file");
+  }
+  try {
+    struct stat info;
+    if (fstat(fd, &info)) {
+      throw CErrnoException("Getting the size of an event index file");
+    }
+    size_t nRead = io::readData(fd, &m_header, sizeof(m_header));
+    if ((nRead != sizeof(m_header)) ||
+        (memcmp(m_header.s_magic, EVENT_INDEX_MAGIC, sizeof(m_header.s_magic)) != 0)) {
+      throw std::string("Not an event index file: ") + path;
+    }
+    if (m_header.s_version != EVENT_INDEX_VERSION) {
+      throw std::string("Unsupported event index file version: ") + path;
+    }
+    size_t nEntries = (info.st_size - sizeof(m_header))/sizeof(EventIndexEntry);
+    m_entries.resize(nEntries);
+    nRead = io::readData(fd, m_entries.data(), nEntries*sizeof(EventIndexEntry));
+    m_entries.resize(nRead/sizeof(EventIndexEntry));
+  }
+  catch (int err) {                     // io::readData failure.
+    close(fd);
+    errno = err;
+    throw CErrnoException("Reading event index file");
+  }
+  catch (...) {
+    close(fd);
+    throw;
+  }
+  close(fd);
+}
+
+/**
+ * findItem
+ *    Locate the entry from which to read forward to get to an item.
+ *
+ * @param itemNumber - Number of the desired item.
+ *
+ * @return const EventIndexEntry* - The last entry at or before the item.
+ * @retval nullptr - The item precedes this segment (or there are no entries).
+ */
+const EventIndexEntry*
+CEventIndex::findItem(uint64_t itemNumber) const
+{
+  auto p = std::upper_bound(
+    m_entries.begin(), m_entries.end(), itemNumber,
+    [](uint64_t n, const EventIndexEntry& e) { return n < e.s_itemNumber; }
+  );
+  if (p == m_entries.begin()) {
+    return nullptr;
+  }
+  --p;
+  return &(*p);
+}
+/**
+ * findTimestamp
+ *    Locate the entry from which to read forward to get to the first item
+ *    with a timestamp at least as large as the one requested.  This is the
+ *    last timestamped entry before the first entry whose timestamp is
+ *    larger than the one requested.  Entries without timestamps are
+ *    ignored.
+ *
+ * @param timestamp - Desired timestamp.
+ *
+ * @return const EventIndexEntry* - Entry to start from.
+ * @retval nullptr - Start from the beginning of the segment.
+ */
+const EventIndexEntry*
+CEventIndex::findTimestamp(uint64_t timestamp) const
+{
+  const EventIndexEntry* pResult = nullptr;
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    const EventIndexEntry& e(m_entries[i]);
+    if (e.s_timestamp == NullTimestamp) continue;
+    if (e.s_timestamp > timestamp) break;
+    pResult = &e;
+  }
+  return pResult;
+}
+
+/**
+ * indexFile
+ *   @param eventFile - Path to an event file.
+ *   @return std::string - Path to its index.
+ */
+std::string
+CEventIndex::indexFile(const std::string& eventFile)
+{
+  return eventFile + ".idx";
+}
+/**
+ * isStateChange
+ *   @param type - A ring item type.
+ *   @return bool - true if that's a state change item type (these always
+ *                  get index entries).
+ */
+bool
+CEventIndex::isStateChange(uint32_t type)
+{
+  return (type == BEGIN_RUN) || (type == END_RUN) || (type == PAUSE_RUN) ||
+         (type == RESUME_RUN) || (type == ABNORMAL_ENDRUN);
+}
+/**
+ * itemTimestamp
+ *   @param pItem - Pointer to a ring item.
+ *   @return uint64_t - The item's body header timestamp or NullTimestamp
+ *                      if it has no body header.  Items from a system of
+ *                      the other byte order are treated as not having one.
+ */
+uint64_t
+CEventIndex::itemTimestamp(const RingItem* pItem)
+{
+  if (mustSwap(pItem) || !hasBodyHeader(pItem)) {
+    return NullTimestamp;
+  }
+  return pItem->s_body.u_hasBodyHeader.s_bodyHeader.s_timestamp;
+}
@@ -0,0 +1,98 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CEventIndex.h
+ * @brief Format of and access to event file sidecar indices.
+ */
+#ifndef CEVENTINDEX_H
+#define CEVENTINDEX_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+struct _RingItem;
+
+/*
+ *  An event file index is a file that sits next to an event file
+ *  (run-nnnn-ss.evt has the index run-nnnn-ss.evt.idx).  It consists of an
+ *  EventIndexHeader followed by EventIndexEntry records in file order.  There
+ *  is an entry for the first item of the file, every s_interval'th item
+ *  after that and every state change item.
+ *
+ *  Item numbers count all items written for the run, so they continue
+ *  from one segment to the next;  s_firstItem is the number of the first item
+ *  in the segment.  Offsets are relative to the start of the segment.
+ *  Entries are in host byte order.
+ */
+#pragma pack(push, 1)
+typedef struct _EventIndexHeader {
+  char     s_magic[8];         // EVENT_INDEX_MAGIC
+  uint32_t s_version;          // EVENT_INDEX_VERSION
+  uint32_t s_interval;         // Items between periodic entries.
+  uint32_t s_runNumber;
+  uint32_t s_segment;
+  uint64_t s_firstItem;        // Item number of the first item in the segment.
+} EventIndexHeader, *pEventIndexHeader;
+
+typedef struct _EventIndexEntry {
+  uint64_t s_offset;           // Byte offset of the item in the segment.
+  uint64_t s_itemNumber;
+  uint64_t s_timestamp;        // CEventIndex::NullTimestamp if no body header.
+  uint32_t s_type;
+  uint32_t s_size;
+} EventIndexEntry, *pEventIndexEntry;
+#pragma pack(pop)
+
+#define EVENT_INDEX_MAGIC   "NSCLIDX"
+#define EVENT_INDEX_VERSION 1
+
+/**
+ * @class CEventIndex
+ *
+ *   Reads an event file index into memory and answers questions about where
+ *   to start reading the event file to get to an item number or a timestamp.
+ */
+class CEventIndex
+{
+public:
+  static const uint64_t NullTimestamp;
+
+private:
+  EventIndexHeader             m_header;
+  std::vector<EventIndexEntry> m_entries;
+
+public:
+  CEventIndex(const char* path);
+
+private:
+  CEventIndex(const CEventIndex&);
+  CEventIndex& operator=(const CEventIndex&);
+  int operator==(const CEventIndex&) const;
+  int operator!=(const CEventIndex&) const;
+
+public:
+  const EventIndexHeader&             getHeader() const  { return m_header; }
+  const std::vector<EventIndexEntry>& getEntries() const { return m_entries; }
+
+  const EventIndexEntry* findItem(uint64_t itemNumber) const;
+  const EventIndexEntry* findTimestamp(uint64_t timestamp) const;
+
+  static std::string indexFile(const std::string& eventFile);
+  static bool        isStateChange(uint32_t type);
+  static uint64_t    itemTimestamp(const _RingItem* pItem);
+};
+
+#endif
@@ -0,0 +1,173 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CEventIndexWriter.cpp
+ * @brief Implement the event file index writer.
+ */
+
+#include "CEventIndexWriter.h"
+
+#include <DataFormat.h>
+#include <ErrnoException.h>
+#include <io.h>
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Entries buffered before they're written.
+
+static const size_t FlushEntries(4096);
+
+/**
+ * constructor
+ *
+ * @param interval - Number of items between periodic entries (0 means
+ *                   only the first item and state changes get entries).
+ */
+CEventIndexWriter::CEventIndexWriter(unsigned interval) :
+  m_fd(-1), m_interval(interval), m_offset(0), m_itemNumber(0), m_firstItem(0)
+{
+  m_pending.reserve(FlushEntries);
+}
+/**
+ * destructor
+ *    Finish off any open index.
+ */
+CEventIndexWriter::~CEventIndexWriter()
+{
+  try {
+    close();
+  }
+  catch (...) {}
+}
+
+/**
+ * open
+ *    Start the index for a new event file segment, finishing off the one
+ *    for the prior segment if it's still open.
+ *
+ * @param eventFile - Path to the event file segment.
+ * @param runNumber - Run being recorded.
+ * @param segment   - Segment number, 0 starts a new run.
+ *
+ * @throw CErrnoException - if the index file can't be created.
+ * @throw int             - errno from io::writeData.
+ */
+void
+CEventIndexWriter::open(const std::string& eventFile, uint32_t runNumber, unsigned segment)
+{
+  close();
+  m_pending.clear();
+  std::string path = CEventIndex::indexFile(eventFile);
+  m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                S_IWUSR | S_IRUSR | S_IRGRP);
+  if (m_fd < 0) {
+    throw CErrnoException("Creating event index file");
+  }
+  if (segment == 0) {
+    m_itemNumber = 0;
+  }
+  m_offset    = 0;
+  m_firstItem = m_itemNumber;
+
+  EventIndexHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.s_magic, EVENT_INDEX_MAGIC, sizeof(EVENT_INDEX_MAGIC));
+  header.s_version   = EVENT_INDEX_VERSION;
+  header.s_interval  = m_interval;
+  header.s_runNumber = runNumber;
+  header.s_segment   = segment;
+  header.s_firstItem = m_firstItem;
+  io::writeData(m_fd, &header, sizeof(header));
+}
+/**
+ * close
+ *    Write the remaining entries and close the index.  No-op if there's
+ *    no index open.
+ */
+void
+CEventIndexWriter::close()
+{
+  if (m_fd >= 0) {
+    int fd = m_fd;
+    m_fd   = -1;
+    try {
+      flush(fd);
+    }
+    catch (...) {
+      ::close(fd);
+      throw;
+    }
+    ::close(fd);
+  }
+}
+/**
+ * addItems
+ *    Account for a block of complete ring items that was just written to
+ *    the segment.
+ *
+ * @param pItems - Pointer to the first item.
+ * @param nBytes - Number of bytes of items.
+ */
+void
+CEventIndexWriter::addItems(const void* pItems, size_t nBytes)
+{
+  const uint8_t* p    = static_cast<const uint8_t*>(pItems);
+  const uint8_t* pEnd = p + nBytes;
+  while (p < pEnd) {
+    const RingItem* pItem = reinterpret_cast<const RingItem*>(p);
+    uint32_t size = itemSize(pItem);
+    uint32_t type = itemType(pItem);
+
+    uint64_t n = m_itemNumber - m_firstItem;
+    if ((n == 0) || (m_interval && ((n % m_interval) == 0)) ||
+        CEventIndex::isStateChange(type)) {
+      EventIndexEntry e;
+      e.s_offset     = m_offset;
+      e.s_itemNumber = m_itemNumber;
+      e.s_timestamp  = CEventIndex::itemTimestamp(pItem);
+      e.s_type       = type;
+      e.s_size       = size;
+      m_pending.push_back(e);
+      if ((m_pending.size() >= FlushEntries) && (m_fd >= 0)) {
+        flush(m_fd);
+      }
+    }
+    m_offset += size;
+    m_itemNumber++;
+    p        += size;
+  }
+}
+/*-----------------------------------------------------------------------------
+ * Private utilities.
+ */
+
+/**
+ * flush
+ *    Write the pending entries.
+ *
+ * @param fd - The index file.
+ */
+void
+CEventIndexWriter::flush(int fd)
+{
+  if (!m_pending.empty()) {
+    io::writeData(fd, m_pending.data(), m_pending.size()*sizeof(EventIndexEntry));
+    m_pending.clear();
+  }
+}
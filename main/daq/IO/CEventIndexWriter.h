@@ -0,0 +1,72 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CEventIndexWriter.h
+ * @brief Write the sidecar index for an event file as it's written.
+ */
+#ifndef CEVENTINDEXWRITER_H
+#define CEVENTINDEXWRITER_H
+
+#include "CEventIndex.h"
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @class CEventIndexWriter
+ *
+ *   Builds the index (see CEventIndex.h) of an event file segment from the
+ *   ring items written to that segment.  The writer of the event file hands
+ *   us the same blocks of complete ring items it writes to the segment
+ *   and we walk their headers.  Entries are buffered and written in blocks
+ *   so that this costs next to nothing compared with writing the data.
+ *
+ *   Item numbers continue across the segments of a run.  Opening segment 0
+ *   starts a new run and resets the item count.
+ */
+class CEventIndexWriter
+{
+private:
+  int                          m_fd;
+  unsigned                     m_interval;
+  uint64_t                     m_offset;       // Next byte offset in segment.
+  uint64_t                     m_itemNumber;   // Next item number in run.
+  uint64_t                     m_firstItem;    // First item in segment.
+  std::vector<EventIndexEntry> m_pending;
+
+public:
+  CEventIndexWriter(unsigned interval);
+  virtual ~CEventIndexWriter();
+
+private:
+  CEventIndexWriter(const CEventIndexWriter&);
+  CEventIndexWriter& operator=(const CEventIndexWriter&);
+  int operator==(const CEventIndexWriter&) const;
+  int operator!=(const CEventIndexWriter&) const;
+
+public:
+  void open(const std::string& eventFile, uint32_t runNumber, unsigned segment);
+  void close();
+  void addItems(const void* pItems, size_t nBytes);
+
+  uint64_t getItemCount() const { return m_itemNumber; }
+
+private:
+  void flush(int fd);
+};
+
+#endif
@@ -17,6 +17,7 @@
 
 #include <config.h>
 #include "CFileDataSource.h"
+#include "CEventIndex.h"
 
 
 #include <URL.h>
@@ -26,16 +27,22 @@
 #include <CInvalidArgumentException.h>
 #include <io.h>
 
+#include <memory>
 #include <string>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 
 using std::vector;
 using std::set;
 using std::string;
 
+// Bytes read from the file at a time.  The buffer grows if an item is bigger.
+
+static const size_t BlockSize(1024*1024);
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -53,7 +60,8 @@ using std::string;
 */
 CFileDataSource::CFileDataSource(URL& url, vector<uint16_t> exclusionList) :
   m_fd(-1),
-  m_url(*(new URL(url)))
+  m_url(*(new URL(url))),
+  m_buffer(BlockSize), m_start(0), m_end(0), m_offset(0), m_limit(UINT64_MAX)
 {
   for (int i=0; i < exclusionList.size(); i++) {
     m_exclude.insert(exclusionList[i]);
@@ -64,7 +72,8 @@ CFileDataSource::CFileDataSource(URL& url, vector<uint16_t> exclusionList) :
  * construtor from fd:
  */
 CFileDataSource::CFileDataSource(int fd, vector<uint16_t> exclusionlist) :
-  m_fd(fd),  m_url(*(new URL("file://stdin/junk")))
+  m_fd(fd),  m_url(*(new URL("file://stdin/junk"))),
+  m_buffer(BlockSize), m_start(0), m_end(0), m_offset(0), m_limit(UINT64_MAX)
 {
   for (int i=0; i < exclusionlist.size(); i++) {
     m_exclude.insert(exclusionlist[i]);
@@ -98,9 +107,37 @@ CFileDataSource::~CFileDataSource()
 */
 CRingItem*
 CFileDataSource::getItem()
+{
+  const RingItem* p = getItemPointer();
+  if (!p) {
+    return reinterpret_cast<CRingItem*>(NULL);
+  }
+  uint32_t   itemsize = itemSize(p);
+  CRingItem* pItem    = new CRingItem(1, itemsize); //  Type will get overwritten:
+
+  // The ring item is filled in this way to preserve the initial byte order.
+
+  uint8_t* pStorage = reinterpret_cast<uint8_t*>(pItem->getItemPointer());
+  memcpy(pStorage, p, itemsize);
+  pItem->setBodyCursor(pStorage + itemsize);
+
+  return pItem;
+}
+/*!
+  Provide the caller with the next acceptable item in place in our block
+  buffer.
+
+  \return const RingItem*
+  \retval NULL  - end of file reached without an acceptable item being found.
+  \retval other - Pointer to the item.  The item belongs to this object and
+                  is only valid until the next call to getItem,
+                  getItemPointer or read.
+*/
+const RingItem*
+CFileDataSource::getItemPointer()
 {
   while (1) {
-    CRingItem* pItem = getItemFromFile();
+    const RingItem* pItem = getItemFromFile();
     if (!pItem) {
       return pItem;
     }
@@ -108,88 +145,269 @@ CFileDataSource::getItem()
       return pItem;
     }
     // Skip the item, it's not acceptable.
-
-    delete pItem;
   }
 }
 
 void CFileDataSource::read(char* pBuffer, size_t nBytes)
 {
   if (! eof() ) {
-    size_t nRead = io::readData(m_fd, pBuffer, nBytes);
+
+    // Data we've already read from the file comes first:
+
+    size_t nBuffered = m_end - m_start;
+    if (nBuffered > nBytes) {
+      nBuffered = nBytes;
+    }
+    memcpy(pBuffer, m_buffer.data() + m_start, nBuffered);
+    consume(nBuffered);
+
+    size_t nRead = nBuffered;
+    if (nRead < nBytes) {
+      size_t nDirect = io::readData(m_fd, pBuffer + nRead, nBytes - nRead);
+      nRead    += nDirect;
+      m_offset += nDirect;
+    }
 
     if (nRead != nBytes) {
       setEOF(true);
     }
   }
 }
+/*!
+  Position the source at an item.
+
+  \param itemNumber - Number of the item.  If the file has an index,
+                      item numbers are those of the run (the first item of
+                      the segment is the index's s_firstItem), otherwise
+                      they count from zero at the start of the file.
+  
+  \throw CInvalidArgumentException - The item is in an earlier segment.
+  \throw CErrnoException - The file can't be positioned.
+
+  \note If there are fewer items in the file, the next getItem returns NULL.
+*/
+void
+CFileDataSource::seekItem(uint64_t itemNumber)
+{
+  uint64_t offset = 0;
+  uint64_t item   = 0;
+  std::unique_ptr<CEventIndex> pIndex(openIndex());
+  if (pIndex.get()) {
+    item = pIndex->getHeader().s_firstItem;
+    if (itemNumber < item) {
+      throw CInvalidArgumentException(
+        std::to_string(itemNumber), "Item is in an earlier event file segment",
+        "Seeking a file data source"
+      );
+    }
+    const EventIndexEntry* pEntry = pIndex->findItem(itemNumber);
+    if (pEntry) {
+      offset = pEntry->s_offset;
+      item   = pEntry->s_itemNumber;
+    }
+  }
+  position(offset);
+  while ((item < itemNumber) && getItemFromFile()) {
+    item++;
+  }
+}
+/*!
+  Position the source at the first item whose body header timestamp is
+  at least as big as a timestamp.  Items without body headers in front
+  of that item are skipped as well.
+
+  \param timestamp - The timestamp.
+
+  \throw CErrnoException - The file can't be positioned.
+*/
+void
+CFileDataSource::seekTimestamp(uint64_t timestamp)
+{
+  uint64_t offset = 0;
+  std::unique_ptr<CEventIndex> pIndex(openIndex());
+  if (pIndex.get()) {
+    const EventIndexEntry* pEntry = pIndex->findTimestamp(timestamp);
+    if (pEntry) {
+      offset = pEntry->s_offset;
+    }
+  }
+  position(offset);
+  while (const RingItem* pItem = peekItem()) {
+    uint64_t stamp = CEventIndex::itemTimestamp(pItem);
+    if ((stamp != CEventIndex::NullTimestamp) && (stamp >= timestamp)) {
+      break;
+    }
+    consume(itemSize(pItem));
+  }
+}
+/*!
+  Restrict the source to a range of the file.  The source is positioned at
+  the start of the range and returns no more items once the end is reached.
+
+  \param begin - File offset of the first item of the range.
+  \param end   - File offset just past the last item of the range.
+
+  \throw CErrnoException - The file can't be positioned.
+  \note  getItem and getItemPointer throw a std::string if an item runs
+         past the end of the range; that means the range is not aligned to
+         items.
+*/
+void
+CFileDataSource::setRange(uint64_t begin, uint64_t end)
+{
+  position(begin);
+  m_limit = end;
+}
 //////////////////////////////////////////////////////////////////////////////////////////
 //
 // Private utilties.
 
 /*
 **  Get the next item from the file:
-**  First we fetch the header.  Using that we can create storage of the right size
-**  and read the item into that.
-**  We then allocate a ring item and fill its body in from the file.
+**  First we make sure the header is in the buffer.  Using that we can make
+**  sure the whole item is in the buffer.
 **  Returns:
-**    Pointer to the item read from file or NULL if we hit the end of file or an error.
+**    Pointer to the item in the buffer or NULL if we hit the end of file or
+**    an error.
 */
-CRingItem*
+const RingItem*
 CFileDataSource::getItemFromFile()
 {
-  // First read a header:
-
-  RingItemHeader header;
-
-  int nRead = io::readData(m_fd, &header, sizeof(header));
-  if (nRead != sizeof(header)) {
-    return reinterpret_cast<CRingItem*>(NULL);
+  const RingItem* pItem = peekItem();
+  if (pItem) {
+    consume(itemSize(pItem));
   }
-  uint32_t itemsize = getItemSize(header);
-  uint32_t bodysize = itemsize - sizeof(header);
-
-  // Read the remainder of the data:
-
-  uint8_t* pBody = new uint8_t[bodysize];
-  nRead          = io::readData(m_fd, pBody, bodysize);
-  if (nRead != bodysize) {
-    delete []pBody;
-    return reinterpret_cast<CRingItem*>(NULL);
+  return pItem;
+}
+/*
+**  Make sure the next item from the file is in the buffer without
+**  consuming it.
+**  Returns:
+**    Pointer to the item in the buffer or NULL if we hit the end of file or
+**    an error.
+*/
+const RingItem*
+CFileDataSource::peekItem()
+{
+  if ((m_offset >= m_limit) || !fill(sizeof(RingItemHeader))) {
+    return reinterpret_cast<const RingItem*>(NULL);
   }
+  uint32_t itemsize = getItemSize(
+    *reinterpret_cast<pRingItemHeader>(m_buffer.data() + m_start)
+  );
+  if (m_offset + itemsize > m_limit) {
+    throw std::string("A ring item runs past the end of a file data source range");
+  }
+  if (itemsize < sizeof(RingItemHeader) || !fill(itemsize)) {
+    return reinterpret_cast<const RingItem*>(NULL);
+  }
+  return reinterpret_cast<const RingItem*>(m_buffer.data() + m_start);
+}
+/*
+** Position the file at an offset and throw away what's buffered.
+**
+** Parameters:
+**   offset - Byte offset in the file.
+*/
+void
+CFileDataSource::position(uint64_t offset)
+{
+  if (lseek(m_fd, offset, SEEK_SET) == static_cast<off_t>(-1)) {
+    throw CErrnoException("Positioning a file data source");
+  }
+  m_start  = 0;
+  m_end    = 0;
+  m_offset = offset;
+  m_limit  = UINT64_MAX;
+  setEOF(false);
+}
+/*
+** Consume bytes from the buffer.
+**
+** Parameters:
+**   nBytes - Number of bytes at m_start that have been used.
+*/
+void
+CFileDataSource::consume(size_t nBytes)
+{
+  m_start  += nBytes;
+  m_offset += nBytes;
+}
+/*
+** Open the index of the file if it has a usable one.
+**
+** Returns:
+**   Dynamically allocated index the caller must delete or NULL if there
+**   is none.
+*/
+CEventIndex*
+CFileDataSource::openIndex() const
+{
+  if (m_path.empty()) {
+    return reinterpret_cast<CEventIndex*>(NULL);
+  }
+  try {
+    return new CEventIndex(CEventIndex::indexFile(m_path).c_str());
+  }
+  catch (CErrnoException& e) {}   // No index.
+  catch (std::string& msg) {}     // Not an index we can use - just read.
 
-  CRingItem* pItem = new CRingItem(1, itemsize); //  Type will get overwritten:
-
-
-  // The ring item is filled in this way to preserve the initial byte order.
-
-  pRingItemHeader pStorage = reinterpret_cast<pRingItemHeader>(pItem->getItemPointer());
-  memcpy(pStorage, &header, sizeof(RingItemHeader));
-  memcpy(pStorage+1, pBody, bodysize);
-
-  delete []pBody;
-
-  // Set the cursor:
-
-  char* pCursor = reinterpret_cast<char*>(pStorage+1); // start of body.
-  pCursor      += bodysize;	                       // end of body.
-  pItem->setBodyCursor(pCursor);
-
-  return pItem;
-  
+  return reinterpret_cast<CEventIndex*>(NULL);
+}
+/*
+** Ensure there are at least nBytes unconsumed bytes in the buffer.
+** Unconsumed data are moved to the front of the buffer and the buffer is
+** grown if need be.  The file is then read until there are enough bytes,
+** taking whatever each read gives so that pipes are not waited on for more
+** than is needed.
+**
+** Parameters:
+**   nBytes - Number of bytes needed.
+** Returns:
+**   false if the end of file came first.
+*/
+bool
+CFileDataSource::fill(size_t nBytes)
+{
+  if ((m_end - m_start) >= nBytes) {
+    return true;
+  }
+  if (m_start) {
+    memmove(m_buffer.data(), m_buffer.data() + m_start, m_end - m_start);
+    m_end  -= m_start;
+    m_start = 0;
+  }
+  if (nBytes > m_buffer.size()) {
+    m_buffer.resize(nBytes);
+  }
+  while (m_end < nBytes) {
+    ssize_t nRead = ::read(m_fd, m_buffer.data() + m_end,
+			   m_buffer.size() - m_end);
+    if (nRead < 0) {
+      if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        continue;
+      }
+      throw errno;                    // As io::readData does.
+    }
+    if (nRead == 0) {
+      return false;
+    }
+    m_end += nRead;
+  }
+  return true;
 }
 /*
 ** Determines if an item is acceptable.
 **
 ** Parameters:
-**   item - Pointer to the item.
+**   pItem - Pointer to the item.
 ** Returns:
 **   True if acceptable, false if not.
 */
 bool
-CFileDataSource::acceptable(CRingItem* item) const
+CFileDataSource::acceptable(const RingItem* pItem) const
 {
-  uint16_t type             = item->type(); // Byte swaps as needed.
+  uint16_t type             = itemType(pItem); // Byte swaps as needed.
   set<uint16_t>::iterator i = m_exclude.find(type);
   return (i == m_exclude.end()); // Not found is good.
 }
@@ -213,6 +431,7 @@ CFileDataSource::openFile()
 
 
   m_fd = open(fullPath.c_str(), O_RDONLY);
+  m_path = fullPath;
   if (m_fd == -1) {
     throw CErrnoException("Opening file data source");
   }
@@ -21,6 +21,7 @@
 #include "CDataSource.h"
 
 #include <set>
+#include <string>
 #include <vector>
 #include <stdint.h>
 
@@ -28,13 +29,29 @@
 
 class URL;
 class CRingItem;
+class CEventIndex;
 struct _RingItemHeader;
+struct _RingItem;
 
 /*!
   Provide a data source from an event file.  This allows users to directly dump
   an event file to stdout.  The data source returns sequential ring items
   that are not in the excluded set of data types.
 
+  The file is read in large blocks.  getItemPointer returns the next
+  acceptable item in place in the block buffer so that callers that
+  process items one at a time need make neither system calls nor memory
+  allocations for most items.  getItem is built on top of it.
+
+  seekItem and seekTimestamp reposition the source in a file.  If the file
+  has an index (see CEventIndex) it's used to get close to the target
+  and only the remaining few items are read; otherwise the file is read
+  from its start.
+
+  setRange restricts the source to a byte range of the file that starts
+  and ends on item boundaries so that several sources can each process a
+  part of the same file.
+
 */
 
 class CFileDataSource : public CDataSource
@@ -45,6 +62,12 @@ private:
   int                  m_fd;	  // File descriptor open on the event source.
   std::set<uint16_t>   m_exclude; // item types to exclude from the return set.
   URL&                 m_url;	  // URI that points to the file.
+  std::string          m_path;    // File path ("" if made from an fd).
+  std::vector<uint8_t> m_buffer;  // Block buffer.
+  size_t               m_start;   // Offset of first unconsumed byte.
+  size_t               m_end;     // Offset past the last valid byte.
+  uint64_t             m_offset;  // File offset of m_buffer[m_start].
+  uint64_t             m_limit;   // File offset at which items end.
 
   // Constructors and other canonicals:
 
@@ -66,11 +89,23 @@ public:
 
   void read(char* pBuffer, size_t nBytes);
 
+  const _RingItem* getItemPointer();
+
+  void seekItem(uint64_t itemNumber);
+  void seekTimestamp(uint64_t timestamp);
+  void setRange(uint64_t begin, uint64_t end);
+  uint64_t getOffset() const { return m_offset; }
+
   // utilities:
 
 private:
-  CRingItem* getItemFromFile();
-  bool       acceptable(CRingItem* item) const;
+  const _RingItem* getItemFromFile();
+  const _RingItem* peekItem();
+  void       consume(size_t nBytes);
+  void       position(uint64_t offset);
+  CEventIndex* openIndex() const;
+  bool       acceptable(const _RingItem* pItem) const;
+  bool       fill(size_t nBytes);
   void       openFile();
   uint32_t   getItemSize(_RingItemHeader& header);
 };
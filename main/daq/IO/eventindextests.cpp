@@ -0,0 +1,312 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+// Tests for event file indices and positioning file data sources with them.
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <CEventIndex.h>
+#include <CEventIndexWriter.h>
+#include <CFileDataSource.h>
+#include <CDataSourceFactory.h>
+#include <CRingItem.h>
+#include <DataFormat.h>
+#include <CInvalidArgumentException.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+class CEventIndexTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( CEventIndexTest );
+  CPPUNIT_TEST ( entries );
+  CPPUNIT_TEST ( segments );
+  CPPUNIT_TEST ( find );
+  CPPUNIT_TEST ( seekEvent );
+  CPPUNIT_TEST ( seekTimestamp );
+  CPPUNIT_TEST ( noIndex );
+  CPPUNIT_TEST ( badQuery );
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::string          m_path;
+  std::vector<uint8_t> m_data;
+
+public:
+  void setUp() {
+    char name[] = "/tmp/eventindexXXXXXX";
+    int fd = mkstemp(name);
+    close(fd);
+    m_path = name;
+    m_data.clear();
+  }
+  void tearDown() {
+    unlink(m_path.c_str());
+    unlink(CEventIndex::indexFile(m_path).c_str());
+  }
+protected:
+  void entries();
+  void segments();
+  void find();
+  void seekEvent();
+  void seekTimestamp();
+  void noIndex();
+  void badQuery();
+
+private:
+  void addItem(uint32_t type, uint64_t timestamp, bool bodyHeader = true);
+  void makeRun(CEventIndexWriter* pIndex);
+  void writeFile();
+  CFileDataSource* source(std::string query);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CEventIndexTest );
+
+// Append an item with a uint32_t body holding the low bits of the timestamp
+// to m_data.
+
+void
+CEventIndexTest::addItem(uint32_t type, uint64_t timestamp, bool bodyHeader)
+{
+  size_t nBytes = sizeof(RingItemHeader) +
+    (bodyHeader ? sizeof(BodyHeader) : sizeof(uint32_t)) + sizeof(uint32_t);
+  std::vector<uint8_t> item(nBytes, 0);
+  pRingItem p = reinterpret_cast<pRingItem>(item.data());
+  p->s_header.s_size = nBytes;
+  p->s_header.s_type = type;
+  uint8_t* pBody;
+  if (bodyHeader) {
+    p->s_body.u_hasBodyHeader.s_bodyHeader.s_size      = sizeof(BodyHeader);
+    p->s_body.u_hasBodyHeader.s_bodyHeader.s_timestamp = timestamp;
+    pBody = p->s_body.u_hasBodyHeader.s_body;
+  } else {
+    p->s_body.u_noBodyHeader.s_empty = sizeof(uint32_t);
+    pBody = p->s_body.u_noBodyHeader.s_body;
+  }
+  uint32_t value = timestamp;
+  memcpy(pBody, &value, sizeof(value));
+  m_data.insert(m_data.end(), item.begin(), item.end());
+}
+// Begin run, 100 physics items with timestamps 1000, 1010... a pause and
+// resume in the middle and an end run.
+
+void
+CEventIndexTest::makeRun(CEventIndexWriter* pIndex)
+{
+  addItem(BEGIN_RUN, 0, false);
+  for (int i = 0; i < 100; i++) {
+    if (i == 55) {
+      addItem(PAUSE_RUN, 0, false);
+      addItem(RESUME_RUN, 0, false);
+    }
+    addItem(PHYSICS_EVENT, 1000 + 10*i);
+  }
+  addItem(END_RUN, 0, false);
+
+  if (pIndex) {
+    pIndex->open(m_path, 12, 0);
+    pIndex->addItems(m_data.data(), m_data.size());
+    pIndex->close();
+  }
+  writeFile();
+}
+
+void
+CEventIndexTest::writeFile()
+{
+  FILE* fp = fopen(m_path.c_str(), "w");
+  fwrite(m_data.data(), 1, m_data.size(), fp);
+  fclose(fp);
+}
+
+CFileDataSource*
+CEventIndexTest::source(std::string query)
+{
+  std::vector<uint16_t> empty;
+  std::string uri = "file://" + m_path + query;
+  return dynamic_cast<CFileDataSource*>(
+    CDataSourceFactory::makeSource(uri, empty, empty)
+  );
+}
+
+// There are entries for the first item, every interval items and
+// state changes.
+
+void CEventIndexTest::entries()
+{
+  CEventIndexWriter writer(10);
+  makeRun(&writer);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(104), writer.getItemCount());
+
+  CEventIndex index(CEventIndex::indexFile(m_path).c_str());
+  const EventIndexHeader& h(index.getHeader());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(10), h.s_interval);
+  CPPUNIT_ASSERT_EQUAL(uint32_t(12), h.s_runNumber);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(0), h.s_firstItem);
+
+  // items 0 (begin), 10, 20... 100, 56 (pause), 57 (resume), 103 (end).
+
+  const std::vector<EventIndexEntry>& e(index.getEntries());
+  CPPUNIT_ASSERT_EQUAL(size_t(14), e.size());
+  CPPUNIT_ASSERT_EQUAL(uint64_t(0), e[0].s_offset);
+  CPPUNIT_ASSERT_EQUAL(BEGIN_RUN, e[0].s_type);
+  CPPUNIT_ASSERT_EQUAL(CEventIndex::NullTimestamp, e[0].s_timestamp);
+
+  CPPUNIT_ASSERT_EQUAL(uint64_t(10), e[1].s_itemNumber);
+  CPPUNIT_ASSERT_EQUAL(PHYSICS_EVENT, e[1].s_type);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1090), e[1].s_timestamp);
+  const RingItem* p = reinterpret_cast<const RingItem*>(m_data.data() + e[1].s_offset);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1090), CEventIndex::itemTimestamp(p));
+  CPPUNIT_ASSERT_EQUAL(itemSize(p), e[1].s_size);
+
+  CPPUNIT_ASSERT_EQUAL(PAUSE_RUN, e[6].s_type);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(56), e[6].s_itemNumber);
+  CPPUNIT_ASSERT_EQUAL(RESUME_RUN, e[7].s_type);
+  CPPUNIT_ASSERT_EQUAL(END_RUN, e[13].s_type);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(103), e[13].s_itemNumber);
+}
+// Item numbers continue across segments, offsets do not.
+
+void CEventIndexTest::segments()
+{
+  makeRun(0);
+  CEventIndexWriter writer(10);
+  writer.open(m_path, 12, 0);
+  writer.addItems(m_data.data(), m_data.size());
+  writer.open(m_path, 12, 1);
+  writer.addItems(m_data.data(), m_data.size());
+  writer.close();
+
+  CEventIndex index(CEventIndex::indexFile(m_path).c_str());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(1), index.getHeader().s_segment);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(104), index.getHeader().s_firstItem);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(0), index.getEntries()[0].s_offset);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(104), index.getEntries()[0].s_itemNumber);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(114), index.getEntries()[1].s_itemNumber);
+
+  // A new run starts counting over.
+
+  writer.open(m_path, 13, 0);
+  writer.close();
+  CEventIndex next(CEventIndex::indexFile(m_path).c_str());
+  CPPUNIT_ASSERT_EQUAL(uint64_t(0), next.getHeader().s_firstItem);
+}
+// Lookups give the nearest entry at or before the target.
+
+void CEventIndexTest::find()
+{
+  CEventIndexWriter writer(10);
+  makeRun(&writer);
+  CEventIndex index(CEventIndex::indexFile(m_path).c_str());
+
+  CPPUNIT_ASSERT_EQUAL(uint64_t(30), index.findItem(35)->s_itemNumber);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(30), index.findItem(30)->s_itemNumber);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(57), index.findItem(59)->s_itemNumber);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(103), index.findItem(5000)->s_itemNumber);
+
+  CPPUNIT_ASSERT(!index.findTimestamp(500));
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1090), index.findTimestamp(1100)->s_timestamp);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1190), index.findTimestamp(1190)->s_timestamp);
+}
+// ?event= positions at an item.
+
+void CEventIndexTest::seekEvent()
+{
+  CEventIndexWriter writer(10);
+  makeRun(&writer);
+
+  std::unique_ptr<CFileDataSource> pSource(source("?event=35"));
+  std::unique_ptr<CRingItem> pItem(pSource->getItem());
+  CPPUNIT_ASSERT_EQUAL(PHYSICS_EVENT, pItem->type());
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1340), pItem->getEventTimestamp());
+
+  pSource->seekItem(56);
+  pItem.reset(pSource->getItem());
+  CPPUNIT_ASSERT_EQUAL(PAUSE_RUN, pItem->type());
+
+  pSource->seekItem(0);
+  pItem.reset(pSource->getItem());
+  CPPUNIT_ASSERT_EQUAL(BEGIN_RUN, pItem->type());
+
+  pSource->seekItem(104);
+  CPPUNIT_ASSERT(!pSource->getItem());
+}
+// ?seek=ts: positions at the first item at or after a timestamp.
+
+void CEventIndexTest::seekTimestamp()
+{
+  CEventIndexWriter writer(10);
+  makeRun(&writer);
+
+  std::unique_ptr<CFileDataSource> pSource(source("?seek=ts:1345"));
+  std::unique_ptr<CRingItem> pItem(pSource->getItem());
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1350), pItem->getEventTimestamp());
+
+  // Non-timestamped items before the target are skipped:
+
+  pSource->seekTimestamp(1550);
+  pItem.reset(pSource->getItem());
+  CPPUNIT_ASSERT_EQUAL(PHYSICS_EVENT, pItem->type());
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1550), pItem->getEventTimestamp());
+
+  pSource->seekTimestamp(0);
+  pItem.reset(pSource->getItem());
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1000), pItem->getEventTimestamp());
+
+  pSource->seekTimestamp(1000000);
+  CPPUNIT_ASSERT(!pSource->getItem());
+}
+// Without an index (or with a broken one) the file is just read from the start.
+
+void CEventIndexTest::noIndex()
+{
+  makeRun(0);
+  std::unique_ptr<CFileDataSource> pSource(source("?event=35&seek=ts:1500"));
+  std::unique_ptr<CRingItem> pItem(pSource->getItem());
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1500), pItem->getEventTimestamp());
+
+  FILE* fp = fopen(CEventIndex::indexFile(m_path).c_str(), "w");
+  fprintf(fp, "This is not an index\n");
+  fclose(fp);
+  CPPUNIT_ASSERT_THROW(
+    CEventIndex(CEventIndex::indexFile(m_path).c_str()), std::string
+  );
+  pSource.reset(source("?event=35"));
+  pItem.reset(pSource->getItem());
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1340), pItem->getEventTimestamp());
+}
+// Queries must be understood.
+
+void CEventIndexTest::badQuery()
+{
+  CEventIndexWriter writer(10);
+  makeRun(&writer);
+  CPPUNIT_ASSERT_THROW(source("?seek=ts:junk"), std::string);
+  CPPUNIT_ASSERT_THROW(source("?seek=12"), std::string);
+  CPPUNIT_ASSERT_THROW(source("?whatever"), std::string);
+
+  // Items in earlier segments can't be reached:
+
+  CEventIndexWriter segmented(10);
+  segmented.open(m_path, 12, 0);
+  segmented.addItems(m_data.data(), m_data.size());
+  segmented.open(m_path, 12, 1);
+  segmented.addItems(m_data.data(), m_data.size());
+  segmented.close();
+  CPPUNIT_ASSERT_THROW(source("?event=5"), CInvalidArgumentException);
+}
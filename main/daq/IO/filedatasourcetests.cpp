@@ -0,0 +1,244 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+// Tests for the block buffered CFileDataSource.
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <CFileDataSource.h>
+#include <CRingItem.h>
+#include <DataFormat.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+class CFileDataSourceTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE( CFileDataSourceTest );
+  CPPUNIT_TEST ( sequence );
+  CPPUNIT_TEST ( inPlace );
+  CPPUNIT_TEST ( exclude );
+  CPPUNIT_TEST ( bigItem );
+  CPPUNIT_TEST ( truncated );
+  CPPUNIT_TEST ( mixedRead );
+  CPPUNIT_TEST ( range );
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::string m_path;
+  int         m_fd;
+
+public:
+  void setUp() {
+    char name[] = "/tmp/filedatasourceXXXXXX";
+    m_fd   = mkstemp(name);
+    m_path = name;
+  }
+  void tearDown() {
+    close(m_fd);
+    unlink(m_path.c_str());
+  }
+protected:
+  void sequence();
+  void inPlace();
+  void exclude();
+  void bigItem();
+  void truncated();
+  void mixedRead();
+  void range();
+
+private:
+  void writeItem(uint32_t type, uint32_t nBodyBytes, uint8_t fill);
+  CFileDataSource* source(std::vector<uint16_t> exclude = std::vector<uint16_t>());
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CFileDataSourceTest );
+
+// Write an item with no body header whose body is nBodyBytes of fill.
+
+void
+CFileDataSourceTest::writeItem(uint32_t type, uint32_t nBodyBytes, uint8_t fill)
+{
+  std::vector<uint8_t> item(sizeof(RingItemHeader) + sizeof(uint32_t) + nBodyBytes, fill);
+  pRingItem p = reinterpret_cast<pRingItem>(item.data());
+  p->s_header.s_size = item.size();
+  p->s_header.s_type = type;
+  p->s_body.u_noBodyHeader.s_empty = sizeof(uint32_t);
+  write(m_fd, item.data(), item.size());
+}
+// Open a source on the file from its start.
+
+CFileDataSource*
+CFileDataSourceTest::source(std::vector<uint16_t> exclude)
+{
+  int fd = open(m_path.c_str(), O_RDONLY);
+  return new CFileDataSource(fd, exclude);
+}
+
+// getItem returns the items in order then NULL.
+
+void CFileDataSourceTest::sequence()
+{
+  for (int i = 0; i < 100; i++) {
+    writeItem(PHYSICS_EVENT, i, i);
+  }
+  CFileDataSource* pSource = source();
+  for (int i = 0; i < 100; i++) {
+    CRingItem* pItem = pSource->getItem();
+    CPPUNIT_ASSERT(pItem);
+    CPPUNIT_ASSERT_EQUAL(PHYSICS_EVENT, pItem->type());
+    CPPUNIT_ASSERT_EQUAL(
+      uint32_t(sizeof(RingItemHeader) + sizeof(uint32_t) + i), pItem->size()
+    );
+    if (i) {
+      uint8_t* pBody = reinterpret_cast<uint8_t*>(pItem->getBodyPointer());
+      CPPUNIT_ASSERT_EQUAL(uint8_t(i), pBody[i-1]);
+    }
+    delete pItem;
+  }
+  CPPUNIT_ASSERT(!pSource->getItem());
+  delete pSource;
+}
+// getItemPointer gives the same items in place.
+
+void CFileDataSourceTest::inPlace()
+{
+  writeItem(BEGIN_RUN, 10, 1);
+  writeItem(PHYSICS_EVENT, 20, 2);
+
+  CFileDataSource* pSource = source();
+  const RingItem* p = pSource->getItemPointer();
+  CPPUNIT_ASSERT(p);
+  CPPUNIT_ASSERT_EQUAL(uint16_t(BEGIN_RUN), itemType(p));
+  CPPUNIT_ASSERT_EQUAL(uint32_t(sizeof(RingItemHeader) + 14), itemSize(p));
+
+  p = pSource->getItemPointer();
+  CPPUNIT_ASSERT(p);
+  CPPUNIT_ASSERT_EQUAL(uint16_t(PHYSICS_EVENT), itemType(p));
+  CPPUNIT_ASSERT_EQUAL(uint8_t(2), p->s_body.u_noBodyHeader.s_body[19]);
+
+  CPPUNIT_ASSERT(!pSource->getItemPointer());
+  delete pSource;
+}
+// Excluded types are skipped.
+
+void CFileDataSourceTest::exclude()
+{
+  writeItem(BEGIN_RUN, 0, 0);
+  writeItem(PHYSICS_EVENT, 4, 0);
+  writeItem(END_RUN, 0, 0);
+
+  std::vector<uint16_t> excluded;
+  excluded.push_back(PHYSICS_EVENT);
+  CFileDataSource* pSource = source(excluded);
+
+  CPPUNIT_ASSERT_EQUAL(uint16_t(BEGIN_RUN), itemType(pSource->getItemPointer()));
+  CPPUNIT_ASSERT_EQUAL(uint16_t(END_RUN), itemType(pSource->getItemPointer()));
+  CPPUNIT_ASSERT(!pSource->getItemPointer());
+  delete pSource;
+}
+// Items bigger than the block size and items that straddle blocks come
+// back intact.
+
+void CFileDataSourceTest::bigItem()
+{
+  uint32_t big = 3*1024*1024;
+  for (int i = 0; i < 50; i++) {
+    writeItem(PHYSICS_EVENT, 100000, i);
+  }
+  writeItem(PHYSICS_EVENT, big, 0xaa);
+  writeItem(END_RUN, 0, 0);
+
+  CFileDataSource* pSource = source();
+  for (int i = 0; i < 50; i++) {
+    const RingItem* p = pSource->getItemPointer();
+    CPPUNIT_ASSERT(p);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(i), p->s_body.u_noBodyHeader.s_body[0]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(i), p->s_body.u_noBodyHeader.s_body[99999]);
+  }
+  CRingItem* pItem = pSource->getItem();
+  CPPUNIT_ASSERT(pItem);
+  CPPUNIT_ASSERT_EQUAL(uint32_t(sizeof(RingItemHeader) + sizeof(uint32_t) + big),
+		       pItem->size());
+  uint8_t* pBody = reinterpret_cast<uint8_t*>(pItem->getBodyPointer());
+  CPPUNIT_ASSERT_EQUAL(uint8_t(0xaa), pBody[big-1]);
+  delete pItem;
+
+  CPPUNIT_ASSERT_EQUAL(uint16_t(END_RUN), itemType(pSource->getItemPointer()));
+  delete pSource;
+}
+// A partial item at the end of the file is treated as the end of file.
+
+void CFileDataSourceTest::truncated()
+{
+  writeItem(PHYSICS_EVENT, 10, 0);
+  uint32_t partial[2] = {1000, PHYSICS_EVENT};
+  write(m_fd, partial, sizeof(partial));
+
+  CFileDataSource* pSource = source();
+  CPPUNIT_ASSERT(pSource->getItemPointer());
+  CPPUNIT_ASSERT(!pSource->getItemPointer());
+  delete pSource;
+}
+// read() takes buffered data first.
+
+void CFileDataSourceTest::mixedRead()
+{
+  writeItem(BEGIN_RUN, 0, 0);
+  uint32_t words[4] = {1, 2, 3, 4};
+  write(m_fd, words, sizeof(words));
+
+  CFileDataSource* pSource = source();
+  CPPUNIT_ASSERT(pSource->getItemPointer());
+
+  uint32_t data[4];
+  pSource->read(reinterpret_cast<char*>(data), sizeof(data));
+  CPPUNIT_ASSERT(!pSource->eof());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(1), data[0]);
+  CPPUNIT_ASSERT_EQUAL(uint32_t(4), data[3]);
+
+  pSource->read(reinterpret_cast<char*>(data), sizeof(uint32_t));
+  CPPUNIT_ASSERT(pSource->eof());
+  delete pSource;
+}
+// A range gives just its items and offsets are tracked.
+
+void CFileDataSourceTest::range()
+{
+  for (int i = 0; i < 10; i++) {
+    writeItem(PHYSICS_EVENT, 8, i);      // 20 byte items.
+  }
+  CFileDataSource* pSource = source();
+  pSource->setRange(60, 120);
+  CPPUNIT_ASSERT_EQUAL(uint64_t(60), pSource->getOffset());
+  for (int i = 3; i < 6; i++) {
+    const RingItem* p = pSource->getItemPointer();
+    CPPUNIT_ASSERT(p);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(i), p->s_body.u_noBodyHeader.s_body[0]);
+  }
+  CPPUNIT_ASSERT_EQUAL(uint64_t(120), pSource->getOffset());
+  CPPUNIT_ASSERT(!pSource->getItemPointer());
+
+  // A range that doesn't end on an item boundary is an error:
+
+  pSource->setRange(0, 50);
+  CPPUNIT_ASSERT(pSource->getItemPointer());
+  CPPUNIT_ASSERT(pSource->getItemPointer());
+  CPPUNIT_ASSERT_THROW(pSource->getItemPointer(), std::string);
+  delete pSource;
+}
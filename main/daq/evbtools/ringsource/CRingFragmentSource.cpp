@@ -33,8 +33,9 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
-static const size_t FRAG_RESIZE_AMOUNT(1024);   // Number of frags to add on resize
+static const size_t FRAG_RESIZE_AMOUNT(1024);   // Minimum number of frags to add on resize
 
 /**
  * constructor:
@@ -68,8 +69,11 @@ CRingFragmentSource::CRingFragmentSource(
     m_endsExpected(endRunsExpected), m_endsSeen(0),
     m_endRunTimeout(endTimeoutSeconds),
     m_timestampOffset(timestampOffset), m_nDefaultSid(defaultId),
-    m_nFragments(0), m_pFragments(nullptr), m_endRunTime(0)
+    m_nFragments(0), m_pFragments(nullptr), m_endRunTime(0),
+    m_statsInterval(0), m_lastReportTime(0)
 {
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_lastReportStats = m_stats;
     setValidIds(validIds);
     setTsExtractor(tsExtractorLib);
 }
@@ -90,8 +94,63 @@ CRingFragmentSource::operator()()
 {
     CRingBufferChunkAccess accessor(&m_dataSource);
     size_t chunkSize = accessor.m_nRingBufferBytes/4;  // go for 1/4'th the buffer.
-    while (processSegment(accessor, chunkSize) && !(timedOut()))
-        ;
+    m_lastReportTime = now();
+    while (processSegment(accessor, chunkSize) && !(timedOut())) {
+        if (m_statsInterval && ((now() - m_lastReportTime) >= m_statsInterval)) {
+            reportStatistics(std::cerr);
+        }
+    }
+}
+/**
+ * getStatistics
+ *   @return const ChunkStatistics& - the chunk statistics so far.
+ */
+const CRingFragmentSource::ChunkStatistics&
+CRingFragmentSource::getStatistics() const
+{
+    return m_stats;
+}
+/**
+ * setStatisticsInterval
+ *    Sets how often operator() reports the statistics.  Reports are made
+ *    as chunks are processed, so none are made while there's no data.
+ *
+ *  @param seconds - seconds between reports; 0 turns reporting off.
+ */
+void
+CRingFragmentSource::setStatisticsInterval(int seconds)
+{
+    m_statsInterval = seconds;
+}
+/**
+ * reportStatistics
+ *    Writes a line with the totals, the item and byte rates since the last
+ *    report and the rates for the most recent chunk.
+ *
+ *  @param out - stream to which the report is written.
+ */
+void
+CRingFragmentSource::reportStatistics(std::ostream& out)
+{
+    double t       = now();
+    double elapsed = t - m_lastReportTime;
+    double items   = m_stats.s_items - m_lastReportStats.s_items;
+    double bytes   = m_stats.s_bytes - m_lastReportStats.s_bytes;
+    
+    out << "ringFragmentSource: " << m_stats.s_chunks << " chunks "
+        << m_stats.s_items << " items " << m_stats.s_bytes << " bytes";
+    if (elapsed > 0) {
+        out << " : " << items/elapsed << " items/s " << bytes/elapsed << " bytes/s";
+    }
+    if (m_stats.s_lastSeconds > 0) {
+        out << " : last chunk " << m_stats.s_lastItems/m_stats.s_lastSeconds
+            << " items/s " << m_stats.s_lastBytes/m_stats.s_lastSeconds
+            << " bytes/s";
+    }
+    out << std::endl;
+    
+    m_lastReportTime  = t;
+    m_lastReportStats = m_stats;
 }
 //////////////////////////////////////////////////////////////////////
 // Private methods.
@@ -194,6 +253,8 @@ CRingFragmentSource::processSegment(CRingBufferChunkAccess& a, size_t chunkSize)
 bool
 CRingFragmentSource::sendChunk(CRingBufferChunkAccess::Chunk& c)
 {
+    double start = now();
+    
     // Create the fragment headers and count the end runs.
     
     std::pair<size_t, EVB::pFragment> frags = makeFragments(c);
@@ -202,6 +263,7 @@ CRingFragmentSource::sendChunk(CRingBufferChunkAccess::Chunk& c)
     
     if (frags.first > 0) {
         m_client.submitFragments(frags.first, frags.second);
+        updateStatistics(frags.first, c.size(), now() - start);
     }
     
     // Figure out if we should continue processing or not.
@@ -215,12 +277,14 @@ CRingFragmentSource::sendChunk(CRingBufferChunkAccess::Chunk& c)
 }
 /**
  * resizeFragments
- *   Adds storage to the fragment array.
+ *   Adds storage to the fragment array.  It's at least doubled so the
+ *   array quickly grows to hold the largest chunk and is then just reused.
  */
 void
 CRingFragmentSource::resizeFragments()
 {
-    m_nFragments += FRAG_RESIZE_AMOUNT;
+    m_nFragments += (m_nFragments > FRAG_RESIZE_AMOUNT) ?
+        m_nFragments : FRAG_RESIZE_AMOUNT;
     m_pFragments = static_cast<EVB::pFragment>(
         realloc(m_pFragments, m_nFragments * sizeof(EVB::Fragment))
     );
@@ -300,11 +364,57 @@ CRingFragmentSource::barrierType(RingItem& item)
     return result;
 }
 
+/**
+ * describeItem
+ *    Sets the fragment that describes an arbitrary ring item: the body
+ *    header if it has one, otherwise the default source id, the user's
+ *    timestamp extractor and the barrier type implied by the item type.
+ *    End runs are counted.
+ *
+ * @param n    - index of the fragment.
+ * @param item - the ring item.
+ */
+void
+CRingFragmentSource::describeItem(int n, RingItem& item)
+{
+    if (!hasBodyHeader(&item)) {
+        setFragment(
+            n, getTimestampFromUserCode(item),
+            m_nDefaultSid,
+            item.s_header.s_size, barrierType(item), &item
+            
+        );
+    } else {
+        pBodyHeader pB =
+            reinterpret_cast<pBodyHeader>(bodyHeader(&item));
+        setFragment(
+            n,
+            pB->s_timestamp + m_timestampOffset,
+            pB->s_sourceId,
+            itemSize(&item),
+            pB->s_barrier,
+            &item
+        );
+    }
+    
+    if (itemType(&item) == END_RUN) countEndRun();
+}
+/**
+ * countEndRun
+ *    Count an end run and when it happened for one-shot and timeout
+ */
+void
+CRingFragmentSource::countEndRun()
+{
+    m_endRunTime = time(nullptr);
+    m_endsSeen++;
+}
 /**
  *
  *  makeFragments
  *     Given a chunk, creates the array of EVB::Fragment-s that describe
- *     that chunk.
+ *     that chunk.  Unless there's a user timestamp extractor, which must
+ *     see each item, the body header fast path is used.
  *
  * @param c - the chunk to process.
  * @return std::pair<size_t, EVB::pFragment> - first is number of fragments,
@@ -313,39 +423,54 @@ CRingFragmentSource::barrierType(RingItem& item)
 std::pair<size_t, EVB::pFragment>
 CRingFragmentSource::makeFragments(CRingBufferChunkAccess::Chunk& c)
 {
+    if (!m_tsExtractor) return makeBodyHeaderFragments(c);
+    
     int n = 0;
     for (auto p = c.begin(); !(p == c.end()); p++) {
         RingItemHeader& header(*p);
         RingItem&       item(reinterpret_cast<RingItem&>(header));
         
+        describeItem(n, item);
+        n++;
+    }
+    return {n, m_pFragments};
+}
+/**
+ * makeBodyHeaderFragments
+ *    Describes a chunk in one pass over its storage taking the fragment
+ *    headers straight from the body headers of native byte order items.
+ *    Anything else (no body header, byte swapped) is given to describeItem.
+ *
+ * @param c - the chunk to process.
+ * @return std::pair<size_t, EVB::pFragment> - as for makeFragments.
+ */
+std::pair<size_t, EVB::pFragment>
+CRingFragmentSource::makeBodyHeaderFragments(CRingBufferChunkAccess::Chunk& c)
+{
+    uint8_t* p    = static_cast<uint8_t*>(c.getStorage());
+    uint8_t* pEnd = p + c.size();
+    size_t   n    = 0;
+    
+    while (p < pEnd) {
+        pRingItem pItem = reinterpret_cast<pRingItem>(p);
+        uint32_t  type  = pItem->s_header.s_type;
         
-        if (!hasBodyHeader(&item)) {
-            setFragment(
-                n, getTimestampFromUserCode(item),
-                m_nDefaultSid,
-                item.s_header.s_size, barrierType(item), &item
-                
-            );
-        } else {
-            pBodyHeader pB =
-                reinterpret_cast<pBodyHeader>(bodyHeader(&item));
-            setFragment(
-                n,
-                pB->s_timestamp + m_timestampOffset,
-                pB->s_sourceId,
-                itemSize(&item),
-                pB->s_barrier,
-                &item
-            );
-        }
-        
-        // Count end runs and when they happened for one-shot and timeout
+        if (n >= m_nFragments) resizeFragments();
+        EVB::pFragment f = m_pFragments + n;
         
-        if (itemType(&item) == END_RUN) {
-            m_endRunTime = time_t(nullptr);
-            m_endsSeen++;
+        if (((type & 0xffff0000) == 0) &&            // Native byte order and...
+            (pItem->s_body.u_noBodyHeader.s_empty > sizeof(uint32_t))) { // body header.
+            pBodyHeader pB = &(pItem->s_body.u_hasBodyHeader.s_bodyHeader);
+            f->s_header.s_timestamp = pB->s_timestamp + m_timestampOffset;
+            f->s_header.s_sourceId  = pB->s_sourceId;
+            f->s_header.s_size      = pItem->s_header.s_size;
+            f->s_header.s_barrier   = pB->s_barrier;
+            f->s_pBody              = pItem;
+            if (type == END_RUN) countEndRun();
+        } else {
+            describeItem(n, *pItem);
         }
-        
+        p += f->s_header.s_size;
         n++;
     }
     return {n, m_pFragments};
@@ -372,6 +497,36 @@ CRingFragmentSource::timedOut()
         
     return false;
 }
+/**
+ * updateStatistics
+ *    Account for a chunk that's been submitted.
+ *
+ * @param items   - fragments in the chunk.
+ * @param bytes   - bytes in the chunk.
+ * @param seconds - time taken to describe and submit it.
+ */
+void
+CRingFragmentSource::updateStatistics(size_t items, size_t bytes, double seconds)
+{
+    m_stats.s_chunks++;
+    m_stats.s_items      += items;
+    m_stats.s_bytes      += bytes;
+    m_stats.s_seconds    += seconds;
+    m_stats.s_lastItems   = items;
+    m_stats.s_lastBytes   = bytes;
+    m_stats.s_lastSeconds = seconds;
+}
+/**
+ * now
+ *   @return double - seconds on the monotonic clock.
+ */
+double
+CRingFragmentSource::now()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec/1.0e9;
+}
 /**
  * throwIfNotExpectingBodyHeaders
  *    Outputs an error to cerr and throws it as a string
@@ -27,6 +27,7 @@
 #include <CRingBufferChunkAccess.h>
 #include <fragment.h>
 #include <time.h>
+#include <iosfwd>
 
 class CEventOrderClient;
 class CRingBuffer;
@@ -40,6 +41,19 @@ class CRingFragmentSource
 {
 public:
     typedef uint64_t  (*timestampExtractor)(pPhysicsEventItem);
+    
+    // Statistics kept as chunks are described and submitted.  Times
+    // are the seconds spent doing that (including waiting for the event builder).
+    
+    typedef struct _ChunkStatistics {
+        uint64_t s_chunks;
+        uint64_t s_items;
+        uint64_t s_bytes;
+        double   s_seconds;
+        uint64_t s_lastItems;          // Most recent chunk.
+        uint64_t s_lastBytes;
+        double   s_lastSeconds;
+    } ChunkStatistics, *pChunkStatistics;
 private:
     CEventOrderClient& m_client;
     CRingBuffer&       m_dataSource;
@@ -57,6 +71,11 @@ private:
     
     time_t             m_endRunTime;  // Most recent end run time.
     
+    ChunkStatistics    m_stats;
+    int                m_statsInterval;     // Seconds between reports (0 - none).
+    double             m_lastReportTime;
+    ChunkStatistics    m_lastReportStats;
+    
 public:
     CRingFragmentSource(
         CEventOrderClient& client, CRingBuffer& dataSource, std::list<int> validIds,
@@ -66,6 +85,10 @@ public:
     virtual ~CRingFragmentSource();
     
     void operator()();
+    
+    const ChunkStatistics& getStatistics() const;
+    void setStatisticsInterval(int seconds);
+    void reportStatistics(std::ostream& out);
 
     // private utilties
 private:
@@ -80,9 +103,16 @@ private:
     );
     uint64_t getTimestampFromUserCode(RingItem& item);
     uint32_t barrierType(RingItem& item);
+    void     describeItem(int n, RingItem& item);
+    void     countEndRun();
     
     std::pair<size_t, EVB::pFragment> makeFragments(CRingBufferChunkAccess::Chunk& c);
+    std::pair<size_t, EVB::pFragment> makeBodyHeaderFragments(
+        CRingBufferChunkAccess::Chunk& c
+    );
     bool timedOut();
+    void updateStatistics(size_t items, size_t bytes, double seconds);
+    static double now();
     void throwIfNotExpectingBodyHeaders(const char* msg);
 };
 
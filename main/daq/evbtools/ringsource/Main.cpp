@@ -80,6 +80,7 @@ main(int argc, char** argv)
         exit(EXIT_FAILURE);
     }
     CEventOrderClient client(evbHost, port);
+    client.setWindow(args.window_arg);   // Older event builders give us 1.
     try {
         client.Connect(info, ids);
     }
@@ -107,6 +108,7 @@ main(int argc, char** argv)
         ids, args.timestampextractor_arg, args.expectbodyheaders_flag,
         args.oneshot_arg, args.timeout_arg, args.offset_arg, args.default_id_arg
     );
+    source.setStatisticsInterval(args.stats_arg);
     source();
     
     client.disconnect();
@@ -63,6 +63,11 @@ class fragsrctest : public CppUnit::TestFixture {
   
   CPPUNIT_TEST(sendchunk_1);
   CPPUNIT_TEST(sendchunk_2);
+  
+  CPPUNIT_TEST(fast_1);
+  CPPUNIT_TEST(fast_2);
+  CPPUNIT_TEST(extractor_1);
+  CPPUNIT_TEST(stats_1);
   CPPUNIT_TEST_SUITE_END();
 
 
@@ -106,6 +111,26 @@ protected:
   
   void sendchunk_1();
   void sendchunk_2();
+  
+  void fast_1();
+  void fast_2();
+  void extractor_1();
+  void stats_1();
+private:
+  // Concatenate ring items into chunk storage (caller deletes []).
+  
+  uint8_t* makeChunk(std::vector<CRingItem*>& items, size_t& nBytes) {
+    nBytes = 0;
+    for (auto p : items) nBytes += itemSize(p->getItemPointer());
+    uint8_t* pResult = new uint8_t[nBytes];
+    uint8_t* pDest   = pResult;
+    for (auto p : items) {
+      pRingItem pi = p->getItemPointer();
+      memcpy(pDest, pi, itemSize(pi));
+      pDest += itemSize(pi);
+    }
+    return pResult;
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(fragsrctest);
@@ -401,4 +426,107 @@ void fragsrctest::sendchunk_2()
   }
   free(pChunkStorage);
   
-}
\ No newline at end of file
+}
+
+// The body header fast path handles items without body headers and
+// counts end runs.
+
+void fragsrctest::fast_1()
+{
+  std::vector<CRingItem*> items = {
+    new CRingItem(PHYSICS_EVENT, 0x1234, 2, 0),
+    new CRingItem(PHYSICS_EVENT),                 // No body header.
+    new CRingItem(END_RUN, 0x5678, 1, 2)
+  };
+  size_t   nBytes;
+  uint8_t* pChunk = makeChunk(items, nBytes);
+  CRingBufferChunkAccess::Chunk c;
+  c.setChunk(nBytes, pChunk);
+  
+  auto result = m_pTestObj->makeFragments(c);
+  EQ(size_t(3), result.first);
+  EVB::pFragment f = result.second;
+  
+  EQ(uint64_t(0x1234), f[0].s_header.s_timestamp);
+  EQ(uint32_t(2),      f[0].s_header.s_sourceId);
+  EQ(uint32_t(0),      f[0].s_header.s_barrier);
+  EQ((void*)pChunk,    f[0].s_pBody);
+  
+  EQ(NULL_TIMESTAMP,   f[1].s_header.s_timestamp);
+  EQ(uint32_t(1),      f[1].s_header.s_sourceId);   // default id.
+  EQ(itemSize(items[1]->getItemPointer()), f[1].s_header.s_size);
+  
+  EQ(uint64_t(0x5678), f[2].s_header.s_timestamp);
+  EQ(uint32_t(2),      f[2].s_header.s_barrier);
+  EQ((void*)(pChunk + nBytes - itemSize(items[2]->getItemPointer())), f[2].s_pBody);
+  
+  EQ(1, m_pTestObj->m_endsSeen);
+  ASSERT((time(nullptr) - m_pTestObj->m_endRunTime) < 2);
+  
+  for (auto p : items) delete p;
+  delete []pChunk;
+}
+// The descriptor array is reused from chunk to chunk.
+
+void fragsrctest::fast_2()
+{
+  std::vector<CRingItem*> items = {new CRingItem(PHYSICS_EVENT, 1, 2, 0)};
+  size_t   nBytes;
+  uint8_t* pChunk = makeChunk(items, nBytes);
+  CRingBufferChunkAccess::Chunk c;
+  c.setChunk(nBytes, pChunk);
+  
+  EVB::pFragment first = m_pTestObj->makeFragments(c).second;
+  EVB::pFragment second = m_pTestObj->makeFragments(c).second;
+  EQ(first, second);
+  
+  for (auto p : items) delete p;
+  delete []pChunk;
+}
+// With a timestamp extractor, it's used for items without body headers.
+
+void fragsrctest::extractor_1()
+{
+  m_pTestObj->m_tsExtractor = fakeExtractor;
+  std::vector<CRingItem*> items = {
+    new CRingItem(PHYSICS_EVENT), new CRingItem(PHYSICS_EVENT, 0x1234, 2, 0)
+  };
+  size_t   nBytes;
+  uint8_t* pChunk = makeChunk(items, nBytes);
+  CRingBufferChunkAccess::Chunk c;
+  c.setChunk(nBytes, pChunk);
+  
+  auto result = m_pTestObj->makeFragments(c);
+  EQ(size_t(2), result.first);
+  EQ(uint64_t(0x123456789abcdef), result.second[0].s_header.s_timestamp);
+  EQ(uint64_t(0x1234), result.second[1].s_header.s_timestamp);
+  
+  for (auto p : items) delete p;
+  delete []pChunk;
+}
+// Submitted chunks are counted in the statistics.
+
+void fragsrctest::stats_1()
+{
+  std::vector<CRingItem*> items = {
+    new CRingItem(PHYSICS_EVENT, 1, 2, 0), new CRingItem(PHYSICS_EVENT, 2, 2, 0)
+  };
+  size_t   nBytes;
+  uint8_t* pChunk = makeChunk(items, nBytes);
+  CRingBufferChunkAccess::Chunk c;
+  c.setChunk(nBytes, pChunk);
+  
+  m_pTestObj->sendChunk(c);
+  m_pTestObj->sendChunk(c);
+  
+  const CRingFragmentSource::ChunkStatistics& stats = m_pTestObj->getStatistics();
+  EQ(uint64_t(2), stats.s_chunks);
+  EQ(uint64_t(4), stats.s_items);
+  EQ(uint64_t(2*nBytes), stats.s_bytes);
+  EQ(uint64_t(2), stats.s_lastItems);
+  EQ(uint64_t(nBytes), stats.s_lastBytes);
+  ASSERT(stats.s_seconds >= stats.s_lastSeconds);
+  
+  for (auto p : items) delete p;
+  delete []pChunk;
+}
@@ -150,6 +150,32 @@ CConfigure::Set(CTCLInterpreter& interp, std::string name, CTCLObject& value)
     }
     pHandler->setBuildWindow(static_cast<time_t>(window));
     
+  } else if (name == "windowms") {
+
+    // Same as window but in milliseconds:
+
+    int window = value;
+    if (window <= 0) {
+      std::string errorMsg = "Build time window must be > 0 was ";
+      errorMsg += static_cast<std::string>(value);
+
+      throw errorMsg;
+    }
+    pHandler->setBuildWindowMs(static_cast<time_t>(window));
+
+  } else if (name == "flushms") {
+
+    // Longest time between idle flushes, also must be > 0:
+
+    int interval = value;
+    if (interval <= 0) {
+      std::string errorMsg = "Flush interval must be > 0 was ";
+      errorMsg += static_cast<std::string>(value);
+
+      throw errorMsg;
+    }
+    pHandler->setFlushInterval(static_cast<time_t>(interval));
+
   } else if (name == "XoffThreshold") {
     
     int size = value;
@@ -197,17 +223,22 @@ CConfigure::Get(CTCLInterpreter& interp, std::string name)
 
   // dispatch according to the parameter name:
 
+  time_t value;
   if (name =="window") {
-    time_t value = pHandler->getBuildWindow();
-    CTCLObject oValue;
-    oValue.Bind(interp);
-    oValue = static_cast<int>(value);
-    interp.setResult(oValue);
+    value = pHandler->getBuildWindow();
+  } else if (name == "windowms") {
+    value = pHandler->getBuildWindowMs();
+  } else if (name == "flushms") {
+    value = pHandler->getFlushInterval();
   } else {
     std::string errorMsg = "Illegal configuration parameter: ";
     errorMsg += name;
     throw name;
   }
+  CTCLObject oValue;
+  oValue.Bind(interp);
+  oValue = static_cast<int>(value);
+  interp.setResult(oValue);
 
   return TCL_OK;
 }
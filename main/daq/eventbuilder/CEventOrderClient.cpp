@@ -49,7 +49,10 @@ CEventOrderClient::CEventOrderClient(std::string host, uint16_t port) :
   m_pConnection(0),
   m_fConnected(false),
   m_nIovecSize(0),
-  m_pIovec(nullptr)
+  m_pIovec(nullptr),
+  m_nRequestedWindow(1),
+  m_nWindow(1),
+  m_nCredits(0)
 {
    m_nIovecMaxSize = sysconf(_SC_IOV_MAX);   // Maximum number of iovs for write.
    if ( m_nIovecMaxSize == -1) {
@@ -128,6 +131,7 @@ CEventOrderClient::Connect(std::string description, std::list<int> sources)
   uint8_t* connectionBody(0);
   sprintf(portNumber, "%u", m_port);
   m_pConnection = new CSocket();
+  m_replies.clear();
 
   try {
     m_pConnection->Connect(m_host, std::string(portNumber));
@@ -149,7 +153,11 @@ CEventOrderClient::Connect(std::string description, std::list<int> sources)
     
     // Figure out the total body size, allocate it, fill in hdr.s_bodySize:
     
-    uint32_t bodySize = EVB_MAX_DESCRIPTION + (sources.size() + 1)*sizeof(uint32_t);
+    uint32_t sidsSize = EVB_MAX_DESCRIPTION + (sources.size() + 1)*sizeof(uint32_t);
+    uint32_t bodySize = sidsSize;
+    if (m_nRequestedWindow > 1) {
+      bodySize += sizeof(EVB::ConnectTrailer);
+    }
     EVB::pConnectBody pBody = static_cast<EVB::pConnectBody>(malloc(bodySize));
     if (!pBody) {
       throw CErrnoException("Unable to allocated connect msg body");
@@ -163,6 +171,10 @@ CEventOrderClient::Connect(std::string description, std::list<int> sources)
       pBody->s_sids[i] = *p;
       i++;
     }
+    if (m_nRequestedWindow > 1) {
+      EVB::ConnectTrailer trailer = {EVB::PROTOCOL_WINDOWED, m_nRequestedWindow};
+      memcpy(reinterpret_cast<uint8_t*>(pBody) + sidsSize, &trailer, sizeof(trailer));
+    }
     // We'll need to I/O vectors, one for the header, one for the body:
     
     iovec d[2];
@@ -172,8 +184,21 @@ CEventOrderClient::Connect(std::string description, std::list<int> sources)
     d[1].iov_base = pBody;
     d[1].iov_len  = bodySize;
     
-    message(2, d);          // Send and process reply.
+    send(2, d);
     free(pBody);
+
+    // An old server (or one that won't window) just says OK:
+
+    std::string reply = getReplyString();
+    unsigned    window;
+    if (reply == "OK") {
+      m_nWindow = 1;
+    } else if ((sscanf(reply.c_str(), "OK WINDOW %u", &window) == 1) && window) {
+      m_nWindow = window;
+    } else {
+      throw reply;
+    }
+    m_nCredits = m_nWindow;
   }
   catch (CTCPConnectionFailed& e) {
     errno = ECONNREFUSED;
@@ -208,7 +233,19 @@ CEventOrderClient::disconnect()
     iovec d;
     d.iov_base = &hdr;
     d.iov_len  = sizeof(EVB::ClientMessageHeader);
-    message(1, &d);
+    if (m_nWindow > 1) {
+      // Credits for messages still in flight may precede the OK:
+
+      send(1, &d);
+      std::string reply;
+      while ((reply = getReplyString()).compare(0, 7, "CREDIT ") == 0)
+        ;
+      if (reply != "OK") {
+        throw reply;
+      }
+    } else {
+      message(1, &d);
+    }
   }
   catch (...) {
     delete m_pConnection;
@@ -222,6 +259,31 @@ CEventOrderClient::disconnect()
 
   m_fConnected = false;
 }
+/**
+ * setWindow
+ *    Set the number of FRAGMENTS messages we'd like to have in flight
+ *    (sent but not yet credited by the server).  This must be called
+ *    before Connect to have any effect.  A window of 1 (the default)
+ *    uses the original protocol in which each message is acknowledged
+ *    before the next is sent.  The server may grant a smaller window.
+ *
+ * @param nMessages - the window size requested.
+ */
+void
+CEventOrderClient::setWindow(unsigned nMessages)
+{
+  m_nRequestedWindow = nMessages ? nMessages : 1;
+}
+/**
+ * getWindow
+ * @return unsigned - the window granted by the server at connect time.
+ *                    1 means lock step acknowledgement.
+ */
+unsigned
+CEventOrderClient::getWindow() const
+{
+  return m_nWindow;
+}
 /**
  * Submits a chain of fragments.  (FragmentChain).  The chain is marshalled into 
  * a body buffer, and submitted to the event builder.
@@ -236,36 +298,19 @@ void
 CEventOrderClient::submitFragments(EVB::pFragmentChain pChain)
 {
   if (m_fConnected) {
-    iovec* pDescription(nullptr);
     EVB::ClientMessageHeader hdr;
     hdr.s_msgType = EVB::FRAGMENTS;
     
     size_t bodyBytes = bytesInChain(pChain);
     hdr.s_bodySize = bodyBytes;
     size_t nIovsInChain = iovecsInChain(pChain);
-    pDescription = static_cast<iovec*>(malloc((nIovsInChain+1)*sizeof(iovec)));
+    iovec* pDescription = getIovecs(nIovsInChain+1);
     
     pDescription[0].iov_base = &hdr;
     pDescription[0].iov_len = sizeof(EVB::ClientMessageHeader);
 
     fillFragmentDescriptors(pDescription+1, pChain);
-    
-
-    try {
-
-
-      // The -1 below is because we don't relay the null terminator on the strings.
-
-      message(nIovsInChain+1, pDescription);
-      free(pDescription);
-    
-    }
-    catch (...) {
-      free(pDescription);
-      throw;
-    }
-    // get the reply and hope it's what we expect.
-
+    sendFragmentMessage(nIovsInChain+1, pDescription);
     
   } else {
     errno = ENOTCONN;		// Not connected.
@@ -275,9 +320,10 @@ CEventOrderClient::submitFragments(EVB::pFragmentChain pChain)
 
 /**
  * Given a pointer to an array of fragments, and the number of fragments,
- * submits them to the event builder.  This is done copy free and amortized
- * dynamic memory free by building a set of I/O vectors
- * for the writev method.  
+ * submits them to the event builder.  This is done copy free and, since
+ * the I/O vectors for writev are built directly from the array into
+ * storage we keep between calls, without dynamic memory management once
+ * that storage is big enough.
  *
  * @param nFragments - Number of fragments in the array.
  * @param ppFragments - Pointer to the first fragment in the array.
@@ -285,28 +331,26 @@ CEventOrderClient::submitFragments(EVB::pFragmentChain pChain)
 void
 CEventOrderClient::submitFragments(size_t nFragments, EVB::pFragment ppFragments)
 {
-  // Just make a fragment chain out of the fragments and use the previous
-  // method:
   if (nFragments == 0) return;
-  EVB::pFragmentChain pChain = new EVB::FragmentChain[nFragments];
-
-  for (size_t i = 0; i < nFragments; i++) {
-
-    pChain[i].s_pFragment = &(ppFragments[i]);
-    if (i != nFragments-1) {
-      pChain[i].s_pNext = &(pChain[i+1]);
-    } else {
-      pChain[i].s_pNext = nullptr;
-    }
-  }
-  try {
-    submitFragments(pChain);
+  if (!m_fConnected) {
+    errno = ENOTCONN;
+    throw CErrnoException("submitting fragment array");
   }
-  catch (...) {
-    delete []pChain;
-    throw;
+  size_t nIovs        = 2*nFragments + 1;
+  iovec* pDescription = getIovecs(nIovs);
+  iovec* pVec         = pDescription + 1;
+  size_t bodyBytes(0);
+  for (size_t i = 0; i < nFragments; i++) {
+    pVec       = makeIoVec(ppFragments[i], pVec);
+    bodyBytes += sizeof(EVB::FragmentHeader) + ppFragments[i].s_header.s_size;
   }
-  delete []pChain;
+  EVB::ClientMessageHeader hdr;
+  hdr.s_msgType  = EVB::FRAGMENTS;
+  hdr.s_bodySize = bodyBytes;
+  pDescription[0].iov_base = &hdr;
+  pDescription[0].iov_len  = sizeof(EVB::ClientMessageHeader);
+
+  sendFragmentMessage(nIovs, pDescription);
 }
 /**
  * Given an STL list of pointers to events:
@@ -407,21 +451,25 @@ CEventOrderClient::message(void** msg,
 }
 /**
  * Get a reply string from the server.
- * Reply strings are fully textual lines.  This just means
- * reading a character at a time until the newline.
+ * Reply strings are fully textual lines.  The server only ever sends us
+ * reply lines, so we read whatever is available and hand out one line at
+ * a time.  A windowed server may have sent several CREDIT lines by the
+ * time we look.
  *
  * @return std::string.
  */
 std::string
 CEventOrderClient::getReplyString()
 {
-  std::string reply;
-  while(1) {
-    char c;
-    m_pConnection->Read(&c, sizeof(c));
-    if (c == '\n') return reply;
-    reply += c;
+  size_t eol;
+  while ((eol = m_replies.find('\n')) == std::string::npos) {
+    char buffer[256];
+    int  nRead = m_pConnection->Read(buffer, sizeof(buffer));
+    m_replies.append(buffer, nRead);
   }
+  std::string reply = m_replies.substr(0, eol);
+  m_replies.erase(0, eol + 1);
+  return reply;
 }
 /**
  * Free a fragment chain (the fragments themselves are not freed by this).
@@ -469,13 +517,83 @@ CEventOrderClient::makeIoVec(EVB::Fragment& Frag, iovec* pVecs)
 void
 CEventOrderClient::message(size_t nItems, iovec* parts)
 {
-  int fd = m_pConnection->getSocketFd();
-  io::writeDataVUnlimited(fd, parts, nItems);
+  send(nItems, parts);
   std::string reply = getReplyString();
   if (reply != "OK") {
     throw reply;
   }
 }
+/**
+ * send
+ *    Sends a message without waiting for any reply.
+ *
+ *  @param nItems  - Number of iovec structs used to describe the message.
+ *  @param parts   - Pointer to the iovecs.
+ */
+void
+CEventOrderClient::send(size_t nItems, iovec* parts)
+{
+  int fd = m_pConnection->getSocketFd();
+  io::writeDataVUnlimited(fd, parts, nItems);
+}
+/**
+ * sendFragmentMessage
+ *    Sends a FRAGMENTS message.  In lock step we wait for its OK, with a
+ *    credit window we only wait if we're out of credits.
+ *
+ *  @param nItems  - Number of iovec structs used to describe the message.
+ *  @param parts   - Pointer to the iovecs.
+ */
+void
+CEventOrderClient::sendFragmentMessage(size_t nItems, iovec* parts)
+{
+  if (m_nWindow > 1) {
+    waitForCredit();
+    send(nItems, parts);
+    m_nCredits--;
+  } else {
+    message(nItems, parts);
+  }
+}
+/**
+ * getIovecs
+ *    Returns the I/O vector storage kept between submissions, enlarged
+ *    if needed.
+ *
+ * @param nItems - Number of iovecs needed.
+ * @return iovec* - Storage for at least nItems iovecs.
+ */
+iovec*
+CEventOrderClient::getIovecs(size_t nItems)
+{
+  if (nItems > m_nIovecSize) {
+    iovec* pNew = static_cast<iovec*>(realloc(m_pIovec, nItems*sizeof(iovec)));
+    if (!pNew) throw std::bad_alloc();
+    m_pIovec     = pNew;
+    m_nIovecSize = nItems;
+  }
+  return m_pIovec;
+}
+/**
+ * waitForCredit
+ *    If we have no credits, read CREDIT replies from the server until we do.
+ *    The server withholds credits while it's flowed off so this is where
+ *    a windowed client is throttled.
+ *
+ * @throw std::string - any reply that is not a CREDIT.
+ */
+void
+CEventOrderClient::waitForCredit()
+{
+  while (m_nCredits == 0) {
+    std::string reply = getReplyString();
+    unsigned    credits;
+    if (sscanf(reply.c_str(), "CREDIT %u", &credits) != 1) {
+      throw reply;
+    }
+    m_nCredits += credits;
+  }
+}
 /**
  * bytesInChain
  *   @param pFrags   - a fragment chain.
@@ -50,6 +50,18 @@ namespace EVB {
     uint32_t s_nSids;                             // Number of sids on this link.
     uint32_t s_sids[0];                           // actually s_nSids follow.
   } ConnectBody, *pConnectBody;
+
+  /**
+   * A client that wants to have more than one FRAGMENTS message in flight
+   * appends this to the connect body.  Servers that don't know about it
+   * ignore it and reply OK; servers that do reply "OK WINDOW n" and then
+   * grant credits with "CREDIT n" lines rather than acking each message.
+   */
+  static const uint32_t PROTOCOL_WINDOWED=2;
+  typedef struct _ConnectTrailer {
+    uint32_t s_version;                           // PROTOCOL_WINDOWED.
+    uint32_t s_window;                            // Messages we'd like in flight.
+  } ConnectTrailer, *pConnectTrailer;
 }
 
 
@@ -75,6 +87,10 @@ private:
   int         m_nIovecMaxSize; // System limit on iov size.
   size_t      m_nIovecSize; // Number of elements allocated below.
   iovec*      m_pIovec;     // Pre-allocated iovector for writev.
+  unsigned    m_nRequestedWindow; // Window asked for in Connect.
+  unsigned    m_nWindow;    // Window the server granted (1 - lock step).
+  unsigned    m_nCredits;   // Messages we can send before waiting.
+  std::string m_replies;    // Reply text read but not yet consumed.
   
   // construction/destruction/canonicals
 public:
@@ -95,6 +111,8 @@ public:
   // Object operations:
 public:
   void Connect(std::string description, std::list<int> sources);
+  void     setWindow(unsigned nMessages);
+  unsigned getWindow() const;
   void disconnect();
   void submitFragments(EVB::pFragmentChain pChain);
   void submitFragments(size_t nFragments, EVB::pFragment ppFragments);
@@ -110,6 +128,10 @@ private:
   iovec* makeIoVec(EVB::Fragment& Frag, iovec* pVecs);
   
   void   message(size_t nItems, iovec* parts);
+  void   send(size_t nItems, iovec* parts);
+  void   sendFragmentMessage(size_t nItems, iovec* parts);
+  iovec* getIovecs(size_t nItems);
+  void   waitForCredit();
   size_t bytesInChain(EVB::pFragmentChain pFrags);
   size_t iovecsInChain(EVB::pFragmentChain pFrags);
   void   fillFragmentDescriptors(iovec* pVec, EVB::pFragmentChain pFrags);
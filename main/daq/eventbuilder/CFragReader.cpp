@@ -38,17 +38,28 @@
  * @param fd - the file descriptor we read from. 
  */
 CFragReader::CFragReader(int fd) :
-  m_fd(fd)
+  m_fd(fd),
+  m_pBuffer(0),
+  m_bufferSize(0)
 {}
+/**
+ * destructor
+ *   Release the fragment buffer.
+ */
+CFragReader::~CFragReader()
+{
+  free(m_pBuffer);
+}
 
 /**
  * operator()
  *
- * Read a fragment from the fd into storage that requries a free(3) call to release.
- * This pointer is returned to the caller and must be freed by them.
+ * Read a fragment from the fd into the reader's buffer, enlarging it
+ * if needed.
  *
  * @return void*
- * @retval Pointer to dynanmically allocated storage that contains the fragment.
+ * @retval Pointer to the fragment.  This is only valid until the next call
+ *         and must not be freed by the caller.
  */
 void*
 CFragReader::operator()()
@@ -64,10 +75,15 @@ CFragReader::operator()()
   //
 
   size_t fragmentSize = sizeof(header) + header.s_size;
-  uint8_t* pResult = reinterpret_cast<uint8_t*>(malloc(fragmentSize));
-  if (pResult==0) {
-    throw std::string("CFragReader:::operator()() Failed to allocate requested memory");
+  if (fragmentSize > m_bufferSize) {
+    void* pBigger = realloc(m_pBuffer, fragmentSize);
+    if (pBigger==0) {
+      throw std::string("CFragReader:::operator()() Failed to allocate requested memory");
+    }
+    m_pBuffer    = pBigger;
+    m_bufferSize = fragmentSize;
   }
+  uint8_t* pResult = reinterpret_cast<uint8_t*>(m_pBuffer);
   memcpy(pResult, &header, sizeof(header));
   uint8_t* pBody = pResult + sizeof(header);
 
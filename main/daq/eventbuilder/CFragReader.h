@@ -33,18 +33,25 @@
  *
  *  Class to read fragments from a file id.  
  *  To use, instantiate on a file id, and then invoke operator()
- *  to get the next fragment.  The fragment will be returned to you 
- *  via a pointer to malloc'd storage.
+ *  to get the next fragment.  The fragment is returned in storage owned
+ *  by the reader that is reused by the next call, so no allocation is
+ *  done once the buffer has grown to the largest fragment size.
  */
 class CFragReader
 {
   // private storage:
 private:
-  int m_fd;			// file descriptor to read from via read(2).
+  int    m_fd;			// file descriptor to read from via read(2).
+  void*  m_pBuffer;		// Holds the most recent fragment.
+  size_t m_bufferSize;
 
   // canonicals we need:
 public:
   CFragReader(int fd);
+  ~CFragReader();
+private:
+  CFragReader(const CFragReader&);
+  CFragReader& operator=(const CFragReader&);
 
   // public methods:
 public:
@@ -31,6 +31,7 @@
 
 
 #include "CopyPopUntil.h"
+#include "MergeSortedRun.h"
 
 using std::uint32_t;
 using std::uint64_t;
@@ -46,9 +47,10 @@ CFragmentHandler* CFragmentHandler::m_pInstance(0);
 
 static const size_t Mega(1024*1024);
 
-static const time_t DefaultBuildWindow(20); // default seconds to accumulate data before ordering.
-static const uint32_t IdlePollInterval(1);  // Seconds between idle polls.
-static const time_t DefaultStartupTimeout(0); // default seconds to accumulate data before ordering.
+static const time_t DefaultBuildWindow(20000); // default ms to accumulate data before ordering.
+static const time_t DefaultFlushInterval(1000); // default longest ms between idle polls.
+static const time_t MinFlushInterval(1);        // Shortest ms between idle polls.
+static const time_t DefaultStartupTimeout(0); // default ms to accumulate data before ordering.
 static time_t timeOfFirstSubmission(UINT64_MAX); //
 static const  size_t defaultXonLimit( 3000000);     // Default total fragment count at which we can xon
 static const  size_t defaultXoffLimit(4000000);    /// Default total fragment count
@@ -107,15 +109,17 @@ CFragmentHandler::CFragmentHandler() :
     m_sorter.start();
     m_nBuildWindow = DefaultBuildWindow;
     m_nStartupTimeout = DefaultStartupTimeout;
+    m_nFlushInterval  = DefaultFlushInterval;
     m_pInstance = this;
     resetTimestamps();
 
-    m_nNow = time(NULL);	// Initialize the time.
-    m_nOldestReceived = INT32_MAX; // Hopefully that makes it infinitely future.
+    m_nNow = now();	// Initialize the time.
+    m_nOldestReceived = std::numeric_limits<time_t>::max(); // infinitely future.
 
     // Start the idle poll off:
 
-    m_timer = Tcl_CreateTimerHandler(1000*IdlePollInterval, &CFragmentHandler::IdlePoll, this);
+    m_timer = 0;
+    scheduleIdlePoll(m_nFlushInterval);
     
     // Set the Xoff values:
     
@@ -171,6 +175,11 @@ CFragmentHandler::getInstance()
  *
  *   @param nSize      - Number of bytes worth of event fragment data.
  *   @param pFragments - Pointer to the first fragment.
+ *   @param pBlock     - If not null, the fragment block pFragments lives in.
+ *                       The queued fragments then point into the block
+ *                       (each holding a reference to it) rather than
+ *                       having their bodies copied.  The caller still
+ *                       releases its own reference when this returns.
  *
  *   @note This method is a no-op if nSize is 0.
  *   @throw std::string exception if there's an inconsistency between
@@ -182,10 +191,12 @@ static bool first(true);
 
 
 void
-CFragmentHandler::addFragments(size_t nSize, const EVB::FlatFragment* pFragments)
+CFragmentHandler::addFragments(
+  size_t nSize, const EVB::FlatFragment* pFragments, EVB::pFragmentBlock pBlock
+)
 {
   
-    m_nNow = time(NULL);
+    m_nNow = now();
     if (m_nNow < m_nOldestReceived) {
       m_nOldestReceived = m_nNow; // Really done first time.
       m_nMostRecentlyEmptied = m_nNow;
@@ -211,7 +222,7 @@ CFragmentHandler::addFragments(size_t nSize, const EVB::FlatFragment* pFragments
 
 
 
-      addFragment(pFragments);
+      addFragment(pFragments, pBlock);
       
       // Point to the next fragment.
       
@@ -232,6 +243,13 @@ CFragmentHandler::addFragments(size_t nSize, const EVB::FlatFragment* pFragments
   
     
     checkXoff();         
+
+    // If we were idle, the next poll may be too late to flush these
+    // fragments when their build window expires:
+
+    if ((m_nNow + m_nBuildWindow) < m_nNextPoll) {
+      scheduleIdlePoll(nextPollDelay());
+    }
 }
 /**
  * setBuildWindow
@@ -244,20 +262,72 @@ CFragmentHandler::addFragments(size_t nSize, const EVB::FlatFragment* pFragments
 void
 CFragmentHandler::setBuildWindow(time_t windowWidth)
 {
-    m_nBuildWindow = windowWidth;
+    setBuildWindowMs(windowWidth*1000);
 }
 /**
  * getBuildWindow
  *
  * Return the value of the current build window.
  *
- * @return time_t - build window in seconds.
+ * @return time_t - build window in seconds.  A window that is not a whole
+ *                  number of seconds is rounded up so that it is never 0.
  */
 time_t
 CFragmentHandler::getBuildWindow() const
+{
+  return (m_nBuildWindow + 999)/1000;
+}
+/**
+ * setBuildWindowMs
+ *
+ * Set the build window in milliseconds.  Sub-second windows let fragments
+ * from sources that don't all produce data often get out of the orderer
+ * quickly.  The idle poll is rescheduled so that a shorter window takes
+ * effect immediately.
+ *
+ * @param windowWidth - milliseconds in the build window.
+ */
+void
+CFragmentHandler::setBuildWindowMs(time_t windowWidth)
+{
+  m_nBuildWindow = windowWidth;
+  scheduleIdlePoll(nextPollDelay());
+}
+/**
+ * getBuildWindowMs
+ *
+ * @return time_t - build window in milliseconds.
+ */
+time_t
+CFragmentHandler::getBuildWindowMs() const
 {
   return m_nBuildWindow;
 }
+/**
+ * setFlushInterval
+ *
+ * Set the longest time between idle polls.  The idle poll runs when
+ * fragments in the queues will fall out of the build window, but
+ * at least this often.
+ *
+ * @param interval - milliseconds.
+ */
+void
+CFragmentHandler::setFlushInterval(time_t interval)
+{
+  m_nFlushInterval = interval;
+  scheduleIdlePoll(nextPollDelay());
+}
+/**
+ * getFlushInterval
+ *
+ * @return time_t - longest milliseconds between idle polls.
+ */
+time_t
+CFragmentHandler::getFlushInterval() const
+{
+  return m_nFlushInterval;
+}
 /**
  * setStartupTimeout
  * 
@@ -270,7 +340,7 @@ CFragmentHandler::getBuildWindow() const
 void
 CFragmentHandler::setStartupTimeout(time_t duration)
 {
-    m_nStartupTimeout = duration;
+    m_nStartupTimeout = duration*1000;
 }
 /**
  * getStartupTimeout
@@ -282,7 +352,7 @@ CFragmentHandler::setStartupTimeout(time_t duration)
 time_t
 CFragmentHandler::getStartupTimeout() const
 {
-  return m_nStartupTimeout;
+  return m_nStartupTimeout/1000;
 }
 /**
  * setXonThreshold
@@ -744,6 +814,7 @@ void
 CFragmentHandler::markSourceFailed(uint32_t id)
 {
   m_liveSources.erase(id);
+  mergeLateFragments();          // A late barrier counts too.
   
   // If there's a pending barrier synchronization and all of the missing
   // sources are dead do an incomplete barrier.
@@ -873,6 +944,10 @@ CFragmentHandler::clearQueues()
       q.s_queue.pop_front();
       
     }
+    while (!q.s_late.empty()) {
+      delete q.s_late.front().second;
+      q.s_late.pop_front();
+    }
   }
   m_FragmentQueues.clear();
 }
@@ -899,6 +974,8 @@ void
 CFragmentHandler::flushQueues(bool completely)
 {
  
+  mergeLateFragments();           // Queues must be in order to flush.
+  
   CSortThread::Fragments* pFrags = new CSortThread::Fragments;
   std::list<std::pair<SourceQueue*, CSortThread::FragmentList*>> statcopy;
   
@@ -937,7 +1014,7 @@ CFragmentHandler::flushQueues(bool completely)
     
     
   
-    m_nNow = time(NULL);
+    m_nNow = now();
     time_t windowEnd = m_nNow - m_nBuildWindow;
   
     for (auto p = m_FragmentQueues.begin(); p != m_FragmentQueues.end(); p++) {
@@ -1034,6 +1111,7 @@ CFragmentHandler::abortBarrierProcessing()
   // Presumably this is done rarely so we're not that
   // worried about performance.
   
+  mergeLateFragments();
   size_t nBarriers = countPresentBarriers();
   if (nBarriers) {
    EvbFragments& outputList(*(new EvbFragments)); // Deleted by sorter/output
@@ -1083,14 +1161,19 @@ CFragmentHandler::dataLate(const ::EVB::Fragment& fragment)
  * with the caller.  allocateFragment is used to create the fragment
  * storage adnfreeFragment should be used to release that storage
  * (and that is done by buildEvent() typically).
+ * If the fragment is in a fragment block, only the header is copied
+ * and the queued fragment refers to the body in the block.
  *
  * @param pFragment - Pointer to the flattened fragment.
+ * @param pBlock    - Block containing pFragment or null.
  * 
  * @note This method can also alter the value of m_nNewest if its
  *       timestamp says it is the newest fragment.
  */
 void
-CFragmentHandler::addFragment(const EVB::FlatFragment* pFragment)
+CFragmentHandler::addFragment(
+  const EVB::FlatFragment* pFragment, EVB::pFragmentBlock pBlock
+)
 {
   
     bool     assigned            = false;
@@ -1098,15 +1181,19 @@ CFragmentHandler::addFragment(const EVB::FlatFragment* pFragment)
 
     m_nFragmentsLastPeriod++;	//  We were not idle.
 
-    // Allocate the fragmentand copy it:
+    // Allocate the fragmentand copy it (or just reference it):
     
     const EVB::FragmentHeader* pHeader = &pFragment->s_header;
-    EVB::pFragment pFrag         = allocateFragment(pHeader); // Copies the header.
+    EVB::pFragment pFrag;
+    if (pBlock) {
+      pFrag = referenceFragment(pBlock, pFragment);
+    } else {
+      pFrag = allocateFragment(pHeader); // Copies the header.
+      memcpy(pFrag->s_pBody, pFragment->s_body, pFrag->s_header.s_size);
+    }
     uint64_t timestamp           = pHeader->s_timestamp;
     m_fBarrierPending           |= (pHeader->s_barrier != 0);   //Mark there's a barrier pending
 
-    memcpy(pFrag->s_pBody, pFragment->s_body, pFrag->s_header.s_size);
-
     // Get a reference to the fragment queue, creating it if needed:
     // Note that queues should get created by connection from the
     // fragment maker.  We'll give this queue a "" for an id.
@@ -1250,6 +1337,7 @@ CFragmentHandler::totalFragmentSize(const EVB::FragmentHeader* pHeader)
 bool
 CFragmentHandler::queuesEmpty()
 {
+    mergeLateFragments();        // Late fragments aren't in s_queue yet.
     for(Sources::iterator p = m_FragmentQueues.begin();
         p != m_FragmentQueues.end(); p++) {
         if (!p->second.s_queue.empty()) return false;
@@ -1267,6 +1355,7 @@ CFragmentHandler::queuesEmpty()
 bool
 CFragmentHandler::noEmptyQueue()
 {
+    mergeLateFragments();
     for(Sources::iterator p = m_FragmentQueues.begin();
         p != m_FragmentQueues.end(); p++) {
         if (p->second.s_queue.empty()) return false;
@@ -1306,10 +1395,21 @@ CFragmentHandler::QueueStatGetter::operator()(SourceElementV& source)
     SourceQueue&  sourceQ(source.second);    
     QueueStatistics stats;
     stats.s_queueId       = source.first;
-    stats.s_queueDepth    = sourceQ.s_queue.size();
+    stats.s_queueDepth    = sourceQ.s_queue.size() + sourceQ.s_late.size();
     stats.s_oldestElement =
-        stats.s_queueDepth ? sourceQ.s_queue.front().second->s_header.s_timestamp 
-                           : 0;
+        sourceQ.s_queue.empty() ? 0 : sourceQ.s_queue.front().second->s_header.s_timestamp;
+    
+    // Late fragments are older than the tail of s_queue but in no
+    // particular order:
+    
+    for (auto p = sourceQ.s_late.begin(); p != sourceQ.s_late.end(); p++) {
+        uint64_t stamp = p->second->s_header.s_timestamp;
+        if (sourceQ.s_queue.empty() && (p == sourceQ.s_late.begin())) {
+            stats.s_oldestElement = stamp;
+        } else if (stamp < stats.s_oldestElement) {
+            stats.s_oldestElement = stamp;
+        }
+    }
     stats.s_queuedBytes       = sourceQ.s_bytesInQ;
     stats.s_dequeuedBytes     = sourceQ.s_bytesDeQd;
     stats.s_totalQueuedBytes  = sourceQ.s_totalBytesQd;
@@ -1361,8 +1461,10 @@ CFragmentHandler::BarrierSummary
 CFragmentHandler::generateBarrier(EvbFragments& outputList)
 {
   // Iterate through the output queues and add any
-  // barrier events to the outputList.
+  // barrier events to the outputList.  A barrier may still be in
+  // a late run so merge those first.
 
+  mergeLateFragments();
 
   BarrierSummary result;
 
@@ -1533,8 +1635,9 @@ CFragmentHandler::partialBarrier(std::vector<std::pair<uint32_t, uint32_t> >& ty
  * @return size_t - number of fragment queues that have barriers at their head.
  */
 size_t
-CFragmentHandler::countPresentBarriers() const
+CFragmentHandler::countPresentBarriers()
 {
+  mergeLateFragments();          // Barriers can arrive late too.
   size_t count(0);
   for (Sources::const_iterator p = m_FragmentQueues.begin(); p != m_FragmentQueues.end(); p++) {
     const SourceQueue& queue(p->second);
@@ -1582,7 +1685,7 @@ CFragmentHandler::checkBarrier(bool completeFlush)
 {
   EvbFragments& outputList(*(new EvbFragments));
   
-  m_nNow = time(NULL);		// Update the time.
+  m_nNow = now();		// Update the time.
   size_t nBarriers = countPresentBarriers();
 
 #ifdef DEBUG
@@ -1615,7 +1718,7 @@ CFragmentHandler::checkBarrier(bool completeFlush)
   if ((nBarriers != 0) && ((m_nNow - oldestBarrier()) > (m_nBuildWindow*4))) {
     std::cerr << "Generating malformed barrier oldest received: "
 	      << std::hex << oldestBarrier() 
-	      << " unix time(m_nNow) " << m_nNow << std::dec << std::endl;
+	      << " clock ms(m_nNow) " << m_nNow << std::dec << std::endl;
     generateMalformedBarrier(outputList);
     observe(outputList);
   }
@@ -1652,13 +1755,63 @@ CFragmentHandler::oldestBarrier()
  * Static methods
  */
 
+/**
+ * scheduleIdlePoll
+ *
+ * (Re)schedule the idle poll.
+ *
+ * @param delay - ms from now at which the poll should run.
+ */
+void
+CFragmentHandler::scheduleIdlePoll(time_t delay)
+{
+  if (m_timer) {
+    Tcl_DeleteTimerHandler(m_timer);
+  }
+  m_nNextPoll = now() + delay;
+  m_timer     = Tcl_CreateTimerHandler(delay, &CFragmentHandler::IdlePoll, this);
+}
+/**
+ * nextPollDelay
+ *
+ * Figure out when the idle poll should next run.  That's when the least
+ * recently queued fragment falls out of the build window.  If it already
+ * has but could not be flushed (e.g. it's waiting on a barrier), there's
+ * no point polling again sooner than a build window from now.  The delay
+ * is never longer than the flush interval so that XON checks still happen
+ * when we're idle.
+ *
+ * @return time_t - ms from now.
+ */
+time_t
+CFragmentHandler::nextPollDelay()
+{
+  time_t oldest = std::numeric_limits<time_t>::max();
+  for (auto p = m_FragmentQueues.begin(); p != m_FragmentQueues.end(); p++) {
+    if (!p->second.s_queue.empty() && (p->second.s_queue.front().first < oldest)) {
+      oldest = p->second.s_queue.front().first;
+    }
+    if (!p->second.s_late.empty() && (p->second.s_late.front().first < oldest)) {
+      oldest = p->second.s_late.front().first;
+    }
+  }
+  time_t delay = m_nFlushInterval;
+  if (oldest != std::numeric_limits<time_t>::max()) {
+    time_t due = oldest + m_nBuildWindow - now();
+    delay = (due > 0) ? due : m_nBuildWindow;
+  }
+  if (delay > m_nFlushInterval) delay = m_nFlushInterval;
+  if (delay < MinFlushInterval) delay = MinFlushInterval;
+  return delay;
+}
 /**
  * IdlePoll
  *
  * If data are not getting pushed through we periodically call flushQueues to ensure
  * the last dribs of data are sent..this also helps if data rates are low.
  *
- * method also resschedules itselfr.
+ * method also resschedules itselfr for when the next queued fragment falls out
+ * of the build window (see nextPollDelay).
  *
  * @param obj - Pointer to the singleton.
  */
@@ -1666,7 +1819,8 @@ void
 CFragmentHandler::IdlePoll(ClientData data)
 {
   CFragmentHandler* pHandler = reinterpret_cast<CFragmentHandler*>(data);
-  pHandler->m_nNow = time(NULL);	// Update tod.
+  pHandler->m_timer = 0;                // We've fired.
+  pHandler->m_nNow = now();	// Update tod.
   
   
   pHandler->flushQueues();   //  Do time window based flush.
@@ -1680,7 +1834,21 @@ CFragmentHandler::IdlePoll(ClientData data)
   pHandler->checkXon();           // May be able to XON.
   // reschedule
 
-  pHandler->m_timer = Tcl_CreateTimerHandler(1000*IdlePollInterval,  &CFragmentHandler::IdlePoll, pHandler);
+  pHandler->scheduleIdlePoll(pHandler->nextPollDelay());
+}
+/**
+ * now
+ *
+ * @return time_t - milliseconds on the monotonic clock.  Unlike time(NULL)
+ *                  this can't jump when the wall clock is set and has
+ *                  resolution enough for sub-second build windows.
+ */
+time_t
+CFragmentHandler::now()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<time_t>(t.tv_sec)*1000 + t.tv_nsec/1000000;
 }
 /**
  * inflightFragmentCont
@@ -1919,7 +2087,7 @@ CFragmentHandler::updateQueueStatistics(
 void
 CFragmentHandler::XoffQueue(SourceQueue& q)
 {
-  if ((q.s_queue.size() >= m_nPerQXoffLimit) && (!q.s_xoffed)) {
+  if ((q.s_queue.size() + q.s_late.size() >= m_nPerQXoffLimit) && (!q.s_xoffed)) {
     std::string sock = q.s_qid;
     for (auto p : m_flowControlObservers) {
       p->Xoff(sock);    
@@ -1939,7 +2107,7 @@ CFragmentHandler::XoffQueue(SourceQueue& q)
 void
 CFragmentHandler::XonQueue(SourceQueue& q)
 {
-  if ((q.s_queue.size() < m_nPerQXonLimit) && (q.s_xoffed)) {
+  if ((q.s_queue.size() + q.s_late.size() < m_nPerQXonLimit) && (q.s_xoffed)) {
     std::string sock = q.s_qid;
     for (auto p : m_flowControlObservers) {
       p->Xon(sock);    
@@ -1960,9 +2128,12 @@ CFragmentHandler::XonQueue(SourceQueue& q)
  *    - Queue is empty - push_back.
  *    - Timestamp of this element is >= timestamp of the element at the queue tail,
  *      push_back
- *    - Otherwise, find the last queue element with a timestamp <= t ours.
- *       *  If found, insert us after that.
- *       *  If not found, push_front.
+ *    - Otherwise the fragment goes in the queue's s_late run.  Inserting
+ *      it in the middle of the deque here is O(queue depth) and with deep
+ *      queues and bursts of out of order data that went quadratic.
+ *      mergeLateFragments puts the run in place (after the last queue
+ *      element with a timestamp <= ours) all at once before the queues
+ *      are flushed.
  *
  *  @param clockTime -the clock time to associate with the queue element.
  *  @param pFrag     -Pointer to the fragment to insert.
@@ -1982,21 +2153,8 @@ CFragmentHandler::insertFragment(
     uint64_t tailStamp = dest.s_queue.back().second->s_header.s_timestamp;
     if (entryTimestamp >= tailStamp) {    // In order....
       dest.s_queue.push_back(entry);
-    } else {                                 // have to hunt.
-      auto p = dest.s_queue.rbegin();        // reverse iteration.
-      while (p != dest.s_queue.rend()) {
-        uint64_t stamp = p->second->s_header.s_timestamp;
-        if (stamp <= entryTimestamp)  break;
-        p++;
-      }
-      // If p == rend push_front otherwise figure out how to insert:
-      
-      if (p == dest.s_queue.rend()) {
-        dest.s_queue.push_front(entry);
-      } else {
-        auto insertionPoint = p.base();
-        dest.s_queue.insert(insertionPoint, entry);
-      }
+    } else {                                 // merged in later.
+      dest.s_late.push_back(entry);
     }
   }
   // Now update the timestamp info:
@@ -2008,6 +2166,33 @@ CFragmentHandler::insertFragment(
   dest.s_lastTimestamp   = dest.s_queue.back().second->s_header.s_timestamp;
   
   
+}
+/**
+ * Orders queue elements by fragment timestamp.
+ */
+class QueueElementStampLess {
+public:
+  bool operator()(
+    const std::pair<time_t, EVB::pFragment>& e1,
+    const std::pair<time_t, EVB::pFragment>& e2
+  ) const {
+    return e1.second->s_header.s_timestamp < e2.second->s_header.s_timestamp;
+  }
+};
+/**
+ * mergeLateFragments
+ *    Merge the out of order fragments insertFragment set aside into their
+ *    queues.  This is done once per batch of fragments (flushQueues calls
+ *    us) so the cost is one pass over the part of each queue the late
+ *    fragments belong in rather than one pass per late fragment.
+ */
+void
+CFragmentHandler::mergeLateFragments()
+{
+  for (auto p = m_FragmentQueues.begin(); p != m_FragmentQueues.end(); p++) {
+    SourceQueue& q(p->second);
+    MergeSortedRun(q.s_queue, q.s_late, QueueElementStampLess());
+  }
 }
 /**
  * handleDequeuedFragments
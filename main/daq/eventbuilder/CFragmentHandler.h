@@ -43,6 +43,9 @@ namespace EVB {
   
   struct _Fragment;
   typedef struct _Fragment Fragment, *pFragment;
+
+  struct _FragmentBlock;
+  typedef struct _FragmentBlock FragmentBlock, *pFragmentBlock;
 };
 
 
@@ -84,6 +87,7 @@ private:
     std::uint64_t                                        s_totalBytesQd;
     std::uint64_t                                        s_lastTimestamp;
     EvbFragments                                         s_queue;
+    EvbFragments                                         s_late;  // Out of order, not yet in s_queue.
     std::string                                          s_qid;
     bool                                                 s_xoffed;
     void reset() {
@@ -225,11 +229,15 @@ private:
   std::uint64_t                     m_nNewest;              //!< Newest fragment seen in terms of ticks.
   std::uint64_t                     m_nMostRecentlyPopped;    //!< Most recently popped fragment in ticks.
 
+  // Clock times and intervals below are milliseconds of the monotonic clock (see now()).
+
   time_t                       m_nBuildWindow;
   time_t                       m_nNow;
   time_t                       m_nOldestReceived;
   time_t                       m_nMostRecentlyEmptied;
-  time_t                       m_nStartupTimeout;   //!< N seconds to wait before flushing (dflt=2)
+  time_t                       m_nStartupTimeout;   //!< ms to wait before flushing.
+  time_t                       m_nFlushInterval;    //!< Longest ms between idle polls.
+  time_t                       m_nNextPoll;         //!< When the idle poll is scheduled.
 
 
   std::uint32_t                     m_nFragmentsLastPeriod; //!< # fragments in last flush check interval.
@@ -283,10 +291,17 @@ public:
   // here are the operations we advertised:
 
 public:
-  void addFragments(size_t nSize, const EVB::FlatFragment* pFragments);
+  void addFragments(
+    size_t nSize, const EVB::FlatFragment* pFragments,
+    EVB::pFragmentBlock pBlock = 0
+  );
 
   void setBuildWindow(time_t windowWidth);
   time_t getBuildWindow() const;
+  void setBuildWindowMs(time_t windowWidth);
+  time_t getBuildWindowMs() const;
+  void setFlushInterval(time_t interval);
+  time_t getFlushInterval() const;
 
   void setStartupTimeout(time_t duration);
   time_t getStartupTimeout() const;
@@ -358,7 +373,7 @@ public:
 private:
   void flushQueues(bool completely=false);
   void   dataLate(const ::EVB::Fragment& fragment);		    // Data late handler.
-  void   addFragment(const EVB::FlatFragment* pFragment);
+  void   addFragment(const EVB::FlatFragment* pFragment, EVB::pFragmentBlock pBlock);
   size_t totalFragmentSize(const EVB::FragmentHeader* pHeader);
   bool   queuesEmpty();
   bool   noEmptyQueue();
@@ -385,7 +400,7 @@ private:
   void Xon();
   
   void findOldest();
-  size_t countPresentBarriers() const;
+  size_t countPresentBarriers();
 
 
   SourceQueue& getSourceQueue(std::string sockName, std::uint32_t id);
@@ -420,14 +435,19 @@ private:
   );
 
   void insertFragment(time_t clockTime, EVB::pFragment pFrag, SourceQueue& dest);
+  void mergeLateFragments();
   void handleDequeuedFragments(
     Sources::iterator& p, EvbFragments& partialSort,
     std::deque<EvbFragments*>* pFrags,
     std::list<std::pair<SourceQueue*, EvbFragments*>>& statcopy
   );
+  void scheduleIdlePoll(time_t delay);
+  time_t nextPollDelay();
+
   // Static private methods:
 
   static void IdlePoll(ClientData obj);
+  static time_t now();
   
 };
 
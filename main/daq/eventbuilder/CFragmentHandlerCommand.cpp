@@ -63,6 +63,16 @@ CFragmentHandlerCommand::~CFragmentHandlerCommand() {
  * The first command object is the socket -  used by the fragment handler.
  * The second the message body containing the fragments.
  *
+ * Alternatively the form:
+ *
+ * \verbatim
+ *   EVB::handleFragments socket -read nBytes
+ * \endverbatim
+ *
+ * reads the nBytes message body from the socket directly into a fragment
+ * block, acknowledges it with OK and queues the fragments by reference to
+ * the block so their bodies are never copied again.
+ *
  * @return int
  * @retval TCL_OK - success.
  * @retval TCL_ERROR -Failure.
@@ -79,7 +89,7 @@ CFragmentHandlerCommand::operator()(CTCLInterpreter& interp, std::vector<CTCLObj
   uint8_t* msgBody(0);
 
 	try {    
-    if (objv.size() != 3) {
+    if ((objv.size() != 3) && (objv.size() != 4)) {
       interp.setResult(std::string("Incorrect number of parameters"));
       return TCL_ERROR;
     }
@@ -92,6 +102,38 @@ CFragmentHandlerCommand::operator()(CTCLInterpreter& interp, std::vector<CTCLObj
       interp.setResult(std::string("Tcl does not know about this channel name"));
       return TCL_ERROR;
     }
+    CFragmentHandler* pHandler = CFragmentHandler::getInstance();
+
+    // -read nBytes: the message body is still in the socket:
+
+    if (objv.size() == 4) {
+      objv[2].Bind(interp);
+      objv[3].Bind(interp);
+      if (std::string(objv[2]) != "-read") {
+        interp.setResult(std::string("Expected -read nBytes"));
+        return TCL_ERROR;
+      }
+      int nBytes = objv[3];
+      if (nBytes < 0) {
+        interp.setResult(std::string("Message body size must not be negative"));
+        return TCL_ERROR;
+      }
+      EVB::pFragmentBlock pBlock = readFragmentBlock(pChannel, nBytes);
+      try {
+        sendOk(pChannel);
+        pHandler->addFragments(
+          nBytes, reinterpret_cast<const EVB::FlatFragment*>(pBlock->s_pData),
+          pBlock
+        );
+      }
+      catch (...) {
+        releaseFragmentBlock(pBlock);
+        throw;
+      }
+      releaseFragmentBlock(pBlock);
+      return TCL_OK;
+    }
+    
     // The second object is a byte array object containing the message body:
 		
     int msgLength;
@@ -101,7 +143,6 @@ CFragmentHandlerCommand::operator()(CTCLInterpreter& interp, std::vector<CTCLObj
     
     // Dispatch the body as the flattened fragments they are:
     
-    CFragmentHandler* pHandler = CFragmentHandler::getInstance();
     pHandler->addFragments(msgLength, reinterpret_cast<const EVB::FlatFragment*>(msg));
     
 
@@ -161,11 +202,19 @@ CFragmentHandlerCommand::operator()(CTCLInterpreter& interp, std::vector<CTCLObj
 
     if (messageType == "FRAGMENTS") {
       sendOk(channel);                // do it here to let sender start marshalling next block.
-      readBlock(channel);            // m_usedSize bytes Block in m_messageBuffer
+      uint32_t nBytes = readPartSize(channel);
+      EVB::pFragmentBlock pBlock = readFragmentBlock(channel, nBytes);
       CFragmentHandler* pHandler = CFragmentHandler::getInstance();
-      pHandler->addFragments(
-	  m_usedSize, reinterpret_cast<EVB::pFlatFragment>(m_messageBuffer)
-      );
+      try {
+        pHandler->addFragments(
+          nBytes, reinterpret_cast<EVB::pFlatFragment>(pBlock->s_pData), pBlock
+        );
+      }
+      catch (...) {
+        releaseFragmentBlock(pBlock);
+        throw;
+      }
+      releaseFragmentBlock(pBlock);
       
     } else  if (messageType == "DISCONNECT") {
       sendOk(channel);
@@ -280,6 +329,27 @@ CFragmentHandlerCommand::readBlock(Tcl_Channel chan)
   m_usedSize = s;
   
 }
+/**
+ * readFragmentBlock
+ *    Read a message body of fragments directly into a new fragment block.
+ *
+ * @param chan   - the channel to read from.
+ * @param nBytes - Size of the message body.
+ * @return EVB::pFragmentBlock - the block.  The caller holds the only
+ *                 reference to it and must release it.
+ * @throw const char* - if the read does not complete normally.
+ */
+EVB::pFragmentBlock
+CFragmentHandlerCommand::readFragmentBlock(Tcl_Channel chan, size_t nBytes)
+{
+  EVB::pFragmentBlock pBlock = allocateFragmentBlock(nBytes);
+  int n = Tcl_Read(chan, reinterpret_cast<char*>(pBlock->s_pData), nBytes);
+  if (n != nBytes) {
+    releaseFragmentBlock(pBlock);
+    throw "Failed to read data from a data source";
+  }
+  return pBlock;
+}
 /**
  * readPartSize
  *    Reads and returns the size of a message part.  Each message part is
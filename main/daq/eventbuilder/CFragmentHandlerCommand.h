@@ -23,6 +23,7 @@
 #include <tcl.h>
 #include <map>
 #include <string>
+#include "fragment.h"
 
 /**
  * The CFragmentHandlerCommand class provides the EVB::handleFragment
@@ -35,6 +36,12 @@
  * \verbatim
  * EVB::handleFragment socket
  * \verbatim
+ *
+ * or, reading the body straight into a fragment block:
+ *
+ * \verbatim
+ * EVB::handleFragment socket -read nBytes
+ * \verbatim
  */
 class CFragmentHandlerCommand : public CTCLObjectProcessor
 {
@@ -58,6 +65,7 @@ private:
     uint8_t*    getBuffer(size_t nBytes);
     void        readHeader(std::string& header, Tcl_Channel chan);
     void        readBlock(Tcl_Channel chan);
+    EVB::pFragmentBlock readFragmentBlock(Tcl_Channel chan, size_t nBytes);
     uint32_t    readPartSize(Tcl_Channel chan);
 
     void        sendOk(Tcl_Channel chan);
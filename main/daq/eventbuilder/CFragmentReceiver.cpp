@@ -0,0 +1,393 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CFragmentReceiver.cpp
+ * @brief Implementation of the per data source fragment receiver thread.
+ */
+#include "CFragmentReceiver.h"
+#include "CEventOrderClient.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+
+/*----------------------------------------------------------------------
+** Canonical methods.
+*/
+
+/**
+ * constructor
+ *
+ * @param socketName - Tcl name of the socket (used to identify us).
+ * @param fd         - File descriptor of the socket.  We own it and close
+ *                     it on destruction.
+ * @param sink       - Where batches of fragments go.
+ * @param pPrefix    - Data already read from the socket (e.g. buffered in a
+ *                     Tcl channel) that must be processed before reading it.
+ * @param nPrefix    - Number of bytes of prefix data.
+ * @param window     - Number of FRAGMENTS messages the client was told it
+ *                     can have in flight.  1 means acknowledge each
+ *                     message with OK.
+ *
+ * @note The thread is not started; call start() for that.
+ */
+CFragmentReceiver::CFragmentReceiver(
+  std::string socketName, int fd, Sink& sink, const void* pPrefix, size_t nPrefix,
+  unsigned window
+) :
+  m_socketName(socketName), m_fd(fd), m_sink(sink), m_prefixUsed(0),
+  m_window(window ? window : 1),
+  m_flowOn(true), m_stopping(false), m_pending(0), m_inFlight(0), m_withheld(0),
+  m_state(ACTIVE)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(pPrefix);
+  m_prefix.assign(p, p + nPrefix);
+  memset(&m_statistics, 0, sizeof(m_statistics));
+}
+/**
+ * destructor
+ *   The thread must have been joined by now.
+ */
+CFragmentReceiver::~CFragmentReceiver()
+{
+  close(m_fd);
+}
+
+/*----------------------------------------------------------------------
+** Thread control.
+*/
+
+/**
+ * start
+ *   Start the receiver thread.
+ */
+void
+CFragmentReceiver::start()
+{
+  m_thread = std::thread(&CFragmentReceiver::run, this);
+}
+/**
+ * join
+ *   Wait for the thread to exit.  Only call this after the sink has seen
+ *   our final batch or after stop, else it may block indefinitely.
+ */
+void
+CFragmentReceiver::join()
+{
+  if (m_thread.joinable()) m_thread.join();
+}
+
+/**
+ * run
+ *   Read and process messages until the peer disconnects, the connection
+ *   fails or we are stopped.
+ */
+void
+CFragmentReceiver::run()
+{
+  State finalState = LOST;
+  try {
+    while (waitForRoom()) {
+      EVB::ClientMessageHeader header;
+      if (!readFully(&header, sizeof(header))) break;
+
+      if (header.s_msgType == EVB::FRAGMENTS) {
+        EVB::pFragmentBlock pBlock = allocateFragmentBlock(header.s_bodySize);
+        if (!readFully(pBlock->s_pData, header.s_bodySize)) {
+          releaseFragmentBlock(pBlock);
+          break;
+        }
+        bool overrun = false;
+        {
+          std::lock_guard<std::mutex> guard(m_lock);
+          overrun = (m_window > 1) && (++m_inFlight > m_window);
+        }
+        if (overrun) {
+          releaseFragmentBlock(pBlock);
+          reply("ERROR {Credit window exceeded}\n");
+          finalState = ERROR;
+          break;
+        }
+        if (m_window == 1) {
+          reply("OK\n");                   // Source can prepare the next one.
+        }
+        {
+          std::lock_guard<std::mutex> guard(m_lock);
+          m_pending++;
+          m_statistics.s_lastReceived = time(NULL);
+          m_statistics.s_messages++;
+          m_statistics.s_bytes += header.s_bodySize;
+        }
+        Batch batch = {this, pBlock, header.s_bodySize};
+        m_sink.put(batch);
+
+      } else if (header.s_msgType == EVB::DISCONNECT) {
+        reply("OK\n");
+        finalState = CLOSED;
+        break;
+
+      } else {
+        reply("ERROR {Unexpected message type}\n");
+        finalState = ERROR;
+        break;
+      }
+    }
+  }
+  catch (...) {
+    finalState = LOST;                   // e.g. the reply could not be sent.
+  }
+  finish(finalState);
+}
+
+/*----------------------------------------------------------------------
+** Public methods (called from other threads).
+*/
+
+/**
+ * getState
+ * @return State - ACTIVE until the run method finishes.
+ */
+CFragmentReceiver::State
+CFragmentReceiver::getState()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_state;
+}
+/**
+ * getStatistics
+ * @return Statistics - a snapshot of the receive statistics.
+ */
+CFragmentReceiver::Statistics
+CFragmentReceiver::getStatistics()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_statistics;
+}
+/**
+ * isStopping
+ * @return bool - true if stop has been called.
+ */
+bool
+CFragmentReceiver::isStopping()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_stopping;
+}
+/**
+ * setFlow
+ *   Turn the reception of messages on or off.
+ *
+ * @param on - true to receive messages.
+ */
+void
+CFragmentReceiver::setFlow(bool on)
+{
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_flowOn = on;
+    m_wakeup.notify_one();
+  }
+  if (on) sendCredits(takeCredits());
+}
+/**
+ * batchDone
+ *   The sink is done with one of our batches.  For windowed clients
+ *   that's a credit we can return (unless we're flowed off).
+ */
+void
+CFragmentReceiver::batchDone()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_pending) m_pending--;
+    if (m_window > 1) m_withheld++;
+    m_wakeup.notify_one();
+  }
+  sendCredits(takeCredits());
+}
+/**
+ * stop
+ *   Ask the thread to exit.  Any blocking read is broken by shutting the
+ *   socket down.  The thread still delivers its final (null) batch.
+ */
+void
+CFragmentReceiver::stop()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_stopping = true;
+  shutdown(m_fd, SHUT_RDWR);
+  m_wakeup.notify_one();
+}
+/**
+ * stateName
+ *   @return const char* - the connection state name matching the
+ *                         ConnectionManager's names for the state.
+ */
+const char*
+CFragmentReceiver::stateName(State state)
+{
+  switch (state) {
+  case ACTIVE:
+    return "ACTIVE";
+  case CLOSED:
+    return "CLOSED";
+  case LOST:
+    return "LOST";
+  case ERROR:
+  default:
+    return "ERROR";
+  }
+}
+
+/*----------------------------------------------------------------------
+** Private utilities.
+*/
+
+/**
+ * waitForRoom
+ *   Block until we are flowed on and the sink does not have too many of our
+ *   batches.
+ *
+ * @return bool - false if we should stop instead.
+ *
+ * @note Windowed clients are never blocked here; they can't send more
+ *       than their window and are throttled by the credits instead.
+ */
+bool
+CFragmentReceiver::waitForRoom()
+{
+  std::unique_lock<std::mutex> guard(m_lock);
+  while (!m_stopping && (m_window == 1) &&
+         (!m_flowOn || (m_pending >= MAX_PENDING_BATCHES))) {
+    m_wakeup.wait(guard);
+  }
+  return !m_stopping;
+}
+/**
+ * readFully
+ *   Read a fixed number of bytes, first from the prefix, then from the
+ *   socket.
+ *
+ * @param pBuffer - where the data goes.
+ * @param nBytes  - Number of bytes to read.
+ * @return bool   - false on end of file or error.
+ */
+bool
+CFragmentReceiver::readFully(void* pBuffer, size_t nBytes)
+{
+  uint8_t* p = reinterpret_cast<uint8_t*>(pBuffer);
+
+  size_t nPrefix = m_prefix.size() - m_prefixUsed;
+  if (nPrefix) {
+    if (nPrefix > nBytes) nPrefix = nBytes;
+    memcpy(p, m_prefix.data() + m_prefixUsed, nPrefix);
+    m_prefixUsed += nPrefix;
+    p            += nPrefix;
+    nBytes       -= nPrefix;
+  }
+  while (nBytes) {
+    ssize_t n = read(m_fd, p, nBytes);
+    if (n > 0) {
+      p      += n;
+      nBytes -= n;
+    } else if ((n < 0) && (errno == EINTR)) {
+      continue;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+/**
+ * reply
+ *   Send a reply line to the source.
+ *
+ * @param pMessage - the reply including its newline.
+ * @throw const char* - if the send fails.
+ */
+void
+CFragmentReceiver::reply(const char* pMessage)
+{
+  std::lock_guard<std::mutex> guard(m_sendLock);
+  size_t      nBytes = strlen(pMessage);
+  const char* p      = pMessage;
+  while (nBytes) {
+    ssize_t n = send(m_fd, p, nBytes, MSG_NOSIGNAL);
+    if (n > 0) {
+      p      += n;
+      nBytes -= n;
+    } else if ((n < 0) && (errno == EINTR)) {
+      continue;
+    } else {
+      throw "Positive ACK (OK) send failed";
+    }
+  }
+}
+/**
+ * finish
+ *   Record the final state and hand the sink our null batch.
+ *
+ * @param state - final state.
+ */
+void
+CFragmentReceiver::finish(State state)
+{
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_state = state;
+  }
+  Batch batch = {this, 0, 0};
+  m_sink.put(batch);
+}
+/**
+ * takeCredits
+ *   @return unsigned - the credits we can return now (none if flowed off).
+ *                      These are no longer in flight.
+ */
+unsigned
+CFragmentReceiver::takeCredits()
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  unsigned result = 0;
+  if (m_flowOn) {
+    result      = m_withheld;
+    m_inFlight -= result;
+    m_withheld  = 0;
+  }
+  return result;
+}
+/**
+ * sendCredits
+ *   Return credits to the client.  This is called from the sink's thread,
+ *   so send failures are left for the receiver thread to discover.
+ *
+ * @param nCredits - number of credits to return.
+ */
+void
+CFragmentReceiver::sendCredits(unsigned nCredits)
+{
+  if (nCredits) {
+    char message[100];
+    snprintf(message, sizeof(message), "CREDIT %u\n", nCredits);
+    try {
+      reply(message);
+    }
+    catch (...) {
+    }
+  }
+}
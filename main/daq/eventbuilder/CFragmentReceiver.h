@@ -0,0 +1,149 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CFragmentReceiver.h
+ * @brief Thread that receives fragment messages from one data source.
+ */
+#ifndef CFRAGMENTRECEIVER_H
+#define CFRAGMENTRECEIVER_H
+
+#include "fragment.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @class CFragmentReceiver
+ *
+ *   Once the connection manager has handled a data source's CONNECT
+ *   message, the rest of the conversation (FRAGMENTS and DISCONNECT
+ *   messages) can be handled by one of these threads rather than
+ *   by Tcl file events in the interpreter thread.  The thread:
+ *
+ *   - Reads each message header and reads FRAGMENTS bodies directly
+ *     into a fragment block.
+ *   - Acknowledges the message (OK) so the source can send the next one.
+ *   - Hands the block to a Sink, which is responsible for getting the
+ *     fragments to the fragment handler (in the interpreter thread).
+ *
+ *   When the peer disconnects (or is lost, or breaks the protocol), the
+ *   sink gets a batch with no block.  The thread is then finished and
+ *   can be joined.  The thread is a std::thread rather than a Thread
+ *   because its owner deletes us as soon as it has joined, and that must not
+ *   race with the thread's exit.
+ *
+ *   Flow control:  While flowed off or while the sink holds
+ *   MAX_PENDING_BATCHES of our batches, no more messages are read.
+ *   The source then blocks in TCP, just as it does when the Tcl connection
+ *   turns off its file event.
+ *
+ *   Windowed clients (see CEventOrderClient::setWindow) are not acked per
+ *   message.  They may have up to window messages in flight and we return
+ *   credits ("CREDIT n") as the sink finishes with batches.  Flow control
+ *   then consists of withholding the credits while flowed off.
+ */
+class CFragmentReceiver
+{
+public:
+  typedef enum _State {
+    ACTIVE, CLOSED, LOST, ERROR
+  } State;
+
+  typedef struct _Batch {
+    CFragmentReceiver*  s_pReceiver;
+    EVB::pFragmentBlock s_pBlock;        // null if the receiver is done.
+    size_t              s_nBytes;        // Bytes of fragments in the block.
+  } Batch, *pBatch;
+
+  /**
+   * Receives the batches.  put is called in the receiver's thread.
+   * Each batch with a block must eventually be followed by a call to the
+   * receiver's batchDone.
+   */
+  class Sink {
+  public:
+    virtual ~Sink() {}
+    virtual void put(const Batch& batch) = 0;
+  };
+
+  typedef struct _Statistics {
+    time_t   s_lastReceived;        // When the last FRAGMENTS message came in.
+    uint64_t s_messages;            // FRAGMENTS messages received.
+    uint64_t s_bytes;               // Bytes of fragments received.
+  } Statistics, *pStatistics;
+
+  static const size_t MAX_PENDING_BATCHES = 8;
+
+private:
+  std::thread             m_thread;
+  std::string             m_socketName;
+  int                     m_fd;
+  Sink&                   m_sink;
+  std::vector<uint8_t>    m_prefix;      // Data the Tcl channel had buffered.
+  size_t                  m_prefixUsed;
+  unsigned                m_window;      // 1 - ack each message with OK.
+
+  std::mutex              m_lock;        // Protects the rest.
+  std::condition_variable m_wakeup;
+  bool                    m_flowOn;
+  bool                    m_stopping;
+  size_t                  m_pending;
+  unsigned                m_inFlight;    // Windowed: received but not credited.
+  unsigned                m_withheld;    // Windowed: credits not yet sent.
+  std::mutex              m_sendLock;    // Serializes replies.
+  State                   m_state;
+  Statistics              m_statistics;
+
+public:
+  CFragmentReceiver(
+    std::string socketName, int fd, Sink& sink,
+    const void* pPrefix = 0, size_t nPrefix = 0, unsigned window = 1
+  );
+  virtual ~CFragmentReceiver();
+private:
+  CFragmentReceiver(const CFragmentReceiver&);
+  CFragmentReceiver& operator=(const CFragmentReceiver&);
+
+public:
+  void start();
+  void join();
+
+  std::string getSocketName() const { return m_socketName; }
+  State       getState();
+  Statistics  getStatistics();
+  bool        isStopping();
+
+  void setFlow(bool on);
+  void batchDone();
+  void stop();
+
+  static const char* stateName(State state);
+
+private:
+  void run();
+  bool waitForRoom();
+  bool readFully(void* pBuffer, size_t nBytes);
+  void reply(const char* pMessage);
+  void finish(State state);
+  unsigned takeCredits();
+  void sendCredits(unsigned nCredits);
+};
+
+#endif
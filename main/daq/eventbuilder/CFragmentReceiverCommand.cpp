@@ -0,0 +1,416 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CFragmentReceiverCommand.cpp
+ * @brief Implementation of the EVB::receiver command.
+ */
+#include "CFragmentReceiverCommand.h"
+#include "CFragmentHandler.h"
+#include "fragment.h"
+#include <TCLInterpreter.h>
+#include <TCLObject.h>
+#include <Exception.h>
+#include <ErrnoException.h>
+
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <iostream>
+#include <unistd.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------
+** Canonical method implementations.
+*/
+
+/**
+ * constructor
+ *
+ *   Registers the command.  Receiver batches are delivered to the thread
+ *   that constructs us, which must therefore be the interpreter's thread.
+ *
+ * @param interp - reference to the encapsulated interpreter.
+ * @param name   - Command name.
+ */
+CFragmentReceiverCommand::CFragmentReceiverCommand(
+  CTCLInterpreter& interp, std::string name
+) :
+  CTCLObjectProcessor(interp, name),
+  m_eventQueued(false),
+  m_interpThread(Tcl_GetCurrentThread())
+{
+}
+/**
+ * destructor
+ *   Stop and join all receivers and release any batches they left us.
+ */
+CFragmentReceiverCommand::~CFragmentReceiverCommand()
+{
+  for (auto p = m_connections.begin(); p != m_connections.end(); p++) {
+    p->first->stop();
+    p->first->join();
+  }
+  std::list<CFragmentReceiver::Batch> batches = m_batches.getAll();
+  for (auto p = batches.begin(); p != batches.end(); p++) {
+    if (p->s_pBlock) releaseFragmentBlock(p->s_pBlock);
+  }
+  for (auto p = m_connections.begin(); p != m_connections.end(); p++) {
+    delete p->first;
+  }
+}
+
+/*---------------------------------------------------------------------------
+** public interface
+*/
+
+/**
+ * operator()
+ *   Dispatch to the subcommand processors.
+ *
+ * @param interp - the interpreter that is running the command.
+ * @param objv   - The command words.
+ * @return int   - TCL_OK on success, TCL_ERROR on failure with the
+ *                 reason in the interpreter result.
+ */
+int
+CFragmentReceiverCommand::operator()(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  try {
+    requireAtLeast(objv, 2, "Missing subcommand");
+    bindAll(interp, objv);
+    std::string subcommand = objv[1];
+
+    if (subcommand == "start") {
+      start(interp, objv);
+    } else if (subcommand == "flow") {
+      flow(interp, objv);
+    } else if (subcommand == "stop") {
+      stop(interp, objv);
+    } else if (subcommand == "stats") {
+      stats(interp, objv);
+    } else {
+      std::string errorMessage = "Illegal subcommand: ";
+      errorMessage += subcommand;
+      throw errorMessage;
+    }
+  }
+  catch (std::string msg) {
+    interp.setResult(msg);
+    return TCL_ERROR;
+  }
+  catch (const char* pMsg) {
+    interp.setResult(pMsg);
+    return TCL_ERROR;
+  }
+  catch (CException& e) {
+    interp.setResult(e.ReasonText());
+    return TCL_ERROR;
+  }
+  catch (...) {
+    interp.setResult("Unanticipated error type in CFragmentReceiverCommand::operator()");
+    return TCL_ERROR;
+  }
+  return TCL_OK;
+}
+/**
+ * put
+ *   Called in a receiver thread to pass a batch to the interpreter thread.
+ *   Only one event is outstanding at a time; it processes everything
+ *   queued by the time it runs.
+ *
+ * @param batch - the batch.
+ */
+void
+CFragmentReceiverCommand::put(const CFragmentReceiver::Batch& batch)
+{
+  m_batches.queue(batch);
+  if (!m_eventQueued.exchange(true)) {
+    pReceiveEvent pEvent =
+      reinterpret_cast<pReceiveEvent>(Tcl_Alloc(sizeof(ReceiveEvent)));
+    pEvent->s_event.proc    = receiveEvent;
+    pEvent->s_event.nextPtr = NULL;
+    pEvent->s_pCommand      = this;
+
+    Tcl_ThreadQueueEvent(
+      m_interpThread, reinterpret_cast<Tcl_Event*>(pEvent), TCL_QUEUE_TAIL
+    );
+    Tcl_ThreadAlert(m_interpThread);
+  }
+}
+
+/*---------------------------------------------------------------------------
+** Subcommands
+*/
+
+/**
+ * start
+ *   EVB::receiver start socket fragmentScript closeScript ?window?
+ *
+ *   The receiver gets its own duplicate of the socket's file descriptor
+ *   along with anything the Tcl channel has already buffered.  The caller
+ *   must have removed any readable file event from the socket.
+ *   window is the credit window the client was granted in its CONNECT
+ *   reply (default 1 - OK each message).
+ */
+void
+CFragmentReceiverCommand::start(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  requireAtLeast(objv, 5, "Usage: EVB::receiver start socket fragmentScript closeScript ?window?");
+  requireAtMost(objv, 6, "Usage: EVB::receiver start socket fragmentScript closeScript ?window?");
+  std::string socket = objv[2];
+  int         window = 1;
+  if (objv.size() == 6) {
+    window = objv[5];
+    if (window <= 0) {
+      throw std::string("Credit window must be > 0");
+    }
+  }
+  if (m_sockets.count(socket)) {
+    throw std::string("A receiver is already running for ") + socket;
+  }
+
+  Tcl_Channel channel = Tcl_GetChannel(interp.getInterpreter(), socket.c_str(), NULL);
+  if (!channel) {
+    throw std::string("Tcl does not know about this channel name: ") + socket;
+  }
+  ClientData handle;
+  if (Tcl_GetChannelHandle(channel, TCL_READABLE, &handle) != TCL_OK) {
+    throw std::string("Unable to get the file descriptor for ") + socket;
+  }
+  int fd = dup(static_cast<int>(reinterpret_cast<intptr_t>(handle)));
+  if (fd < 0) {
+    throw CErrnoException("Duplicating a data source socket");
+  }
+
+  // Drain what Tcl has buffered - the channel is blocking but we only read
+  // what's already there.
+
+  std::vector<char> prefix(Tcl_InputBuffered(channel));
+  if (prefix.size() &&
+      (Tcl_Read(channel, prefix.data(), prefix.size()) != prefix.size())) {
+    close(fd);
+    throw std::string("Unable to drain buffered input from ") + socket;
+  }
+
+  CFragmentReceiver* pReceiver =
+    new CFragmentReceiver(
+      socket, fd, *this, prefix.data(), prefix.size(), window
+    );
+  Connection connection = {
+    socket, std::string(objv[3]), std::string(objv[4])
+  };
+  m_sockets[socket]         = pReceiver;
+  m_connections[pReceiver]  = connection;
+  pReceiver->start();
+}
+/**
+ * flow
+ *    EVB::receiver flow socket on|off
+ */
+void
+CFragmentReceiverCommand::flow(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  requireExactly(objv, 4, "Usage: EVB::receiver flow socket on|off");
+  std::string state = objv[3];
+  if ((state != "on") && (state != "off")) {
+    throw std::string("Flow state must be 'on' or 'off' was: ") + state;
+  }
+  findReceiver(objv[2])->setFlow(state == "on");
+}
+/**
+ * stop
+ *    EVB::receiver stop socket
+ *
+ *    The receiver is forgotten immediately; it is joined and deleted
+ *    when its final batch arrives.
+ */
+void
+CFragmentReceiverCommand::stop(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  requireExactly(objv, 3, "Usage: EVB::receiver stop socket");
+  std::string socket = objv[2];
+  auto p = m_sockets.find(socket);
+  if (p != m_sockets.end()) {
+    p->second->stop();
+    m_sockets.erase(p);
+  }
+}
+/**
+ * stats
+ *    EVB::receiver stats
+ *
+ *    Result is a list of {socket state lastReceived messages bytes}.
+ */
+void
+CFragmentReceiverCommand::stats(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  requireExactly(objv, 2, "Usage: EVB::receiver stats");
+
+  CTCLObject result;
+  result.Bind(interp);
+  CTCLObject wideInt;
+  wideInt.Bind(interp);
+
+  for (auto p = m_sockets.begin(); p != m_sockets.end(); p++) {
+    CFragmentReceiver::Statistics stats = p->second->getStatistics();
+    CTCLObject item;
+    item.Bind(interp);
+
+    item   += p->first;
+    item   += std::string(CFragmentReceiver::stateName(p->second->getState()));
+    wideInt = (Tcl_WideInt)(stats.s_lastReceived);
+    item   += wideInt;
+    wideInt = (Tcl_WideInt)(stats.s_messages);
+    item   += wideInt;
+    wideInt = (Tcl_WideInt)(stats.s_bytes);
+    item   += wideInt;
+
+    result += item;
+  }
+  interp.setResult(result);
+}
+
+/*---------------------------------------------------------------------------
+** Private utilities.
+*/
+
+/**
+ * findReceiver
+ * @param socket - socket name.
+ * @return CFragmentReceiver* - the socket's running receiver.
+ * @throw std::string - if there is none.
+ */
+CFragmentReceiver*
+CFragmentReceiverCommand::findReceiver(const std::string& socket)
+{
+  auto p = m_sockets.find(socket);
+  if (p == m_sockets.end()) {
+    throw std::string("No receiver is running for ") + socket;
+  }
+  return p->second;
+}
+/**
+ * isRegistered
+ * @param pReceiver - a receiver.
+ * @return bool - true if the receiver has not been stopped by a command
+ *                (its scripts should still run).
+ */
+bool
+CFragmentReceiverCommand::isRegistered(CFragmentReceiver* pReceiver)
+{
+  auto p = m_sockets.find(pReceiver->getSocketName());
+  return (p != m_sockets.end()) && (p->second == pReceiver);
+}
+/**
+ * processBatches
+ *   Runs in the interpreter thread.  Queue the fragments in all available
+ *   batches, run the fragment scripts of the receivers that had data, then
+ *   finish off receivers that are done.
+ */
+void
+CFragmentReceiverCommand::processBatches()
+{
+  m_eventQueued = false;                  // Later puts need a new event.
+  std::list<CFragmentReceiver::Batch> batches = m_batches.getAll();
+
+  CFragmentHandler*               pHandler = CFragmentHandler::getInstance();
+  std::vector<CFragmentReceiver*> delivered;
+  std::vector<CFragmentReceiver*> finished;
+
+  for (auto p = batches.begin(); p != batches.end(); p++) {
+    CFragmentReceiver* pReceiver = p->s_pReceiver;
+    if (!p->s_pBlock) {
+      finished.push_back(pReceiver);
+      continue;
+    }
+    try {
+      pHandler->addFragments(
+        p->s_nBytes, reinterpret_cast<const EVB::FlatFragment*>(p->s_pBlock->s_pData),
+        p->s_pBlock
+      );
+    }
+    catch (...) {
+      std::cerr << "Event orderer failed to queue fragments from "
+                << pReceiver->getSocketName() << " - dropping the connection\n";
+      pReceiver->stop();                 // Still registered so close script runs.
+    }
+    releaseFragmentBlock(p->s_pBlock);
+    pReceiver->batchDone();
+    if (std::find(delivered.begin(), delivered.end(), pReceiver) == delivered.end()) {
+      delivered.push_back(pReceiver);
+    }
+  }
+
+  for (size_t i = 0; i < delivered.size(); i++) {
+    if (isRegistered(delivered[i])) {
+      runScript(m_connections[delivered[i]].s_fragmentScript);
+    }
+  }
+
+  for (size_t i = 0; i < finished.size(); i++) {
+    CFragmentReceiver* pReceiver = finished[i];
+    Connection connection        = m_connections[pReceiver];
+    bool       registered        = isRegistered(pReceiver);
+    std::string state            = CFragmentReceiver::stateName(pReceiver->getState());
+
+    pReceiver->join();
+    m_connections.erase(pReceiver);
+    if (registered) m_sockets.erase(connection.s_socket);
+    delete pReceiver;
+
+    if (registered) {
+      runScript(connection.s_closeScript + " " + state);
+    }
+  }
+}
+/**
+ * runScript
+ *   Run a callback script at global level.  Errors are background errors.
+ *
+ * @param script - the script.
+ */
+void
+CFragmentReceiverCommand::runScript(const std::string& script)
+{
+  Tcl_Interp* pInterp = getInterpreter()->getInterpreter();
+  if (Tcl_EvalEx(pInterp, script.c_str(), -1, TCL_EVAL_GLOBAL) != TCL_OK) {
+    Tcl_BackgroundError(pInterp);
+  }
+}
+/**
+ * receiveEvent
+ *   Tcl event handler queued by put.
+ *
+ * @param pEvent - actually a pReceiveEvent.
+ * @param flags  - event flags (unused).
+ * @return int   - 1, the event is always processed.
+ */
+int
+CFragmentReceiverCommand::receiveEvent(Tcl_Event* pEvent, int flags)
+{
+  pReceiveEvent pReceive = reinterpret_cast<pReceiveEvent>(pEvent);
+  pReceive->s_pCommand->processBatches();
+  return 1;
+}
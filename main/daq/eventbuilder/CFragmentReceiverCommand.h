@@ -0,0 +1,122 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CFragmentReceiverCommand.h
+ * @brief Defines the class that implements the EVB::receiver command.
+ */
+#ifndef CFRAGMENTRECEIVERCOMMAND_H
+#define CFRAGMENTRECEIVERCOMMAND_H
+
+#include <TCLObjectProcessor.h>
+#include <CBufferQueue.h>
+#include "CFragmentReceiver.h"
+#include <tcl.h>
+
+#include <string>
+#include <map>
+#include <atomic>
+
+// forward definitions
+
+class CTCLInterpreter;
+class CTCLObject;
+
+/**
+ * @class CFragmentReceiverCommand
+ *
+ *   Hands the data transfer part of a data source connection to a
+ *   CFragmentReceiver thread.  The Tcl connection object still does the
+ *   CONNECT negotiation, flow control and timeout bookkeeping; the
+ *   receiver threads read, acknowledge and buffer FRAGMENTS messages.
+ *   Batches from all receivers are passed back to the interpreter thread
+ *   with Tcl events and given to the fragment handler there.
+ *
+ * \verbatim
+ *   EVB::receiver start socket fragmentScript closeScript ?window?
+ *   EVB::receiver flow  socket on|off
+ *   EVB::receiver stop  socket
+ *   EVB::receiver stats
+ * \endverbatim
+ *
+ *  - start - socket has completed its CONNECT.  fragmentScript is run
+ *            (at global level) after fragments from the socket have been
+ *            queued to the fragment handler.  closeScript is run with the
+ *            final connection state (CLOSED, LOST or ERROR) appended when the
+ *            peer disconnects.  window is the credit window granted to the
+ *            client (1, the default, acks each message instead).
+ *  - flow  - Turns reception from the socket on or off.
+ *  - stop  - Stops the receiver without running its closeScript.  It is not
+ *            an error to stop a socket whose receiver has already finished.
+ *  - stats - Returns a list with one element per receiver:
+ *            {socket state lastReceived messages bytes}
+ */
+class CFragmentReceiverCommand : public CTCLObjectProcessor,
+                                 public CFragmentReceiver::Sink
+{
+private:
+  typedef struct _Connection {
+    std::string s_socket;
+    std::string s_fragmentScript;
+    std::string s_closeScript;
+  } Connection, *pConnection;
+
+  typedef struct _ReceiveEvent {
+    Tcl_Event                 s_event;
+    CFragmentReceiverCommand* s_pCommand;
+  } ReceiveEvent, *pReceiveEvent;
+
+  std::map<std::string, CFragmentReceiver*> m_sockets;     // Running receivers.
+  std::map<CFragmentReceiver*, Connection>  m_connections; // Not yet joined.
+  CBufferQueue<CFragmentReceiver::Batch>    m_batches;
+  std::atomic<bool>                         m_eventQueued;
+  Tcl_ThreadId                              m_interpThread;
+
+  // Implemented canonicals:
+
+public:
+  CFragmentReceiverCommand(CTCLInterpreter& interp, std::string name);
+  virtual ~CFragmentReceiverCommand();
+
+  // canonicals that are forbidden:
+
+private:
+  CFragmentReceiverCommand(const  CFragmentReceiverCommand&);
+  CFragmentReceiverCommand& operator=(const  CFragmentReceiverCommand&);
+  int operator==(const  CFragmentReceiverCommand&) const;
+  int operator!=(const  CFragmentReceiverCommand&) const;
+
+  // public methods (command implementation):
+
+public:
+  int operator()(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+  virtual void put(const CFragmentReceiver::Batch& batch);   // Receiver threads.
+
+  // Subcommands and utilities:
+
+private:
+  void start(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+  void flow(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+  void stop(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+  void stats(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+
+  CFragmentReceiver* findReceiver(const std::string& socket);
+  bool isRegistered(CFragmentReceiver* pReceiver);
+  void processBatches();
+  void runScript(const std::string& script);
+
+  static int receiveEvent(Tcl_Event* pEvent, int flags);
+};
+
+#endif
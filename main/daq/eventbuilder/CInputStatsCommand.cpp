@@ -15,6 +15,7 @@
 */
 #include "CInputStatsCommand.h"
 #include "CFragmentHandler.h"
+#include "fragment.h"
 
 #include <TCLInterpreter.h>
 #include <TCLObject.h>
@@ -131,6 +132,25 @@ CInputStatsCommand::operator()(CTCLInterpreter& interp, std::vector<CTCLObject>&
 
   wideInt = (Tcl_WideInt)stats.s_inflight;  // 4
   result += wideInt;                       // Total in flight frags.
+
+  // Fragment allocator statistics:
+
+  EVB::FragmentPoolStatistics poolStats;
+  getFragmentPoolStatistics(&poolStats);
+
+  CTCLObject PoolStatList;                  // 5
+  PoolStatList.Bind(interp);
+  uint64_t poolValues[] = {
+    poolStats.s_allocations, poolStats.s_poolHits, poolStats.s_slabs,
+    poolStats.s_slabBytes, poolStats.s_inUse, poolStats.s_freeBlocks,
+    poolStats.s_freeBytes, poolStats.s_referenced, poolStats.s_blocksInUse,
+    poolStats.s_blockBytes
+  };
+  for (int i = 0; i < sizeof(poolValues)/sizeof(uint64_t); i++) {
+    wideInt       = (Tcl_WideInt)(poolValues[i]);
+    PoolStatList += wideInt;
+  }
+  result += PoolStatList;
   
   interp.setResult(result);
   return TCL_OK;
@@ -35,7 +35,8 @@ class CTCLObject;
  *     describe the queues in a summary way.
  *     The command returns a list of the following form:
  * \verbatim
- *   {oldestTimestamp newestTimestamp totalFragcount queue-statistics}
+ *   {oldestTimestamp newestTimestamp totalFragcount queue-statistics inflight
+ *    allocator-statistics}
  * \endverbatim
  *    Where:
  *    - oldestTimestamp is the timestamp of the oldest queued fragment and
@@ -51,6 +52,19 @@ class CTCLObject;
  *      # bytes - the number of bytes in the queue.
  *      # dequeued -Number of bytes dequeued from the queue.
  *      # totalqueued - Cumulative bytes that have been put in the queue.
+ *    - inflight is the number of fragments queued to the output thread.
+ *    - allocator-statistics is a list describing the fragment storage pools
+ *      (see EVB::FragmentPoolStatistics):
+ *      # allocations - fragments allocated.
+ *      # hits        - allocations satisfied from a pool.
+ *      # slabs       - slabs malloced to fill the pools.
+ *      # slabbytes   - bytes in those slabs.
+ *      # inuse       - fragments allocated and not yet freed.
+ *      # freeblocks  - fragment bodies in the pools.
+ *      # freebytes   - bytes in those bodies.
+ *      # referenced  - fragments made by reference to a received block.
+ *      # blocks      - received blocks still referenced.
+ *      # blockbytes  - bytes in those blocks.
  *
  */
 class CInputStatsCommand : public CTCLObjectProcessor 
@@ -157,6 +157,7 @@ COutputThread::getFragments()
  * @note  There are two strong assumptions made by this method:
  *        *  The fragments are all dynamically allocated.
  *        *  The vector itself was dynamically allocated:
+ * @note  The whole batch goes back to the fragment pools with one lock.
  */
 void
 COutputThread::freeFragments(EvbFragments* frags)
@@ -164,14 +165,15 @@ COutputThread::freeFragments(EvbFragments* frags)
     auto& fs(*frags);
     // free storage associated with each fragment.
     
-    unsigned freed = 0;
+    m_freeList.clear();
     for (auto p = fs.begin(); p != fs.end(); p++) {
-        EVB::pFragment frag = p->second;
-        freeFragment(frag);
-        freed++;
+        m_freeList.push_back(p->second);
+    }
+    if (!m_freeList.empty()) {
+        freeFragmentList(m_freeList.data(), m_freeList.size());
     }
     if (debug) {
-        std::cerr << "Counted " << freed << " Fragments freed\n";
+        std::cerr << "Counted " << m_freeList.size() << " Fragments freed\n";
     }
     fs.clear();                        // Probably not needed but not harmful.
     // and now the vector itself:
@@ -28,7 +28,7 @@
 #include <vector>
 #include "fragment.h"
 #include <CMutex.h>
-#include <CBufferQueue.h>
+#include <CLockFreeQueue.h>
 #include <atomic>
 
 /**
@@ -37,7 +37,7 @@
  *     event ordering stage of the event builder.  The thread contains
  *     a thread safe queue of pointers to vectors of ordered fragments
  *     and an ordered list of observers.  A mutex protects the list of observers.
- *     The queue has its own mutex/condition variable.
+ *     The queue is lock free; only the sort thread queues to it.
  *
  *     The action of the thread is to get vectors of fragments fromt its thread
  *     safe queue and pass them on to the ordered lists of observers.  Each observer
@@ -58,7 +58,7 @@ class COutputThread : public Thread
 private:
     // Buffer queue between the fragment source and us:
     
-    CBufferQueue<EvbFragments*> m_inputQueue;
+    CSPSCQueue<EvbFragments*> m_inputQueue;
     
     // The mutex guard and the list of observers it guards:
     
@@ -69,6 +69,10 @@ private:
     
     std::atomic<size_t>   m_nInflightCount;
     
+    // Fragments of a batch being released (kept to avoid reallocation):
+    
+    std::vector<EVB::pFragment> m_freeList;
+    
 public:
     COutputThread();
     virtual ~COutputThread();
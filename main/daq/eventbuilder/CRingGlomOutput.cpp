@@ -0,0 +1,484 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CRingGlomOutput.cpp
+ * @brief Implement the orderer output stage that builds events into a ring.
+ */
+#include "CRingGlomOutput.h"
+#include "fragment.h"
+#include <CRingItemFactory.h>
+#include <CRingScalerItem.h>
+#include <CRingPhysicsEventCountItem.h>
+#include <CAbnormalEndItem.h>
+
+#include <iostream>
+#include <string>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const size_t MaxBatch(64*1024);   // Reservations are multiples of this.
+
+/*------------------------------------------------------------------------
+** RingWriter
+*/
+
+/**
+ * constructor
+ *
+ * @param ring - ring we write into (we must be its producer).
+ */
+CRingGlomOutput::RingWriter::RingWriter(CRingBuffer& ring) :
+  m_ring(ring), m_reserved(0), m_written(0), m_itemStart(0), m_complete(0)
+{
+  memset(&m_space, 0, sizeof(m_space));
+  m_batch = ring.getUsage().s_bufferSpace/16;
+  if (m_batch > MaxBatch) m_batch = MaxBatch;
+  if (m_batch == 0)       m_batch = 1;
+}
+/**
+ * begin
+ *   Start an item at the current write position.
+ */
+void
+CRingGlomOutput::RingWriter::begin()
+{
+  m_itemStart = m_written;
+}
+/**
+ * append
+ *   Append data to the item being written.
+ *
+ * @param pData  - data to add.
+ * @param nBytes - bytes of data.
+ */
+void
+CRingGlomOutput::RingWriter::append(const void* pData, size_t nBytes)
+{
+  ensure(m_written + nBytes);
+  m_space.copyIn(m_written, pData, nBytes);
+  m_written += nBytes;
+}
+/**
+ * patch
+ *   Overwrite part of the item being written (e.g. its header once its
+ *   size is known).
+ *
+ * @param offset - offset of the data from the start of the item.
+ * @param pData  - new data.
+ * @param nBytes - bytes of data.
+ */
+void
+CRingGlomOutput::RingWriter::patch(size_t offset, const void* pData, size_t nBytes)
+{
+  ensure(m_written);
+  m_space.copyIn(m_itemStart + offset, pData, nBytes);
+}
+/**
+ * end
+ *   The item being written is complete and can be committed.
+ */
+void
+CRingGlomOutput::RingWriter::end()
+{
+  m_complete  = m_written;
+  m_itemStart = m_written;
+}
+/**
+ * publish
+ *   Commit the complete items.  An item still being written stays where it
+ *   is; it's now at the start of the (stale) reservation.
+ *
+ * @return size_t - number of bytes committed.
+ */
+size_t
+CRingGlomOutput::RingWriter::publish()
+{
+  size_t result = m_complete;
+  if (m_complete) {
+    m_ring.commit(m_complete);
+    m_written   -= m_complete;
+    m_itemStart -= m_complete;
+    m_complete   = 0;
+    m_reserved   = 0;		// Put pointer moved so re-reserve.
+  }
+  return result;
+}
+/**
+ * ensure
+ *   Make sure the reservation covers nBytes.  The reservation is nBytes
+ *   rounded up to a batch so that reserve doesn't wait for much more free
+ *   space than is needed, yet items smaller than a batch don't each need
+ *   their own reserve.  If the item being written can't fit in a batch
+ *   along with the complete items before it, those are committed first so
+ *   the reservation need never be much larger than the item.
+ *
+ * @param nBytes - Bytes we need from the put pointer.
+ * @throw std::string - the item won't fit in the ring at all.
+ */
+void
+CRingGlomOutput::RingWriter::ensure(size_t nBytes)
+{
+  if (nBytes <= m_reserved) return;
+
+  if (m_complete && (nBytes > m_batch)) {
+    nBytes -= m_complete;
+    publish();
+  }
+  size_t ringSize = m_ring.getUsage().s_bufferSpace;
+  if (nBytes >= ringSize) {
+    throw std::string("Item being built won't fit in the output ring");
+  }
+  size_t request = ((nBytes + m_batch - 1)/m_batch)*m_batch;
+  if (request >= ringSize) request = ringSize - 1;
+  m_ring.reserve(request, m_space);
+  m_reserved = request;
+}
+
+/*------------------------------------------------------------------------
+** Canonicals.
+*/
+
+/**
+ * constructor
+ *   Attach to the rings as producer (creating them if need be), output the
+ *   ring format item glom would and register as a fragment handler observer.
+ *
+ * @param ringName        - Output ring for built events.
+ * @param teeRingName     - If not null, ring that gets the fragments.
+ * @param dt              - Coincidence window in ticks.
+ * @param nobuild         - If true each fragment is an event.
+ * @param sourceId        - Source id for built events.
+ * @param timestampPolicy - GLOM_TIMESTAMP_* value.
+ * @param maxFragments    - Most fragments in an event.
+ */
+CRingGlomOutput::CRingGlomOutput(
+  const char* ringName, const char* teeRingName,
+  uint64_t dt, bool nobuild, uint32_t sourceId, int timestampPolicy,
+  unsigned maxFragments
+) :
+  m_pRing(CRingBuffer::createAndProduce(ringName)),
+  m_pTeeRing(0),
+  m_writer(*m_pRing),
+  m_pTeeWriter(0),
+  m_dt(dt), m_nobuild(nobuild), m_sourceId(sourceId),
+  m_tsPolicy(timestampPolicy), m_maxFragments(maxFragments),
+  m_building(false), m_firstTimestamp(0), m_lastTimestamp(0),
+  m_timestampSum(0), m_fragmentCount(0),
+  m_firstBarrier(true), m_stateChangeNesting(0), m_outputEvents(0),
+  m_bytesCommitted(0)
+{
+  if (teeRingName) {
+    m_pTeeRing   = CRingBuffer::createAndProduce(teeRingName);
+    m_pTeeWriter = new RingWriter(*m_pTeeRing);
+  }
+  pDataFormat pFormat = formatDataFormat();
+  outputItem(pFormat, pFormat->s_header.s_size);
+  free(pFormat);
+  publish();
+
+  CFragmentHandler::getInstance()->addObserver(this);
+}
+/**
+ * destructor
+ *   Stop observing, finish up and detach from the rings.  Once
+ *   removeObserver returns the output thread is done with us.
+ */
+CRingGlomOutput::~CRingGlomOutput()
+{
+  CFragmentHandler::getInstance()->removeObserver(this);
+  finish();
+  delete m_pTeeWriter;
+  delete m_pTeeRing;
+  delete m_pRing;
+}
+
+/*------------------------------------------------------------------------
+** Public methods
+*/
+
+/**
+ * operator()
+ *   Called in the output thread with a batch of ordered fragments.
+ *   Each is handled as glom would, and the complete items are committed
+ *   at the end.
+ *
+ * @param event - the fragments.
+ */
+void
+CRingGlomOutput::operator()(const EvbFragments& event)
+{
+  for (auto p = event.begin(); p != event.end(); p++) {
+    processFragment(p->second);
+  }
+  publish();
+}
+/**
+ * finish
+ *   What glom does at end of file: output the event being built and, if
+ *   a run is in progress, an abnormal end item.
+ */
+void
+CRingGlomOutput::finish()
+{
+  flushEvent();
+  if (m_stateChangeNesting) {
+    CAbnormalEndItem end;
+    pRingItem pItem = end.getItemPointer();
+    EVB::Fragment frag = {
+      {NULL_TIMESTAMP, 0xffffffff, pItem->s_header.s_size, 0}, pItem
+    };
+    outputBarrier(&frag);
+  }
+  publish();
+}
+
+/*------------------------------------------------------------------------
+** Private utilities.
+*/
+
+/**
+ * processFragment
+ *   Dispatch a fragment as glom's main loop does.
+ *
+ * @param pFrag - the fragment.
+ */
+void
+CRingGlomOutput::processFragment(EVB::pFragment pFrag)
+{
+  if (m_pTeeWriter) teeFragment(pFrag);
+
+  if (pFrag->s_header.s_barrier) {
+    flushEvent();
+    outputBarrier(pFrag);
+
+    // The first begin run barrier is followed by the glom parameters.
+
+    if (m_firstBarrier && (pFrag->s_header.s_barrier == 1)) {
+      pGlomParameters p = formatGlomParameters(m_dt, m_nobuild ? 0 : 1, m_tsPolicy);
+      outputItem(p, p->s_header.s_size);
+      free(p);
+      m_firstBarrier = false;
+    }
+  } else {
+    m_firstBarrier = true;	// persistent mode: next begin gets parameters.
+
+    pRingItemHeader pH = reinterpret_cast<pRingItemHeader>(pFrag->s_pBody);
+    if (CRingItemFactory::isKnownItemType(pFrag->s_pBody)) {
+      if (pH->s_type == PHYSICS_EVENT) {
+        accumulateEvent(pFrag);
+      } else {
+        outputBarrier(pFrag);	// out of band.
+      }
+    } else {
+      std::cerr << "Unknown ring item type encountered in fragment from source "
+                << pFrag->s_header.s_sourceId << std::endl;
+      outputBarrier(pFrag);
+    }
+  }
+}
+/**
+ * accumulateEvent
+ *   Glue a physics fragment into the event being built, first flushing
+ *   that event if the fragment is outside the coincidence window (in
+ *   either direction, see glom), if there are too many fragments or if
+ *   we're not building.
+ *
+ * @param pFrag - the fragment.
+ */
+void
+CRingGlomOutput::accumulateEvent(EVB::pFragment pFrag)
+{
+  uint64_t timestamp = pFrag->s_header.s_timestamp;
+  uint64_t tsdiff1   = timestamp - m_firstTimestamp;
+  uint64_t tsdiff2   = m_firstTimestamp - timestamp;
+  uint64_t tsdiff    = (tsdiff1 < tsdiff2) ? tsdiff1 : tsdiff2;
+
+  if (m_nobuild || (m_building && (tsdiff > m_dt)) ||
+      (m_fragmentCount > m_maxFragments)) {
+    flushEvent();
+  }
+  if (!m_building) {
+    EventHeader header = {};          // Filled in by flushEvent.
+    m_writer.begin();
+    m_writer.append(&header, sizeof(header));
+
+    m_building       = true;
+    m_firstTimestamp = timestamp;
+    m_fragmentCount  = 0;
+    m_timestampSum   = 0;
+  }
+  m_lastTimestamp = timestamp;
+  m_fragmentCount++;
+  m_timestampSum += timestamp;
+
+  m_writer.append(&pFrag->s_header, sizeof(EVB::FragmentHeader));
+  m_writer.append(pFrag->s_pBody, pFrag->s_header.s_size);
+}
+/**
+ * flushEvent
+ *   Complete the event being built (if there is one) by filling in its
+ *   header, then output any out of band items that were held for it.
+ */
+void
+CRingGlomOutput::flushEvent()
+{
+  if (m_building) {
+    uint64_t eventTimestamp = m_firstTimestamp;
+    if (m_tsPolicy == GLOM_TIMESTAMP_LAST) {
+      eventTimestamp = m_lastTimestamp;
+    } else if (m_tsPolicy == GLOM_TIMESTAMP_AVERAGE) {
+      eventTimestamp = m_timestampSum/m_fragmentCount;
+    }
+    EventHeader header;
+    header.s_itemHeader.s_size      = m_writer.itemBytes();
+    header.s_itemHeader.s_type      = PHYSICS_EVENT;
+    header.s_bodyHeader.s_size      = sizeof(BodyHeader);
+    header.s_bodyHeader.s_timestamp = eventTimestamp;
+    header.s_bodyHeader.s_sourceId  = m_sourceId;
+    header.s_bodyHeader.s_barrier   = 0;
+    header.s_fragBytes = m_writer.itemBytes() - sizeof(RingItemHeader) - sizeof(BodyHeader);
+    m_writer.patch(0, &header, sizeof(header));
+    m_writer.end();
+
+    m_building = false;
+    m_outputEvents++;
+  }
+  if (!m_deferred.empty()) {
+    outputItem(m_deferred.data(), m_deferred.size());
+    m_deferred.clear();
+  }
+}
+/**
+ * outputBarrier
+ *   Output a barrier or out of band item.  Ring items go out as is,
+ *   anything else is wrapped, fragment header and all, in an
+ *   EVB_UNKNOWN_PAYLOAD item.  State changes are tracked so we know whether
+ *   an abnormal end is needed on exit.
+ *
+ * @param pFrag - the fragment.
+ */
+void
+CRingGlomOutput::outputBarrier(EVB::pFragment pFrag)
+{
+  pRingItemHeader pH = reinterpret_cast<pRingItemHeader>(pFrag->s_pBody);
+  if (CRingItemFactory::isKnownItemType(pFrag->s_pBody)) {
+    outputItem(pH, pH->s_size);
+
+    if (pH->s_type == BEGIN_RUN) {
+      m_outputEvents = 0;
+      m_stateChangeNesting++;
+    }
+    if (pH->s_type == END_RUN) {
+      m_stateChangeNesting--;
+    }
+    if (pH->s_type == PERIODIC_SCALERS) {
+      outputEventCount(pH);
+    }
+    if (pH->s_type == ABNORMAL_ENDRUN) m_stateChangeNesting = 0;
+
+  } else {
+    RingItemHeader unknownHdr;
+    unknownHdr.s_type = EVB_UNKNOWN_PAYLOAD;
+    unknownHdr.s_size = sizeof(RingItemHeader) + sizeof(EVB::FragmentHeader) +
+      pFrag->s_header.s_size;
+    outputItem(
+      &unknownHdr, sizeof(unknownHdr),
+      &pFrag->s_header, sizeof(EVB::FragmentHeader),
+      pFrag->s_pBody, pFrag->s_header.s_size
+    );
+  }
+}
+/**
+ * outputEventCount
+ *   Output a physics event count item with our count of built events, timed
+ *   like the periodic scaler item that triggers it.
+ *
+ * @param pItem - the scaler item.
+ */
+void
+CRingGlomOutput::outputEventCount(pRingItemHeader pItem)
+{
+  CRingItem*       pRaw    = CRingItemFactory::createRingItem(pItem);
+  CRingScalerItem* pScaler = dynamic_cast<CRingScalerItem*>(pRaw);
+  if (pScaler) {
+    CRingPhysicsEventCountItem counters(
+      NULL_TIMESTAMP, m_sourceId, 0, m_outputEvents.load(), pScaler->getEndTime(),
+      time(nullptr), pScaler->getTimeDivisor()
+    );
+    pRingItem pCounters = counters.getItemPointer();
+    outputItem(pCounters, pCounters->s_header.s_size);
+  }
+  delete pRaw;
+}
+/**
+ * outputItem
+ *   Output a complete item given as up to three pieces.  While an event is
+ *   being built the item is held until the event is complete.
+ */
+void
+CRingGlomOutput::outputItem(
+  const void* p1, size_t n1, const void* p2, size_t n2, const void* p3, size_t n3
+)
+{
+  if (m_building) {
+    const uint8_t* pieces[3] = {
+      static_cast<const uint8_t*>(p1), static_cast<const uint8_t*>(p2),
+      static_cast<const uint8_t*>(p3)
+    };
+    size_t sizes[3] = {n1, n2, n3};
+    for (int i = 0; i < 3; i++) {
+      m_deferred.insert(m_deferred.end(), pieces[i], pieces[i] + sizes[i]);
+    }
+  } else {
+    m_writer.begin();
+    m_writer.append(p1, n1);
+    if (n2) m_writer.append(p2, n2);
+    if (n3) m_writer.append(p3, n3);
+    m_writer.end();
+  }
+}
+/**
+ * teeFragment
+ *   Put a fragment in the tee ring as an EVB_FRAGMENT item.
+ *
+ * @param pFrag - the fragment.
+ */
+void
+CRingGlomOutput::teeFragment(EVB::pFragment pFrag)
+{
+  EventBuilderFragment header;
+  header.s_header.s_size = sizeof(EventBuilderFragment) + pFrag->s_header.s_size;
+  header.s_header.s_type = EVB_FRAGMENT;
+  header.s_bodyHeader.s_size      = sizeof(BodyHeader);
+  header.s_bodyHeader.s_timestamp = pFrag->s_header.s_timestamp;
+  header.s_bodyHeader.s_sourceId  = pFrag->s_header.s_sourceId;
+  header.s_bodyHeader.s_barrier   = pFrag->s_header.s_barrier;
+
+  m_pTeeWriter->begin();
+  m_pTeeWriter->append(&header, sizeof(header));
+  m_pTeeWriter->append(pFrag->s_pBody, pFrag->s_header.s_size);
+  m_pTeeWriter->end();
+}
+/**
+ * publish
+ *   Commit what's complete in both rings.
+ */
+void
+CRingGlomOutput::publish()
+{
+  m_bytesCommitted += m_writer.publish();
+  if (m_pTeeWriter) m_pTeeWriter->publish();
+}
@@ -0,0 +1,159 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CRingGlomOutput.h
+ * @brief Orderer output stage that builds events into a ring buffer.
+ */
+#ifndef CRINGGLOMOUTPUT_H
+#define CRINGGLOMOUTPUT_H
+#include "CFragmentHandler.h"
+#include <CRingBuffer.h>
+#include <DataFormat.h>
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @class CRingGlomOutput
+ *
+ *   Normally the orderer writes its ordered fragments to stdout and the
+ *   pipeline
+ * \verbatim
+ *    Orderer | teering | glom | stdintoring
+ * \endverbatim
+ *   turns them into events in the output ring.  Every byte is then copied
+ *   through three pipes.  This observer does what glom does in the
+ *   orderer's output thread instead and builds the events in place in the
+ *   output ring using CRingBuffer::reserve/commit.  If a tee ring is given,
+ *   each fragment is also put there as an EVB_FRAGMENT item, as teering
+ *   would.
+ *
+ *   The glom semantics are preserved:
+ *   - Physics fragments within dt ticks of the first fragment of an event
+ *     are glued together (up to maxFragments of them).
+ *   - Barriers end the event and are output as is (or wrapped in an
+ *     EVB_UNKNOWN_PAYLOAD item if the payload is not a ring item).
+ *   - Other ring items go out of band without ending the event being built.
+ *     Since the event is built in place in the ring, they are held until
+ *     that event is complete.
+ *   - A GlomParameters item follows the first begin run barrier, and
+ *     periodic scalers are followed by a physics event count item.
+ *
+ *   Complete items are committed at the end of each batch of fragments
+ *   we are handed; an event still being built stays in the uncommitted
+ *   part of the reservation.
+ */
+class CRingGlomOutput : public CFragmentHandler::Observer
+{
+private:
+  /**
+   * Writes items in place into a ring reservation.  The item being written
+   * (if any) is at m_itemStart; everything before that is complete and is
+   * committed by publish.
+   */
+  class RingWriter {
+  private:
+    CRingBuffer&              m_ring;
+    CRingBuffer::Reservation  m_space;
+    size_t                    m_batch;      // Reservation granularity.
+    size_t                    m_reserved;   // 0 if m_space is stale.
+    size_t                    m_written;
+    size_t                    m_itemStart;
+    size_t                    m_complete;
+  public:
+    RingWriter(CRingBuffer& ring);
+
+    void   begin();
+    void   append(const void* pData, size_t nBytes);
+    void   patch(size_t offset, const void* pData, size_t nBytes);
+    void   end();
+    size_t itemBytes() const { return m_written - m_itemStart; }
+    size_t publish();
+  private:
+    void   ensure(size_t nBytes);
+  };
+#pragma pack(push, 1)
+  typedef struct _EventHeader {
+    RingItemHeader s_itemHeader;
+    BodyHeader     s_bodyHeader;
+    uint32_t       s_fragBytes;      // Bytes of fragments (self inclusive).
+  } EventHeader, *pEventHeader;
+#pragma pack(pop)
+
+private:
+  CRingBuffer*         m_pRing;
+  CRingBuffer*         m_pTeeRing;
+  RingWriter           m_writer;
+  RingWriter*          m_pTeeWriter;
+
+  // Glom parameters:
+
+  uint64_t             m_dt;
+  bool                 m_nobuild;
+  uint32_t             m_sourceId;
+  int                  m_tsPolicy;         // GLOM_TIMESTAMP_*
+  unsigned             m_maxFragments;
+
+  // Event being built:
+
+  bool                 m_building;
+  uint64_t             m_firstTimestamp;
+  uint64_t             m_lastTimestamp;
+  uint64_t             m_timestampSum;
+  uint64_t             m_fragmentCount;
+  std::vector<uint8_t> m_deferred;         // Out of band items held for it.
+
+  // State:
+
+  bool                 m_firstBarrier;
+  unsigned             m_stateChangeNesting;
+  std::atomic<uint64_t> m_outputEvents;    // Atomic: read by other threads.
+  std::atomic<uint64_t> m_bytesCommitted;
+
+public:
+  CRingGlomOutput(
+    const char* ringName, const char* teeRingName,
+    uint64_t dt, bool nobuild, uint32_t sourceId, int timestampPolicy,
+    unsigned maxFragments
+  );
+  virtual ~CRingGlomOutput();
+private:
+  CRingGlomOutput(const CRingGlomOutput&);
+  CRingGlomOutput& operator=(const CRingGlomOutput&);
+  int operator==(const CRingGlomOutput&) const;
+  int operator!=(const CRingGlomOutput&) const;
+
+public:
+  virtual void operator()(const EvbFragments& event);
+
+  uint64_t getEventCount() const { return m_outputEvents; }
+  uint64_t getBytesCommitted() const { return m_bytesCommitted; }
+
+private:
+  void finish();
+  void processFragment(EVB::pFragment pFrag);
+  void accumulateEvent(EVB::pFragment pFrag);
+  void flushEvent();
+  void outputBarrier(EVB::pFragment pFrag);
+  void outputEventCount(pRingItemHeader pItem);
+  void outputItem(
+    const void* p1, size_t n1, const void* p2 = 0, size_t n2 = 0,
+    const void* p3 = 0, size_t n3 = 0
+  );
+  void teeFragment(EVB::pFragment pFrag);
+  void publish();
+};
+
+#endif
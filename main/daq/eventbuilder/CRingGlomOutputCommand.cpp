@@ -0,0 +1,272 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CRingGlomOutputCommand.cpp
+ * @brief Implementation of the EVB::ringoutput command.
+ */
+#include "CRingGlomOutputCommand.h"
+#include "CRingGlomOutput.h"
+#include "COrdererOutput.h"
+#include "CFragmentHandler.h"
+#include <TCLInterpreter.h>
+#include <TCLObject.h>
+#include <Exception.h>
+#include <DataFormat.h>
+
+#include <vector>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------
+** Canonical method implementations.
+*/
+
+/**
+ * constructor
+ *
+ * @param interp        - reference to the encapsulated interpreter.
+ * @param name          - Command name.
+ * @param pStdoutOutput - The stdout output stage start replaces.  It's
+ *                        kept so stop can put it back.
+ */
+CRingGlomOutputCommand::CRingGlomOutputCommand(
+  CTCLInterpreter& interp, std::string name, COrdererOutput* pStdoutOutput
+) :
+  CTCLObjectProcessor(interp, name),
+  m_pStdoutOutput(pStdoutOutput),
+  m_pRingOutput(0)
+{
+}
+/**
+ * destructor
+ */
+CRingGlomOutputCommand::~CRingGlomOutputCommand()
+{
+  stopOutput();
+}
+
+/*---------------------------------------------------------------------------
+** public interface
+*/
+
+/**
+ * operator()
+ *   Dispatch to the subcommand processors.
+ *
+ * @param interp - the interpreter that is running the command.
+ * @param objv   - The command words.
+ * @return int   - TCL_OK on success, TCL_ERROR on failure with the
+ *                 reason in the interpreter result.
+ */
+int
+CRingGlomOutputCommand::operator()(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  try {
+    requireAtLeast(objv, 2, "Missing subcommand");
+    bindAll(interp, objv);
+    std::string subcommand = objv[1];
+
+    if (subcommand == "start") {
+      start(interp, objv);
+    } else if (subcommand == "stop") {
+      stop(interp, objv);
+    } else if (subcommand == "stats") {
+      stats(interp, objv);
+    } else {
+      std::string errorMessage = "Illegal subcommand: ";
+      errorMessage += subcommand;
+      throw errorMessage;
+    }
+  }
+  catch (std::string msg) {
+    interp.setResult(msg);
+    return TCL_ERROR;
+  }
+  catch (const char* pMsg) {
+    interp.setResult(pMsg);
+    return TCL_ERROR;
+  }
+  catch (CException& e) {
+    interp.setResult(e.ReasonText());
+    return TCL_ERROR;
+  }
+  catch (...) {
+    interp.setResult("Unanticipated error type in CRingGlomOutputCommand::operator()");
+    return TCL_ERROR;
+  }
+  return TCL_OK;
+}
+
+/*---------------------------------------------------------------------------
+** Subcommands
+*/
+
+/**
+ * start
+ *   EVB::ringoutput start ring ?options?
+ *
+ *   The options are parsed before anything changes so a bad option leaves
+ *   the stdout output in place.
+ */
+void
+CRingGlomOutputCommand::start(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  requireAtLeast(objv, 3, "Usage: EVB::ringoutput start ring ?options?");
+  if (m_pRingOutput) {
+    throw std::string("Ring output is already running");
+  }
+  std::string ring = objv[2];
+  std::string teeRing;
+  uint64_t    dt           = 1;
+  bool        nobuild      = false;
+  uint32_t    sourceId     = 0;
+  int         policy       = GLOM_TIMESTAMP_FIRST;
+  int         maxFragments = 1000;
+
+  for (size_t i = 3; i < objv.size(); i++) {
+    std::string option = objv[i];
+    if (option == "-nobuild") {
+      nobuild = true;
+      continue;
+    }
+    if (i+1 == objv.size()) {
+      throw std::string("Missing value for ") + option;
+    }
+    CTCLObject& value(objv[++i]);
+    if (option == "-dt") {
+      Tcl_WideInt ticks;
+      if (Tcl_GetWideIntFromObj(
+	    interp.getInterpreter(), value.getObject(), &ticks) != TCL_OK
+	  || (ticks < 0)) {
+	throw std::string("-dt must be a non-negative integer");
+      }
+      dt = ticks;
+    } else if (option == "-sourceid") {
+      int id = value;
+      sourceId = id;
+    } else if (option == "-timestamppolicy") {
+      std::string name = value;
+      if (name == "earliest") {
+	policy = GLOM_TIMESTAMP_FIRST;
+      } else if (name == "latest") {
+	policy = GLOM_TIMESTAMP_LAST;
+      } else if (name == "average") {
+	policy = GLOM_TIMESTAMP_AVERAGE;
+      } else {
+	throw std::string("-timestamppolicy must be earliest, latest or average");
+      }
+    } else if (option == "-maxfragments") {
+      maxFragments = value;
+      if (maxFragments <= 0) {
+	throw std::string("-maxfragments must be > 0");
+      }
+    } else if (option == "-teering") {
+      teeRing = std::string(value);
+    } else {
+      throw std::string("Unrecognized option: ") + option;
+    }
+  }
+
+  // Fragments must go to one output or the other, never both:
+
+  CFragmentHandler* pHandler = CFragmentHandler::getInstance();
+  pHandler->removeObserver(m_pStdoutOutput);
+  try {
+    m_pRingOutput = new CRingGlomOutput(
+      ring.c_str(), teeRing.empty() ? 0 : teeRing.c_str(),
+      dt, nobuild, sourceId, policy, maxFragments
+    );
+  }
+  catch (...) {
+    pHandler->addObserver(m_pStdoutOutput);
+    throw;
+  }
+  Tcl_CreateExitHandler(exitHandler, this);
+}
+/**
+ * stop
+ *   EVB::ringoutput stop
+ *
+ *   Once the ring output is flushed, fragments go to stdout again.
+ */
+void
+CRingGlomOutputCommand::stop(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  requireExactly(objv, 2, "Usage: EVB::ringoutput stop");
+  if (!m_pRingOutput) {
+    throw std::string("Ring output is not running");
+  }
+  stopOutput();
+  CFragmentHandler::getInstance()->addObserver(m_pStdoutOutput);
+}
+/**
+ * stats
+ *   EVB::ringoutput stats  - {events bytes}
+ */
+void
+CRingGlomOutputCommand::stats(
+  CTCLInterpreter& interp, std::vector<CTCLObject>& objv
+)
+{
+  requireExactly(objv, 2, "Usage: EVB::ringoutput stats");
+  Tcl_WideInt events(0), bytes(0);
+  if (m_pRingOutput) {
+    events = m_pRingOutput->getEventCount();
+    bytes  = m_pRingOutput->getBytesCommitted();
+  }
+  CTCLObject result;
+  result.Bind(interp);
+  result += events;
+  result += bytes;
+  interp.setResult(result);
+}
+
+/*---------------------------------------------------------------------------
+** Utilities
+*/
+
+/**
+ * stopOutput
+ *   Destroy the ring output; this flushes what it has built.
+ */
+void
+CRingGlomOutputCommand::stopOutput()
+{
+  if (m_pRingOutput) {
+    Tcl_DeleteExitHandler(exitHandler, this);
+    delete m_pRingOutput;
+    m_pRingOutput = 0;
+  }
+}
+/**
+ * exitHandler
+ *   Flush the ring output when the orderer exits.
+ *
+ * @param pData - Actually a pointer to the command object.
+ */
+void
+CRingGlomOutputCommand::exitHandler(ClientData pData)
+{
+  CRingGlomOutputCommand* pThis = reinterpret_cast<CRingGlomOutputCommand*>(pData);
+  if (pThis->m_pRingOutput) {
+    delete pThis->m_pRingOutput;
+    pThis->m_pRingOutput = 0;
+  }
+}
@@ -0,0 +1,97 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CRingGlomOutputCommand.h
+ * @brief Defines the class that implements the EVB::ringoutput command.
+ */
+#ifndef CRINGGLOMOUTPUTCOMMAND_H
+#define CRINGGLOMOUTPUTCOMMAND_H
+
+#include <TCLObjectProcessor.h>
+#include <tcl.h>
+#include <string>
+
+// forward definitions
+
+class CTCLInterpreter;
+class CTCLObject;
+class COrdererOutput;
+class CRingGlomOutput;
+
+/**
+ * @class CRingGlomOutputCommand
+ *
+ *   Switches the orderer from writing fragments to stdout to building
+ *   events in process into a ring buffer (see CRingGlomOutput).
+ *
+ * \verbatim
+ *   EVB::ringoutput start ring ?options?
+ *   EVB::ringoutput stop
+ *   EVB::ringoutput stats
+ * \endverbatim
+ *
+ *  - start - The stdout output stage is detached and built events go to
+ *            ring.  Options are as for glom (plus teering's ring):
+ *            - -dt ticks         coincidence window (default 1).
+ *            - -nobuild          each fragment is its own event.
+ *            - -sourceid id      source id of built events (default 0).
+ *            - -timestamppolicy  earliest|latest|average (default earliest).
+ *            - -maxfragments n   most fragments in an event (default 1000).
+ *            - -teering name     also put fragments in this ring.
+ *  - stop  - Flushes the event being built (and an abnormal end if a run
+ *            is active), stops ring output and reattaches the stdout
+ *            output stage.  The flush is also done at exit.
+ *  - stats - Returns {events bytes}: the events built and bytes committed
+ *            to the output ring.
+ */
+class CRingGlomOutputCommand : public CTCLObjectProcessor
+{
+private:
+  COrdererOutput*  m_pStdoutOutput;
+  CRingGlomOutput* m_pRingOutput;
+
+  // Implemented canonicals:
+
+public:
+  CRingGlomOutputCommand(
+    CTCLInterpreter& interp, std::string name, COrdererOutput* pStdoutOutput
+  );
+  virtual ~CRingGlomOutputCommand();
+
+  // canonicals that are forbidden:
+
+private:
+  CRingGlomOutputCommand(const  CRingGlomOutputCommand&);
+  CRingGlomOutputCommand& operator=(const  CRingGlomOutputCommand&);
+  int operator==(const  CRingGlomOutputCommand&) const;
+  int operator!=(const  CRingGlomOutputCommand&) const;
+
+  // public methods (command implementation):
+
+public:
+  int operator()(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+
+  // Subcommands and utilities:
+
+private:
+  void start(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+  void stop(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+  void stats(CTCLInterpreter& interp, std::vector<CTCLObject>& objv);
+
+  void stopOutput();
+  static void exitHandler(ClientData pData);
+};
+
+#endif
@@ -26,7 +26,7 @@
 #include <CFragmentHandler.h>
 #include <list>
 #include <vector>
-#include <CBufferQueue.h>
+#include <CLockFreeQueue.h>
 #include "fragment.h"
 
 #include <atomic>
@@ -48,7 +48,7 @@ public:
     typedef EvbFragments FragmentList;
     typedef std::deque<FragmentList*> Fragments;
 private:
-    CBufferQueue<Fragments*> m_fragmentQueue;
+    CMPSCQueue<Fragments*>  m_fragmentQueue;  // Any thread may flush to us.
     CFragmentHandler*       m_pHandler;
     std::atomic<size_t>     m_nQueuedFrags;
 public:
@@ -62,8 +62,6 @@ public:
 private:
     Fragments* dequeueFragments();
     void merge(FragmentList& result, Fragments& lists);
-    void merge(FragmentList& result, FragmentList& list1, FragmentList& list2);
-    void merge(FragmentList& result, FragmentList& list);
     void clearBufferQueue();
     void releaseFragments(Fragments& frags);
     void releaseFragmentList(FragmentList& frags);
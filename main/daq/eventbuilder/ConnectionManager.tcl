@@ -54,6 +54,20 @@ namespace eval EVB {
     variable DISCONNECT 4
     
     variable HeaderSize 8;           # two uint32_t items in the header.
+
+    #
+    #  When nonzero, once a connection is ACTIVE its FRAGMENTS and DISCONNECT
+    #  messages are received by a C++ thread (EVB::receiver) rather than
+    #  by file events in this interpreter.
+    #
+    variable nativeReceiver 1
+
+    #
+    #  Largest credit window granted to clients that ask for one
+    #  (only with nativeReceiver).  1 makes every client lock step.
+    #
+    variable PROTOCOL_WINDOWED 2
+    variable maxCreditWindow  32
 }
 
 
@@ -84,6 +98,7 @@ snit::type EVB::Connection {
     variable callbacks
     variable expecting ""
     variable stateMethods -array [list FORMING _Connect ACTIVE _Fragments]
+    variable receiving 0;               # Nonzero if EVB::receiver has the socket.
 
 
 
@@ -113,7 +128,7 @@ snit::type EVB::Connection {
     #    and if so dispatch.  During this , the -fragmentcommand is disabled.
     #
     method tryRead {} {
-        if {$options(-socket) eq "-1"} {
+        if {($options(-socket) eq "-1") || $receiving} {
             return
         }
         catch {
@@ -129,15 +144,23 @@ snit::type EVB::Connection {
     #   Called to disable reception of data.
     #
     method flowOff {} {
-        fileevent $options(-socket) readable [list]
+        if {$receiving} {
+            EVB::receiver flow $options(-socket) off
+        } else {
+            fileevent $options(-socket) readable [list]
+        }
     }
     ##
     # flowOn
     #   Called to enable reception of data.
     #
     method flowOn {} {
-        set method $stateMethods($options(-state))
-        fileevent $options(-socket) readable [mymethod $method $options(-socket)] 
+        if {$receiving} {
+            EVB::receiver flow $options(-socket) on
+        } else {
+            set method $stateMethods($options(-state))
+            fileevent $options(-socket) readable [mymethod $method $options(-socket)] 
+        }
     }
 
     #----------------------------------------------------------------------------
@@ -167,12 +190,15 @@ snit::type EVB::Connection {
     #  - 80 characters of description information.
     #  - uint32 of number of following source ids.
     #  - source ids each in a uint32_t
+    #  - optionally, from windowed clients, a uint32_t protocol version
+    #    and the uint32_t credit window the client would like.
     #  
     #  The count and source ids are all little endian uint32_t numbers.
     #
     # @param body - The body binary blob.
-    # @return list - 2 element list.
+    # @return list - 3 element list.
     # @retval First list element is the description string.  The second, a list of source ids.
+    #         The third is the requested credit window (1 if none was requested).
     #
     method _DecodeConnectBody body {
         #  The string and number of bytes:
@@ -186,7 +212,19 @@ snit::type EVB::Connection {
             lappend sources $sid
             incr cursor 4
         }
-        return [list $description $sources]
+        # Windowed clients append a version and requested window:
+
+        set window 1
+        if {[string length $body] >= ($cursor + 8)} {
+            binary scan $body @${cursor}ii version requested
+            # A window below 1 would never let the client send, so it
+            # gets at least 1:
+
+            if {($version == $EVB::PROTOCOL_WINDOWED) && ($requested > 1)} {
+                set window $requested
+            }
+        }
+        return [list $description $sources $window]
     }
 
     ##
@@ -282,6 +320,10 @@ snit::type EVB::Connection {
     method _Close {newState} {
         set alive 0
         set options(-state) $newState
+        if {$receiving} {
+            EVB::receiver stop $options(-socket)
+            set receiving 0
+        }
         fileevent $options(-socket) readable [list]
         close $options(-socket) 
         set options(-socket) -1
@@ -350,7 +392,17 @@ snit::type EVB::Connection {
         set description [lindex $decodedBody 0]
         set sourceIds   [lindex $decodedBody 1]
 
-        puts $socket "OK"
+        # Only receiver threads do credit windows; file events stay lock step.
+
+        set window 1
+        if {$EVB::nativeReceiver} {
+            set window [expr {min([lindex $decodedBody 2], $EVB::maxCreditWindow)}]
+        }
+        if {$window > 1} {
+            puts $socket "OK WINDOW $window"
+        } else {
+            puts $socket "OK"
+        }
         flush $socket
     
         # Save the description and transition to the active state:
@@ -361,7 +413,42 @@ snit::type EVB::Connection {
     
     
         EVB::source $socket {*}$sourceIds
-     
+
+        if {$EVB::nativeReceiver} {
+            $self _StartReceiver $window
+        }
+    }
+    ##
+    # _StartReceiver
+    #   Hand the rest of the conversation to an EVB::receiver thread.
+    #   We still get told when fragments have been queued (so the
+    #   -fragmentcommand callback works as before) and when the
+    #   peer goes away.
+    #
+    # @param window - credit window granted to the client.
+    #
+    method _StartReceiver window {
+        fileevent $options(-socket) readable [list]
+        EVB::receiver start $options(-socket) \
+            [mymethod _ReceivedFragments] [mymethod _ReceiverDone] $window
+        set receiving 1
+    }
+    ##
+    # _ReceivedFragments
+    #   Called when fragments from our receiver have been queued.
+    #
+    method _ReceivedFragments {} {
+        $callbacks invoke -fragmentcommand [list] [list]
+    }
+    ##
+    # _ReceiverDone
+    #   Called when the receiver has seen the peer disconnect or fail.
+    #
+    # @param state - CLOSED, LOST or ERROR.
+    #
+    method _ReceiverDone state {
+        set receiving 0;                # Receiver is already gone.
+        $self _Close $state
     }
     #
     # Expecting fragments if the next message is
@@ -404,21 +491,16 @@ snit::type EVB::Connection {
             # protocol allows FRAGMENTS here:
             # TODO: Handle errors as a close
             
-            # We can read the fragments from the socket:
+            # The fragment handler reads the fragments from the socket
+            # directly into a block the queued fragments point into,
+            # then acknowledges them (which allows the next bunch to be
+            # prepared in the caller) before queueing them.
             
-            set fragments [read $socket $bodySize]
-            
-            # Acknowledging the fragments here allows next bunch to be prepared
-            # in the caller.
-            
-            if {[catch {puts $socket "OK"} msg]} {
-                puts stderr "Event orderer failed to ack ok to a data source $msg"
+            if {[catch {EVB::handleFragments $socket -read $bodySize} msg]} {
+                puts stderr "Event orderer failed to read/ack fragments from a data source $msg"
                 $self  _Close LOST
-            } else {
-                flush $socket
+                return
             }
-
-            EVB::handleFragments $socket $fragments;    # Handle fragments in C++
     
             $callbacks invoke -fragmentcommand [list] [list]
     
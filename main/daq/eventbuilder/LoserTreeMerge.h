@@ -0,0 +1,152 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/** @file:  LoserTreeMerge.h
+ *  @brief: Templated k-way merge of sorted lists using a tournament
+ *          (loser) tree.
+ */
+
+#ifndef LOSERTREEMERGE_H
+#define LOSERTREEMERGE_H
+#include <cstddef>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/**
+ * LoserTreeMerge
+ *    Merges k sorted lists into a result list.  The lists are the leaves
+ *    of a tournament tree.  Each internal node of the tree holds the loser
+ *    of the match played there and the overall winner (the list whose
+ *    front item has the smallest key) sits above the root.  Taking the
+ *    winner's front item and replaying the matches on the path from its
+ *    leaf to the root costs log2(k) comparisons and touches nothing but
+ *    the tree itself:  nodes hold the key of the front item inline
+ *    (along with its list number) so comparisons never chase pointers into
+ *    the items.
+ *
+ *    When one list stays the winner for a while (e.g. a source with a
+ *    burst of fragments), replaying the tree per item is wasted effort.
+ *    The runner up is the best of the losers on the winner's path so, when
+ *    a list wins twice in a row, all of its items that still beat the
+ *    runner up are moved to the result in one go.
+ *
+ *    Ties are broken by list number (lower wins), so items with equal keys
+ *    come out in list order.  Items within a list keep their order.
+ *
+ * @param result - Items are appended to this.  Must support push_back and
+ *                 insert at end.
+ * @param lists  - Random access container of pointers to the lists.  Each
+ *                 list must be sorted by key and support begin, end, front,
+ *                 empty, pop_front and erase.  The lists are empty on return.
+ * @param key    - Function object that returns the uint64_t key of an item.
+ */
+template <class ListType, class ListsType, class KeyFunction>
+void
+LoserTreeMerge(ListType& result, ListsType& lists, KeyFunction key)
+{
+    struct Node {
+        uint64_t s_key;               // Key of the list's front item.
+        size_t   s_list;              // List number; >= k for no item.
+        bool operator<(const Node& rhs) const {
+            return (s_key < rhs.s_key) ||
+                ((s_key == rhs.s_key) && (s_list < rhs.s_list));
+        }
+    };
+
+    size_t k = lists.size();
+    if (k == 0) return;
+    if (k == 1) {
+        ListType& list(*lists[0]);
+        result.insert(result.end(), list.begin(), list.end());
+        list.erase(list.begin(), list.end());
+        return;
+    }
+
+    // Leaves are numbered nLeaves..2*nLeaves-1.  Leaves past k, and lists
+    // as they empty, get a node that loses to any real item.
+
+    size_t nLeaves = 1;
+    while (nLeaves < k) nLeaves *= 2;
+
+    std::vector<Node> losers(nLeaves);
+    std::vector<Node> winners(2*nLeaves);
+    for (size_t i = 0; i < nLeaves; i++) {
+        Node& leaf(winners[nLeaves + i]);
+        if ((i < k) && !lists[i]->empty()) {
+            leaf.s_key  = key(lists[i]->front());
+            leaf.s_list = i;
+        } else {
+            leaf.s_key  = UINT64_MAX;
+            leaf.s_list = k + i;
+        }
+    }
+    for (size_t n = nLeaves - 1; n > 0; n--) {
+        const Node& left(winners[2*n]);
+        const Node& right(winners[2*n+1]);
+        if (left < right) {
+            winners[n] = left;
+            losers[n]  = right;
+        } else {
+            winners[n] = right;
+            losers[n]  = left;
+        }
+    }
+    Node   winner = winners[1];
+    size_t last   = k;                  // List that won last time.
+
+    while (winner.s_list < k) {
+        size_t    i = winner.s_list;
+        ListType& list(*lists[i]);
+        auto      e = list.begin();
+        ++e;
+
+        // If this list won twice running it may have a run that beats
+        // everyone else: find the runner up and take everything that beats it.
+
+        if (i == last) {
+            Node runnerUp = losers[(nLeaves + i)/2];
+            for (size_t n = (nLeaves + i)/4; n > 0; n /= 2) {
+                if (losers[n] < runnerUp) runnerUp = losers[n];
+            }
+            Node item = winner;
+            while (e != list.end()) {
+                item.s_key = key(*e);
+                if (!(item < runnerUp)) break;
+                ++e;
+            }
+        }
+        if (e == list.begin() + 1) {
+            result.push_back(list.front());
+            list.pop_front();
+        } else {
+            result.insert(result.end(), list.begin(), e);
+            list.erase(list.begin(), e);
+        }
+        last = i;
+
+        // Replay the winner's path with its new front:
+
+        if (list.empty()) {
+            winner.s_key  = UINT64_MAX;
+            winner.s_list = k + i;
+        } else {
+            winner.s_key  = key(list.front());
+        }
+        for (size_t n = (nLeaves + i)/2; n > 0; n /= 2) {
+            if (losers[n] < winner) std::swap(losers[n], winner);
+        }
+    }
+}
+#endif
@@ -0,0 +1,76 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/** @file:  MergeSortedRun.h
+ *  @brief: Templated function to merge a run of out of order items into
+ *          a sorted container.
+ */
+
+#ifndef MERGESORTEDRUN_H
+#define MERGESORTEDRUN_H
+#include <algorithm>
+
+
+/**
+ * MergeSortedRun
+ *    Merges a run of items, in any order, into a sorted container.
+ *    Inserting out of order items one at a time into the middle of a
+ *    deque after a linear search for their spot costs O(n) per item.
+ *    Collecting them and merging them in one go only touches the tail of
+ *    the container from the point the earliest of them belongs:
+ *
+ *    - The run is (stably) sorted and appended to the container.
+ *    - The first item of the container that sorts after the first item
+ *      of the run is found by binary search.
+ *    - The tail from that point is merged in place with the appended run.
+ *
+ *    A run of only a few items is instead inserted an item at a time at
+ *    binary searched positions; a deque insert only shifts the shorter
+ *    side of the container, which beats a merge of the tail when the items
+ *    are few and belong far from the back.
+ *
+ *    Items that compare equal keep their order: items already in the
+ *    container come before those in the run and items in the run stay in
+ *    the order they were added.  This is the same result inserting each of
+ *    them after the last item that does not sort after it would give.
+ *
+ * @param c    - The sorted container.  Must support random access iterators,
+ *               and insert.
+ * @param run  - The items to merge in.  Must support random access
+ *               iterators.  It is emptied.
+ * @param less - Strict weak ordering of the items.
+ */
+template <class c1type, class c2type, class Compare>
+void
+MergeSortedRun(c1type& c, c2type& run, Compare less)
+{
+    static const size_t SMALL_RUN(4);
+    
+    if (run.empty()) return;
+
+    std::stable_sort(run.begin(), run.end(), less);
+    if (run.size() <= SMALL_RUN) {
+        for (auto p = run.begin(); p != run.end(); p++) {
+            c.insert(std::upper_bound(c.begin(), c.end(), *p, less), *p);
+        }
+    } else {
+        size_t nSorted = c.size();
+        c.insert(c.end(), run.begin(), run.end());
+        auto mid = c.begin() + nSorted;
+        auto s   = std::upper_bound(c.begin(), mid, *mid, less);
+        std::inplace_merge(s, mid, c.end(), less);
+    }
+    run.clear();
+}
+#endif
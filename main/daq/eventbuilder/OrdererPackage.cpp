@@ -34,6 +34,7 @@
 #include "CSourceCommand.h"
 #include "CDeadSourceCommand.h"
 #include "CReviveSocketCommand.h"
+#include "CFragmentReceiverCommand.h"
 #include "CFlushCommand.h"
 #include "CResetCommand.h"
 #include "CBarrierStatsCommand.h"
@@ -44,6 +45,7 @@
 #include "CFragmentHandler.h"
 #include "BarrierAbortCommand.h"
 #include "COutOfOrderStatsCommand.h"
+#include "CRingGlomOutputCommand.h"
 
 static const char* version = "1.0"; // package version string.
 
@@ -75,6 +77,7 @@ int Eventbuilder_Init(Tcl_Interp* pInterp)
   new CSourceCommand(*pInterpObject, "EVB::source"); //  namespace prevents conflict with core source
   new CDeadSourceCommand(*pInterpObject,"EVB::deadsource");
   new CReviveSocketCommand(*pInterpObject, "EVB::reviveSocket");
+  new CFragmentReceiverCommand(*pInterpObject, "EVB::receiver");
   new CFlushCommand(*pInterpObject, "EVB::flushqueues");
   new CResetCommand(*pInterpObject, "EVB::reset");
   new CBarrierStatsCommand(*pInterpObject, "EVB::barrierstats"); 
@@ -88,7 +91,11 @@ int Eventbuilder_Init(Tcl_Interp* pInterp)
 
   
   CFragmentHandler* pInstance = CFragmentHandler::getInstance();
-  new COrdererOutput(STDOUT_FILENO);
+  COrdererOutput* pStdout = new COrdererOutput(STDOUT_FILENO);
+
+  // The stdout output can be replaced by in-process event building:
+
+  new CRingGlomOutputCommand(*pInterpObject, "EVB::ringoutput", pStdout);
 
   return TCL_OK;
 }
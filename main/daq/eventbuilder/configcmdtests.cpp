@@ -9,6 +9,7 @@
 #undef private
 
 #include <TCLInterpreter.h>
+#include <Exception.h>
 #include "CConfigure.h"
 #include <stdlib.h>
 #include <fragment.h>
@@ -19,6 +20,10 @@ class ConfigCmdTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ConfigCmdTest);
   CPPUNIT_TEST(setxon);
   CPPUNIT_TEST(setxoff);
+  CPPUNIT_TEST(windowms);
+  CPPUNIT_TEST(window);
+  CPPUNIT_TEST(flushms);
+  CPPUNIT_TEST(badwindowms);
 //  CPPUNIT_TEST(xoffObserved);
 //  CPPUNIT_TEST(xonObserved);
   CPPUNIT_TEST_SUITE_END();
@@ -39,6 +44,10 @@ public:
 protected:
   void setxon();
   void setxoff();
+  void windowms();
+  void window();
+  void flushms();
+  void badwindowms();
   void xoffObserved();
   void xonObserved();
 };
@@ -57,6 +66,37 @@ void ConfigCmdTest::setxoff() {
     m_pInterp->Eval("config set XoffThreshold 1234");
     EQ(static_cast<size_t>(1234), m_pHandler->m_nXoffLimit);
 }
+void ConfigCmdTest::windowms() {
+    CConfigure cmd(*m_pInterp, "config");
+
+    m_pInterp->Eval("config set windowms 250");
+    EQ(static_cast<time_t>(250), m_pHandler->getBuildWindowMs());
+    EQ(std::string("250"), m_pInterp->Eval("config get windowms"));
+    EQ(std::string("1"), m_pInterp->Eval("config get window")); // Rounds up.
+}
+void ConfigCmdTest::window() {
+    CConfigure cmd(*m_pInterp, "config");
+
+    m_pInterp->Eval("config set window 3");
+    EQ(static_cast<time_t>(3000), m_pHandler->getBuildWindowMs());
+    EQ(std::string("3"), m_pInterp->Eval("config get window"));
+}
+void ConfigCmdTest::flushms() {
+    CConfigure cmd(*m_pInterp, "config");
+
+    m_pInterp->Eval("config set flushms 5");
+    EQ(static_cast<time_t>(5), m_pHandler->m_nFlushInterval);
+    EQ(std::string("5"), m_pInterp->Eval("config get flushms"));
+    ASSERT(m_pHandler->m_nNextPoll <= CFragmentHandler::now() + 5);
+}
+void ConfigCmdTest::badwindowms() {
+    CConfigure cmd(*m_pInterp, "config");
+
+    CPPUNIT_ASSERT_THROW(
+        m_pInterp->Eval("config set windowms 0"), CException
+    );
+    EQ(static_cast<time_t>(20000), m_pHandler->getBuildWindowMs());
+}
 
 class XonOffObserver : public CFragmentHandler::FlowControlObserver {
 public:
@@ -72,6 +72,8 @@ namespace eval ::EVBC {
     # Configuration parameters for the event builder:
     
     variable window             ""
+    variable windowms           ""
+    variable flushms            ""
     
     
     variable XoffThreshold      ""
@@ -101,6 +103,9 @@ namespace eval ::EVBC {
 #    * -glomid    - Source id to assign to built physics events
 #    * -maxfragments - maximum number of fragments glombuilds into an event.
 #                   prevents stuck timestamps from crashing.
+#    * -inprocess - If true the orderer builds events and writes them to
+#                   -destring (and -teeringname) itself rather than through
+#                   the teering | glom | stdintoring pipeline.
 #
 snit::type EVBC::StartOptions {
     option -teering   0
@@ -111,6 +116,7 @@ snit::type EVBC::StartOptions {
     option -glomtspolicy -configuremethod checkTsPolicy -default latest
     option -destring -default $::tcl_platform(user) -configuremethod updateLoggerRing
     option -maxfragments -default 1000;    #Same default as program.
+    option -inprocess -default 0
     
     variable policyValues [list earliest latest average]
     
@@ -271,31 +277,34 @@ proc EVBC::start args {
     set program [file join $bindir Orderer]
    # set pipecommand "valgrind --tool=callgrind $program 2> orderer.err ";        # TODO - this should be @TCLSH_CMD@
     set pipecommand "$program 2> orderer.err ";        # TODO - this should be @TCLSH_CMD@
-    #  If -teering is not null hook teering into the pipeline:
-    
-    set intermediateRing [$options cget -teering]
-    if {$intermediateRing} {
-        set teering "[file join $bindir teering] --ring=[$options cget -teeringname]"
-        append pipecommand " | " $teering
-    }
-    #
-    #  Figure out the glom command and hook it in.
-    #
-    
-    # set glom "valgrind --tool=callgrind [file join $bindir glom] --dt=[$options cget -glomdt] "
-    set glom "[file join $bindir glom] --dt=[$options cget -glomdt]"
-    if {![$options cget -glombuild]} {
-        append glom " --nobuild "
+    set inprocess [$options cget -inprocess]
+    if {!$inprocess} {
+        #  If -teering is not null hook teering into the pipeline:
+        
+        set intermediateRing [$options cget -teering]
+        if {$intermediateRing} {
+            set teering "[file join $bindir teering] --ring=[$options cget -teeringname]"
+            append pipecommand " | " $teering
+        }
+        #
+        #  Figure out the glom command and hook it in.
+        #
+        
+        # set glom "valgrind --tool=callgrind [file join $bindir glom] --dt=[$options cget -glomdt] "
+        set glom "[file join $bindir glom] --dt=[$options cget -glomdt]"
+        if {![$options cget -glombuild]} {
+            append glom " --nobuild "
+        }
+        append glom " --sourceid=[$options cget -glomid]"
+        append glom " --timestamp-policy=[$options cget -glomtspolicy] "
+        append glom "  --maxfragments [$options cget -maxfragments]"
+        append pipecommand " | $glom  "
+        #
+        #  Ground the pipeline in the -destring 
+        #
+        set stdintoring "[file join $bindir stdintoring] [$options cget -destring]"
+        append pipecommand " | $stdintoring |& cat  "; # The cat captures stderr.
     }
-    append glom " --sourceid=[$options cget -glomid]"
-    append glom " --timestamp-policy=[$options cget -glomtspolicy] "
-    append glom "  --maxfragments [$options cget -maxfragments]"
-    append pipecommand " | $glom  "
-    #
-    #  Ground the pipeline in the -destring 
-    #
-    set stdintoring "[file join $bindir stdintoring] [$options cget -destring]"
-    append pipecommand " | $stdintoring |& cat  "; # The cat captures stderr.
     
     #
     #  Create the pipeline:
@@ -315,6 +324,23 @@ proc EVBC::start args {
     ::flush $EVBC::pipefd
     puts $EVBC::pipefd "set ::OutputRing [$options cget -destring]"
     ::flush $EVBC::pipefd
+    
+    # In process, the orderer's output stage does glom's job:
+    
+    if {$inprocess} {
+        set ringoutput [list EVB::ringoutput start [$options cget -destring] \
+            -dt [$options cget -glomdt] -sourceid [$options cget -glomid]   \
+            -timestamppolicy [$options cget -glomtspolicy]                 \
+            -maxfragments [$options cget -maxfragments]]
+        if {![$options cget -glombuild]} {
+            lappend ringoutput -nobuild
+        }
+        if {[$options cget -teering]} {
+            lappend ringoutput -teering [$options cget -teeringname]
+        }
+        puts $EVBC::pipefd $ringoutput
+        ::flush $EVBC::pipefd
+    }
     puts $EVBC::pipefd "start $::EVBC::appNameSuffix"
     ::flush $EVBC::pipefd
     
@@ -326,7 +352,7 @@ proc EVBC::start args {
     
     # If any parameters have been set push those out now:
     
-    foreach param [list window XoffThreshold XonThreshold perQXoffThreshold perQXonThreshold] {
+    foreach param [list window windowms flushms XoffThreshold XonThreshold perQXoffThreshold perQXonThreshold] {
         set value [set ::EVBC::$param]
         if {$value ne ""} {
             EVBC::configParams $param $value
@@ -630,7 +656,8 @@ proc EVBC::onBegin {} {
             -glomdt    [$EVBC::applicationOptions cget -glomdt]    \
             -glomid    [$EVBC::applicationOptions cget -glomid]    \
             -glomtspolicy [$EVBC::applicationOptions cget -glomtspolicy] \
-            -destring  $destring -maxfragments [$EVBC::applicationOptions cget -maxfragments]
+            -destring  $destring -maxfragments [$EVBC::applicationOptions cget -maxfragments] \
+            -inprocess [$EVBC::applicationOptions cget -inprocess]
         
         
         if {[::EVBC::_guiExists]} {
@@ -680,6 +707,8 @@ proc EVBC::onEnd {} {
 #
 # @param parameter - the parameter to configure must be one of
 #                    * window set number of seconds in the build window.
+#                    * windowms set number of milliseconds in the build window.
+#                    * flushms  - longest number of milliseconds between idle flushes.
 #                    * XoffThreshold - set the number of queued bytes before xoffing.
 #                    * XonThreshold  - set then umber of queued bytes at which XON
 #                    * perQXoffThreshold - set the number of Fragments in a queue for xoff
@@ -695,7 +724,7 @@ proc EVBC::configParams {parameter value} {
     
     # Validate the parameter name:
     
-    set configParams [list window XoffThreshold XonThreshold perQXoffThreshold perQXonThreshold]
+    set configParams [list window windowms flushms XoffThreshold XonThreshold perQXoffThreshold perQXonThreshold]
     if {$parameter ni $configParams} {
         error "EVBC::configure $parameter must be one of [join $configParams {, }]"
     }
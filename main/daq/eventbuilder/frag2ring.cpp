@@ -96,7 +96,6 @@ int main(int argc, const char** argv)
     while(1) {
       void* pData = reader();
       writer(pData);
-      free(pData);
     }
   }
   catch(std::string errorMessage) {
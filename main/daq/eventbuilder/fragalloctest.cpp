@@ -16,6 +16,11 @@ class Fragalloctest : public CppUnit::TestFixture {
   
   CPPUNIT_TEST(bodypool_1);
   CPPUNIT_TEST(bodypool_2);
+  CPPUNIT_TEST(slab);
+  CPPUNIT_TEST(bulkfree);
+  CPPUNIT_TEST(statistics);
+  CPPUNIT_TEST(blockref);
+  CPPUNIT_TEST(blockreuse);
   CPPUNIT_TEST_SUITE_END();
 
 
@@ -32,6 +37,11 @@ protected:
   
   void bodypool_1();
   void bodypool_2();
+  void slab();
+  void bulkfree();
+  void statistics();
+  void blockref();
+  void blockreuse();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(Fragalloctest);
@@ -83,4 +93,120 @@ void Fragalloctest::bodypool_2()
   ASSERT(pBody1 != frag2->s_pBody);
   
   freeFragment(frag2);
-}
\ No newline at end of file
+}
+// Bodies of a size class are carved from one slab.
+
+void Fragalloctest::slab()
+{
+  EVB::FragmentHeader hdr = {0, 0, 100, 0};
+  EVB::pFragment frag1 = allocateFragment(&hdr);
+  EVB::pFragment frag2 = allocateFragment(&hdr);
+
+  EQ(static_cast<uint8_t*>(frag1->s_pBody) + 128,
+     static_cast<uint8_t*>(frag2->s_pBody));
+  EQ(frag1 + 1, frag2);
+
+  freeFragment(frag1);
+  freeFragment(frag2);
+}
+// A batch released with freeFragmentList is all reusable.
+
+void Fragalloctest::bulkfree()
+{
+  EVB::FragmentHeader hdr = {0, 0, 100, 0};
+  EVB::pFragment frags[10];
+  for (int i = 0; i < 10; i++) {
+    frags[i] = allocateFragment(&hdr);
+  }
+  freeFragmentList(frags, 10);
+
+  EVB::FragmentPoolStatistics stats;
+  getFragmentPoolStatistics(&stats);
+  EQ((uint64_t)0, stats.s_inUse);
+
+  for (int i = 0; i < 10; i++) {
+    frags[i] = allocateFragment(&hdr);
+  }
+  getFragmentPoolStatistics(&stats);
+  EQ((uint64_t)20, stats.s_allocations);
+  EQ((uint64_t)19, stats.s_poolHits);
+  freeFragmentList(frags, 10);
+}
+// Statistics track the slabs and the pools.
+
+void Fragalloctest::statistics()
+{
+  EVB::FragmentPoolStatistics stats;
+  getFragmentPoolStatistics(&stats);
+  EQ((uint64_t)0, stats.s_allocations);
+  EQ((uint64_t)0, stats.s_slabs);
+
+  EVB::FragmentHeader hdr = {0, 0, 100, 0};
+  EVB::pFragment frag = allocateFragment(&hdr);
+  getFragmentPoolStatistics(&stats);
+  EQ((uint64_t)1, stats.s_allocations);
+  EQ((uint64_t)0, stats.s_poolHits);
+  EQ((uint64_t)2, stats.s_slabs);           // Headers and 128 byte bodies.
+  EQ((uint64_t)1, stats.s_inUse);
+  EQ((uint64_t)(64*1024/128 - 1), stats.s_freeBlocks);
+  EQ(stats.s_freeBlocks*128, stats.s_freeBytes);
+
+  freeFragment(frag);
+  getFragmentPoolStatistics(&stats);
+  EQ((uint64_t)0, stats.s_inUse);
+  EQ((uint64_t)(64*1024/128), stats.s_freeBlocks);
+}
+// Fragments made from a block point into it and keep it alive
+// until the last one is freed.
+
+void Fragalloctest::blockref()
+{
+  size_t fragSize = sizeof(EVB::FragmentHeader) + 16;
+  EVB::pFragmentBlock pBlock = allocateFragmentBlock(2*fragSize);
+  ASSERT(pBlock->s_size >= 2*fragSize);
+  EQ((uint32_t)1, pBlock->s_references);
+
+  EVB::pFlatFragment pFlat1 = reinterpret_cast<EVB::pFlatFragment>(pBlock->s_pData);
+  EVB::pFlatFragment pFlat2 = reinterpret_cast<EVB::pFlatFragment>(pBlock->s_pData + fragSize);
+  EVB::FragmentHeader hdr = {1234, 1, 16, 0};
+  pFlat1->s_header = hdr;
+  hdr.s_timestamp = 1235;
+  pFlat2->s_header = hdr;
+
+  EVB::pFragment frag1 = referenceFragment(pBlock, pFlat1);
+  EVB::pFragment frag2 = referenceFragment(pBlock, pFlat2);
+  releaseFragmentBlock(pBlock);
+  EQ((uint32_t)2, pBlock->s_references);
+
+  EQ((uint64_t)1234, frag1->s_header.s_timestamp);
+  EQ((uint64_t)1235, frag2->s_header.s_timestamp);
+  EQ((void*)pFlat1->s_body, frag1->s_pBody);
+  EQ(pBlock, frag2->s_pBlock);
+
+  EVB::FragmentPoolStatistics stats;
+  getFragmentPoolStatistics(&stats);
+  EQ((uint64_t)2, stats.s_referenced);
+  EQ((uint64_t)0, stats.s_allocations);   // No bodies needed.
+  EQ((uint64_t)1, stats.s_blocksInUse);
+  EQ((uint64_t)pBlock->s_size, stats.s_blockBytes);
+
+  freeFragment(frag1);
+  getFragmentPoolStatistics(&stats);
+  EQ((uint64_t)1, stats.s_blocksInUse);
+
+  freeFragmentList(&frag2, 1);
+  getFragmentPoolStatistics(&stats);
+  EQ((uint64_t)0, stats.s_blocksInUse);
+  EQ((uint64_t)0, stats.s_blockBytes);
+}
+// Released blocks are reused for blocks of the same size class.
+
+void Fragalloctest::blockreuse()
+{
+  EVB::pFragmentBlock pBlock1 = allocateFragmentBlock(1000);
+  releaseFragmentBlock(pBlock1);
+  EVB::pFragmentBlock pBlock2 = allocateFragmentBlock(600);
+  EQ(pBlock1, pBlock2);
+  EQ((uint32_t)1, pBlock2->s_references);
+  releaseFragmentBlock(pBlock2);
+}
@@ -19,14 +19,46 @@
  *  @brief: Implement fragment command stubs.
  */
 #include "fragcmdstubs.h"
+#include <stdlib.h>
 
 CFragmentHandler* CFragmentHandler::m_pInstance(nullptr);
 
 void
-CFragmentHandler::addFragments(unsigned long nFrags, const EVB::FlatFragment* pFrags)
+CFragmentHandler::addFragments(
+    unsigned long nFrags, const EVB::FlatFragment* pFrags, EVB::pFragmentBlock pBlock
+)
 {
     m_nLastSize = nFrags;
     m_pLastFrags = pFrags;
+    m_pLastBlock = pBlock;
+    
+    // Blocks are released when we return so keep a copy of the data:
+    
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(pFrags);
+    m_lastData.assign(p, p + nFrags);
+}
+
+// Fragment block stubs - the blocks are just malloced:
+
+extern "C" {
+EVB::pFragmentBlock
+allocateFragmentBlock(size_t nBytes)
+{
+    EVB::pFragmentBlock p =
+        static_cast<EVB::pFragmentBlock>(malloc(sizeof(EVB::FragmentBlock) + nBytes));
+    p->s_references = 1;
+    p->s_pool       = 0;
+    p->s_size       = nBytes;
+    p->s_pData      = reinterpret_cast<uint8_t*>(p + 1);
+    return p;
+}
+void
+releaseFragmentBlock(EVB::pFragmentBlock p)
+{
+    if (--p->s_references == 0) {
+        free(p);
+    }
+}
 }
 
 CFragmentHandler*
@@ -22,15 +22,22 @@
 #ifndef FRAGCMDSTUBS_H
 #define FRAGCMDSTUBS_H
 #include "fragment.h"
+#include <vector>
+#include <stdint.h>
 
 class CFragmentHandler
 {
 public:
     unsigned long      m_nLastSize;
     const EVB::FlatFragment* m_pLastFrags;
+    EVB::pFragmentBlock      m_pLastBlock;
+    std::vector<uint8_t>     m_lastData;
    static CFragmentHandler* m_pInstance;
 public:
-    void addFragments(unsigned long nFrags, const EVB::FlatFragment* pFrags);
+    void addFragments(
+        unsigned long nFrags, const EVB::FlatFragment* pFrags,
+        EVB::pFragmentBlock pBlock = 0
+    );
     static CFragmentHandler* getInstance();
 };
 
@@ -30,11 +30,17 @@
 #include "TCLInterpreter.h"
 #include "TCLObject.h"
 #include <vector>
+#include <string>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
 
 class fragcmdtest : public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE(fragcmdtest);
     CPPUNIT_TEST(frags_1);
     CPPUNIT_TEST(frags_2);
+    CPPUNIT_TEST(read_1);
     CPPUNIT_TEST_SUITE_END();
     
 private:
@@ -56,6 +62,7 @@ public:
 protected:
     void frags_1();
     void frags_2();
+    void read_1();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(fragcmdtest);
@@ -105,5 +112,48 @@ void fragcmdtest::frags_2()
     }
 }
 
+void fragcmdtest::read_1()
+{
+    // -read reads the body from the socket into a block and acks it.
+    
+    int fds[2];
+    EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    Tcl_Channel chan = Tcl_MakeFileChannel(
+        reinterpret_cast<ClientData>(static_cast<intptr_t>(fds[0])),
+        TCL_READABLE | TCL_WRITABLE
+    );
+    Tcl_RegisterChannel(m_pInterp->getInterpreter(), chan);
+    Tcl_SetChannelOption(nullptr, chan, "-translation", "binary");
+    
+    uint8_t bytes[100];
+    for (int i =0; i < 100; i++) bytes[i] = i;
+    EQ(ssize_t(100), write(fds[1], bytes, 100));
+    
+    CTCLObject name; name.Bind(*m_pInterp);
+    name = "command";
+    CTCLObject sock; sock.Bind(*m_pInterp);
+    sock = Tcl_GetChannelName(chan);
+    CTCLObject readOpt; readOpt.Bind(*m_pInterp);
+    readOpt = "-read";
+    CTCLObject size; size.Bind(*m_pInterp);
+    size = 100;
+    std::vector<CTCLObject> command = {name, sock, readOpt, size};
+    int status = (*m_pCmd)(*m_pInterp, command);
+    EQ(TCL_OK, status);
+    EQ(size_t(100), m_pStubs->m_nLastSize);
+    ASSERT(m_pStubs->m_pLastBlock);
+    EQ(size_t(100), m_pStubs->m_lastData.size());
+    for (int i =0; i < 100; i++) {
+        EQ(bytes[i], m_pStubs->m_lastData[i]);
+    }
+    
+    char ack[3];
+    EQ(ssize_t(3), read(fds[1], ack, 3));
+    EQ(std::string("OK\n"), std::string(ack, 3));
+    
+    Tcl_UnregisterChannel(m_pInterp->getInterpreter(), chan);
+    close(fds[1]);
+}
+
 void* gpTCLApplication(nullptr);
 
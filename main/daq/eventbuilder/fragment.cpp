@@ -23,6 +23,7 @@
 #include <thread>
 #include <iostream>
 #include <memory>
+#include <new>
 
 namespace EVB {
 bool debug=false;
@@ -50,6 +51,20 @@ bool debug=false;
  *    pool into which the block is returned.  The set of pools itself is
  *    resized as needed to ensure we have sufficient pools to satsify the
  *    memory request so far.
+ *
+ *    Empty pools are not refilled one malloc at a time.  A slab of
+ *    SLAB_BYTES (or one block if that's bigger) is malloced and carved into
+ *    blocks that all go into the pool, so at high fragment rates malloc is
+ *    only called while the pools are growing.  Slabs are never returned to the
+ *    heap (except by resetFragmentPool).  The output thread gives back all
+ *    the fragments of a batch with a single lock (freeFragmentList).
+ *
+ *    Fragments need not have a body of their own at all.  The orderer
+ *    receives fragments a message at a time into a FragmentBlock and
+ *    referenceFragment makes fragments whose bodies point into the block.
+ *    The block is reference counted (atomically, since the last reference
+ *    usually goes away in the output thread) and returns to a block pool
+ *    sized like the body pools when the last fragment in it is freed.
  */ 
   
 // The pool below is for fragment headers:
@@ -64,6 +79,20 @@ FragmentHeaderPool fragmentHeaderPool;
 
 std::vector<FragmentBodyPool> fragmentBodyPools;
 
+// Pools of free fragment blocks, indexed like fragmentBodyPools:
+
+typedef std::vector<pFragmentBlock> FragmentBlockPool;
+std::vector<FragmentBlockPool> fragmentBlockPools;
+
+// Slabs the blocks in the pools were carved from:
+
+std::vector<void*> slabs;
+
+static const size_t SLAB_BYTES(64*1024);
+static const size_t MIN_BLOCK(16);        // Keeps carved bodies aligned.
+
+FragmentPoolStatistics poolStatistics = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
 CMutex poolProtector;             // So we're threadsafe.
 
 /**
@@ -73,17 +102,48 @@ CMutex poolProtector;             // So we're threadsafe.
 void
 resetFragmentPool()
 {
-  while(!fragmentHeaderPool.empty()) {
-    free(fragmentHeaderPool.back());
-    fragmentHeaderPool.pop_back();
-  }
-  while(!fragmentBodyPools.empty()) {
-    FragmentBodyPool& pool(fragmentBodyPools.back());
-    while(!pool.empty()) {
-      free(pool.back());
-      pool.pop_back();
+  fragmentHeaderPool.clear();
+  fragmentBodyPools.clear();
+  for (unsigned i = 0; i < fragmentBlockPools.size(); i++) {
+    FragmentBlockPool& pool(fragmentBlockPools[i]);
+    for (unsigned j = 0; j < pool.size(); j++) {
+      free(pool[j]);
     }
-    fragmentBodyPools.pop_back();
+  }
+  fragmentBlockPools.clear();
+  while(!slabs.empty()) {
+    free(slabs.back());
+    slabs.pop_back();
+  }
+  memset(&poolStatistics, 0, sizeof(poolStatistics));
+}
+/**
+ * allocateSlab
+ *    Get a new slab and carve it into blocks that are pushed on a pool.
+ *    The blocks are pushed so that the lowest addressed block is given
+ *    out first.
+ *
+ * @param pool      - The pool that gets the blocks.
+ * @param blockSize - Size of each block.
+ */
+template<typename T>
+static void
+allocateSlab(std::vector<T>& pool, size_t blockSize)
+{
+  if (blockSize < MIN_BLOCK) blockSize = MIN_BLOCK;
+  size_t nBlocks = SLAB_BYTES/blockSize;
+  if (nBlocks == 0) nBlocks = 1;
+
+  uint8_t* pSlab = static_cast<uint8_t*>(malloc(nBlocks*blockSize));
+  if (!pSlab) {
+    throw std::bad_alloc();
+  }
+  slabs.push_back(pSlab);
+  poolStatistics.s_slabs++;
+  poolStatistics.s_slabBytes += nBlocks*blockSize;
+
+  for (size_t i = nBlocks; i > 0; i--) {
+    pool.push_back(reinterpret_cast<T>(pSlab + (i-1)*blockSize));
   }
 }
 
@@ -168,13 +228,11 @@ poolSize(unsigned poolNo)
 static pFragment
 getFragmentDescription()
 {
-  pFragment result(0);
-  if (!fragmentHeaderPool.empty()) {
-    result = fragmentHeaderPool.back();
-    fragmentHeaderPool.pop_back();
-  } else {
-    result = static_cast<pFragment>(malloc(sizeof(Fragment)));
+  if (fragmentHeaderPool.empty()) {
+    allocateSlab(fragmentHeaderPool, sizeof(Fragment));
   }
+  pFragment result = fragmentHeaderPool.back();
+  fragmentHeaderPool.pop_back();
   return result;
 }
 
@@ -199,23 +257,68 @@ freeFragmentHeader(pFragment pHeader)
 static void*
 getFragmentBody(size_t bytes)
 {
-  void* result(nullptr);
-  
   int poolNo = getPoolNumber(bytes);
   FragmentBodyPool& pool(getPool(poolNo));          // Makes more pools if needed.
   
+  poolStatistics.s_allocations++;
   if (pool.empty()) {
     if (debug) std::cerr << std::this_thread::get_id() << " pool " << poolNo << " empty\n";
-    result = malloc(poolSize(poolNo));
+    allocateSlab(pool, poolSize(poolNo));
   } else {
     if (debug) std::cerr << std::this_thread::get_id() << " Satsified body from pool\n";
-    result = pool.back();
-    pool.pop_back();
+    poolStatistics.s_poolHits++;
   }
+  void* result = pool.back();
+  pool.pop_back();
+  poolStatistics.s_inUse++;
   if (debug) std::cerr.flush();
   return result;
 }
 
+/**
+ * getBlockPool
+ *    Same as getPool but for the fragment block pools.
+ *
+ * @param poolNo - pool number.
+ * @return FragmentBlockPool&
+ */
+static FragmentBlockPool&
+getBlockPool(unsigned poolNo)
+{
+  while (poolNo >= fragmentBlockPools.size()) {
+    fragmentBlockPools.push_back(FragmentBlockPool());
+  }
+  return fragmentBlockPools[poolNo];
+}
+/**
+ * freeFragmentBlock
+ *    Return a block nobody references any more to its pool.
+ *    The caller must hold poolProtector.
+ *
+ * @param pBlock - the block.
+ */
+static void
+freeFragmentBlock(pFragmentBlock pBlock)
+{
+  getBlockPool(pBlock->s_pool).push_back(pBlock);
+  poolStatistics.s_blocksInUse--;
+  poolStatistics.s_blockBytes -= pBlock->s_size;
+}
+/**
+ * dereferenceBlock
+ *    Drop a reference to a block, freeing it if that was the last one.
+ *    The caller must hold poolProtector.
+ *
+ * @param pBlock - the block.
+ */
+static void
+dereferenceBlock(pFragmentBlock pBlock)
+{
+  if (__atomic_sub_fetch(&pBlock->s_references, 1, __ATOMIC_ACQ_REL) == 0) {
+    freeFragmentBlock(pBlock);
+  }
+}
+
 /**
  * freeFragmentBody
  *    Given a fragment header returns the fragment body to the appropriate
@@ -226,9 +329,15 @@ getFragmentBody(size_t bytes)
 static void
 freeFragmentBody(pFragment pFrag)
 {
+  if (pFrag->s_pBlock) {
+    dereferenceBlock(pFrag->s_pBlock);
+    pFrag->s_pBlock = 0;
+    return;
+  }
   unsigned poolNo = getPoolNumber(pFrag->s_header.s_size);
   FragmentBodyPool& pool(getPool(poolNo));
   pool.push_back(pFrag->s_pBody);
+  poolStatistics.s_inUse--;
 }
 /**
  * Free a fragment.  The assumption is that  both the header and the body 
@@ -247,6 +356,46 @@ void freeFragment(pFragment p)
   freeFragmentHeader(p);
 
 
+}
+}
+/**
+ * Free a batch of fragments.  This is the same as calling freeFragment
+ * on each of them but the pools are only locked once.
+ *
+ * @param pFrags - Pointer to the fragment pointers.
+ * @param n      - Number of fragments.
+ */
+extern "C" {
+void freeFragmentList(pFragment* pFrags, size_t n)
+{
+  CriticalSection critsect(poolProtector);
+
+  for (size_t i = 0; i < n; i++) {
+    pFragment p = pFrags[i];
+    freeFragmentBody(p);
+    p->s_pBody = 0;
+    freeFragmentHeader(p);
+  }
+}
+}
+/**
+ * Return the fragment pool statistics.
+ *
+ * @param pStats - Filled in with the statistics.  s_freeBlocks and
+ *                 s_freeBytes are computed from the pools on each call.
+ */
+extern "C" {
+void getFragmentPoolStatistics(pFragmentPoolStatistics pStats)
+{
+  CriticalSection critsect(poolProtector);
+
+  *pStats = poolStatistics;
+  pStats->s_freeBlocks = 0;
+  pStats->s_freeBytes  = 0;
+  for (unsigned i = 0; i < fragmentBodyPools.size(); i++) {
+    pStats->s_freeBlocks += fragmentBodyPools[i].size();
+    pStats->s_freeBytes  += fragmentBodyPools[i].size() * poolSize(i);
+  }
 }
 }
 /**
@@ -269,6 +418,7 @@ pFragment allocateFragment(const FragmentHeader* pHeader)
   memcpy(&(p->s_header), pHeader, sizeof(FragmentHeader));
 
   p->s_pBody = getFragmentBody(pHeader->s_size);
+  p->s_pBlock = 0;
 
   return p;
 
@@ -291,6 +441,82 @@ pFragment newFragment(uint64_t timestamp, uint32_t sourceId, uint32_t size)
   return allocateFragment(&h);
 }
 }
+/**
+ * Allocate a fragment block.  The caller holds the only reference
+ * to the block and must release it with releaseFragmentBlock once it
+ * has made all the fragments it's going to make from the block.
+ *
+ * @param nBytes - Minimum number of bytes of storage needed.
+ * @return pFragmentBlock - Block with at least nBytes at s_pData.
+ */
+extern "C" {
+pFragmentBlock allocateFragmentBlock(size_t nBytes)
+{
+  CriticalSection critsect(poolProtector);
+
+  unsigned poolNo = getPoolNumber(nBytes);
+  FragmentBlockPool& pool(getBlockPool(poolNo));
+  pFragmentBlock result;
+  if (pool.empty()) {
+    size_t size = static_cast<size_t>(1) << poolNo;
+    result = static_cast<pFragmentBlock>(malloc(sizeof(FragmentBlock) + size));
+    if (!result) {
+      throw std::bad_alloc();
+    }
+    result->s_pool  = poolNo;
+    result->s_size  = size;
+    result->s_pData = reinterpret_cast<uint8_t*>(result + 1);
+  } else {
+    result = pool.back();
+    pool.pop_back();
+  }
+  result->s_references = 1;
+  poolStatistics.s_blocksInUse++;
+  poolStatistics.s_blockBytes += result->s_size;
+
+  return result;
+}
+}
+/**
+ * Release the caller's reference to a fragment block.  The block is
+ * returned to its pool if no fragments refer to it.
+ *
+ * @param pBlock - The block.
+ */
+extern "C" {
+void releaseFragmentBlock(pFragmentBlock pBlock)
+{
+  if (__atomic_sub_fetch(&pBlock->s_references, 1, __ATOMIC_ACQ_REL) == 0) {
+    CriticalSection critsect(poolProtector);
+    freeFragmentBlock(pBlock);
+  }
+}
+}
+/**
+ * Make a fragment from a flat fragment that lives in a block.
+ * The header is copied but the body is not; the fragment points into
+ * the block and holds a reference to it until it is freed with
+ * freeFragment or freeFragmentList.
+ *
+ * @param pBlock - The block the flat fragment is in.
+ * @param pFlat  - The flat fragment.
+ * @return pFragment
+ */
+extern "C" {
+pFragment referenceFragment(pFragmentBlock pBlock, const FlatFragment* pFlat)
+{
+  CriticalSection critsect(poolProtector);
+
+  pFragment p = getFragmentDescription();
+  memcpy(&(p->s_header), &(pFlat->s_header), sizeof(FragmentHeader));
+  p->s_pBody  = const_cast<int*>(pFlat->s_body);
+  p->s_pBlock = pBlock;
+  __atomic_add_fetch(&pBlock->s_references, 1, __ATOMIC_ACQ_REL);
+  poolStatistics.s_referenced++;
+
+  return p;
+}
+}
 /**
  * Determine the total number of bytes needed to flatten a fragment chain out into
  * memory (e.g. a message payload).
@@ -72,6 +72,19 @@ namespace EVB {
 
 
   
+  /**
+   * A block of received data holding several flat fragments.  Fragments
+   * made by referenceFragment point into the block rather than having
+   * their own body.  The block goes back to its pool when the last
+   * reference to it is released.
+   */
+  typedef struct _FragmentBlock {
+    uint32_t  s_references;	//< Fragments (and the creator) using the block.
+    uint32_t  s_pool;		//< Pool the block came from.
+    size_t    s_size;		//< Bytes of storage at s_pData.
+    uint8_t*  s_pData;		//< The data.
+  } FragmentBlock, *pFragmentBlock;
+
   /**
    * Within the event builder fragments and payloads get bundled
    * together into something that looks like:
@@ -79,6 +92,7 @@ namespace EVB {
   typedef struct __attribute__((__packed__)) _Fragment {
     FragmentHeader   s_header;
     void*           s_pBody;
+    struct _FragmentBlock* s_pBlock; //< Block s_pBody points into or null.
   } Fragment, *pFragment;
 
 
@@ -96,6 +110,22 @@ namespace EVB {
     int            s_body[0];
   } FlatFragment, *pFlatFragment;
 
+  /**
+   * Statistics of the pools allocateFragment gets fragment storage from.
+   */
+  typedef struct _FragmentPoolStatistics {
+    uint64_t s_allocations;	//< Fragments allocated.
+    uint64_t s_poolHits;	//< Of those, bodies reused from a pool.
+    uint64_t s_slabs;		//< Slabs malloced to fill the pools.
+    uint64_t s_slabBytes;	//< Bytes in those slabs.
+    uint64_t s_inUse;		//< Fragment bodies allocated but not freed.
+    uint64_t s_freeBlocks;	//< Bodies sitting in the pools.
+    uint64_t s_freeBytes;	//< Bytes in those bodies.
+    uint64_t s_referenced;	//< Fragments made by reference to a block.
+    uint64_t s_blocksInUse;	//< Blocks that are still referenced.
+    uint64_t s_blockBytes;	//< Bytes in those blocks.
+  } FragmentPoolStatistics, *pFragmentPoolStatistics;
+
 #ifdef __cplusplus
 }
 #endif
@@ -110,9 +140,16 @@ namespace EVB {
 #define NS(type) type
 #endif
     void freeFragment(NS(pFragment) p);
+    void freeFragmentList(NS(pFragment)* pFrags, size_t n);
+    void getFragmentPoolStatistics(NS(pFragmentPoolStatistics) pStats);
     NS(pFragment) allocateFragment(const NS(FragmentHeader*) pHeader);
     NS(pFragment) newFragment(uint64_t timestamp, uint32_t sourceId, uint32_t size);
 
+    NS(pFragmentBlock) allocateFragmentBlock(size_t nBytes);
+    void releaseFragmentBlock(NS(pFragmentBlock) pBlock);
+    NS(pFragment) referenceFragment(NS(pFragmentBlock) pBlock,
+				    const NS(FlatFragment*) pFlat);
+
     size_t fragmentChainLength(NS(pFragmentChain) p);
 #ifdef __cplusplus
   }
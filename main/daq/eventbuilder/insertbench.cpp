@@ -0,0 +1,142 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+// Benchmark of out of order fragment insertion into an orderer source queue.
+// A queue is held at a fixed depth (as if the build window kept that many
+// fragments queued) while batches of fragments are added and the oldest
+// popped.  A fraction of the fragments have timestamps that jump back
+// by a random amount up to the depth of the queue.  Two strategies are
+// timed as a function of that disorder fraction:
+//
+//   hunt - Each out of order fragment is inserted where it belongs by a
+//          reverse scan and a deque insert (what the orderer used to do).
+//   run  - Out of order fragments are collected and merged in with
+//          MergeSortedRun once per batch (what the orderer does now).
+//
+// Usage:
+//    insertbench ?depth? ?fragments? ?batch?
+//      depth     - Queue depth to hold (default 100000).
+//      fragments - Fragments to insert per measurement (default 1000000).
+//      batch     - Fragments per batch (received message) (default 100).
+//
+#include "fragment.h"
+#include "MergeSortedRun.h"
+
+#include <deque>
+#include <vector>
+#include <utility>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+typedef std::pair<time_t, EVB::pFragment> QueueElement;
+typedef std::deque<QueueElement>         Queue;
+
+static double
+now()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1.0e-9;
+}
+
+static bool
+stampLess(const QueueElement& e1, const QueueElement& e2)
+{
+  return e1.second->s_header.s_timestamp < e2.second->s_header.s_timestamp;
+}
+
+// Make the fragment headers to insert.  Timestamps step by 10 with a
+// fraction 'disorder' of them stepped back by up to depth steps.
+
+static void
+makeFragments(std::vector<EVB::Fragment>& frags, double disorder, size_t depth)
+{
+  srand48(1234);
+  uint64_t stamp = 10*depth;
+  for (size_t i = 0; i < frags.size(); i++) {
+    stamp += 10;
+    EVB::Fragment& f(frags[i]);
+    f.s_header.s_timestamp = stamp;
+    f.s_header.s_sourceId  = 0;
+    f.s_header.s_size      = 0;
+    f.s_header.s_barrier   = 0;
+    f.s_pBody              = 0;
+    f.s_pBlock             = 0;
+    if (drand48() < disorder) {
+      f.s_header.s_timestamp -= 10*static_cast<uint64_t>(drand48()*depth);
+    }
+  }
+}
+
+static void
+huntInsert(Queue& q, Queue&, const QueueElement& e)
+{
+  if (q.empty() || !stampLess(e, q.back())) {
+    q.push_back(e);
+  } else {
+    auto p = q.rbegin();
+    while ((p != q.rend()) && stampLess(e, *p)) p++;
+    q.insert(p.base(), e);
+  }
+}
+static void
+runInsert(Queue& q, Queue& late, const QueueElement& e)
+{
+  if (q.empty() || !stampLess(e, q.back())) {
+    q.push_back(e);
+  } else {
+    late.push_back(e);
+  }
+}
+
+// Time inserting all fragments, returns fragments/sec.
+
+static double
+measure(std::vector<EVB::Fragment>& frags, size_t depth, size_t batch,
+        void (*insert)(Queue&, Queue&, const QueueElement&))
+{
+  Queue q;
+  Queue late;
+  double start = now();
+  for (size_t i = 0; i < frags.size(); i++) {
+    insert(q, late, QueueElement(0, &frags[i]));
+    if (((i+1) % batch) == 0) {
+      MergeSortedRun(q, late, stampLess);
+      while (q.size() > depth) q.pop_front();
+    }
+  }
+  MergeSortedRun(q, late, stampLess);
+  return frags.size()/(now() - start);
+}
+
+int main(int argc, char** argv)
+{
+  size_t depth     = (argc > 1) ? atol(argv[1]) : 100000;
+  size_t fragments = (argc > 2) ? atol(argv[2]) : 1000000;
+  size_t batch     = (argc > 3) ? atol(argv[3]) : 100;
+
+  double fractions[] = {0.0, 0.0001, 0.001, 0.01, 0.1, 0.5};
+  std::vector<EVB::Fragment> frags(fragments);
+
+  printf("depth %lu fragments %lu batch %lu\n", depth, fragments, batch);
+  printf("disorder     hunt frags/sec      run frags/sec\n");
+  for (int i = 0; i < sizeof(fractions)/sizeof(double); i++) {
+    makeFragments(frags, fractions[i], depth);
+    double hunt = measure(frags, depth, batch, huntInsert);
+    double run  = measure(frags, depth, batch, runInsert);
+    printf("%8.4f %18.0f %18.0f\n", fractions[i], hunt, run);
+  }
+  return EXIT_SUCCESS;
+}
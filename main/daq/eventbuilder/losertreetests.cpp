@@ -0,0 +1,151 @@
+// Tests for LoserTreeMerge.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include "LoserTreeMerge.h"
+#include <deque>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdlib.h>
+
+typedef std::pair<uint64_t, size_t> Item;          // key, list.
+typedef std::deque<Item>            Items;
+
+static uint64_t itemKey(const Item& i)
+{
+  return i.first;
+}
+
+class LoserTreeTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(LoserTreeTest);
+  CPPUNIT_TEST(none);
+  CPPUNIT_TEST(one);
+  CPPUNIT_TEST(two);
+  CPPUNIT_TEST(ties);
+  CPPUNIT_TEST(emptylists);
+  CPPUNIT_TEST(runs);
+  CPPUNIT_TEST(random);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::vector<Items*> m_lists;
+public:
+  void setUp() {
+  }
+  void tearDown() {
+    for (size_t i = 0; i < m_lists.size(); i++) delete m_lists[i];
+    m_lists.clear();
+  }
+protected:
+  void none();
+  void one();
+  void two();
+  void ties();
+  void emptylists();
+  void runs();
+  void random();
+private:
+  void addList(const uint64_t* keys, size_t n) {
+    Items* pList = new Items;
+    for (size_t i = 0; i < n; i++) pList->push_back(Item(keys[i], m_lists.size()));
+    m_lists.push_back(pList);
+  }
+  // Merge and check against a stable sort by key then list.
+  void check() {
+    Items expected;
+    for (size_t i = 0; i < m_lists.size(); i++) {
+      expected.insert(expected.end(), m_lists[i]->begin(), m_lists[i]->end());
+    }
+    std::stable_sort(expected.begin(), expected.end());
+
+    Items result;
+    LoserTreeMerge(result, m_lists, itemKey);
+    EQ(expected.size(), result.size());
+    ASSERT(expected == result);
+    for (size_t i = 0; i < m_lists.size(); i++) {
+      ASSERT(m_lists[i]->empty());
+    }
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LoserTreeTest);
+
+void LoserTreeTest::none()
+{
+  Items result;
+  LoserTreeMerge(result, m_lists, itemKey);
+  ASSERT(result.empty());
+}
+
+void LoserTreeTest::one()
+{
+  uint64_t keys[] = {1, 2, 3};
+  addList(keys, 3);
+  check();
+}
+
+void LoserTreeTest::two()
+{
+  uint64_t keys1[] = {1, 4, 5, 9};
+  uint64_t keys2[] = {2, 3, 6, 7, 8};
+  addList(keys1, 4);
+  addList(keys2, 5);
+  check();
+}
+// Equal keys come out in list order.
+
+void LoserTreeTest::ties()
+{
+  uint64_t keys[] = {5, 5, 10};
+  addList(keys, 3);
+  addList(keys, 3);
+  addList(keys, 3);
+  check();
+}
+// Some lists start out empty; a non power of two count.
+
+void LoserTreeTest::emptylists()
+{
+  uint64_t keys1[] = {3, 4};
+  uint64_t keys2[] = {1, 7};
+  addList(keys1, 2);
+  addList(keys1, 0);
+  addList(keys2, 2);
+  addList(keys2, 0);
+  addList(keys1, 2);
+  check();
+}
+// Long runs from one list are moved in bulk - still in the right order.
+
+void LoserTreeTest::runs()
+{
+  uint64_t keys1[] = {1, 2, 3, 4, 5, 6, 50, 51};
+  uint64_t keys2[] = {7, 8, 9, 10, 11, 12, 13, 40};
+  uint64_t keys3[] = {6, 14, 15, 16, 52};
+  addList(keys1, 8);
+  addList(keys2, 8);
+  addList(keys3, 5);
+  check();
+}
+
+void LoserTreeTest::random()
+{
+  srand48(4321);
+  for (int trial = 0; trial < 20; trial++) {
+    tearDown();
+    size_t nLists = 1 + (lrand48() % 40);
+    for (size_t i = 0; i < nLists; i++) {
+      std::vector<uint64_t> keys(lrand48() % 50);
+      uint64_t key = 0;
+      for (size_t j = 0; j < keys.size(); j++) {
+        key    += lrand48() % 4;        // Lots of ties.
+        keys[j] = key;
+      }
+      addList(keys.data(), keys.size());
+    }
+    check();
+  }
+}
@@ -0,0 +1,189 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+// Benchmark of the sort thread's k-way merge of source queue extents.
+// For 16, 64 and 256 sources, lists of fragments are made and merged
+// repeatedly by:
+//
+//   minheap - The multimap "minheap" that drops to a two way merge and
+//             then an append (what CSortThread used to do).
+//   loser   - LoserTreeMerge (what CSortThread does now).
+//
+// Two timestamp patterns are used:
+//   interleaved - Each source's timestamps advance by a random step so the
+//                 sources interleave fragment by fragment.
+//   bursts      - Sources emit bursts of consecutive fragments so one
+//                 source stays the minimum for a while.
+//
+// Usage:
+//    mergebench ?fragments? ?burst? ?repeats?
+//      fragments - Total fragments in each merge (default 1000000).
+//      burst     - Fragments per burst in the bursts pattern (default 50).
+//      repeats   - Merges timed per measurement (default 5).
+//
+#include "fragment.h"
+#include "LoserTreeMerge.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <utility>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+typedef std::pair<time_t, EVB::pFragment> QueueElement;
+typedef std::deque<QueueElement>         FragmentList;
+typedef std::deque<FragmentList*>        Fragments;
+
+static double
+now()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1.0e-9;
+}
+
+static uint64_t
+fragmentTimestamp(const QueueElement& e)
+{
+  return e.second->s_header.s_timestamp;
+}
+
+// The old merge:
+
+static void
+append(FragmentList& result, FragmentList& list)
+{
+  result.insert(result.end(), list.begin(), list.end());
+  list.clear();
+}
+static void
+merge2(FragmentList& result, FragmentList& list1, FragmentList& list2)
+{
+  while (!list1.empty() && !list2.empty()) {
+    if (fragmentTimestamp(list1.front()) < fragmentTimestamp(list2.front())) {
+      result.push_back(list1.front());
+      list1.pop_front();
+    } else {
+      result.push_back(list2.front());
+      list2.pop_front();
+    }
+  }
+  append(result, list1);
+  append(result, list2);
+}
+static void
+minheapMerge(FragmentList& result, Fragments& lists)
+{
+  std::multimap<uint64_t, FragmentList*> minheap;
+  for (size_t i = 0; i < lists.size(); i++) {
+    minheap.emplace(std::make_pair(fragmentTimestamp(lists[i]->front()), lists[i]));
+  }
+  while (minheap.size() > 2) {
+    auto q = minheap.begin();
+    FragmentList* pList = q->second;
+    result.push_back(pList->front());
+    pList->pop_front();
+    minheap.erase(q);
+    if (!pList->empty()) {
+      minheap.emplace(std::make_pair(fragmentTimestamp(pList->front()), pList));
+    }
+  }
+  if (minheap.size() == 2) {
+    merge2(result, *(minheap.begin()->second), *(minheap.rbegin()->second));
+  } else if (minheap.size() == 1) {
+    append(result, *(minheap.begin()->second));
+  }
+}
+static void
+loserMerge(FragmentList& result, Fragments& lists)
+{
+  LoserTreeMerge(result, lists, fragmentTimestamp);
+}
+
+// Make the fragments for a pattern.  Each source gets an equal share.
+
+static void
+makeFragments(std::vector<EVB::Fragment>& frags, size_t nSources, size_t burst)
+{
+  srand48(1234);
+  size_t perSource = frags.size()/nSources;
+  for (size_t s = 0; s < nSources; s++) {
+    uint64_t stamp = lrand48() % 100;
+    for (size_t i = 0; i < perSource; i++) {
+      if (burst) {
+        stamp += ((i % burst) == 0) ? (lrand48() % (100*burst*nSources)) : 1;
+      } else {
+        stamp += 1 + (lrand48() % (20*nSources));
+      }
+      EVB::Fragment& f(frags[s*perSource + i]);
+      f.s_header.s_timestamp = stamp;
+      f.s_header.s_sourceId  = s;
+      f.s_header.s_size      = 0;
+      f.s_header.s_barrier   = 0;
+      f.s_pBody              = 0;
+      f.s_pBlock             = 0;
+    }
+  }
+}
+
+// Time the merges, returns fragments/sec.
+
+static double
+measure(std::vector<EVB::Fragment>& frags, size_t nSources, int repeats,
+        void (*merge)(FragmentList&, Fragments&))
+{
+  size_t perSource = frags.size()/nSources;
+  double elapsed = 0;
+  for (int r = 0; r < repeats; r++) {
+    Fragments lists;
+    for (size_t s = 0; s < nSources; s++) {
+      FragmentList* pList = new FragmentList;
+      for (size_t i = 0; i < perSource; i++) {
+        pList->push_back(QueueElement(0, &frags[s*perSource + i]));
+      }
+      lists.push_back(pList);
+    }
+    FragmentList result;
+    double start = now();
+    merge(result, lists);
+    elapsed += now() - start;
+    for (size_t s = 0; s < nSources; s++) delete lists[s];
+  }
+  return repeats*perSource*nSources/elapsed;
+}
+
+int main(int argc, char** argv)
+{
+  size_t fragments = (argc > 1) ? atol(argv[1]) : 1000000;
+  size_t burst     = (argc > 2) ? atol(argv[2]) : 50;
+  int    repeats   = (argc > 3) ? atoi(argv[3]) : 5;
+
+  size_t sources[] = {16, 64, 256};
+  std::vector<EVB::Fragment> frags(fragments);
+
+  printf("fragments %lu burst %lu repeats %d\n", fragments, burst, repeats);
+  printf("pattern      sources  minheap frags/sec    loser frags/sec\n");
+  for (int pattern = 0; pattern < 2; pattern++) {
+    for (int i = 0; i < sizeof(sources)/sizeof(size_t); i++) {
+      makeFragments(frags, sources[i], pattern ? burst : 0);
+      double minheap = measure(frags, sources[i], repeats, minheapMerge);
+      double loser   = measure(frags, sources[i], repeats, loserMerge);
+      printf("%-12s %7lu %19.0f %18.0f\n", pattern ? "bursts" : "interleaved",
+             sources[i], minheap, loser);
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+// Tests for MergeSortedRun.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include "MergeSortedRun.h"
+#include <deque>
+#include <utility>
+
+typedef std::pair<int, int> Item;          // key, tag.
+typedef std::deque<Item>    Items;
+
+static bool keyLess(const Item& i1, const Item& i2)
+{
+  return i1.first < i2.first;
+}
+
+class MergeRunTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MergeRunTest);
+  CPPUNIT_TEST(empty);
+  CPPUNIT_TEST(middle);
+  CPPUNIT_TEST(front);
+  CPPUNIT_TEST(unsorted);
+  CPPUNIT_TEST(ties);
+  CPPUNIT_TEST(bigrun);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {
+  }
+  void tearDown() {
+  }
+protected:
+  void empty();
+  void middle();
+  void front();
+  void unsorted();
+  void ties();
+  void bigrun();
+private:
+  static Items make(const int* keys, int n, int tag) {
+    Items result;
+    for (int i = 0; i < n; i++) result.push_back(Item(keys[i], tag));
+    return result;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MergeRunTest);
+
+// An empty run leaves the container alone.
+
+void MergeRunTest::empty()
+{
+  int keys[] = {1, 2, 3};
+  Items c = make(keys, 3, 0);
+  Items run;
+  MergeSortedRun(c, run, keyLess);
+  EQ(size_t(3), c.size());
+  EQ(3, c.back().first);
+}
+// Run items land in the middle; the head is untouched.
+
+void MergeRunTest::middle()
+{
+  int keys[] = {1, 3, 5, 7};
+  int late[] = {4, 6};
+  Items c   = make(keys, 4, 0);
+  Items run = make(late, 2, 1);
+  MergeSortedRun(c, run, keyLess);
+
+  int expected[] = {1, 3, 4, 5, 6, 7};
+  EQ(size_t(6), c.size());
+  for (int i = 0; i < 6; i++) {
+    EQ(expected[i], c[i].first);
+  }
+  ASSERT(run.empty());
+}
+// Items older than everything go to the front.
+
+void MergeRunTest::front()
+{
+  int keys[] = {5, 6};
+  int late[] = {1};
+  Items c   = make(keys, 2, 0);
+  Items run = make(late, 1, 1);
+  MergeSortedRun(c, run, keyLess);
+  EQ(1, c.front().first);
+  EQ(size_t(3), c.size());
+}
+// The run need not be in order.
+
+void MergeRunTest::unsorted()
+{
+  int keys[] = {10, 20};
+  int late[] = {15, 2, 12, 8};
+  Items c   = make(keys, 2, 0);
+  Items run = make(late, 4, 1);
+  MergeSortedRun(c, run, keyLess);
+
+  int expected[] = {2, 8, 10, 12, 15, 20};
+  for (int i = 0; i < 6; i++) {
+    EQ(expected[i], c[i].first);
+  }
+}
+// Equal keys: container items first, then run items in run order.
+
+void MergeRunTest::ties()
+{
+  int keys[] = {1, 5, 9};
+  Items c = make(keys, 3, 0);
+  Items run;
+  run.push_back(Item(5, 1));
+  run.push_back(Item(5, 2));
+  MergeSortedRun(c, run, keyLess);
+
+  EQ(5, c[1].first);
+  EQ(0, c[1].second);
+  EQ(1, c[2].second);
+  EQ(2, c[3].second);
+  EQ(9, c[4].first);
+}
+// Longer runs are merged rather than inserted; same ordering rules.
+
+void MergeRunTest::bigrun()
+{
+  int keys[] = {0, 10, 20, 30, 40};
+  int late[] = {35, 5, 25, 15, 20, 5};
+  Items c   = make(keys, 5, 0);
+  Items run;
+  for (int i = 0; i < 6; i++) run.push_back(Item(late[i], i+1));
+  MergeSortedRun(c, run, keyLess);
+
+  int expected[] = {0, 5, 5, 10, 15, 20, 20, 25, 30, 35, 40};
+  EQ(size_t(11), c.size());
+  for (int i = 0; i < 11; i++) {
+    EQ(expected[i], c[i].first);
+  }
+  EQ(2, c[1].second);           // Run order kept for the 5s.
+  EQ(6, c[2].second);
+  EQ(0, c[5].second);           // Container's 20 before the run's.
+  EQ(5, c[6].second);
+  ASSERT(run.empty());
+}
@@ -23,6 +23,7 @@ class ObserverTests : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ObserverTests);
   CPPUNIT_TEST(dlate);
   CPPUNIT_TEST(observedup);
+  CPPUNIT_TEST(lateBarrier);
   //  CPPUNIT_TEST(generateBarrier_0);  // Threading breaks this badly.
   CPPUNIT_TEST_SUITE_END();
 
@@ -42,6 +43,7 @@ public:                                    // for the timer handler.
 protected:
   void dlate();
   void observedup();
+  void lateBarrier();
   void generateBarrier_0();
 };
 
@@ -163,7 +165,36 @@ public:
     std::vector<std::pair<uint32_t,uint32_t>> getLastBarrier() { return m_record;};
 };
 
+// A barrier that is out of order in its queue lands in the late run.
+// The barrier and empty queue checks must still see it.
 
+void ObserverTests::lateBarrier()
+{
+  CFragmentHandler::SourceQueue& q1(m_pFragHandler->getSourceQueue("s1", 1));
+  CFragmentHandler::SourceQueue& q2(m_pFragHandler->getSourceQueue("s2", 2));
+
+  EVB::pFragment pData    = newFragment(100, 1, 0);
+  EVB::pFragment pBarrier = newFragment(50, 1, 0);
+  pBarrier->s_header.s_barrier = 1;
+  m_pFragHandler->insertFragment(0, pData, q1);
+  m_pFragHandler->insertFragment(0, pBarrier, q1);
+  EQ(size_t(1), q1.s_late.size());
+
+  // Only a late fragment in q2:
+
+  EVB::pFragment pLate = newFragment(10, 2, 0);
+  q2.s_late.push_back(std::pair<time_t, EVB::pFragment>(0, pLate));
+
+  ASSERT(!m_pFragHandler->queuesEmpty());
+  ASSERT(m_pFragHandler->noEmptyQueue());
+  EQ(size_t(1), m_pFragHandler->countPresentBarriers());
+  EQ(pBarrier, q1.s_queue.front().second);
+
+  freeFragment(pData);
+  freeFragment(pBarrier);
+  freeFragment(pLate);
+  m_pFragHandler->m_FragmentQueues.clear();
+}
 
 
 void ObserverTests::generateBarrier_0()
@@ -0,0 +1,291 @@
+// Tests for CFragmentReceiver.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include "CFragmentReceiver.h"
+#include "CEventOrderClient.h"
+#include "fragment.h"
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string.h>
+
+// Sink that just saves the batches:
+
+class TestSink : public CFragmentReceiver::Sink
+{
+public:
+  std::mutex                             m_lock;
+  std::condition_variable                m_arrived;
+  std::vector<CFragmentReceiver::Batch>  m_batches;
+
+  virtual void put(const CFragmentReceiver::Batch& batch) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_batches.push_back(batch);
+    m_arrived.notify_all();
+  }
+  // Wait for at least n batches; returns how many there are.
+  size_t waitFor(size_t n, int ms = 2000) {
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_arrived.wait_for(
+      guard, std::chrono::milliseconds(ms),
+      [this, n]() { return m_batches.size() >= n; }
+    );
+    return m_batches.size();
+  }
+  void release() {
+    for (size_t i = 0; i < m_batches.size(); i++) {
+      if (m_batches[i].s_pBlock) releaseFragmentBlock(m_batches[i].s_pBlock);
+    }
+    m_batches.clear();
+  }
+};
+
+class ReceiverTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ReceiverTest);
+  CPPUNIT_TEST(fragments);
+  CPPUNIT_TEST(disconnect);
+  CPPUNIT_TEST(lost);
+  CPPUNIT_TEST(badtype);
+  CPPUNIT_TEST(prefix);
+  CPPUNIT_TEST(flow);
+  CPPUNIT_TEST(stop);
+  CPPUNIT_TEST(window);
+  CPPUNIT_TEST(overrun);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  int                m_peer;
+  TestSink*          m_pSink;
+  CFragmentReceiver* m_pReceiver;
+public:
+  void setUp() {
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    m_peer      = fds[0];
+    m_pSink     = new TestSink;
+    m_pReceiver = new CFragmentReceiver("sock1", fds[1], *m_pSink);
+  }
+  void tearDown() {
+    m_pReceiver->stop();
+    m_pReceiver->join();
+    delete m_pReceiver;
+    m_pSink->release();
+    delete m_pSink;
+    if (m_peer >= 0) close(m_peer);
+  }
+protected:
+  void fragments();
+  void disconnect();
+  void lost();
+  void badtype();
+  void prefix();
+  void flow();
+  void stop();
+  void window();
+  void overrun();
+private:
+  void makeWindowed(unsigned window) {
+    m_pReceiver->stop();
+    delete m_pReceiver;
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    close(m_peer);
+    m_peer      = fds[0];
+    m_pReceiver = new CFragmentReceiver("sock3", fds[1], *m_pSink, 0, 0, window);
+  }
+  void send(uint32_t type, const void* pBody, uint32_t nBytes) {
+    EVB::ClientMessageHeader hdr = {nBytes, type};
+    write(m_peer, &hdr, sizeof(hdr));
+    if (nBytes) write(m_peer, pBody, nBytes);
+  }
+  std::string reply() {
+    std::string result;
+    char c;
+    while ((read(m_peer, &c, 1) == 1)) {
+      result += c;
+      if (c == '\n') break;
+    }
+    return result;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReceiverTest);
+
+// Each FRAGMENTS body lands in a block and is acked.
+
+void ReceiverTest::fragments()
+{
+  m_pReceiver->start();
+  const char* body1 = "first message body";
+  const char* body2 = "second";
+  send(EVB::FRAGMENTS, body1, strlen(body1));
+  EQ(std::string("OK\n"), reply());
+  send(EVB::FRAGMENTS, body2, strlen(body2));
+  EQ(std::string("OK\n"), reply());
+
+  EQ(size_t(2), m_pSink->waitFor(2));
+  CFragmentReceiver::Batch& b(m_pSink->m_batches[0]);
+  ASSERT(b.s_pReceiver == m_pReceiver);
+  ASSERT(b.s_pBlock);
+  EQ(strlen(body1), b.s_nBytes);
+  EQ(0, memcmp(body1, b.s_pBlock->s_pData, b.s_nBytes));
+  EQ(strlen(body2), m_pSink->m_batches[1].s_nBytes);
+
+  CFragmentReceiver::Statistics stats = m_pReceiver->getStatistics();
+  EQ(uint64_t(2), stats.s_messages);
+  EQ(uint64_t(strlen(body1) + strlen(body2)), stats.s_bytes);
+  ASSERT(stats.s_lastReceived != 0);
+  EQ(CFragmentReceiver::ACTIVE, m_pReceiver->getState());
+}
+// DISCONNECT is acked and the final batch says we're closed.
+
+void ReceiverTest::disconnect()
+{
+  m_pReceiver->start();
+  send(EVB::DISCONNECT, 0, 0);
+  EQ(std::string("OK\n"), reply());
+  EQ(size_t(1), m_pSink->waitFor(1));
+  ASSERT(!m_pSink->m_batches[0].s_pBlock);
+  m_pReceiver->join();
+  EQ(CFragmentReceiver::CLOSED, m_pReceiver->getState());
+}
+// The peer just going away is LOST.
+
+void ReceiverTest::lost()
+{
+  m_pReceiver->start();
+  close(m_peer);
+  m_peer = -1;
+  EQ(size_t(1), m_pSink->waitFor(1));
+  m_pReceiver->join();
+  EQ(CFragmentReceiver::LOST, m_pReceiver->getState());
+}
+// Anything but FRAGMENTS/DISCONNECT is a protocol error.
+
+void ReceiverTest::badtype()
+{
+  m_pReceiver->start();
+  send(EVB::CONNECT, 0, 0);
+  std::string r = reply();
+  EQ(std::string("ERROR"), r.substr(0, 5));
+  EQ(size_t(1), m_pSink->waitFor(1));
+  m_pReceiver->join();
+  EQ(CFragmentReceiver::ERROR, m_pReceiver->getState());
+}
+// Data the Tcl channel had buffered is used first.
+
+void ReceiverTest::prefix()
+{
+  delete m_pReceiver;
+  int fds[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+  close(m_peer);
+  m_peer = fds[0];
+
+  const char* body = "0123456789";
+  uint8_t     buffered[sizeof(EVB::ClientMessageHeader) + 4];
+  EVB::ClientMessageHeader hdr = {10, EVB::FRAGMENTS};
+  memcpy(buffered, &hdr, sizeof(hdr));
+  memcpy(buffered + sizeof(hdr), body, 4);
+  m_pReceiver = new CFragmentReceiver(
+    "sock2", fds[1], *m_pSink, buffered, sizeof(buffered)
+  );
+  m_pReceiver->start();
+  write(m_peer, body + 4, 6);
+
+  EQ(std::string("OK\n"), reply());
+  EQ(size_t(1), m_pSink->waitFor(1));
+  EQ(size_t(10), m_pSink->m_batches[0].s_nBytes);
+  EQ(0, memcmp(body, m_pSink->m_batches[0].s_pBlock->s_pData, 10));
+}
+// Nothing is read while flowed off or while too many batches are pending.
+
+void ReceiverTest::flow()
+{
+  m_pReceiver->setFlow(false);
+  m_pReceiver->start();
+  send(EVB::FRAGMENTS, "abc", 3);
+  EQ(size_t(0), m_pSink->waitFor(1, 100));
+
+  m_pReceiver->setFlow(true);
+  EQ(std::string("OK\n"), reply());
+  EQ(size_t(1), m_pSink->waitFor(1));
+
+  // Fill the pending limit:
+
+  for (size_t i = 1; i < CFragmentReceiver::MAX_PENDING_BATCHES; i++) {
+    send(EVB::FRAGMENTS, "abc", 3);
+    EQ(std::string("OK\n"), reply());
+  }
+  size_t n = CFragmentReceiver::MAX_PENDING_BATCHES;
+  EQ(n, m_pSink->waitFor(n));
+  send(EVB::FRAGMENTS, "abc", 3);
+  EQ(n, m_pSink->waitFor(n+1, 100));
+
+  m_pReceiver->batchDone();
+  EQ(std::string("OK\n"), reply());
+  EQ(n+1, m_pSink->waitFor(n+1));
+}
+// stop breaks a blocked read; the final batch still comes.
+
+void ReceiverTest::stop()
+{
+  m_pReceiver->start();
+  m_pReceiver->stop();
+  EQ(size_t(1), m_pSink->waitFor(1));
+  ASSERT(!m_pSink->m_batches[0].s_pBlock);
+  ASSERT(m_pReceiver->isStopping());
+  m_pReceiver->join();
+}
+// Windowed: no OKs, credits come back as batches are done but not while
+// flowed off.
+
+void ReceiverTest::window()
+{
+  makeWindowed(4);
+  m_pReceiver->start();
+  for (int i = 0; i < 4; i++) {
+    send(EVB::FRAGMENTS, "abcd", 4);
+  }
+  EQ(size_t(4), m_pSink->waitFor(4));
+
+  m_pReceiver->batchDone();
+  m_pReceiver->batchDone();
+  EQ(std::string("CREDIT 1\n"), reply());
+  EQ(std::string("CREDIT 1\n"), reply());
+
+  m_pReceiver->setFlow(false);
+  m_pReceiver->batchDone();
+  m_pReceiver->batchDone();
+  m_pReceiver->setFlow(true);
+  EQ(std::string("CREDIT 2\n"), reply());
+
+  send(EVB::DISCONNECT, 0, 0);
+  EQ(std::string("OK\n"), reply());
+  EQ(size_t(5), m_pSink->waitFor(5));
+  m_pReceiver->join();
+  EQ(CFragmentReceiver::CLOSED, m_pReceiver->getState());
+}
+// Sending past the window is a protocol error.
+
+void ReceiverTest::overrun()
+{
+  makeWindowed(2);
+  m_pReceiver->start();
+  for (int i = 0; i < 3; i++) {
+    send(EVB::FRAGMENTS, "abcd", 4);
+  }
+  EQ(std::string("ERROR"), reply().substr(0, 5));
+  EQ(size_t(3), m_pSink->waitFor(3));
+  m_pReceiver->join();
+  EQ(CFragmentReceiver::ERROR, m_pReceiver->getState());
+}
@@ -0,0 +1,252 @@
+// Tests of the in-process glom output stage.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include "CRingGlomOutput.h"
+#include "fragment.h"
+#include <CRingBuffer.h>
+#include <DataFormat.h>
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// The fragment handler is mocked in outputTests.cpp.
+
+class RingGlomTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RingGlomTests);
+  CPPUNIT_TEST(format);
+  CPPUNIT_TEST(build);
+  CPPUNIT_TEST(nobuild);
+  CPPUNIT_TEST(maxfrags);
+  CPPUNIT_TEST(barrier);
+  CPPUNIT_TEST(outofband);
+  CPPUNIT_TEST(tee);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::string  m_ringName;
+  std::string  m_teeName;
+  CRingBuffer* m_pConsumer;
+  CRingBuffer* m_pTeeConsumer;
+  std::vector<EVB::pFragment> m_frags;
+public:
+  void setUp() {
+    std::stringstream s;
+    s << "glomtest_" << getpid();
+    m_ringName = s.str();
+    m_teeName  = m_ringName + "_tee";
+    CRingBuffer::create(m_ringName);
+    CRingBuffer::create(m_teeName);
+    m_pConsumer    = new CRingBuffer(m_ringName);
+    m_pTeeConsumer = new CRingBuffer(m_teeName);
+  }
+  void tearDown() {
+    delete m_pConsumer;
+    delete m_pTeeConsumer;
+    try { CRingBuffer::remove(m_ringName); } catch (...) {}
+    try { CRingBuffer::remove(m_teeName); } catch (...) {}
+    for (size_t i = 0; i < m_frags.size(); i++) {
+      freeFragment(m_frags[i]);
+    }
+    m_frags.clear();
+  }
+protected:
+  void format();
+  void build();
+  void nobuild();
+  void maxfrags();
+  void barrier();
+  void outofband();
+  void tee();
+private:
+  CRingGlomOutput* makeOutput(
+    uint64_t dt, bool nobuild = false, unsigned maxFrags = 1000, bool tee = false
+  ) {
+    return new CRingGlomOutput(
+      m_ringName.c_str(), tee ? m_teeName.c_str() : 0, dt, nobuild, 5,
+      GLOM_TIMESTAMP_FIRST, maxFrags
+    );
+  }
+  // Fragment wrapping a ring item.
+  EVB::pFragment fragment(uint64_t ts, uint32_t sid, pRingItem pItem, uint32_t barrier = 0) {
+    EVB::FragmentHeader hdr = {ts, sid, pItem->s_header.s_size, barrier};
+    EVB::pFragment p = allocateFragment(&hdr);
+    memcpy(p->s_pBody, pItem, pItem->s_header.s_size);
+    free(pItem);
+    m_frags.push_back(p);
+    return p;
+  }
+  EVB::pFragment physics(uint64_t ts, uint32_t sid) {
+    uint16_t payload[4] = {1, 2, 3, 4};
+    return fragment(ts, sid, reinterpret_cast<pRingItem>(formatEventItem(4, payload)));
+  }
+  EVB::pFragment stateChange(uint64_t ts, int type, uint32_t barrier) {
+    return fragment(
+      ts, 1,
+      reinterpret_cast<pRingItem>(formatStateChange(0, 0, 12, "title", type)),
+      barrier
+    );
+  }
+  void send(CRingGlomOutput& out, std::vector<EVB::pFragment> frags) {
+    EvbFragments event;
+    for (size_t i = 0; i < frags.size(); i++) {
+      event.push_back(std::make_pair(time_t(0), frags[i]));
+    }
+    out(event);
+  }
+  // Next item in a ring (empty if there is none).
+  std::vector<uint8_t> next(CRingBuffer* pRing) {
+    std::vector<uint8_t> result;
+    RingItemHeader hdr;
+    if (pRing->availableData() < sizeof(hdr)) return result;
+    pRing->peek(&hdr, sizeof(hdr));
+    result.resize(hdr.s_size);
+    pRing->get(result.data(), hdr.s_size, hdr.s_size);
+    return result;
+  }
+  uint32_t type(const std::vector<uint8_t>& item) {
+    return reinterpret_cast<const RingItemHeader*>(item.data())->s_type;
+  }
+  // Fragments in a built event.
+  unsigned fragCount(const std::vector<uint8_t>& item) {
+    const uint8_t* p   = item.data() + sizeof(RingItemHeader) + sizeof(BodyHeader);
+    uint32_t       n   = *reinterpret_cast<const uint32_t*>(p) - sizeof(uint32_t);
+    unsigned       result = 0;
+    p += sizeof(uint32_t);
+    while (n) {
+      const EVB::FragmentHeader* pH = reinterpret_cast<const EVB::FragmentHeader*>(p);
+      size_t fragBytes = sizeof(EVB::FragmentHeader) + pH->s_size;
+      p += fragBytes;
+      n -= fragBytes;
+      result++;
+    }
+    return result;
+  }
+  uint64_t timestamp(const std::vector<uint8_t>& item) {
+    return reinterpret_cast<const BodyHeader*>(
+      item.data() + sizeof(RingItemHeader)
+    )->s_timestamp;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RingGlomTests);
+
+// The first thing out is the ring format item.
+
+void RingGlomTests::format()
+{
+  CRingGlomOutput* pOut = makeOutput(10);
+  EQ(RING_FORMAT, type(next(m_pConsumer)));
+  ASSERT(next(m_pConsumer).empty());
+  delete pOut;
+}
+// Fragments within dt are glued; the event in progress is only committed
+// when it's done (here when we're destroyed).
+
+void RingGlomTests::build()
+{
+  CRingGlomOutput* pOut = makeOutput(10);
+  next(m_pConsumer);
+
+  send(*pOut, {physics(100, 1), physics(105, 2), physics(200, 1)});
+  std::vector<uint8_t> event = next(m_pConsumer);
+  EQ(PHYSICS_EVENT, type(event));
+  EQ(2U, fragCount(event));
+  EQ(uint64_t(100), timestamp(event));
+  ASSERT(next(m_pConsumer).empty());
+
+  send(*pOut, {physics(203, 3)});   // Still in the 200 event.
+  ASSERT(next(m_pConsumer).empty());
+
+  EQ(uint64_t(1), pOut->getEventCount());
+  delete pOut;
+  event = next(m_pConsumer);
+  EQ(PHYSICS_EVENT, type(event));
+  EQ(2U, fragCount(event));
+  EQ(uint64_t(200), timestamp(event));
+}
+// nobuild makes each fragment an event.
+
+void RingGlomTests::nobuild()
+{
+  CRingGlomOutput* pOut = makeOutput(10, true);
+  next(m_pConsumer);
+
+  send(*pOut, {physics(100, 1), physics(101, 2)});
+  EQ(1U, fragCount(next(m_pConsumer)));
+  delete pOut;
+  EQ(1U, fragCount(next(m_pConsumer)));
+}
+// Like glom, events are flushed once they have more than maxfrags.
+
+void RingGlomTests::maxfrags()
+{
+  CRingGlomOutput* pOut = makeOutput(10, false, 1);
+  next(m_pConsumer);
+
+  send(*pOut, {physics(100, 1), physics(100, 2), physics(100, 3)});
+  EQ(2U, fragCount(next(m_pConsumer)));
+  delete pOut;
+  EQ(1U, fragCount(next(m_pConsumer)));
+}
+// A begin barrier ends the event, goes out and is followed by the glom
+// parameters.  A run still active at the end gets an abnormal end.
+
+void RingGlomTests::barrier()
+{
+  CRingGlomOutput* pOut = makeOutput(10);
+  next(m_pConsumer);
+
+  send(*pOut, {physics(100, 1), stateChange(101, BEGIN_RUN, 1), physics(102, 1)});
+  EQ(PHYSICS_EVENT,   type(next(m_pConsumer)));
+  EQ(BEGIN_RUN,       type(next(m_pConsumer)));
+  EQ(EVB_GLOM_INFO,   type(next(m_pConsumer)));
+  ASSERT(next(m_pConsumer).empty());
+
+  delete pOut;
+  EQ(PHYSICS_EVENT,   type(next(m_pConsumer)));
+  EQ(ABNORMAL_ENDRUN, type(next(m_pConsumer)));
+  ASSERT(next(m_pConsumer).empty());
+}
+// Out of band items don't end the event but come after it.
+
+void RingGlomTests::outofband()
+{
+  CRingGlomOutput* pOut = makeOutput(10);
+  next(m_pConsumer);
+
+  const char* strings[] = {"a string"};
+  pRingItem pText = reinterpret_cast<pRingItem>(
+    formatTextItem(1, 0, 0, strings, MONITORED_VARIABLES)
+  );
+  send(*pOut, {physics(100, 1), fragment(101, 1, pText), physics(102, 2)});
+  ASSERT(next(m_pConsumer).empty());
+
+  delete pOut;
+  std::vector<uint8_t> event = next(m_pConsumer);
+  EQ(PHYSICS_EVENT, type(event));
+  EQ(2U, fragCount(event));
+  EQ(MONITORED_VARIABLES, type(next(m_pConsumer)));
+}
+// The tee ring gets every fragment as an EVB_FRAGMENT.
+
+void RingGlomTests::tee()
+{
+  CRingGlomOutput* pOut = makeOutput(10, false, 1000, true);
+  send(*pOut, {physics(100, 1), physics(105, 2)});
+  for (int i = 0; i < 2; i++) {
+    std::vector<uint8_t> item = next(m_pTeeConsumer);
+    EQ(EVB_FRAGMENT, type(item));
+    pEventBuilderFragment pFrag = reinterpret_cast<pEventBuilderFragment>(item.data());
+    EQ(uint64_t(i ? 105 : 100), pFrag->s_bodyHeader.s_timestamp);
+    EQ(uint32_t(i + 1), pFrag->s_bodyHeader.s_sourceId);
+  }
+  ASSERT(next(m_pTeeConsumer).empty());
+  delete pOut;
+}
@@ -163,6 +163,9 @@ class clienttest : public CppUnit::TestFixture {
     CPPUNIT_TEST(frag_3);
     CPPUNIT_TEST(frag_4);
     CPPUNIT_TEST(frag_5);
+
+    CPPUNIT_TEST(window_1);
+    CPPUNIT_TEST(window_2);
     CPPUNIT_TEST_SUITE_END();
 protected:
     void chainbytes_1();
@@ -193,13 +196,16 @@ protected:
     void frag_4();
     void frag_5();
 
+    void window_1();
+    void window_2();
+
 private:
     CPortManager*  m_pPortManager;
     int            m_nPort;
     CEventOrderClient* m_pClient;
   static int              m_seq;
 private:
-    SimulatorThread* setupSimulator();
+    SimulatorThread* setupSimulator(const char* response="OK\n");
     void             cleanupSimulator(SimulatorThread* thread);
     
 
@@ -793,9 +799,72 @@ void clienttest::frag_5()
     cleanupSimulator(thread);
 }
 
-SimulatorThread* clienttest::setupSimulator()
+void clienttest::window_1()
+{
+    // Asking for a window from an old server gets lock step.
+
+    SimulatorThread* thread = setupSimulator();
+    Simulator&       sim(thread->m_rSimulator);
+
+    std::list<int> sources; sources.push_back(1);
+    m_pClient->setWindow(4);
+    m_pClient->Connect("Window test", sources);
+    EQ(unsigned(1), m_pClient->getWindow());
+
+    delete m_pClient;
+    m_pClient = nullptr;
+    thread->join();
+
+    // The connect body has the trailer after the source ids:
+
+    Simulator::Request r = sim.m_requests[0];
+    EQ(sizeof(EVB::ConnectBody) + sizeof(uint32_t) + sizeof(EVB::ConnectTrailer),
+       size_t(r.s_hdr.s_bodySize));
+    EVB::pConnectBody b = static_cast<EVB::pConnectBody>(r.s_body);
+    EVB::pConnectTrailer t = reinterpret_cast<EVB::pConnectTrailer>(&(b->s_sids[1]));
+    EQ(EVB::PROTOCOL_WINDOWED, t->s_version);
+    EQ(uint32_t(4), t->s_window);
+    cleanupSimulator(thread);
+}
+void clienttest::window_2()
+{
+    // Windowed server - messages go out against credits.
+
+    SimulatorThread* thread = setupSimulator("OK WINDOW 4\n");
+    Simulator&       sim(thread->m_rSimulator);
+
+    uint8_t data[10];
+    for (int i =0; i < 10; i++) data[i] = i;
+    EVB::Fragment frag;
+    frag.s_header.s_size      = 10;
+    frag.s_header.s_sourceId  = 1;
+    frag.s_header.s_timestamp = 0x12345678;
+    frag.s_header.s_barrier   = 0;
+    frag.s_pBody = data;
+
+    std::list<int> sources; sources.push_back(1);
+    m_pClient->setWindow(8);
+    m_pClient->Connect("Window test", sources);
+    EQ(unsigned(4), m_pClient->getWindow());
+    sim.setResponse("CREDIT 1\n");
+
+    for (int i =0; i < 10; i++) {
+        CPPUNIT_ASSERT_NO_THROW(m_pClient->submitFragments(1, &frag));
+    }
+    delete m_pClient;
+    m_pClient = nullptr;
+    thread->join();
+
+    EQ(size_t(11), sim.m_requests.size());
+    for (int i = 1; i < 11; i++) {
+        EQ(EVB::FRAGMENTS, sim.m_requests[i].s_hdr.s_msgType);
+    }
+    cleanupSimulator(thread);
+}
+
+SimulatorThread* clienttest::setupSimulator(const char* response)
 {
-    Simulator* pSim = new Simulator(m_nPort);
+    Simulator* pSim = new Simulator(m_nPort, response);
     SimulatorThread* result = new SimulatorThread(*pSim);
     result->start();
     
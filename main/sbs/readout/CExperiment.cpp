@@ -104,12 +104,15 @@ CExperiment::CExperiment(string ringName,
   m_nDefaultSourceId(0),
   m_useBarriers(barriers),
   m_fWantZeroCopy(false),                // by default.
+  m_nBatchItems(1),                      // One item per commit by default.
+  m_nRingBytes(0),
   m_fNeedVmeLock(false)
 
 {
   try {
     m_pRing = CRingBuffer::createAndProduce(ringName);
     m_pRing->setPollInterval(0);
+    m_nRingBytes = m_pRing->getUsage().s_bufferSpace;
   } catch (CException& e) {
     std::cerr << "Could not attach ringbuffer : " << ringName << " "
       << e.ReasonText() << std::endl;
@@ -570,7 +573,9 @@ CExperiment::ReadEvent()
   // If the root event segment exists, read it into the data buffer
   // and put the resulting event in the ring buffer:
   //
-  if (m_pReadout) {
+  if (m_pReadout && (m_nBatchItems > 1)) {
+    readEventBatch();
+  } else if (m_pReadout) {
     do {
       m_fHavemore = false;       // Read can set this true to do an other ringitem.
       m_pReadout->keep();
@@ -946,18 +951,137 @@ CExperiment::readEvent(CRingItem& item)
       item.setBodyHeader(m_nEventTimestamp, m_nSourceId, 0);
     }
     item.commitToRing(*m_pRing);
-    m_nEventsEmitted++;
-    
-    m_statistics.s_cumulative.s_acceptedTriggers++;
-    
-    m_statistics.s_perRun.s_acceptedTriggers++;
-    
-    size_t nBytes = (nWords+2)*sizeof(uint16_t);
-    m_statistics.s_cumulative.s_bytes += nBytes;
-    m_statistics.s_perRun.s_bytes     += nBytes;
-    
+    countEvent((nWords+2)*sizeof(uint16_t));
   }  
 }
+/**
+ * readEventBatch
+ *    Reads all of the physics items for a trigger (the first one and
+ *    any the event segments ask for with haveMore) directly into one
+ *    ring buffer reservation that is committed once.  At most
+ *    m_nBatchItems items go in a reservation; if more than that are
+ *    read, the full batch is committed and a new reservation made.
+ *    The reservation is room for that many maximum sized items (or as
+ *    many as the ring holds).
+ *
+ *    Items are built in place if the reservation has room for a maximum
+ *    sized item before any wrap at the top of the ring.  Otherwise the item
+ *    is built in m_batchScratch and copied into the reservation.
+ */
+void
+CExperiment::readEventBatch()
+{
+  size_t maxItem    = sizeof(RingItemHeader) + sizeof(BodyHeader)
+    + m_nDataBufferSize + 100;
+  size_t batchItems = m_nBatchItems;
+  size_t ringItems  = m_nRingBytes ? (m_nRingBytes - 1)/maxItem : 0;
+  if (batchItems > ringItems) {
+    batchItems = ringItems;           // A reservation must fit in the ring.
+  }
+  if (batchItems < 1) {
+    batchItems = 1;
+  }
+  size_t batchBytes = maxItem*batchItems;
+  if (m_batchScratch.size() < maxItem) {
+    m_batchScratch.resize(maxItem);
+  }
+
+  CRingBuffer::Reservation space;
+  size_t   reserved = 0;                // Bytes in space.
+  size_t   written  = 0;                // Bytes of complete items in space.
+  unsigned nItems   = 0;                // Items in space.
+  do {
+    if (((reserved - written) < maxItem) || (nItems >= m_nBatchItems)) {
+      if (written) {
+        m_pRing->commit(written);
+      }
+      reserved = m_pRing->reserve(batchBytes, space);
+      written  = 0;
+      nItems   = 0;
+    }
+    m_fHavemore = false;       // Read can set this true to do an other ringitem.
+    m_pReadout->keep();
+    m_needHeader = false;
+    m_nEventTimestamp = 0;
+    m_nSourceId  = m_nDefaultSourceId;
+
+    bool     inPlace = (written + maxItem) <= space.s_firstBytes;
+    uint8_t* pItem   = inPlace ?
+      reinterpret_cast<uint8_t*>(space.s_pFirst) + written : m_batchScratch.data();
+    size_t   nBytes  = readEvent(reinterpret_cast<pRingItem>(pItem));
+    if (nBytes) {
+      if (!inPlace) {
+        space.copyIn(written, pItem, nBytes);
+      }
+      written += nBytes;
+      nItems++;
+    }
+    m_pReadout->clear();	// do any post event clears.
+  } while(m_fHavemore);
+
+  if (written) {
+    m_pRing->commit(written);
+  }
+}
+/**
+ * readEvent
+ *    Reads one event into a physics item built in place.
+ *
+ *  @param pItem - Where the item goes.  There must be room for the
+ *                 headers and m_nDataBufferSize+100 bytes of body.
+ *  @return size_t - Size of the item or 0 if the event was rejected.
+ */
+size_t
+CExperiment::readEvent(pRingItem pItem)
+{
+  uint8_t* pItemBytes = reinterpret_cast<uint8_t*>(pItem);
+  pItem->s_body.u_noBodyHeader.s_empty = sizeof(uint32_t);
+  uint16_t* pBuffer = reinterpret_cast<uint16_t*>(
+    pItemBytes + sizeof(RingItemHeader) + sizeof(uint32_t)
+  );
+
+  size_t nWords = m_pReadout->read(
+    pBuffer + 2, (m_nDataBufferSize - sizeof(uint32_t))/sizeof(uint16_t)
+  );
+
+  m_statistics.s_cumulative.s_triggers++;
+  m_statistics.s_perRun.s_triggers++;
+
+  if (m_pReadout->getAcceptState() != CEventSegment::Keep) {
+    return 0;
+  }
+  *(reinterpret_cast<uint32_t*>(pBuffer)) = nWords + 2;
+  size_t bodyBytes = (nWords+2)*sizeof(uint16_t);
+  size_t itemBytes;
+  if (m_needHeader) {
+    uint8_t* pBody = pItemBytes + sizeof(RingItemHeader) + sizeof(BodyHeader);
+    memmove(pBody, pBuffer, bodyBytes);
+    fillBodyHeader(pItem, m_nEventTimestamp, m_nSourceId, 0);
+    itemBytes = sizeof(RingItemHeader) + sizeof(BodyHeader) + bodyBytes;
+  } else {
+    itemBytes = sizeof(RingItemHeader) + sizeof(uint32_t) + bodyBytes;
+  }
+  fillRingHeader(pItem, itemBytes, PHYSICS_EVENT);
+  countEvent(bodyBytes);
+  return itemBytes;
+}
+/**
+ * countEvent
+ *    Account for an accepted event.
+ *
+ *  @param nBytes - Bytes of event body.
+ */
+void
+CExperiment::countEvent(size_t nBytes)
+{
+  m_nEventsEmitted++;
+
+  m_statistics.s_cumulative.s_acceptedTriggers++;
+  m_statistics.s_perRun.s_acceptedTriggers++;
+
+  m_statistics.s_cumulative.s_bytes += nBytes;
+  m_statistics.s_perRun.s_bytes     += nBytes;
+}
 
 /**
  * clearCounters
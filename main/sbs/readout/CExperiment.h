@@ -18,6 +18,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include  <time.h>
 #include <tcl.h>
 #include <TCLObject.h>
@@ -42,6 +43,7 @@ class CRingBuffer;
 class CEventSegment;
 class CScaler;
 class CRingItem;
+struct _RingItem;
 
 struct gengetopt_args_info;
 
@@ -96,6 +98,9 @@ private:
   bool                    m_useBarriers;
   bool                    m_fHavemore;      // If true readout has more events.
   bool                    m_fWantZeroCopy;  // Want zero copy ring items.
+  unsigned                m_nBatchItems;    // Max physics items per ring commit.
+  std::vector<uint8_t>    m_batchScratch;   // Item that would wrap in the ring.
+  size_t                  m_nRingBytes;     // Size of the ring data area.
   bool                    m_fNeedVmeLock;
 	CElapsedTime            m_runTime;
 	
@@ -152,10 +157,15 @@ public:
   void syncEndRun(bool pause);
   void haveMore() { m_fHavemore = true; }
   void setZeroCopy(bool state) {m_fWantZeroCopy = state;}
+  void setEventBatch(unsigned maxItems) {m_nBatchItems = maxItems;}
+  unsigned getEventBatch() const { return m_nBatchItems; }
 	const Statistics& getStatistics() const {return m_statistics; } 
 private:
   void readScalers();
 	void readEvent(CRingItem& item);
+  void readEventBatch();
+  size_t readEvent(struct _RingItem* pItem);
+  void countEvent(size_t nBytes);
 	
   static int HandleEndRunEvent(Tcl_Event* evPtr, int flags);
   static int HandleTriggerLoopError(Tcl_Event* evPtr, int flags);
@@ -0,0 +1,194 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+#include <config.h>
+#include "CSimulatedEventSegment.h"
+#include <CExperiment.h>
+#include <RangeError.h>
+#include <time.h>
+
+
+/*!
+   Construct the segment.
+   \param minWords     - Smallest event size in 16 bit words (at least 1).
+   \param maxWords     - Largest event size in words (0 means minWords).
+   \param distribution - How sizes are distributed between the two.
+   \param pExperiment  - Experiment to give timestamps to (see class comments).
+*/
+CSimulatedEventSegment::CSimulatedEventSegment(
+  size_t minWords, size_t maxWords, SizeDistribution distribution,
+  CExperiment* pExperiment
+) :
+  m_pExperiment(pExperiment),
+  m_timestampMode(NoTimestamp),
+  m_tick(1),
+  m_jitter(0),
+  m_timestamp(0),
+  m_events(0),
+  m_eventsPerTrigger(1),
+  m_eventInTrigger(0)
+{
+  setSizes(minWords, maxWords ? maxWords : minWords, distribution);
+}
+
+/*!
+   Change the event size distribution.
+   \throw CRangeError - minWords is 0 or maxWords is less than minWords.
+*/
+void
+CSimulatedEventSegment::setSizes(size_t minWords, size_t maxWords,
+				 SizeDistribution distribution)
+{
+  if (minWords < 1) {
+    throw CRangeError(1, maxWords, minWords, "Setting simulated event sizes");
+  }
+  if (maxWords < minWords) {
+    throw CRangeError(minWords, minWords, maxWords,
+		      "Setting simulated event sizes");
+  }
+  m_minWords     = minWords;
+  m_maxWords     = maxWords;
+  m_distribution = distribution;
+}
+/*!
+   Select the timestamp behavior.
+   \param mode   - What sort of timestamps to produce.
+   \param tick   - Counter mode ticks per event.
+   \param jitter - Counter mode maximum deviation from the nominal timestamp.
+*/
+void
+CSimulatedEventSegment::setTimestampMode(TimestampMode mode, uint64_t tick,
+					 uint64_t jitter)
+{
+  m_timestampMode = mode;
+  m_tick          = tick;
+  m_jitter        = jitter;
+}
+/*!
+   Seed the size and jitter generator so runs can be repeated.
+*/
+void
+CSimulatedEventSegment::setSeed(uint64_t seed)
+{
+  m_generator.seed(seed);
+}
+
+/*!
+   Set the number of events read for each trigger.
+*/
+void
+CSimulatedEventSegment::setEventsPerTrigger(unsigned nEvents)
+{
+  m_eventsPerTrigger = nEvents ? nEvents : 1;
+  m_eventInTrigger   = 0;
+}
+
+/*!
+   Each run starts counting events and timestamps from zero.
+*/
+void
+CSimulatedEventSegment::onBegin()
+{
+  m_events         = 0;
+  m_timestamp      = 0;
+  m_eventInTrigger = 0;
+}
+/*!
+   Produce an event.
+   \param pBuffer  - Where the event goes.
+   \param maxwords - Words available in pBuffer.
+   \return size_t  - Number of words put in pBuffer.
+   \throw CRangeError - the event drawn does not fit in maxwords.
+*/
+size_t
+CSimulatedEventSegment::read(void* pBuffer, size_t maxwords)
+{
+  size_t nWords = eventSize();
+  if (nWords > maxwords) {
+    throw CRangeError(0, maxwords, nWords, "Reading a simulated event");
+  }
+  uint16_t* p = reinterpret_cast<uint16_t*>(pBuffer);
+  *p++ = static_cast<uint16_t>(nWords);
+  uint16_t datum = static_cast<uint16_t>(m_events);
+  for (size_t i = 1; i < nWords; i++) {
+    *p++ = datum++;
+  }
+
+  if (m_timestampMode != NoTimestamp) {
+    uint64_t stamp = nextTimestamp();
+    if (m_pExperiment) {
+      m_pExperiment->setTimestamp(stamp);
+    } else {
+      setTimestamp(stamp);
+    }
+  }
+  m_events++;
+
+  if (m_pExperiment && (++m_eventInTrigger < m_eventsPerTrigger)) {
+    m_pExperiment->haveMore();
+  } else {
+    m_eventInTrigger = 0;
+  }
+  return nWords;
+}
+
+/*
+** Draw the size of the next event.
+*/
+size_t
+CSimulatedEventSegment::eventSize()
+{
+  switch (m_distribution) {
+  case Uniform:
+    {
+      std::uniform_int_distribution<size_t> sizes(m_minWords, m_maxWords);
+      return sizes(m_generator);
+    }
+  case Exponential:
+    {
+      double mean = (m_maxWords - m_minWords)/2.0;
+      size_t extra = 0;
+      if (mean > 0) {
+	std::exponential_distribution<double> sizes(1.0/mean);
+	extra = static_cast<size_t>(sizes(m_generator));
+      }
+      size_t result = m_minWords + extra;
+      return result > m_maxWords ? m_maxWords : result;
+    }
+  case Fixed:
+  default:
+    return m_minWords;
+  }
+}
+/*
+** Produce the timestamp for the next event.
+*/
+uint64_t
+CSimulatedEventSegment::nextTimestamp()
+{
+  if (m_timestampMode == Clock) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec)*1000000000 + now.tv_nsec;
+  }
+  // Counter:
+
+  m_timestamp += m_tick;
+  uint64_t stamp = m_timestamp;
+  if (m_jitter) {
+    std::uniform_int_distribution<uint64_t> offsets(0, 2*m_jitter);
+    uint64_t offset = offsets(m_generator);
+    stamp = (stamp + offset > m_jitter) ? stamp + offset - m_jitter : 0;
+  }
+  return stamp;
+}
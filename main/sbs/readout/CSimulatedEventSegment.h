@@ -0,0 +1,101 @@
+#ifndef CSIMULATEDEVENTSEGMENT_H
+#define CSIMULATEDEVENTSEGMENT_H
+
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+#include "CEventSegment.h"
+#include <stdint.h>
+#include <random>
+
+class CExperiment;
+
+/*!
+   An event segment that reads no hardware.  Each event it produces
+   is a number of 16 bit words drawn from a size distribution:
+   - Fixed       - always the minimum size.
+   - Uniform     - uniformly distributed between the minimum and maximum.
+   - Exponential - the minimum plus an exponentially distributed number of
+                   words with mean (max-min)/2, truncated at the maximum.
+
+   The first word of the event is its size in words (self inclusive); the
+   remaining words count up from the number of the event so that data can
+   be checked downstream.
+
+   The segment can also set an event timestamp:
+   - NoTimestamp - none is set (events have no body header).
+   - Counter     - timestamps count up by a fixed number of ticks per event.
+   - Clock       - the CLOCK_MONOTONIC time in nanoseconds.
+   A jitter can be added to Counter timestamps; it moves each timestamp
+   randomly by up to that many ticks in either direction, which lets
+   out of order timestamps be simulated.
+
+   Several events can be produced for each trigger.  The segment then asks
+   the experiment for another event (CExperiment::haveMore) until that many
+   have been read.
+
+   Timestamps are given to the experiment object passed to the constructor.
+   If none is given, the normal CEventSegment::setTimestamp is used, which
+   requires a CReadoutMain application.  Multiple events per trigger need
+   the experiment object.
+*/
+class CSimulatedEventSegment : public CEventSegment
+{
+public:
+  typedef enum _SizeDistribution {
+    Fixed, Uniform, Exponential
+  } SizeDistribution;
+  typedef enum _TimestampMode {
+    NoTimestamp, Counter, Clock
+  } TimestampMode;
+
+private:
+  CExperiment*       m_pExperiment;
+  SizeDistribution   m_distribution;
+  size_t             m_minWords;
+  size_t             m_maxWords;
+  TimestampMode      m_timestampMode;
+  uint64_t           m_tick;
+  uint64_t           m_jitter;
+  uint64_t           m_timestamp;
+  uint64_t           m_events;
+  unsigned           m_eventsPerTrigger;
+  unsigned           m_eventInTrigger;
+  std::mt19937_64    m_generator;
+
+public:
+  CSimulatedEventSegment(size_t minWords = 1, size_t maxWords = 0,
+			 SizeDistribution distribution = Fixed,
+			 CExperiment* pExperiment = 0);
+
+public:
+  void setSizes(size_t minWords, size_t maxWords,
+		SizeDistribution distribution);
+  void setTimestampMode(TimestampMode mode, uint64_t tick = 1,
+			uint64_t jitter = 0);
+  void setSeed(uint64_t seed);
+  void setEventsPerTrigger(unsigned nEvents);
+  uint64_t getEventCount() const { return m_events; }
+
+  // Event segment interface:
+
+public:
+  virtual void   onBegin();
+  virtual size_t read(void* pBuffer, size_t maxwords);
+
+private:
+  size_t   eventSize();
+  uint64_t nextTimestamp();
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+#include <config.h>
+#include "CSimulatedTrigger.h"
+#include "CTimedTrigger.h"	// timespec operators.
+
+
+static const long nsPerSec(1000*1000*1000); // Nanoseconds per second.
+
+/*!
+   Construct the trigger.
+   \param rate    - Mean triggers per second (0 fires on every poll).
+   \param spacing - Periodic or Random (Poisson) trigger spacing.
+   \param limit   - Number of triggers to give (0 for no limit).
+*/
+CSimulatedTrigger::CSimulatedTrigger(double rate, Spacing spacing,
+				     uint64_t limit) :
+  m_rate(rate),
+  m_spacing(spacing),
+  m_limit(limit),
+  m_count(0),
+  m_intervals(1.0)
+{
+  setup();
+}
+
+/*!
+   Change the mean trigger rate.  Takes effect after the next trigger.
+*/
+void
+CSimulatedTrigger::setRate(double rate)
+{
+  m_rate = rate;
+}
+/*!
+   Change between periodic and random trigger spacing.
+*/
+void
+CSimulatedTrigger::setSpacing(Spacing spacing)
+{
+  m_spacing = spacing;
+}
+/*!
+   Set the number of triggers to give after setup (0 for no limit).
+*/
+void
+CSimulatedTrigger::setLimit(uint64_t limit)
+{
+  m_limit = limit;
+}
+/*!
+   Seed the random spacing generator so runs can be repeated.
+*/
+void
+CSimulatedTrigger::setSeed(uint64_t seed)
+{
+  m_generator.seed(seed);
+}
+
+/*!
+   Called as the trigger loop starts.  The trigger count is cleared and
+   the first trigger is scheduled one interval from now.
+*/
+void
+CSimulatedTrigger::setup()
+{
+  m_count = 0;
+  clock_gettime(CLOCK_MONOTONIC, &m_nextTrigger);
+  advance();
+}
+
+/*!
+   Fires if the next trigger time has come (always if the rate is 0) and
+   the limit has not been reached.
+*/
+bool
+CSimulatedTrigger::operator()()
+{
+  if (exhausted()) {
+    return false;
+  }
+  if (m_rate > 0.0) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (!(now >= m_nextTrigger)) {
+      return false;
+    }
+    advance();
+  }
+  m_count++;
+  return true;
+}
+
+/*
+** Schedule the trigger after m_nextTrigger.
+*/
+void
+CSimulatedTrigger::advance()
+{
+  if (m_rate <= 0.0) {
+    return;
+  }
+  double interval = 1.0/m_rate;
+  if (m_spacing == Random) {
+    interval *= m_intervals(m_generator);
+  }
+  struct timespec dt;
+  dt.tv_sec  = static_cast<time_t>(interval);
+  dt.tv_nsec = static_cast<long>((interval - dt.tv_sec)*nsPerSec);
+  m_nextTrigger = m_nextTrigger + dt;
+}
@@ -0,0 +1,72 @@
+#ifndef CSIMULATEDTRIGGER_H
+#define CSIMULATEDTRIGGER_H
+
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+#include <CEventTrigger.h>
+#include <time.h>
+#include <stdint.h>
+#include <random>
+
+/*!
+  A trigger that needs no hardware.  It fires at a mean rate given in
+  triggers per second, either periodically or with exponentially distributed
+  (Poisson) spacing as beam triggers would have.  A rate of zero fires on
+  every poll, which measures how fast the readout can go.  If a limit is set,
+  the trigger stops firing after that many triggers have been given.
+
+  Time is measured with CLOCK_MONOTONIC.  Triggers that fall due while the
+  readout is busy are not lost; they fire on the following polls, so the
+  rate is kept as long as the readout can keep up.
+*/
+class CSimulatedTrigger : public CEventTrigger
+{
+public:
+  typedef enum _Spacing {
+    Periodic, Random
+  } Spacing;
+private:
+  double          m_rate;		// Triggers per second.
+  Spacing         m_spacing;
+  uint64_t        m_limit;		// 0 means no limit.
+  uint64_t        m_count;		// Triggers given since setup.
+  struct timespec m_nextTrigger;
+  std::mt19937_64 m_generator;
+  std::exponential_distribution<double> m_intervals;
+
+  // Canonicals:
+
+public:
+  CSimulatedTrigger(double rate = 0.0, Spacing spacing = Periodic,
+		    uint64_t limit = 0);
+
+  // Additional object member functions:
+public:
+  void     setRate(double rate);
+  void     setSpacing(Spacing spacing);
+  void     setLimit(uint64_t limit);
+  void     setSeed(uint64_t seed);
+  double   getRate() const      { return m_rate; }
+  uint64_t getCount() const     { return m_count; }
+  bool     exhausted() const    { return m_limit && (m_count >= m_limit); }
+
+  // Virtual function overrides
+public:
+  virtual void setup();
+  virtual bool operator()();
+private:
+  void advance();
+};
+
+#endif
@@ -0,0 +1,257 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/*
+** readoutbench - runs the SBS readout framework with no hardware.
+**
+** A CExperiment is built with a CSimulatedEventSegment as its only event
+** segment and driven by a CSimulatedTrigger.  The trigger loop is done here
+** rather than by CTriggerLoop since that needs a Tcl event loop to end the
+** run; like CTriggerLoop, each trigger the trigger says is there is given to
+** CExperiment::ReadEvent.  Each ReadEvent is timed and the triggers/sec,
+** bytes/sec and a histogram of the per-trigger latency are reported for the
+** copy, zero copy and/or batched (CExperiment::setEventBatch) ring item paths.
+**
+** Unless --no-consumer is given, a thread drains the ring so that the
+** measurement is of the readout rather than of how big the ring is.
+*/
+#include <config.h>
+#include "benchoptions.h"
+#include "CExperiment.h"
+#include "CSimulatedTrigger.h"
+#include "CSimulatedEventSegment.h"
+#include <CVariableBuffers.h>
+#include <TCLApplication.h>
+#include <TCLInterpreter.h>
+#include <CRingBuffer.h>
+#include <Exception.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// CExperiment refers to the application object; there isn't one here.
+
+CTCLApplication* gpTCLApplication = 0;
+
+static const unsigned HistogramBins(32); // log2(ns) bins.
+
+/*
+** Drain the ring until told to stop.
+*/
+static void
+drainRing(std::string ringName, std::atomic<bool>* pDone)
+{
+  CRingBuffer ring(ringName, CRingBuffer::consumer);
+  while (!pDone->load()) {
+    size_t n = ring.availableData();
+    if (n) {
+      ring.skip(n);
+    } else {
+      usleep(100);
+    }
+  }
+}
+
+/*
+** Report the results of a measurement.
+**   mode      - Name of the ring item path measured.
+**   latencies - Nanoseconds spent in each ReadEvent.
+**   seconds   - Elapsed time for the measurement.
+**   bytes     - Bytes of events produced (from the experiment statistics).
+*/
+static void
+report(const char* mode, std::vector<uint64_t>& latencies, double seconds,
+       size_t bytes)
+{
+  size_t n = latencies.size();
+  std::cout << mode << ":\n";
+  std::cout << "  Triggers    : " << n << " in " << seconds << " sec\n";
+  if (!n || (seconds <= 0)) return;
+
+  std::cout << "  Triggers/sec: " << n/seconds << std::endl;
+  std::cout << "  Bytes/sec   : " << bytes/seconds << std::endl;
+
+  std::sort(latencies.begin(), latencies.end());
+  double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+  std::cout << "  Latency (ns): min " << latencies.front();
+  for (unsigned i = 0; i < sizeof(percentiles)/sizeof(double); i++) {
+    size_t index = static_cast<size_t>(percentiles[i]*(n - 1)/100.0);
+    std::cout << " p" << percentiles[i] << " " << latencies[index];
+  }
+  std::cout << " max " << latencies.back() << std::endl;
+
+  // Histogram - bin i holds latencies in [2^i, 2^(i+1)) ns.
+
+  std::vector<size_t> bins(HistogramBins, 0);
+  for (size_t i = 0; i < n; i++) {
+    unsigned bin = 0;
+    uint64_t l   = latencies[i];
+    while ((l >>= 1) && (bin < HistogramBins-1)) bin++;
+    bins[bin]++;
+  }
+  std::cout << "  Latency histogram:\n";
+  for (unsigned i = 0; i < HistogramBins; i++) {
+    if (bins[i]) {
+      std::cout << "    >= " << std::setw(12) << (uint64_t(1) << i) << " ns : "
+		<< std::setw(10) << bins[i] << std::endl;
+    }
+  }
+}
+
+/*
+** Do one measurement.
+*/
+static void
+measure(CExperiment& experiment, CSimulatedTrigger& trigger,
+	CSimulatedEventSegment& segment, const char* name, bool zeroCopy,
+	unsigned batch, size_t triggers)
+{
+  experiment.setZeroCopy(zeroCopy);
+  experiment.setEventBatch(batch);
+  segment.onBegin();
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(triggers);
+  size_t startBytes = experiment.getStatistics().s_cumulative.s_bytes;
+
+  auto start = std::chrono::steady_clock::now();
+  trigger.setup();
+  while (!trigger.exhausted()) {
+    if (trigger()) {
+      auto t0 = std::chrono::steady_clock::now();
+      experiment.ReadEvent();
+      auto t1 = std::chrono::steady_clock::now();
+      latencies.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()
+      );
+    }
+  }
+  trigger.teardown();
+  auto end = std::chrono::steady_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  size_t bytes   = experiment.getStatistics().s_cumulative.s_bytes - startBytes;
+  report(name, latencies, seconds, bytes);
+}
+
+static CSimulatedEventSegment::SizeDistribution
+sizeDistribution(std::string name)
+{
+  if (name == "uniform")     return CSimulatedEventSegment::Uniform;
+  if (name == "exponential") return CSimulatedEventSegment::Exponential;
+  return CSimulatedEventSegment::Fixed;
+}
+static CSimulatedEventSegment::TimestampMode
+timestampMode(std::string name)
+{
+  if (name == "counter") return CSimulatedEventSegment::Counter;
+  if (name == "clock")   return CSimulatedEventSegment::Clock;
+  return CSimulatedEventSegment::NoTimestamp;
+}
+
+int
+main(int argc, char** argv)
+{
+  bench_args_info args;
+  if (bench_parser(argc, argv, &args)) {
+    exit(EXIT_FAILURE);
+  }
+  if (args.batch_arg < 2) {
+    std::cerr << "--batch must be at least 2\n";
+    exit(EXIT_FAILURE);
+  }
+  if (args.triggers_arg <= 0) {
+    std::cerr << "--triggers must be positive\n";
+    exit(EXIT_FAILURE);
+  }
+  if ((args.min_size_arg < 1) || (args.max_size_arg < args.min_size_arg)) {
+    std::cerr << "Event sizes must satisfy 1 <= --min-size <= --max-size\n";
+    exit(EXIT_FAILURE);
+  }
+  if (args.max_size_arg*sizeof(uint16_t) + sizeof(uint32_t) >
+      static_cast<size_t>(args.buffersize_arg)) {
+    std::cerr << "--buffersize is too small for --max-size words\n";
+    exit(EXIT_FAILURE);
+  }
+
+  std::string ringName = args.ring_arg;
+  std::string mode     = args.mode_arg;
+  try {
+    CTCLInterpreter   interp;
+    new CVariableBuffers(interp);	// CExperiment needs it.
+
+    CExperiment experiment(ringName, args.buffersize_arg);
+    CSimulatedEventSegment* pSegment = new CSimulatedEventSegment(
+      args.min_size_arg, args.max_size_arg, sizeDistribution(args.sizes_arg),
+      &experiment
+    );
+    pSegment->setTimestampMode(
+      timestampMode(args.timestamps_arg), args.tick_arg, args.jitter_arg
+    );
+    pSegment->setSeed(args.seed_arg);
+    pSegment->setEventsPerTrigger(args.events_per_trigger_arg);
+    experiment.AddEventSegment(pSegment);
+
+    CSimulatedTrigger trigger(
+      args.rate_arg,
+      args.random_flag ? CSimulatedTrigger::Random : CSimulatedTrigger::Periodic,
+      args.triggers_arg
+    );
+    trigger.setSeed(args.seed_arg);
+
+    std::atomic<bool> done(false);
+    std::thread*      pConsumer = 0;
+    if (!args.no_consumer_flag) {
+      pConsumer = new std::thread(drainRing, ringName, &done);
+    }
+
+    if ((mode == "copy") || (mode == "all")) {
+      measure(experiment, trigger, *pSegment, "Copy", false, 1,
+	      args.triggers_arg);
+    }
+    if ((mode == "zerocopy") || (mode == "all")) {
+      measure(experiment, trigger, *pSegment, "Zero copy", true, 1,
+	      args.triggers_arg);
+    }
+    if ((mode == "batch") || (mode == "all")) {
+      measure(experiment, trigger, *pSegment, "Batched", false,
+	      args.batch_arg, args.triggers_arg);
+    }
+
+    done = true;
+    if (pConsumer) {
+      pConsumer->join();
+      delete pConsumer;
+    }
+  }
+  catch (CException& e) {
+    std::cerr << "readoutbench failed: " << e.ReasonText() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  catch (std::string msg) {
+    std::cerr << "readoutbench failed: " << msg << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  exit(EXIT_SUCCESS);
+}
@@ -14,6 +14,7 @@
 #include <string.h>
 #include <string>
 #include <CNullTrigger.h>
+#include <CSimulatedEventSegment.h>
 #include <tcl.h>
 #include <os.h>
 
@@ -38,6 +39,7 @@ class experimentTests : public CppUnit::TestFixture {
   CPPUNIT_TEST(buffersize);
   CPPUNIT_TEST(start);
   CPPUNIT_TEST(stop);
+  CPPUNIT_TEST(batch);
   CPPUNIT_TEST_SUITE_END();
 
 
@@ -62,6 +64,7 @@ protected:
   void buffersize();
   void start();
   void stop();
+  void batch();
 
 private:
   void renewTitle();
@@ -258,4 +261,39 @@ experimentTests::stop()
   Tcl_DeleteInterp(pInterp);
 
 }
+// With batching, all the items for a trigger go into the ring at once and
+// the statistics count each of them.
 
+void
+experimentTests::batch()
+{
+  CSimulatedEventSegment seg(10, 10, CSimulatedEventSegment::Fixed,
+			     m_pExperiment);
+  seg.setEventsPerTrigger(3);
+  seg.setTimestampMode(CSimulatedEventSegment::Counter, 100);
+  m_pExperiment->AddEventSegment(&seg);
+  m_pExperiment->setEventBatch(8);
+
+  CRingBuffer consumer(ringName);
+  CAllButPredicate  pred;
+
+  m_pExperiment->ReadEvent();
+
+  for (int i = 0; i < 3; i++) {
+    CRingItem* pItem = CRingItem::getFromRing(consumer, pred);
+    EQ(PHYSICS_EVENT, pItem->type());
+    ASSERT(pItem->hasBodyHeader());
+    EQ(static_cast<uint64_t>((i+1)*100), pItem->getEventTimestamp());
+    EQ(static_cast<size_t>(24), pItem->getBodySize());  // 4 byte count + 10 words.
+    uint16_t* pBody = reinterpret_cast<uint16_t*>(pItem->getBodyPointer());
+    EQ(static_cast<uint16_t>(12), pBody[0]);
+    EQ(static_cast<uint16_t>(i), pBody[3]);
+    delete pItem;
+  }
+  EQ(static_cast<size_t>(3), m_pExperiment->getStatistics().s_cumulative.s_triggers);
+  EQ(static_cast<size_t>(3),
+     m_pExperiment->getStatistics().s_cumulative.s_acceptedTriggers);
+  EQ(static_cast<size_t>(72), m_pExperiment->getStatistics().s_cumulative.s_bytes);
+
+  m_pExperiment->RemoveEventSegment(&seg);
+}
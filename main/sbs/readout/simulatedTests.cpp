@@ -0,0 +1,182 @@
+// Tests for the simulated trigger and event segment.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include <stdint.h>
+#include <time.h>
+#include <RangeError.h>
+
+#define private public
+#include "CSimulatedTrigger.h"
+#include "CSimulatedEventSegment.h"
+#undef private
+
+class simulatedTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(simulatedTests);
+  CPPUNIT_TEST(unlimited);
+  CPPUNIT_TEST(limit);
+  CPPUNIT_TEST(rate);
+  CPPUNIT_TEST(random);
+  CPPUNIT_TEST(fixedsize);
+  CPPUNIT_TEST(sizerange);
+  CPPUNIT_TEST(toobig);
+  CPPUNIT_TEST(badsizes);
+  CPPUNIT_TEST(counter);
+  CPPUNIT_TEST(jitter);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+
+public:
+  void setUp() {
+  }
+  void tearDown() {
+  }
+protected:
+  void unlimited();
+  void limit();
+  void rate();
+  void random();
+  void fixedsize();
+  void sizerange();
+  void toobig();
+  void badsizes();
+  void counter();
+  void jitter();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(simulatedTests);
+
+// A zero rate trigger with no limit fires every time.
+
+void simulatedTests::unlimited()
+{
+  CSimulatedTrigger trig;
+  trig.setup();
+  for (int i = 0; i < 1000; i++) {
+    ASSERT(trig());
+  }
+  EQ(uint64_t(1000), trig.getCount());
+  ASSERT(!trig.exhausted());
+}
+// The trigger stops after its limit; setup starts it over.
+
+void simulatedTests::limit()
+{
+  CSimulatedTrigger trig(0.0, CSimulatedTrigger::Periodic, 3);
+  trig.setup();
+  ASSERT(trig());
+  ASSERT(trig());
+  ASSERT(trig());
+  ASSERT(trig.exhausted());
+  ASSERT(!trig());
+
+  trig.setup();
+  ASSERT(!trig.exhausted());
+  ASSERT(trig());
+}
+// At 10 triggers/sec the trigger should not fire right away but should
+// after 0.1 sec.
+
+void simulatedTests::rate()
+{
+  CSimulatedTrigger trig(10.0);
+  trig.setup();
+  ASSERT(!trig());
+
+  struct timespec wait = {0, 110*1000*1000};
+  nanosleep(&wait, 0);
+  ASSERT(trig());
+  ASSERT(!trig());
+}
+// Random spacing gives intervals averaging 1/rate.
+
+void simulatedTests::random()
+{
+  CSimulatedTrigger trig(1000.0, CSimulatedTrigger::Random);
+  trig.setSeed(1234);
+  trig.setup();
+  struct timespec first = trig.m_nextTrigger;
+  for (int i = 0; i < 10000; i++) {
+    trig.advance();
+  }
+  double seconds = (trig.m_nextTrigger.tv_sec - first.tv_sec) +
+    (trig.m_nextTrigger.tv_nsec - first.tv_nsec)*1.0e-9;
+  ASSERT((seconds > 9.5) && (seconds < 10.5));
+}
+// A fixed size event has the size first then counts up from the event number.
+
+void simulatedTests::fixedsize()
+{
+  CSimulatedEventSegment seg(5, 10);
+  uint16_t buffer[20];
+
+  EQ(size_t(5), seg.read(buffer, 20));
+  EQ(uint16_t(5), buffer[0]);
+  EQ(uint16_t(0), buffer[1]);
+  EQ(uint16_t(3), buffer[4]);
+
+  EQ(size_t(5), seg.read(buffer, 20));
+  EQ(uint16_t(1), buffer[1]);
+  EQ(uint64_t(2), seg.getEventCount());
+
+  seg.onBegin();
+  EQ(uint64_t(0), seg.getEventCount());
+}
+// Uniform and exponential sizes stay in range.
+
+void simulatedTests::sizerange()
+{
+  CSimulatedEventSegment seg(2, 50, CSimulatedEventSegment::Uniform);
+  uint16_t buffer[50];
+  for (int i = 0; i < 1000; i++) {
+    size_t n = seg.read(buffer, 50);
+    ASSERT((n >= 2) && (n <= 50));
+    EQ(uint16_t(n), buffer[0]);
+  }
+  seg.setSizes(2, 50, CSimulatedEventSegment::Exponential);
+  for (int i = 0; i < 1000; i++) {
+    size_t n = seg.read(buffer, 50);
+    ASSERT((n >= 2) && (n <= 50));
+  }
+}
+// Events that don't fit throw.
+
+void simulatedTests::toobig()
+{
+  CSimulatedEventSegment seg(10);
+  uint16_t buffer[10];
+  EXCEPTION(seg.read(buffer, 5), CRangeError);
+}
+// Sizes must be at least one word and max >= min.
+
+void simulatedTests::badsizes()
+{
+  EXCEPTION(CSimulatedEventSegment(0, 1), CRangeError);
+  EXCEPTION(CSimulatedEventSegment(10, 5), CRangeError);
+}
+// Counter timestamps go up by the tick.
+
+void simulatedTests::counter()
+{
+  CSimulatedEventSegment seg;
+  seg.setTimestampMode(CSimulatedEventSegment::Counter, 10);
+  EQ(uint64_t(10), seg.nextTimestamp());
+  EQ(uint64_t(20), seg.nextTimestamp());
+  seg.onBegin();
+  EQ(uint64_t(10), seg.nextTimestamp());
+}
+// Jitter stays within its bounds.
+
+void simulatedTests::jitter()
+{
+  CSimulatedEventSegment seg;
+  seg.setTimestampMode(CSimulatedEventSegment::Counter, 100, 5);
+  for (uint64_t i = 1; i <= 1000; i++) {
+    uint64_t stamp = seg.nextTimestamp();
+    ASSERT((stamp >= i*100 - 5) && (stamp <= i*100 + 5));
+  }
+}
@@ -26,6 +26,7 @@
 #include <Exception.h>
 #include <ErrnoException.h>
 #include <CRingBuffer.h>
+#include <DataFormat.h>
 #include <Globals.h>
 
 #include <assert.h>
@@ -628,12 +629,14 @@ COutputThread::newOutputBuffer()
 /**
 /**
  * Process a single event:
- * - If necessary create the event assembly buffer and initialize its
+ * - If the segment is a complete event (no continuation and nothing
+ *   already assembled), it goes directly from the USB buffer into the ring.
+ * - Otherwise, if necessary create the event assembly buffer and initialize its
  *   cursor.
  * - Put the segment in the event assembly buffer.
  * - If there is a continuation segment we're done for now..as we'll get called again with the next
  *   segment
- * - If there is no continuation segment then we create and submit the output
+ * - If there is no continuation segment then we submit the assembled
  *   event to the ring and reset the cursor.
  *
  * @param pData - pointer to a CCUSB event segment.
@@ -646,14 +649,6 @@ COutputThread::newOutputBuffer()
 void 
 COutputThread::event(void* pData)
 {
-  // If necessary make an new output buffer
-
-  if (!m_pBuffer) {
-    m_pBuffer        = newOutputBuffer();
-    m_pCursor        = m_pBuffer;
-    m_nWordsInBuffer = 0;	  
-  }
-
   // Initialize the pointers to event bits and pieces.
 
   uint16_t* pSegment = reinterpret_cast<uint16_t*>(pData);
@@ -664,9 +659,26 @@ COutputThread::event(void* pData)
   size_t segmentSize = header & CCUSBEventLengthMask;
   bool   haveMore    = (header & CCUSBContinuation) != 0;
   
+  segmentSize += 1;		// Size is not self inclusive
+
+  // The usual case: the whole event is in this USB buffer so there's
+  // no need to assemble it first.
+
+  if (!haveMore && (!m_pBuffer || (m_nWordsInBuffer == 0))) {
+    outputEvent(pData, segmentSize*sizeof(uint16_t));
+    return;
+  }
+
+  // If necessary make an new output buffer
+
+  if (!m_pBuffer) {
+    m_pBuffer        = newOutputBuffer();
+    m_pCursor        = m_pBuffer;
+    m_nWordsInBuffer = 0;	  
+  }
+
   // Events must currently fit in the buffer...otherwise we throw an error.
 
-  segmentSize += 1;		// Size is not self inclusive
   if ((segmentSize + m_nWordsInBuffer) >= m_nOutputBufferSize/sizeof(uint16_t)) {
     std::string msg = 
       "An event would not fit in the output buffer, adjust bufferMultiplier in your config file";
@@ -685,47 +697,57 @@ COutputThread::event(void* pData)
   // If that was the last segment submit it and reset cursors and counters.
 
   if (!haveMore) {			    // Ending segment:
-    
-    // Note that if we were given a timestamp extractor we create event
-    // with the timestamp otherwise we create it with a null body header.
-    
-    CRingItem* pEvent;
-    
-    
-    if (m_pEvtTimestampExtractor) {
-        pEvent = new CRingItem(
-            PHYSICS_EVENT, m_pEvtTimestampExtractor(m_pBuffer), Globals::sourceId,
-            0, m_nWordsInBuffer*sizeof(uint16_t) + 100
-        );
-    } else {
-        pEvent = new CRingItem(
-            PHYSICS_EVENT, m_nWordsInBuffer*sizeof(uint16_t) + 100
-        ); // +100 really needed?
-    }
-    CRingItem& event(*pEvent);
-    
-    // Put the data in the event and figure out where the end pointer is.
-
-    void* pDest = event.getBodyPointer();
-    memcpy(pDest, m_pBuffer, m_nWordsInBuffer*sizeof(uint16_t));
-    uint8_t* pEnd = reinterpret_cast<uint8_t*>(pDest);
-    pEnd += m_nWordsInBuffer*sizeof(uint16_t); // Where the new body cursor goes.
-
-    event.setBodyCursor(pEnd);
-    event.updateSize();
-    event.commitToRing(*m_pRing);
-
-    delete pEvent;
+    outputEvent(m_pBuffer, m_nWordsInBuffer*sizeof(uint16_t));
 
     // Reset the cursor and word count in the assembly buffer:
 
     m_nWordsInBuffer = 0;
     m_pCursor        = m_pBuffer;
-    
-    m_nEventsSeen++;
   }
 
 }
+/**
+ * Output a physics event item.  The item header (and body header if
+ * we were given a timestamp extractor) is built on the stack and the
+ * item is then written directly into reserved ring space rather than
+ * being built in a CRingItem first.
+ *
+ * @param pBody  - The event in native CCUSB format.
+ * @param nBytes - Number of bytes in the event.
+ *
+ * @throws CRangeError - From CRingBuffer if the event is bigger than the ring.
+ */
+void
+COutputThread::outputEvent(const void* pBody, size_t nBytes)
+{
+  uint8_t   itemHeader[sizeof(RingItemHeader) + sizeof(BodyHeader)];
+  pRingItem pItem = reinterpret_cast<pRingItem>(itemHeader);
+  uint8_t*  pEnd;
+
+  // Note that if we were given a timestamp extractor we create event
+  // with the timestamp otherwise we create it with a null body header.
+
+  if (m_pEvtTimestampExtractor) {
+    pEnd = reinterpret_cast<uint8_t*>(fillBodyHeader(
+      pItem, m_pEvtTimestampExtractor(const_cast<void*>(pBody)),
+      Globals::sourceId, 0
+    ));
+  } else {
+    pItem->s_body.u_noBodyHeader.s_empty = sizeof(uint32_t);  // No body header.
+    pEnd = pItem->s_body.u_noBodyHeader.s_body;
+  }
+  size_t headerSize = pEnd - itemHeader;
+  size_t itemSize   = headerSize + nBytes;
+  fillRingHeader(pItem, itemSize, PHYSICS_EVENT);
+
+  CRingBuffer::Reservation space;
+  m_pRing->reserve(itemSize, space);
+  space.copyIn(0, itemHeader, headerSize);
+  space.copyIn(headerSize, pBody, nBytes);
+  m_pRing->commit(itemSize);
+
+  m_nEventsSeen++;
+}
 
 
 /**
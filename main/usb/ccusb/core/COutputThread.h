@@ -156,6 +156,7 @@ private:
 
  
   void event(void* pData);
+  void outputEvent(const void* pBody, size_t nBytes);
 
   void attachRing();
   uint8_t* newOutputBuffer();
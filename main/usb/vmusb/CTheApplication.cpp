@@ -191,10 +191,15 @@ int CTheApplication::operator()(int argc, char** argv)
     
     // How the USB controller is created depends on the parameters.
     // if host_given we need a remote server otherwise local with the serialno.
+    // --replay substitutes a file of buffers for the controller.
     //
 
     const char* connectionString;
     CVMUSBFactory::ControllerType type;
+    if (parsedArgs.replay_given) {
+      type             = CVMUSBFactory::file;
+      connectionString = parsedArgs.replay_arg;
+    } else {
 #ifdef HOST_ARG_DEFINED
     if (parsedArgs.host_given) {
       type             = CVMUSBFactory::remote;
@@ -206,6 +211,7 @@ int CTheApplication::operator()(int argc, char** argv)
 #ifdef HOST_ARG_DEFINED
     }
 #endif
+    }
 
     Globals::pUSBController  = CVMUSBFactory::createUSBController(type, connectionString);
     
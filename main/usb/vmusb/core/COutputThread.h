@@ -182,6 +182,7 @@ private:
   void pauseRun(DataBuffer& buffer);   //  Bug #5882
   void resumeRun(DataBuffer& buffer);  //  Bug #5882
   void event(void* pData);      //
+  void outputEvent(const void* pBody, size_t nBytes);
   void scaler(void* pData);	//
   void sendToTclServer(uint16_t* pEvent);
   void attachRing();
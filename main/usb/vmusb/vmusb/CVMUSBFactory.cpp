@@ -16,6 +16,7 @@
 #include "CVMUSBFactory.h"
 #include "CVMUSBusb.h"
 #include "CVMUSBEthernet.h"
+#include "CVMUSBFile.h"
 #include <string>
 #include <vector>
 /**
@@ -35,6 +36,7 @@
  *                       software to pick the first one enumerated.
  *                     - remote - the host on which the VMUSB server is running.  In general such hosts
  *                       only manage one server.  If null, the server running in localhost is used,.
+ *                     - file   - path to a file of VM-USB buffers to replay.
  *
  * @return CVMUSB* Pointer to the appropriate VMUSB controller object.  It's the responsibility
  *                 of the caller to delete when done.
@@ -47,6 +49,8 @@ CVMUSBFactory::createUSBController(CVMUSBFactory::ControllerType type, const cha
     return createLocalController(specifier);
   } else if (type == remote) {
     return createRemoteController(specifier);
+  } else if (type == file) {
+    return createFileController(specifier);
   } else {
     throw std::string("Invalid controller type in createUSBController!");
   }
@@ -125,3 +129,21 @@ CVMUSBFactory::createRemoteController(const char* pHost)
   pController->reconnect();                // Force server to reconnect.
   return pController;
 }
+/**
+ * createFileController
+ *
+ * Create a CVMUSBFile - a controller that replays buffers from a file
+ * so that the readout can be run without hardware.
+ *
+ * @param path - the file to replay.
+ *
+ * @throw std::string - no path or the file can't be opened.
+ */
+CVMUSB*
+CVMUSBFactory::createFileController(const char* path)
+{
+  if (!path) {
+    throw std::string("A replay file must be given for a file controller");
+  }
+  return new CVMUSBFile(path);
+}
@@ -36,7 +36,7 @@ class CVMUSBFactory
 {
 public:
   typedef enum _ControllerType {
-    local, remote
+    local, remote, file
   } ControllerType;
 
 public:
@@ -45,6 +45,7 @@ public:
   static CVMUSB* createUSBController(ControllerType type, const char* specifier = 0);
   static CVMUSB* createLocalController(const char* serialNumber = 0);
   static CVMUSB* createRemoteController(const char* host = 0);
+  static CVMUSB* createFileController(const char* path);
 };
 
 #endif
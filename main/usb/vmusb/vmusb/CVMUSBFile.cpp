@@ -0,0 +1,250 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/**
+ * @file CVMUSBFile.cpp
+ * @brief Implementation of the file replay VM-USB.
+ */
+
+#include "CVMUSBFile.h"
+#include "CVMUSBReadoutList.h"
+#include <string>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+// Buffer header bits (see section 4.6 of the VM-USB manual):
+
+static const uint16_t LastBuffer(0x8000);
+static const uint16_t BufferTerminator(0xffff);
+
+static const unsigned ACTIONRegister(1);
+static const unsigned GMODERegister(4);
+
+/**
+ * constructor
+ *   Open the file to replay.
+ *
+ * @param path - Path to the file of VM-USB buffers.
+ * @param loop - If true, the file is rewound when its end is reached.
+ *
+ * @throw std::string - The file can't be opened.
+ */
+CVMUSBFile::CVMUSBFile(const char* path, bool loop) :
+  CVMUSB(),
+  m_path(path), m_fd(-1), m_loop(loop), m_running(false), m_lastBuffer(false),
+  m_buffers(0), m_bytes(0)
+{
+  m_fd = open(path, O_RDONLY);
+  if (m_fd < 0) {
+    std::string msg = "Unable to open VM-USB replay file ";
+    msg += path;
+    msg += ": ";
+    msg += strerror(errno);
+    throw msg;
+  }
+}
+/**
+ * destructor
+ */
+CVMUSBFile::~CVMUSBFile()
+{
+  close(m_fd);
+}
+
+/**
+ * writeActionRegister
+ *   Setting startDAQ starts the replay, clearing it stops it and
+ *   arranges for the next read to return the last buffer.
+ *
+ * @param value - new action register value.
+ */
+void
+CVMUSBFile::writeActionRegister(uint16_t value)
+{
+  bool start = (value & ActionRegister::startDAQ) != 0;
+  if (m_running && !start) {
+    m_lastBuffer = true;
+  }
+  m_running = start;
+  m_registers[ACTIONRegister] = value;
+}
+/**
+ * writeRegister
+ *    Just remembers the value.
+ */
+void
+CVMUSBFile::writeRegister(unsigned int address, uint32_t data)
+{
+  m_registers[address] = data;
+}
+/**
+ * readRegister
+ *   @return uint32_t - the last value written to the register (0 if never
+ *                      written).
+ */
+uint32_t
+CVMUSBFile::readRegister(unsigned int address)
+{
+  std::map<unsigned, uint32_t>::iterator p = m_registers.find(address);
+  return (p == m_registers.end()) ? 0 : p->second;
+}
+/**
+ * executeList
+ *   There's no VME crate so nothing is read.
+ */
+int
+CVMUSBFile::executeList(CVMUSBReadoutList& list, void* pReadBuffer,
+                        size_t readBufferSize, size_t* bytesRead)
+{
+  memset(pReadBuffer, 0, readBufferSize);
+  *bytesRead = 0;
+  return 0;
+}
+/**
+ * loadList
+ *   Nothing to load into.
+ */
+int
+CVMUSBFile::loadList(uint8_t listNumber, CVMUSBReadoutList& list,
+                     off_t listOffset)
+{
+  return 0;
+}
+/**
+ * usbRead
+ *   Return the next buffer from the file if data taking is on.  See the
+ *   class comments.
+ *
+ * @param data          - Where the buffer goes.
+ * @param bufferSize    - Bytes available in data.
+ * @param transferCount - Receives the number of bytes read.
+ * @param timeout       - Milliseconds to wait before reporting there's
+ *                        no data.
+ *
+ * @return int - 0 on success, -1 with errno ETIMEDOUT if there's no data.
+ *
+ * @throw std::string - Errors reading the file or a record that is too big
+ *                      for the buffer.
+ */
+int
+CVMUSBFile::usbRead(void* data, size_t bufferSize, size_t* transferCount,
+                    int timeout)
+{
+  *transferCount = 0;
+  if (m_running) {
+    if (readRecord(data, bufferSize, transferCount)) {
+      return 0;
+    }
+    if (m_loop) {
+      rewind();
+      if (readRecord(data, bufferSize, transferCount)) {
+        return 0;
+      }
+    }
+  } else if (m_lastBuffer) {
+    m_lastBuffer   = false;
+    *transferCount = lastBuffer(data, bufferSize);
+    return 0;
+  }
+  // Don't let a caller that retries on timeout spin:
+
+  if (timeout > 0) {
+    struct timespec delay = {timeout/1000, (timeout % 1000)*1000000L};
+    nanosleep(&delay, nullptr);
+  }
+  errno = ETIMEDOUT;
+  return -1;
+}
+
+/*---------------------------------------------------------------------------
+ * Private utilities.
+ */
+
+/**
+ * readRecord
+ *   Read the next record from the file.
+ *
+ * @return bool - false if there are no more records.
+ */
+bool
+CVMUSBFile::readRecord(void* data, size_t bufferSize, size_t* transferCount)
+{
+  uint32_t nBytes;
+  ssize_t  n = read(m_fd, &nBytes, sizeof(nBytes));
+  if (n == 0) {
+    return false;
+  }
+  if (n != sizeof(nBytes)) {
+    throw std::string("Truncated record header in VM-USB replay file ") + m_path;
+  }
+  if (nBytes > bufferSize) {
+    throw std::string("Record in VM-USB replay file is larger than the read buffer: ")
+      + m_path;
+  }
+  uint8_t* p      = reinterpret_cast<uint8_t*>(data);
+  size_t   remain = nBytes;
+  while (remain) {
+    n = read(m_fd, p, remain);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      throw std::string("Truncated record in VM-USB replay file ") + m_path;
+    }
+    p      += n;
+    remain -= n;
+  }
+  *transferCount = nBytes;
+  m_buffers++;
+  m_bytes += nBytes;
+  return true;
+}
+/**
+ * lastBuffer
+ *    Build an empty buffer with the last buffer bit set.  If the global
+ *    mode asks for a second header word it's there too.
+ *
+ * @return size_t - Number of bytes in the buffer.
+ */
+size_t
+CVMUSBFile::lastBuffer(void* data, size_t bufferSize)
+{
+  uint16_t  buffer[4];
+  uint16_t* p = buffer;
+  *p++ = LastBuffer;                      // No events.
+  if (readRegister(GMODERegister) & GlobalModeRegister::doubleHeader) {
+    *p++ = 2;                             // Words after this one.
+  }
+  *p++ = BufferTerminator;
+  *p++ = BufferTerminator;
+
+  size_t nBytes = (p - buffer)*sizeof(uint16_t);
+  if (nBytes > bufferSize) {
+    nBytes = bufferSize;
+  }
+  memcpy(data, buffer, nBytes);
+  return nBytes;
+}
+/**
+ * rewind
+ *   Back to the start of the file.
+ */
+void
+CVMUSBFile::rewind()
+{
+  if (lseek(m_fd, 0, SEEK_SET) < 0) {
+    throw std::string("Unable to rewind VM-USB replay file ") + m_path;
+  }
+}
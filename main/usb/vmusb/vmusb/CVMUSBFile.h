@@ -0,0 +1,95 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+#ifndef CVMUSBFILE_H
+#define CVMUSBFILE_H
+
+/**
+ * @file CVMUSBFile.h
+ * @brief A CVMUSB that replays data buffers from a file.
+ */
+
+#include "CVMUSB.h"
+
+#include <map>
+#include <string>
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * @class CVMUSBFile
+ *
+ *   Stands in for a VM-USB so that the readout software downstream of
+ *   usbRead (in particular the output thread) can be run and benchmarked
+ *   without any hardware.
+ *
+ *   The file is a sequence of records each of which is a uint32_t byte
+ *   count followed by that many bytes of VM-USB buffer exactly as usbRead
+ *   would have returned them.  While data taking is on (the startDAQ bit of
+ *   the action register is set), usbRead returns the records one at a time
+ *   as fast as it is called, rewinding to the start of the file at the end
+ *   if looping was requested.  When data taking is turned off, the next
+ *   read returns an empty buffer with the last buffer bit set so that the
+ *   readout sees the normal end of data.  At all other times reads wait
+ *   for the timeout, as a real VM-USB with no data would, and time out.
+ *
+ *   Registers are just remembered and lists execute without doing anything
+ *   (reads return no data).
+ */
+class CVMUSBFile : public CVMUSB
+{
+private:
+  std::string                  m_path;
+  int                          m_fd;
+  bool                         m_loop;
+  bool                         m_running;      // startDAQ set.
+  bool                         m_lastBuffer;   // Last buffer owed to reader.
+  std::map<unsigned, uint32_t> m_registers;
+  uint64_t                     m_buffers;
+  uint64_t                     m_bytes;
+
+public:
+  CVMUSBFile(const char* path, bool loop = true);
+  virtual ~CVMUSBFile();
+
+private:
+  CVMUSBFile(const CVMUSBFile&);
+  CVMUSBFile& operator=(const CVMUSBFile&);
+  int operator==(const CVMUSBFile&) const;
+  int operator!=(const CVMUSBFile&) const;
+
+public:
+  virtual void     writeActionRegister(uint16_t value);
+  virtual void     writeRegister(unsigned int address, uint32_t data);
+  virtual uint32_t readRegister(unsigned int address);
+
+  virtual int executeList(CVMUSBReadoutList& list,
+                          void* pReadBuffer,
+                          size_t readBufferSize,
+                          size_t* bytesRead);
+  virtual int loadList(uint8_t listNumber, CVMUSBReadoutList& list,
+                       off_t listOffset = 0);
+  virtual int usbRead(void* data, size_t bufferSize, size_t* transferCount,
+                      int timeout = 2000);
+
+  uint64_t getBuffersRead() const { return m_buffers; }
+  uint64_t getBytesRead() const   { return m_bytes; }
+
+private:
+  bool   readRecord(void* data, size_t bufferSize, size_t* transferCount);
+  size_t lastBuffer(void* data, size_t bufferSize);
+  void   rewind();
+};
+
+#endif
@@ -0,0 +1,192 @@
+// Tests for the file replay VM-USB.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+
+#include "Asserts.h"
+#include <CVMUSBFile.h>
+
+#include <string>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+
+class CVMUSBFileTests : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(CVMUSBFileTests);
+  CPPUNIT_TEST(idle);
+  CPPUNIT_TEST(replay);
+  CPPUNIT_TEST(loop);
+  CPPUNIT_TEST(noloop);
+  CPPUNIT_TEST(last);
+  CPPUNIT_TEST(doubleheader);
+  CPPUNIT_TEST(registers);
+  CPPUNIT_TEST(toobig);
+  CPPUNIT_TEST(nofile);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::string m_path;
+public:
+  void setUp() {
+    char name[] = "/tmp/filevmusbXXXXXX";
+    int fd = mkstemp(name);
+    m_path = name;
+
+    // Two buffers of 2 and 3 words.
+
+    uint16_t b1[] = {1, 2};
+    uint16_t b2[] = {3, 4, 5};
+    writeRecord(fd, b1, sizeof(b1));
+    writeRecord(fd, b2, sizeof(b2));
+    close(fd);
+  }
+  void tearDown() {
+    unlink(m_path.c_str());
+  }
+protected:
+  void idle();
+  void replay();
+  void loop();
+  void noloop();
+  void last();
+  void doubleheader();
+  void registers();
+  void toobig();
+  void nofile();
+private:
+  void writeRecord(int fd, const void* p, uint32_t n) {
+    write(fd, &n, sizeof(n));
+    write(fd, p, n);
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CVMUSBFileTests);
+
+// No data until DAQ is started; the read waits out its timeout.
+
+void CVMUSBFileTests::idle()
+{
+  CVMUSBFile ctlr(m_path.c_str());
+  uint16_t buffer[100];
+  size_t   n;
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  EQ(-1, ctlr.usbRead(buffer, sizeof(buffer), &n, 100));
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  EQ(ETIMEDOUT, errno);
+  EQ(size_t(0), n);
+  long ms = (end.tv_sec - start.tv_sec)*1000 + (end.tv_nsec - start.tv_nsec)/1000000;
+  ASSERT(ms >= 100);
+}
+// Buffers come back in order once started.
+
+void CVMUSBFileTests::replay()
+{
+  CVMUSBFile ctlr(m_path.c_str());
+  ctlr.writeActionRegister(CVMUSB::ActionRegister::startDAQ);
+  uint16_t buffer[100];
+  size_t   n;
+
+  EQ(0, ctlr.usbRead(buffer, sizeof(buffer), &n, 1000));
+  EQ(size_t(4), n);
+  EQ(uint16_t(1), buffer[0]);
+  EQ(uint16_t(2), buffer[1]);
+
+  EQ(0, ctlr.usbRead(buffer, sizeof(buffer), &n, 1000));
+  EQ(size_t(6), n);
+  EQ(uint16_t(3), buffer[0]);
+  EQ(uint16_t(5), buffer[2]);
+
+  EQ(uint64_t(2), ctlr.getBuffersRead());
+  EQ(uint64_t(10), ctlr.getBytesRead());
+}
+// By default the file is replayed over and over.
+
+void CVMUSBFileTests::loop()
+{
+  CVMUSBFile ctlr(m_path.c_str());
+  ctlr.writeActionRegister(CVMUSB::ActionRegister::startDAQ);
+  uint16_t buffer[100];
+  size_t   n;
+  for (int i = 0; i < 2; i++) {
+    ctlr.usbRead(buffer, sizeof(buffer), &n, 1000);
+  }
+  EQ(0, ctlr.usbRead(buffer, sizeof(buffer), &n, 1000));
+  EQ(size_t(4), n);
+  EQ(uint16_t(1), buffer[0]);
+}
+// Without looping, reads time out at the end of the file.
+
+void CVMUSBFileTests::noloop()
+{
+  CVMUSBFile ctlr(m_path.c_str(), false);
+  ctlr.writeActionRegister(CVMUSB::ActionRegister::startDAQ);
+  uint16_t buffer[100];
+  size_t   n;
+  for (int i = 0; i < 2; i++) {
+    ctlr.usbRead(buffer, sizeof(buffer), &n, 1000);
+  }
+  EQ(-1, ctlr.usbRead(buffer, sizeof(buffer), &n, 100));
+  EQ(ETIMEDOUT, errno);
+}
+// Stopping DAQ gives one last (empty) buffer then timeouts.
+
+void CVMUSBFileTests::last()
+{
+  CVMUSBFile ctlr(m_path.c_str());
+  ctlr.writeActionRegister(CVMUSB::ActionRegister::startDAQ);
+  ctlr.writeActionRegister(0);
+
+  uint16_t buffer[100];
+  size_t   n;
+  EQ(0, ctlr.usbRead(buffer, sizeof(buffer), &n, 1000));
+  EQ(size_t(6), n);
+  EQ(uint16_t(0x8000), buffer[0]);
+  EQ(uint16_t(0xffff), buffer[1]);
+  EQ(uint16_t(0xffff), buffer[2]);
+
+  EQ(-1, ctlr.usbRead(buffer, sizeof(buffer), &n, 100));
+}
+// The last buffer has the optional second header if the global mode says so.
+
+void CVMUSBFileTests::doubleheader()
+{
+  CVMUSBFile ctlr(m_path.c_str());
+  ctlr.writeGlobalMode(CVMUSB::GlobalModeRegister::doubleHeader);
+  ctlr.writeActionRegister(CVMUSB::ActionRegister::startDAQ);
+  ctlr.writeActionRegister(0);
+
+  uint16_t buffer[100];
+  size_t   n;
+  EQ(0, ctlr.usbRead(buffer, sizeof(buffer), &n, 1000));
+  EQ(size_t(8), n);
+  EQ(uint16_t(0x8000), buffer[0]);
+  EQ(uint16_t(2), buffer[1]);
+}
+// Registers remember what's written to them.
+
+void CVMUSBFileTests::registers()
+{
+  CVMUSBFile ctlr(m_path.c_str());
+  EQ(0, ctlr.readGlobalMode());
+  ctlr.writeDAQSettings(0x1234);
+  EQ(0x1234, ctlr.readDAQSettings());
+}
+// Records that don't fit the read buffer are an error.
+
+void CVMUSBFileTests::toobig()
+{
+  CVMUSBFile ctlr(m_path.c_str());
+  ctlr.writeActionRegister(CVMUSB::ActionRegister::startDAQ);
+  uint16_t buffer[1];
+  size_t   n;
+  EXCEPTION(ctlr.usbRead(buffer, sizeof(buffer), &n, 1000), std::string);
+}
+// Constructing on a nonexistent file throws.
+
+void CVMUSBFileTests::nofile()
+{
+  EXCEPTION(CVMUSBFile("/no/such/file/anywhere"), std::string);
+}
@@ -0,0 +1,151 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/** @file:  ChecksumPipeline.cpp
+ *  @brief: Implement the checksum pipeline.
+ */
+#include "ChecksumPipeline.h"
+#include <openssl/evp.h>
+#include <string>
+#include <system_error>
+#include <errno.h>
+
+// Blocks that can be queued before add blocks.
+
+static const size_t MaxPending(8);
+
+/**
+ * constructor
+ *    Create the sha512 digest context and start the thread that
+ *    updates it.
+ *
+ * @throw std::system_error - the context could not be allocated.
+ * @throw std::string       - the digest could not be initialized.
+ */
+CChecksumPipeline::CChecksumPipeline() :
+    m_pContext(0),
+    m_nBusy(0),
+    m_fStopping(false),
+    m_fFailed(false)
+{
+    EVP_MD_CTX* pCtx = EVP_MD_CTX_create();
+    if (!pCtx) {
+        throw std::system_error(
+            errno, std::generic_category(), "Allocating sha512 context"
+        );
+    }
+    if (EVP_DigestInit_ex(pCtx, EVP_sha512(), NULL) != 1) {
+        EVP_MD_CTX_destroy(pCtx);
+        throw std::string("Failed to initialize the sha512 digest");
+    }
+    m_pContext = pCtx;
+    m_thread   = std::thread(&CChecksumPipeline::digestBlocks, this);
+}
+/**
+ * destructor
+ *    Stop the thread and release the context.  Blocks not yet
+ *    digested are dropped.
+ */
+CChecksumPipeline::~CChecksumPipeline()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_fStopping = true;
+    }
+    m_workReady.notify_all();
+    m_thread.join();
+    EVP_MD_CTX_destroy(reinterpret_cast<EVP_MD_CTX*>(m_pContext));
+}
+
+/**
+ * add
+ *    Queue a block of data to be added to the digest.
+ *
+ * @param pData  - the data, which must not change until wait() returns.
+ * @param nBytes - number of bytes of data.
+ */
+void
+CChecksumPipeline::add(const void* pData, size_t nBytes)
+{
+    if (!nBytes) return;
+    Block b = {pData, nBytes};
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        while (m_blocks.size() >= MaxPending) {
+            m_workDone.wait(lock);
+        }
+        m_blocks.push_back(b);
+    }
+    m_workReady.notify_one();
+}
+/**
+ * wait
+ *    Wait until all blocks that have been added are in the digest.
+ */
+void
+CChecksumPipeline::wait()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (!m_blocks.empty() || m_nBusy) {
+        m_workDone.wait(lock);
+    }
+}
+/**
+ * finish
+ *    Finish the digest of all data added.
+ *
+ * @param[out] pDigest - receives the digest, EVP_MD_size(EVP_sha512()) bytes.
+ * @param[out] pLen    - receives the number of bytes of digest.
+ *
+ * @return bool - false if the digest could not be computed.
+ */
+bool
+CChecksumPipeline::finish(unsigned char* pDigest, unsigned int* pLen)
+{
+    wait();
+    if (m_fFailed) return false;
+    return EVP_DigestFinal_ex(
+        reinterpret_cast<EVP_MD_CTX*>(m_pContext), pDigest, pLen
+    ) == 1;
+}
+
+/**
+ * digestBlocks
+ *    Thread body - add blocks to the digest, in order, until told
+ *    to stop.
+ */
+void
+CChecksumPipeline::digestBlocks()
+{
+    EVP_MD_CTX* pCtx = reinterpret_cast<EVP_MD_CTX*>(m_pContext);
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (1) {
+        while (!m_fStopping && m_blocks.empty()) {
+            m_workReady.wait(lock);
+        }
+        if (m_fStopping) return;
+
+        Block b = m_blocks.front();
+        m_blocks.pop_front();
+        m_nBusy++;
+        lock.unlock();
+
+        bool ok = EVP_DigestUpdate(pCtx, b.s_pData, b.s_nBytes) == 1;
+
+        lock.lock();
+        m_nBusy--;
+        if (!ok) m_fFailed = true;
+        m_workDone.notify_all();
+    }
+}
@@ -0,0 +1,74 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/** @file:  ChecksumPipeline.h
+ *  @brief: Compute the sha512 checksum of a run in a separate thread.
+ */
+#ifndef CHECKSUMPIPELINE_H
+#define CHECKSUMPIPELINE_H
+#include <stddef.h>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @class CChecksumPipeline
+ *    The event logger writes each chunk of data straight from the ring
+ *    buffer.  Computing the sha512 of a chunk costs about as much as
+ *    writing it, so rather than doing one and then the other we hand the
+ *    chunk to a thread that digests it while the chunk is being written.
+ *
+ *    Only a pointer to the data is queued, not a copy.  The data must
+ *    stay put until wait() returns, i.e. the chunk is skipped in the ring
+ *    buffer only after wait().  The digest is of the data in the order it
+ *    was added so it's the same as if it had been computed inline.
+ *
+ *    At most MaxPending blocks are queued; add blocks if there are more.
+ */
+class CChecksumPipeline
+{
+private:
+    struct Block {
+        const void* s_pData;
+        size_t      s_nBytes;
+    };
+
+    void*                    m_pContext;     //< EVP_MD_CTX*
+    std::deque<Block>        m_blocks;       //< Waiting to be digested.
+    size_t                   m_nBusy;        //< Blocks taken by the thread, not done.
+    bool                     m_fStopping;
+    bool                     m_fFailed;      //< A digest update failed.
+    std::mutex               m_lock;         //< Guards all of the above.
+    std::condition_variable  m_workReady;
+    std::condition_variable  m_workDone;
+    std::thread              m_thread;
+
+public:
+    CChecksumPipeline();
+    ~CChecksumPipeline();
+private:
+    CChecksumPipeline(const CChecksumPipeline&);
+    CChecksumPipeline& operator=(const CChecksumPipeline&);
+public:
+
+    void add(const void* pData, size_t nBytes);
+    void wait();
+    bool finish(unsigned char* pDigest, unsigned int* pLen);
+private:
+    void digestBlocks();
+};
+
+
+#endif
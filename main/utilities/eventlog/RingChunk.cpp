@@ -19,6 +19,7 @@
  *  @brief: Implement the ring chunk class.
  */
 #include "RingChunk.h"
+#include "SegmentWriter.h"
 #include <CRingBuffer.h>
 #include <DataFormat.h>
 #include <iostream>
@@ -38,7 +39,8 @@ CRingChunk::CRingChunk(CRingBuffer* pBuffer, bool combine) :
     m_pRing(pBuffer),
     m_fChangeRunOk(combine),
     m_nRunNumber(0),
-    m_nFd(-1)
+    m_nFd(-1),
+    m_pWriter(0)
 {}
 
 /**
@@ -65,6 +67,19 @@ CRingChunk::setFd(int newFd)
     m_nFd = newFd;
 }
 
+/**
+ * setWriter
+ *   Sets the writer that writes the data to the file descriptor.  Its
+ *   writes are finished before an event segment is closed.
+ *
+ * @param pWriter - the writer.
+ */
+void
+CRingChunk::setWriter(CSegmentWriter* pWriter)
+{
+    m_pWriter = pWriter;
+}
+
 /**
  * getChunk
  *    Get the next contiguous chunk of ring items.
@@ -156,6 +171,9 @@ CRingChunk::nextItemWraps()
 void
 CRingChunk::closeEventSegment()
 {
+  if (m_pWriter) {
+    m_pWriter->close();
+  }
   off_t fileSize = lseek(m_nFd, 0, SEEK_CUR);  // Tricky way to get the offset.
   ftruncate(m_nFd, fileSize);
   close(m_nFd);
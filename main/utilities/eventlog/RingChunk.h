@@ -39,6 +39,7 @@ typedef struct _Chunk {
 // Forward definitions:
 
 class CRingBuffer;
+class CSegmentWriter;
 
 /**
  * @class RingChunk
@@ -66,6 +67,7 @@ private:
     bool         m_fChangeRunOk;      //< True if --combine-runs is set.
     uint32_t     m_nRunNumber;        //< Current run number.
     int          m_nFd;               //< Current file descriptor.
+    CSegmentWriter* m_pWriter;        //< Writes m_nFd (if not null).
 public:
     CRingChunk(CRingBuffer* pBuffer, bool combine=false);
     
@@ -73,6 +75,7 @@ public:
     
     void setRunNumber(uint32_t newRun);
     void setFd(int newFd);
+    void setWriter(CSegmentWriter* pWriter);
     
     // What used to be in eventlogMain
     
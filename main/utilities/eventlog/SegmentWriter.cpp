@@ -0,0 +1,388 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/** @file:  SegmentWriter.cpp
+ *  @brief: Implement the event file segment writer.
+ */
+#include "SegmentWriter.h"
+#include <io.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+
+// O_DIRECT transfers must be aligned to this in memory, size and offset.
+
+static const size_t DirectAlignment(4096);
+
+// Pages this far behind the last write are dropped from the page cache.
+
+static const uint64_t DropBehindBytes(16*1024*1024);
+
+/**
+ * constructor
+ *    Make the buffer pool and start the writer threads if there are any.
+ *
+ * @param nWriters   - Number of writer threads, 0 to write in the caller.
+ * @param direct     - Write with O_DIRECT (only with writer threads).
+ * @param bufferSize - Largest single write, a multiple of 4KBytes for
+ *                     direct writes.
+ *
+ * @throw std::bad_alloc - the buffers could not be allocated.
+ */
+CSegmentWriter::CSegmentWriter(unsigned nWriters, bool direct, size_t bufferSize) :
+    m_nWriters(nWriters),
+    m_fDirect(direct && nWriters),
+    m_nBufferSize(bufferSize),
+    m_fd(-1),
+    m_fDirectOn(false),
+    m_offset(0),
+    m_pCurrent(0),
+    m_nBusy(0),
+    m_error(0),
+    m_fStopping(false)
+{
+    if (m_nWriters) {
+        m_pool.resize(m_nWriters + 2);
+        for (size_t i = 0; i < m_pool.size(); i++) {
+            void* p;
+            if (posix_memalign(&p, DirectAlignment, m_nBufferSize)) {
+                throw std::bad_alloc();
+            }
+            m_pool[i].s_pData  = static_cast<uint8_t*>(p);
+            m_pool[i].s_nBytes = 0;
+            m_free.push_back(&m_pool[i]);
+        }
+        for (unsigned i = 0; i < m_nWriters; i++) {
+            m_threads.push_back(std::thread(&CSegmentWriter::writeBuffers, this));
+        }
+    }
+}
+/**
+ * destructor
+ *    Stop the writer threads and release the buffers.  Data not yet
+ *    written is dropped; close first to keep it.
+ */
+CSegmentWriter::~CSegmentWriter()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_fStopping = true;
+    }
+    m_workReady.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        m_threads[i].join();
+    }
+    for (size_t i = 0; i < m_pool.size(); i++) {
+        free(m_pool[i].s_pData);
+    }
+}
+
+/**
+ * open
+ *    Start writing a new segment.  The prior one must have been closed.
+ *
+ * @param fd - File descriptor open on the segment, positioned at its start.
+ */
+void
+CSegmentWriter::open(int fd)
+{
+    m_fd        = fd;
+    m_offset    = 0;
+    m_fDirectOn = false;
+    if (m_fDirect) {
+        int flags = fcntl(fd, F_GETFL);
+        if ((flags == -1) || (fcntl(fd, F_SETFL, flags | O_DIRECT) == -1)) {
+            std::cerr << "Unable to use O_DIRECT for event files: "
+                      << strerror(errno) << " writing through the page cache\n";
+            m_fDirect = false;
+        } else {
+            m_fDirectOn = true;
+        }
+    }
+}
+/**
+ * write
+ *    Write data to the segment.  On return the data can be released.
+ *
+ * @param pData  - the data.
+ * @param nBytes - number of bytes of data.
+ */
+void
+CSegmentWriter::write(const void* pData, size_t nBytes)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(pData);
+
+    if (!m_nWriters) {
+        while (nBytes) {
+            size_t n = std::min(nBytes, m_nBufferSize);
+            writeBlock(m_fd, p, n, m_offset);
+            m_offset += n;
+            p        += n;
+            nBytes   -= n;
+        }
+        return;
+    }
+
+    while (nBytes) {
+        if (!m_pCurrent) {
+            std::unique_lock<std::mutex> lock(m_lock);
+            while (m_free.empty() && !m_error) {
+                m_workDone.wait(lock);
+            }
+            if (m_error) {
+                lock.unlock();
+                throwError();
+            }
+            m_pCurrent = m_free.back();
+            m_free.pop_back();
+            m_pCurrent->s_nBytes = 0;
+        }
+        size_t n = std::min(nBytes, m_nBufferSize - m_pCurrent->s_nBytes);
+        memcpy(m_pCurrent->s_pData + m_pCurrent->s_nBytes, p, n);
+        m_pCurrent->s_nBytes += n;
+        p      += n;
+        nBytes -= n;
+        if (m_pCurrent->s_nBytes == m_nBufferSize) {
+            queueCurrent();
+        }
+    }
+}
+/**
+ * close
+ *    Write what's left and wait for all writes of the segment to finish.
+ *    The file is left positioned at its end (CRingChunk::closeEventSegment
+ *    truncates the file at its position).
+ */
+void
+CSegmentWriter::close()
+{
+    if (m_fd < 0) return;
+    if (!m_nWriters) {
+        m_fd = -1;
+        return;
+    }
+
+    // Direct writes must be whole blocks; pad the last one and cut the
+    // file back to the data afterwards.
+
+    uint64_t end = m_offset;
+    bool     padded = false;
+    if (m_pCurrent && m_pCurrent->s_nBytes) {
+        end += m_pCurrent->s_nBytes;
+        size_t tail = m_pCurrent->s_nBytes % DirectAlignment;
+        if (m_fDirectOn && tail) {
+            memset(m_pCurrent->s_pData + m_pCurrent->s_nBytes, 0,
+                   DirectAlignment - tail);
+            m_pCurrent->s_nBytes += DirectAlignment - tail;
+            padded = true;
+        }
+        queueCurrent();
+    }
+    waitIdle();
+    int fd = m_fd;
+    m_fd = -1;
+    if (m_pCurrent) {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_free.push_back(m_pCurrent);
+        m_pCurrent = 0;
+    }
+    throwError();
+    if ((padded && ftruncate(fd, end)) ||
+        (lseek(fd, end, SEEK_SET) == static_cast<off_t>(-1))) {
+        throw errno;
+    }
+}
+/**
+ * latencyReport
+ *    Describe the latencies of the writes since the last report.
+ *
+ * @return std::string - the description, empty if there were no writes.
+ */
+std::string
+CSegmentWriter::latencyReport()
+{
+    std::vector<uint32_t> latencies;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        latencies.swap(m_latencies);
+    }
+    if (latencies.empty()) return std::string();
+
+    std::sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    std::ostringstream report;
+    report << n << " event file writes of up to " << m_nBufferSize/1024
+           << " KBytes, latency (usec) 50%: " << latencies[n/2]
+           << " 90%: "  << latencies[(n*9)/10]
+           << " 99%: "  << latencies[(n*99)/100]
+           << " max: "  << latencies[n-1];
+    return report.str();
+}
+
+/*-----------------------------------------------------------------------------
+ * Private utilities.
+ */
+
+/**
+ * writeBlock
+ *    Write a block of data and time the write.
+ *
+ * @param fd     - file to write.
+ * @param pData  - data to write.
+ * @param nBytes - size of the data.
+ * @param offset - where it goes in the file (writer threads only).
+ *
+ * @throw int - errno if the write fails.
+ */
+void
+CSegmentWriter::writeBlock(int fd, const void* pData, size_t nBytes, uint64_t offset)
+{
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!m_nWriters) {
+        io::writeData(fd, pData, nBytes);
+    } else {
+        const uint8_t* p = static_cast<const uint8_t*>(pData);
+        while (nBytes) {
+            ssize_t n = pwrite(fd, p, nBytes, offset);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw errno;
+            }
+            if (n == 0) throw 0;
+            p      += n;
+            nBytes -= n;
+            offset += n;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    uint64_t usec = (end.tv_sec - start.tv_sec)*1000000 +
+        (end.tv_nsec - start.tv_nsec)/1000;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_latencies.push_back(usec);
+}
+/**
+ * dropBehind
+ *    Start writeback of a block that was just written and drop the block
+ *    DropBehindBytes before it from the page cache once it's on disk.
+ *    Errors are ignored; this is only advice to the kernel.
+ *
+ * @param fd     - the file.
+ * @param offset - where the block was written.
+ * @param nBytes - its size.
+ */
+void
+CSegmentWriter::dropBehind(int fd, uint64_t offset, size_t nBytes)
+{
+    sync_file_range(fd, offset, nBytes, SYNC_FILE_RANGE_WRITE);
+    if (offset >= DropBehindBytes) {
+        offset -= DropBehindBytes;
+        sync_file_range(fd, offset, nBytes,
+            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+            SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(fd, offset, nBytes, POSIX_FADV_DONTNEED);
+    }
+}
+/**
+ * queueCurrent
+ *    Queue the buffer being filled to be written.
+ */
+void
+CSegmentWriter::queueCurrent()
+{
+    m_pCurrent->s_offset = m_offset;
+    m_pCurrent->s_fd     = m_fd;
+    m_offset += m_pCurrent->s_nBytes;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_queued.push_back(m_pCurrent);
+    }
+    m_pCurrent = 0;
+    m_workReady.notify_one();
+}
+/**
+ * waitIdle
+ *    Wait for all queued buffers to be written.
+ */
+void
+CSegmentWriter::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (!m_queued.empty() || m_nBusy) {
+        m_workDone.wait(lock);
+    }
+}
+/**
+ * throwError
+ *    If a writer thread failed, throw its errno.
+ */
+void
+CSegmentWriter::throwError()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_error) {
+        int error = m_error;
+        throw error;
+    }
+}
+/**
+ * writeBuffers
+ *    Writer thread body: write queued buffers until told to stop.
+ *    Once a write has failed, remaining buffers are discarded.
+ */
+void
+CSegmentWriter::writeBuffers()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (1) {
+        while (!m_fStopping && m_queued.empty()) {
+            m_workReady.wait(lock);
+        }
+        if (m_fStopping) return;
+
+        Buffer* pBuffer = m_queued.front();
+        m_queued.pop_front();
+        m_nBusy++;
+        bool failed = m_error != 0;
+        lock.unlock();
+
+        int error = 0;
+        if (!failed) {
+            try {
+                writeBlock(pBuffer->s_fd, pBuffer->s_pData, pBuffer->s_nBytes,
+                           pBuffer->s_offset);
+                if (!m_fDirectOn) {
+                    dropBehind(pBuffer->s_fd, pBuffer->s_offset, pBuffer->s_nBytes);
+                }
+            }
+            catch (int e) {
+                error = e ? e : EIO;
+            }
+        }
+
+        lock.lock();
+        if (error && !m_error) m_error = error;
+        m_free.push_back(pBuffer);
+        m_nBusy--;
+        m_workDone.notify_all();
+    }
+}
@@ -0,0 +1,106 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+/** @file:  SegmentWriter.h
+ *  @brief: Write event file segments.
+ */
+#ifndef SEGMENTWRITER_H
+#define SEGMENTWRITER_H
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @class CSegmentWriter
+ *    Writes the data of an event file segment.  There are two backends:
+ *
+ *    -  With no writer threads, data are written by the caller in blocks
+ *       of at most the buffer size, as the event logger always did.
+ *    -  With writer threads, data are copied into a small pool of aligned
+ *       buffers and each full buffer is written at its offset in the file
+ *       by one of the threads, so several writes are in flight and the
+ *       caller (the thread draining the ring) only blocks when all buffers
+ *       are busy.  Writeback of each buffer is started as soon as it's
+ *       written and pages a little behind that are dropped from the page
+ *       cache so that a long run doesn't fill memory with dirty pages.
+ *       Optionally the file is written with O_DIRECT instead, bypassing
+ *       the page cache altogether.
+ *
+ *    The time taken by each write is kept so the latency percentiles can
+ *    be reported at the end of a run.
+ *
+ *    Write errors throw the errno as an int, as io::writeData does.  For
+ *    the threaded backend they're thrown by the write or close after the
+ *    failure.
+ */
+class CSegmentWriter
+{
+private:
+    struct Buffer {
+        uint8_t*  s_pData;
+        size_t    s_nBytes;
+        uint64_t  s_offset;     //< Where it goes in the file.
+        int       s_fd;
+    };
+
+    unsigned                 m_nWriters;
+    bool                     m_fDirect;      //< O_DIRECT requested.
+    size_t                   m_nBufferSize;
+    int                      m_fd;
+    bool                     m_fDirectOn;    //< O_DIRECT set on m_fd.
+    uint64_t                 m_offset;       //< File offset of the next buffer.
+    Buffer*                  m_pCurrent;     //< Buffer being filled.
+    std::vector<Buffer>      m_pool;
+
+    std::vector<Buffer*>     m_free;         //< All below guarded by m_lock.
+    std::deque<Buffer*>      m_queued;
+    size_t                   m_nBusy;
+    int                      m_error;        //< errno of a failed write.
+    bool                     m_fStopping;
+    std::vector<uint32_t>    m_latencies;    //< Microseconds per write.
+    std::mutex               m_lock;
+    std::condition_variable  m_workReady;
+    std::condition_variable  m_workDone;
+    std::vector<std::thread> m_threads;
+
+public:
+    CSegmentWriter(unsigned nWriters = 0, bool direct = false,
+                   size_t bufferSize = 1024*1024);
+    ~CSegmentWriter();
+private:
+    CSegmentWriter(const CSegmentWriter&);
+    CSegmentWriter& operator=(const CSegmentWriter&);
+public:
+
+    void open(int fd);
+    void write(const void* pData, size_t nBytes);
+    void close();
+    std::string latencyReport();
+
+private:
+    void writeBlock(int fd, const void* pData, size_t nBytes, uint64_t offset);
+    void dropBehind(int fd, uint64_t offset, size_t nBytes);
+    void queueCurrent();
+    void waitIdle();
+    void throwError();
+    void writeBuffers();
+};
+
+
+#endif
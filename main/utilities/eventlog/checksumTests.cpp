@@ -0,0 +1,106 @@
+// Tests for the checksum pipeline.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include "ChecksumPipeline.h"
+#include <openssl/evp.h>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+class checksumTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(checksumTest);
+  CPPUNIT_TEST(same_1);
+  CPPUNIT_TEST(same_2);
+  CPPUNIT_TEST(empty);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  std::vector<unsigned char> m_data;
+public:
+  void setUp() {
+    m_data.resize(4*1024*1024 + 17);
+    srand(1234);
+    for (size_t i = 0; i < m_data.size(); i++) {
+      m_data[i] = rand();
+    }
+  }
+  void tearDown() {
+  }
+private:
+  std::vector<unsigned char> inlineDigest(size_t nBytes);
+protected:
+  void same_1();
+  void same_2();
+  void empty();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(checksumTest);
+
+// The digest computed the way eventlog used to.
+
+std::vector<unsigned char>
+checksumTest::inlineDigest(size_t nBytes)
+{
+  std::vector<unsigned char> result(EVP_MD_size(EVP_sha512()));
+  unsigned int len;
+  EVP_MD_CTX* pCtx = EVP_MD_CTX_create();
+  EVP_DigestInit_ex(pCtx, EVP_sha512(), NULL);
+  EVP_DigestUpdate(pCtx, m_data.data(), nBytes);
+  EVP_DigestFinal_ex(pCtx, result.data(), &len);
+  EVP_MD_CTX_destroy(pCtx);
+  result.resize(len);
+  return result;
+}
+
+// Adding blocks, waiting after each, gives the same digest.
+
+void checksumTest::same_1()
+{
+  CChecksumPipeline pipe;
+  size_t offset = 0;
+  size_t n      = 1;
+  while (offset < m_data.size()) {
+    if (offset + n > m_data.size()) n = m_data.size() - offset;
+    pipe.add(m_data.data() + offset, n);
+    pipe.wait();
+    offset += n;
+    n = n*3 + 1;
+  }
+  std::vector<unsigned char> digest(EVP_MD_size(EVP_sha512()));
+  unsigned int len;
+  ASSERT(pipe.finish(digest.data(), &len));
+  digest.resize(len);
+  ASSERT(inlineDigest(m_data.size()) == digest);
+}
+// Many small blocks queued without waiting (more than can be
+// pending) are digested in order.
+
+void checksumTest::same_2()
+{
+  CChecksumPipeline pipe;
+  for (size_t offset = 0; offset < m_data.size(); offset += 1000) {
+    size_t n = m_data.size() - offset;
+    pipe.add(m_data.data() + offset, n < 1000 ? n : 1000);
+  }
+  std::vector<unsigned char> digest(EVP_MD_size(EVP_sha512()));
+  unsigned int len;
+  ASSERT(pipe.finish(digest.data(), &len));
+  digest.resize(len);
+  ASSERT(inlineDigest(m_data.size()) == digest);
+}
+// No data is the digest of nothing.
+
+void checksumTest::empty()
+{
+  CChecksumPipeline pipe;
+  pipe.add(m_data.data(), 0);
+  std::vector<unsigned char> digest(EVP_MD_size(EVP_sha512()));
+  unsigned int len;
+  ASSERT(pipe.finish(digest.data(), &len));
+  digest.resize(len);
+  ASSERT(inlineDigest(0) == digest);
+}
@@ -19,6 +19,8 @@
 #include "eventlogargs.h"
 
 #include "RingChunk.h"
+#include "ChecksumPipeline.h"
+#include "SegmentWriter.h"
 
 #include <CRingBuffer.h>
 
@@ -29,6 +31,8 @@
 #include <DataFormat.h>
 #include <CAllButPredicate.h>
 #include <CRingItemFactory.h>
+#include <CEventIndexWriter.h>
+#include <Exception.h>
 #include <io.h>
 #include "CZCopyRingBuffer.h"
 
@@ -43,7 +47,6 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <system_error>
 
 using std::string;
 using std::cerr;
@@ -84,18 +87,24 @@ class noData :  public CRingBuffer::CRingBufferPredicate
    m_exitOnEndRun(false),
    m_nSourceCount(1),
    m_fRunNumberOverride(false),
-   m_pChecksumContext(0),
+   m_pChecksum(0),
    m_nBeginsSeen(0),
    m_fChangeRunOk(false),
    m_prefix("run"),
    m_pItem(nullptr),
    m_nItemSize(0),
-   m_pChunker(0)
+   m_pChunker(0),
+   m_pIndex(0),
+   m_pWriter(0)
  {
  }
 
  EventLogMain::~EventLogMain()
- {}
+ {
+   delete m_pIndex;
+   delete m_pChecksum;
+   delete m_pWriter;
+ }
  //////////////////////////////////////////////////////////////////////////////////
  //
  // Object member functions:
@@ -138,7 +147,7 @@ class noData :  public CRingBuffer::CRingBufferPredicate
  ** segment   - The run ssegment in %02d
  **
  ** Note that all files are stored in the directory pointed to by
- ** m_eventDirectory.
+ ** m_eventDirectory.  If indexing, the segment's index is started too.
  **
  ** Parameters:
  **     runNumber   - The run number.
@@ -167,6 +176,22 @@ class noData :  public CRingBuffer::CRingBufferPredicate
    }
    
    m_pChunker->setFd(fd);
+   m_pWriter->open(fd);
+
+   if (m_pIndex) {
+     try {
+       m_pIndex->open(fullPath, runNumber, segment);
+     }
+     catch (CException& e) {
+       cerr << "Unable to create the index for an event file segment: "
+            << e.ReasonText() << endl;
+       exit(EXIT_FAILURE);
+     }
+     catch (int err) {
+       cerr << "Unable to write the event file index: " << strerror(err) << endl;
+       exit(EXIT_FAILURE);
+     }
+   }
    return fd;
 
  } 
@@ -340,8 +365,7 @@ class noData :  public CRingBuffer::CRingBufferPredicate
     
     // If requested, write the checksum file:
     
-    if (m_pChecksumContext) {
-      EVP_MD_CTX* pCtx = reinterpret_cast<EVP_MD_CTX*>(m_pChecksumContext);
+    if (m_pChecksum) {
        unsigned char* pDigest = reinterpret_cast<unsigned char*>(OPENSSL_malloc(EVP_MD_size(EVP_sha512())));
        unsigned int   len;
          
@@ -349,9 +373,12 @@ class noData :  public CRingBuffer::CRingBufferPredicate
        // silently ignore...
   
       if (pDigest) {
-         EVP_DigestFinal_ex(pCtx, pDigest, &len);
+        if (!m_pChecksum->finish(pDigest, &len)) {
+          std::cerr << "Unable to compute the sha512 checksum of the run\n";
+          len = 0;
+        }
          std::string digestFilename = shaFile(runNumber);
-         FILE* shafp = fopen(digestFilename.c_str(), "w");
+         FILE* shafp = len ? fopen(digestFilename.c_str(), "w") : 0;
   
        
          // Again not quite sure what to do if the open failed.
@@ -367,10 +394,14 @@ class noData :  public CRingBuffer::CRingBufferPredicate
         OPENSSL_free(pDigest);
   
       }
-      EVP_MD_CTX_destroy(pCtx);
-      m_pChecksumContext = 0;
+      delete m_pChecksum;
+      m_pChecksum = 0;
        
     }  
+    std::string latencies = m_pWriter->latencyReport();
+    if (!latencies.empty()) {
+      std::cerr << "Run " << runNumber << ": " << latencies << std::endl;
+    }
     return;
 
  }
@@ -450,8 +481,30 @@ class noData :  public CRingBuffer::CRingBufferPredicate
 
    m_fChecksum = (parsed.checksum_flag != 0);
    m_fChangeRunOk = (parsed.combine_runs_flag != 0);
+
+   if (parsed.index_given) {
+     if (parsed.index_arg < 0) {
+       cerr << "--index must be given a non-negative item count\n";
+       exit(EXIT_FAILURE);
+     }
+     m_pIndex = new CEventIndexWriter(parsed.index_arg);
+   }
    
+   // The writer backend.  --direct needs writer threads as ring data
+   // aren't aligned for O_DIRECT.
+
+   if (parsed.writers_arg < 0) {
+     cerr << "--writers must be given a non-negative thread count\n";
+     exit(EXIT_FAILURE);
+   }
+   unsigned nWriters = parsed.writers_arg;
+   if (parsed.direct_flag && !nWriters) {
+     nWriters = 1;
+   }
+   m_pWriter = new CSegmentWriter(nWriters, parsed.direct_flag != 0, BUFFERSIZE);
+
    m_pChunker = new CRingChunk(m_pRing, m_fChangeRunOk);
+   m_pChunker->setWriter(m_pWriter);
 
  }
 
@@ -573,26 +626,16 @@ EventLogMain::writeItem(int fd, CRingItem& item)
       void*    pItem = item.getItemPointer();
       uint32_t nBytes= itemSize(item);
 
-      // If necessary create the checksum context
-      // If checksumming add the ring item to the sum.
+      // If checksumming add the ring item to the sum while it's written.
 
       if (m_fChecksum) {
-        if (!m_pChecksumContext) {
-          m_pChecksumContext = EVP_MD_CTX_create();
-          if (!m_pChecksumContext) throw errno;
-          if(EVP_DigestInit_ex(
-              reinterpret_cast<EVP_MD_CTX*>(m_pChecksumContext), EVP_sha512(), NULL) != 1) {
-            EVP_MD_CTX_destroy(reinterpret_cast<EVP_MD_CTX*>(m_pChecksumContext));
-            m_pChecksumContext = 0;
-            throw std::string("Unable to initialize the checksum digest");
-          }
-      
-        }
-        EVP_DigestUpdate(
-               reinterpret_cast<EVP_MD_CTX*>(m_pChecksumContext), pItem, nBytes);
+        checksumData(pItem, nBytes);
       }
-      io::writeData(fd, pItem, nBytes);
-      //io::writeData(fd, pItem, nBytes);
+      m_pWriter->write(pItem, nBytes);
+      if (m_pIndex) {
+        m_pIndex->addItems(pItem, nBytes);
+      }
+      waitForChecksum();
     }
     catch(int err) {
       if(err) {
@@ -711,12 +754,14 @@ EventLogMain::writeInterior(int fd, uint32_t runNumber, uint64_t bytesSoFar)
     
     if(endsSeen >= m_nBeginsSeen) {
       m_pChunker->closeEventSegment();
+      closeIndex();
       return;                      // The run is recorded.
     } else if (endsSeen && dataTimeout()) {
       
       // If we time out on data, then end abnormally:
       
       m_pChunker->closeEventSegment();
+      closeIndex();
       std::cerr << " Timed out with " << m_nBeginsSeen - endsSeen
         << " ends still not seen\n";
       return;
@@ -794,7 +839,9 @@ EventLogMain::writeWrappedItem(int fd, int& ends)
 /**
  * writeData
  *    Writes data to the file.  If checksumming is enabled the checksum
- *    is updated.
+ *    is updated by the checksum thread while the data are written.  On
+ *    return the checksum thread is done with the data so the caller can
+ *    release it (e.g. skip it in the ring).
  *
  *  @param pData - pointer to the data to write.
  *  @param nBytes - Number of bytes of data to write.
@@ -802,27 +849,38 @@ EventLogMain::writeWrappedItem(int fd, int& ends)
 void
 EventLogMain::writeData(int fd, void* pData, size_t nBytes)
 {
-  uint8_t* p = static_cast<uint8_t*>(pData);
-  size_t  nLeft = nBytes;
-  while (nLeft > BUFFERSIZE) {
-    io::writeData(fd, p, BUFFERSIZE);
-    nLeft -= BUFFERSIZE;
-    p     += BUFFERSIZE;
+  if (m_fChecksum) {
+    checksumData(pData,nBytes);
   }
+
+  m_pWriter->write(pData, nBytes);      // In BUFFERSIZE writes.
   
-  // Last partial buffer write:
-  
-  if (nLeft) {
-    io::writeData(fd, p, nLeft);
+  if (m_pIndex) {
+    m_pIndex->addItems(pData, nBytes);
   }
-  
-  if (m_fChecksum) {
-    checksumData(pData,nBytes);
+  waitForChecksum();
+}
+/**
+ * closeIndex
+ *    Finish the index of the last segment of a run, if we're indexing.
+ */
+void
+EventLogMain::closeIndex()
+{
+  if (m_pIndex) {
+    try {
+      m_pIndex->close();
+    }
+    catch (int err) {
+      cerr << "Unable to write the event file index: " << strerror(err) << endl;
+      exit(EXIT_FAILURE);
+    }
   }
 }
 /**
  * checksumData
- *    update the sha512 hash of the data:
+ *    Hand data to the checksum thread to be added to the run's sha512
+ *    hash.  The data must not be released until waitForChecksum returns.
  *
  * @param pData -pointer to the new data.
  * @param nBytes - number of bytes of new data.
@@ -830,32 +888,24 @@ EventLogMain::writeData(int fd, void* pData, size_t nBytes)
 void
 EventLogMain::checksumData(void* pData, size_t nBytes)
 {
-  // If we need to make the checksum context:
+  // If we need to make the checksum pipeline for this run:
   
-  if(!m_pChecksumContext) {
-    m_pChecksumContext = EVP_MD_CTX_create();
-    if (!m_pChecksumContext) {
-      throw std::system_error(
-        errno, std::generic_category(), "Allocating sha512 context"
-      );
-    }
-    // Make the sha512 digest in the context:
-    
-    if(EVP_DigestInit_ex(
-	      reinterpret_cast<EVP_MD_CTX*>(m_pChecksumContext), EVP_sha512(), NULL) != 1) {
-	    EVP_MD_CTX_destroy(reinterpret_cast<EVP_MD_CTX*>(m_pChecksumContext));
-	    m_pChecksumContext = 0;
-      throw std::string("Failed to initialize the sha512 digest");
-    }
-    
+  if(!m_pChecksum) {
+    m_pChecksum = new CChecksumPipeline;
+  }
+  m_pChecksum->add(pData, nBytes);
+}
+/**
+ * waitForChecksum
+ *    Wait until the checksum thread is done with the data it's been
+ *    given.
+ */
+void
+EventLogMain::waitForChecksum()
+{
+  if (m_pChecksum) {
+    m_pChecksum->wait();
   }
-  // Now we can compute the checksum to update the chunk we have:
-  
-  EVP_DigestUpdate(
-    reinterpret_cast<EVP_MD_CTX*>(m_pChecksumContext),
-    pData, nBytes
-  );
-    
 }
 
 /**
@@ -33,6 +33,9 @@ class CRingItem;
 class CRingStateChangeItem;
 class CZCopyRingBuffer;
 class CRingChunk;
+class CEventIndexWriter;
+class CChecksumPipeline;
+class CSegmentWriter;
 
 
 /*!
@@ -53,7 +56,7 @@ private:
   bool              m_fRunNumberOverride;
   uint32_t          m_nOverrideRunNumber;
   bool              m_fChecksum;
-  void*             m_pChecksumContext;  
+  CChecksumPipeline* m_pChecksum;        // Digest of the run, if --checksum.
   uint32_t          m_nBeginsSeen;
   bool              m_fChangeRunOk;
   std::string       m_prefix;
@@ -61,6 +64,8 @@ private:
   size_t            m_nItemSize;
   uint32_t          m_nRunNumber;
   CRingChunk*        m_pChunker;
+  CEventIndexWriter* m_pIndex;          // Null unless --index.
+  CSegmentWriter*    m_pWriter;         // Writes the event segments.
   
 
   
@@ -103,6 +108,8 @@ private:
   size_t writeWrappedItem(int fd, int& ends);
   void writeData(int fd, void* pData, size_t nBytes);
   void checksumData(void* pData, size_t nBytes);
+  void waitForChecksum();
+  void closeIndex();
   bool badBegin(void* p);
 };
 
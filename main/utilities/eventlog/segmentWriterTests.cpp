@@ -0,0 +1,142 @@
+// Tests for the event segment writer backends.
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/Asserter.h>
+#include "Asserts.h"
+
+#include "SegmentWriter.h"
+#include <vector>
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+class segmentWriterTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(segmentWriterTest);
+  CPPUNIT_TEST(inline_1);
+  CPPUNIT_TEST(threads_1);
+  CPPUNIT_TEST(threads_2);
+  CPPUNIT_TEST(direct_1);
+  CPPUNIT_TEST(latency_1);
+  CPPUNIT_TEST_SUITE_END();
+
+
+private:
+  std::vector<unsigned char> m_data;
+  std::string                m_path;
+public:
+  void setUp() {
+    m_data.resize(3*1024*1024 + 4097);
+    srand(4321);
+    for (size_t i = 0; i < m_data.size(); i++) {
+      m_data[i] = rand();
+    }
+    char name[] = "segwriterXXXXXX";
+    int fd = mkstemp(name);
+    close(fd);
+    m_path = name;
+  }
+  void tearDown() {
+    unlink(m_path.c_str());
+  }
+private:
+  void writeSegment(CSegmentWriter& writer, size_t nBytes);
+  std::vector<unsigned char> readSegment();
+protected:
+  void inline_1();
+  void threads_1();
+  void threads_2();
+  void direct_1();
+  void latency_1();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(segmentWriterTest);
+
+// Write the first nBytes of m_data in odd sized pieces and close the
+// segment the way CRingChunk::closeEventSegment does.
+
+void
+segmentWriterTest::writeSegment(CSegmentWriter& writer, size_t nBytes)
+{
+  int fd = open(m_path.c_str(), O_RDWR | O_TRUNC);
+  ASSERT(fd >= 0);
+  writer.open(fd);
+  size_t offset = 0;
+  size_t n      = 1;
+  while (offset < nBytes) {
+    if (offset + n > nBytes) n = nBytes - offset;
+    writer.write(m_data.data() + offset, n);
+    offset += n;
+    n = n*2 + 3;
+  }
+  writer.close();
+  off_t size = lseek(fd, 0, SEEK_CUR);
+  ftruncate(fd, size);
+  close(fd);
+}
+
+std::vector<unsigned char>
+segmentWriterTest::readSegment()
+{
+  struct stat info;
+  stat(m_path.c_str(), &info);
+  std::vector<unsigned char> result(info.st_size);
+  int fd = open(m_path.c_str(), O_RDONLY);
+  EQ(ssize_t(result.size()), read(fd, result.data(), result.size()));
+  close(fd);
+  return result;
+}
+
+// Writing from the caller.
+
+void segmentWriterTest::inline_1()
+{
+  CSegmentWriter writer;
+  writeSegment(writer, m_data.size());
+  ASSERT(m_data == readSegment());
+}
+// Writer threads, data that doesn't fill the last buffer.
+
+void segmentWriterTest::threads_1()
+{
+  CSegmentWriter writer(3, false, 64*1024);
+  writeSegment(writer, m_data.size());
+  ASSERT(m_data == readSegment());
+}
+// A writer is reused for several segments, the last one empty.
+
+void segmentWriterTest::threads_2()
+{
+  CSegmentWriter writer(2, false, 64*1024);
+  writeSegment(writer, m_data.size());
+  writeSegment(writer, 1000);
+  std::vector<unsigned char> data = readSegment();
+  EQ(size_t(1000), data.size());
+  ASSERT(memcmp(m_data.data(), data.data(), 1000) == 0);
+  writeSegment(writer, 0);
+  EQ(size_t(0), readSegment().size());
+}
+// O_DIRECT pads the last block and cuts the file back.  If the file
+// system can't do O_DIRECT the writer falls back to buffered writes.
+
+void segmentWriterTest::direct_1()
+{
+  CSegmentWriter writer(3, true, 64*1024);
+  writeSegment(writer, m_data.size());
+  ASSERT(m_data == readSegment());
+}
+// There's a latency for each write.
+
+void segmentWriterTest::latency_1()
+{
+  CSegmentWriter writer(2, false, 1024*1024);
+  EQ(std::string(""), writer.latencyReport());
+  writeSegment(writer, m_data.size());
+  std::string report = writer.latencyReport();
+  EQ(size_t(0), report.find("4 event file writes of up to 1024 KBytes"));
+  ASSERT(report.find("99%:") != std::string::npos);
+  EQ(std::string(""), writer.latencyReport());
+}
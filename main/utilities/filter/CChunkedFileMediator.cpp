@@ -0,0 +1,496 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+
+#include "CChunkedFileMediator.h"
+
+#include <CDataSink.h>
+#include <CFileDataSource.h>
+#include <CEventIndex.h>
+#include <CFilter.h>
+#include <CRingItem.h>
+#include <DataFormat.h>
+#include <ErrnoException.h>
+
+#include <algorithm>
+#include <memory>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Ranges that may be filtered or waiting to be written, per worker.
+
+static const size_t InFlightPerWorker(2);
+
+// Bytes read at a time when walking the item headers of a file without
+// an index.
+
+static const size_t HeaderBlock(1024*1024);
+
+// Largest block of output given to one sink put.
+
+static const size_t OutputChunk(1024*1024);
+
+// Output of the range the calling worker thread is filtering.
+
+static thread_local std::vector<uint8_t>* pRangeOutput(0);
+
+/*
+ * Append a ring item to a range's output.
+ */
+static void
+appendItem(std::vector<uint8_t>& output, const CRingItem& item)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(item.getItemPointer());
+  output.insert(output.end(), p, p + item.size());
+}
+/*
+ * pread all of a block or throw.
+ */
+static void
+readBlock(int fd, void* pData, size_t nBytes, uint64_t offset)
+{
+  uint8_t* p = static_cast<uint8_t*>(pData);
+  while (nBytes) {
+    ssize_t n = pread(fd, p, nBytes, offset);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      throw CErrnoException("Reading an event file");
+    }
+    if (n == 0) {
+      throw std::string("Unexpected end of an event file");
+    }
+    p      += n;
+    nBytes -= n;
+    offset += n;
+  }
+}
+
+/**! Constructor
+
+  \param files the event files in the order they're to be processed.
+  \param filter a pointer to a CFilter; its clones do the filtering.
+  \param sink a pointer to a CDataSink
+  \param nWorkers number of filter threads (at least 1).
+  \param exclude item types that are not filtered or written.
+  \param chunkSize approximate number of bytes in a range.
+
+*/
+CChunkedFileMediator::CChunkedFileMediator(
+  const std::vector<std::string>& files, CFilter* filter, CDataSink* sink,
+  unsigned nWorkers, std::vector<uint16_t> exclude, uint64_t chunkSize)
+: CMediator(0, filter, sink),
+  m_files(files),
+  m_exclude(exclude),
+  m_nWorkers(nWorkers ? nWorkers : 1),
+  m_chunkSize(chunkSize ? chunkSize : 1),
+  m_nextRange(0),
+  m_nextOutput(0),
+  m_stopping(false),
+  m_failed(false)
+{}
+
+/**! Destructor
+  Stops the workers if finalize was not called, deletes the clones and
+  closes the files.
+*/
+CChunkedFileMediator::~CChunkedFileMediator()
+{
+  stopWorkers();
+  for (size_t i = 0; i < m_filters.size(); i++) {
+    delete m_filters[i];
+  }
+  for (size_t i = 0; i < m_fds.size(); i++) {
+    close(m_fds[i]);
+  }
+}
+
+/**! Initialize operations
+  Opens the files, splits them into ranges, clones the filter for each
+  worker, initializes the clones and starts the worker threads.
+
+  \throw CErrnoException if a file can't be opened.
+*/
+void CChunkedFileMediator::initialize()
+{
+  for (size_t i = 0; i < m_files.size(); i++) {
+    int fd = open(m_files[i].c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw CErrnoException("Opening an event file to filter");
+    }
+    m_fds.push_back(fd);
+    planRanges(i);
+  }
+
+  for (unsigned i = 0; i < m_nWorkers; i++) {
+    CFilter* pFilter = getFilter()->clone();
+    m_filters.push_back(pFilter);
+    pFilter->initialize();
+  }
+  m_nextRange  = 0;
+  m_nextOutput = 0;
+  m_stopping   = false;
+  m_failed     = false;
+  for (unsigned i = 0; i < m_nWorkers; i++) {
+    m_threads.push_back(std::thread(&CChunkedFileMediator::worker, this, i));
+  }
+}
+
+/**! Finalization operations
+  Stops the workers and finalizes each filter clone.
+*/
+void CChunkedFileMediator::finalize()
+{
+  stopWorkers();
+  for (size_t i = 0; i < m_filters.size(); i++) {
+    m_filters[i]->finalize();
+  }
+}
+
+/**! The main loop
+  Writes the output of each range, in order, as it is completed.
+
+  If a filter throws or a range is not aligned to items, what was filtered
+  before that is written and the exception is rethrown here.
+*/
+void CChunkedFileMediator::mainLoop()
+{
+  while (1) {
+    Result result;
+    {
+      std::unique_lock<std::mutex> lock(m_lock);
+      std::map<size_t, Result>::iterator p;
+      while ((m_nextOutput < m_ranges.size()) &&
+             ((p = m_output.find(m_nextOutput)) == m_output.end())) {
+        m_workDone.wait(lock);
+      }
+      if (m_nextOutput == m_ranges.size()) {
+        break;
+      }
+      result.s_output.swap(p->second.s_output);
+      result.s_error = p->second.s_error;
+      m_output.erase(p);
+      m_nextOutput++;
+    }
+    m_workReady.notify_all();
+    writeRange(result.s_output);
+    if (result.s_error) {
+      std::rethrow_exception(result.s_error);
+    }
+  }
+}
+
+/**! Put an item to the output
+  \param item the item to write.
+*/
+void CChunkedFileMediator::putItem(const CRingItem& item)
+{
+  if (pRangeOutput) {
+    appendItem(*pRangeOutput, item);
+  } else {
+    std::lock_guard<std::mutex> guard(m_sinkLock);
+    getDataSink()->putItem(item);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Private utilities
+
+/**! Split a file into ranges
+  \param file index of the file in m_files.
+*/
+void CChunkedFileMediator::planRanges(size_t file)
+{
+  struct stat info;
+  if (fstat(m_fds[file], &info)) {
+    throw CErrnoException("Getting the size of an event file");
+  }
+  uint64_t fileSize = info.st_size;
+  if (!planFromIndex(file, fileSize)) {
+    planFromHeaders(file, fileSize);
+  }
+}
+
+/**! Account for an item when splitting a file into ranges
+  State changes are recorded.  A range ends before a state change and
+  before the first item at least m_chunkSize bytes past its start.
+
+  \param file index of the file.
+  \param offset where the item is.
+  \param type its type.
+  \param[inout] begin start of the range being planned.
+*/
+void CChunkedFileMediator::planItem(size_t file, uint64_t offset,
+                                    uint32_t type, uint64_t& begin)
+{
+  bool stateChange = CEventIndex::isStateChange(type);
+  if (stateChange) {
+    m_stateChanges.push_back(Position(file, offset));
+  }
+  if ((offset > begin) &&
+      (stateChange || ((offset - begin) >= m_chunkSize))) {
+    Range r = {file, begin, offset};
+    m_ranges.push_back(r);
+    begin = offset;
+  }
+}
+
+/**! Split a file into ranges using its index
+  Only indexed items can start a range.
+
+  \param file index of the file.
+  \param fileSize its size.
+  \return false if the file has no usable index.
+*/
+bool CChunkedFileMediator::planFromIndex(size_t file, uint64_t fileSize)
+{
+  std::unique_ptr<CEventIndex> pIndex;
+  try {
+    pIndex.reset(new CEventIndex(CEventIndex::indexFile(m_files[file]).c_str()));
+  }
+  catch (CErrnoException& e) {
+    return false;
+  }
+  catch (std::string& msg) {
+    return false;
+  }
+
+  const std::vector<EventIndexEntry>& entries(pIndex->getEntries());
+  uint64_t begin = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    const EventIndexEntry& e(entries[i]);
+    if (e.s_offset >= fileSize) break;
+    planItem(file, e.s_offset, e.s_type, begin);
+  }
+  Range r = {file, begin, UINT64_MAX};
+  m_ranges.push_back(r);
+  return true;
+}
+
+/**! Split a file into ranges by walking its item headers
+  Without an index this is the only way to find the state changes each
+  filter clone must see.  Only the headers are looked at, and the file is
+  read sequentially in HeaderBlock pieces.  A truncated last item ends
+  the walk; filtering that range finds it.
+
+  \param file index of the file.
+  \param fileSize its size.
+  \throw std::string if an item header has an impossible size.
+*/
+void CChunkedFileMediator::planFromHeaders(size_t file, uint64_t fileSize)
+{
+  std::vector<uint8_t> block(HeaderBlock);
+  uint64_t blockStart = 0;
+  uint64_t blockEnd   = 0;
+  uint64_t begin      = 0;
+  uint64_t offset     = 0;
+  while (offset + sizeof(RingItemHeader) <= fileSize) {
+    if (offset + sizeof(RingItemHeader) > blockEnd) {
+      blockStart = offset;
+      blockEnd   = std::min(fileSize, offset + HeaderBlock);
+      readBlock(m_fds[file], block.data(), blockEnd - blockStart, blockStart);
+    }
+    const RingItem* pItem =
+      reinterpret_cast<const RingItem*>(block.data() + (offset - blockStart));
+    uint32_t size = itemSize(pItem);
+    if (size < sizeof(RingItemHeader)) {
+      throw std::string("Invalid ring item size in ") + m_files[file];
+    }
+    planItem(file, offset, itemType(pItem), begin);
+    offset += size;
+  }
+  Range r = {file, begin, UINT64_MAX};
+  m_ranges.push_back(r);
+}
+
+/**! Body of a worker thread
+  Filters ranges with this worker's filter clone until there are no more,
+  not getting too far ahead of the output.
+
+  \param index which worker this is.
+*/
+void CChunkedFileMediator::worker(unsigned index)
+{
+  CFilter* pFilter = m_filters[index];
+  Position last(0, 0);
+  size_t   maxInFlight = InFlightPerWorker*m_nWorkers;
+
+  std::unique_lock<std::mutex> lock(m_lock);
+  while (1) {
+    while (!m_stopping && !m_failed && (m_nextRange < m_ranges.size()) &&
+           (m_nextRange >= m_nextOutput + maxInFlight)) {
+      m_workReady.wait(lock);
+    }
+    if (m_stopping || m_failed || (m_nextRange >= m_ranges.size())) {
+      return;
+    }
+    size_t range = m_nextRange++;
+    lock.unlock();
+
+    Result result;
+    pRangeOutput = &result.s_output;
+    try {
+      filterRange(pFilter, m_ranges[range], last);
+    }
+    catch (...) {
+      result.s_error = std::current_exception();
+    }
+    pRangeOutput = 0;
+
+    lock.lock();
+    if (result.s_error) {
+      m_failed = true;           // Ranges not yet started are not filtered.
+    }
+    Result& done(m_output[range]);
+    done.s_output.swap(result.s_output);
+    done.s_error = result.s_error;
+    m_workDone.notify_all();
+  }
+}
+
+/**! Filter a range into pRangeOutput
+  \param pFilter the worker's filter clone.
+  \param range the range.
+  \param[inout] last the end of the last range this filter did.
+  \throw std::string if the range does not end on an item boundary.
+*/
+void CChunkedFileMediator::filterRange(CFilter* pFilter, const Range& range,
+                                       Position& last)
+{
+  replayStateChanges(pFilter, last, Position(range.s_file, range.s_begin));
+
+  int fd = open(m_files[range.s_file].c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw CErrnoException("Opening an event file to filter");
+  }
+  CFileDataSource source(fd, m_exclude);       // Closes fd.
+  source.setRange(range.s_begin, range.s_end);
+
+  while (1) {
+    std::unique_ptr<CRingItem> pItem(source.getItem());
+    if (!pItem.get()) {
+      break;
+    }
+    CRingItem* pResult = dispatchItem(pFilter, pItem.get());
+    if (pResult) {
+      appendItem(*pRangeOutput, *pResult);
+      if (pResult != pItem.get()) {
+        delete pResult;
+      }
+    }
+  }
+  if ((range.s_end != UINT64_MAX) && (source.getOffset() != range.s_end)) {
+    throw std::string("Parallel filter range does not end on a ring item in ")
+      + m_files[range.s_file];
+  }
+  last = Position(range.s_file, range.s_end);
+}
+
+/**! Give a filter clone the state changes it has not seen
+  Their output is discarded.
+
+  \param pFilter the filter clone.
+  \param from position the clone has filtered up to.
+  \param to position of the range it is about to filter.
+*/
+void CChunkedFileMediator::replayStateChanges(CFilter* pFilter,
+                                              Position from, Position to)
+{
+  std::vector<Position>::iterator p =
+    std::lower_bound(m_stateChanges.begin(), m_stateChanges.end(), from);
+  std::vector<Position>::iterator end =
+    std::lower_bound(m_stateChanges.begin(), m_stateChanges.end(), to);
+  for (; p != end; ++p) {
+    std::unique_ptr<CRingItem> pItem(readItem(p->first, p->second));
+    if (std::find(m_exclude.begin(), m_exclude.end(), pItem->type()) != m_exclude.end()) {
+      continue;
+    }
+    CRingItem* pResult = dispatchItem(pFilter, pItem.get());
+    if (pResult != pItem.get()) {
+      delete pResult;
+    }
+  }
+}
+
+/**! Read one item from a file
+  \param file index of the file.
+  \param offset where the item is.
+  \return a dynamically allocated copy of the item.
+*/
+CRingItem* CChunkedFileMediator::readItem(size_t file, uint64_t offset)
+{
+  RingItemHeader header;
+  readBlock(m_fds[file], &header, sizeof(header), offset);
+  uint32_t size = itemSize(reinterpret_cast<pRingItem>(&header));
+  if (size < sizeof(header)) {
+    throw std::string("Invalid ring item size in ") + m_files[file];
+  }
+
+  CRingItem* pItem    = new CRingItem(1, size);
+  uint8_t*   pStorage = reinterpret_cast<uint8_t*>(pItem->getItemPointer());
+  try {
+    readBlock(m_fds[file], pStorage, size, offset);
+  }
+  catch (...) {
+    delete pItem;
+    throw;
+  }
+  pItem->setBodyCursor(pStorage + size);
+  return pItem;
+}
+
+/**! Write the output of a range
+  The items are put in blocks of whole items.
+
+  \param data the items.
+*/
+void CChunkedFileMediator::writeRange(const std::vector<uint8_t>& data)
+{
+  std::lock_guard<std::mutex> guard(m_sinkLock);
+  CDataSink* pSink = getDataSink();
+  size_t start = 0;
+  size_t pos   = 0;
+  while (pos < data.size()) {
+    uint32_t size = itemSize(reinterpret_cast<const RingItem*>(data.data() + pos));
+    if ((pos > start) && ((pos + size - start) > OutputChunk)) {
+      pSink->put(data.data() + start, pos - start);
+      start = pos;
+    }
+    pos += size;
+  }
+  if (pos > start) {
+    pSink->put(data.data() + start, pos - start);
+  }
+}
+
+/**! Stop the worker threads
+  Output not yet written is discarded.
+*/
+void CChunkedFileMediator::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stopping = true;
+  }
+  m_workReady.notify_all();
+  for (size_t i = 0; i < m_threads.size(); i++) {
+    m_threads[i].join();
+  }
+  m_threads.clear();
+
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_output.clear();
+}
@@ -0,0 +1,136 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+
+
+#ifndef CCHUNKEDFILEMEDIATOR_H
+#define CCHUNKEDFILEMEDIATOR_H
+
+#include <CMediator.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdint.h>
+
+class CFilter;
+class CDataSink;
+class CRingItem;
+
+
+/**! \brief A mediator that filters event files in parallel byte ranges.
+ *
+ *  The files (e.g. the segments of a run, in order) are split into ranges
+ *  that start and end on ring item boundaries.  Each worker thread has its
+ *  own clone() of the filter and filters whole ranges, reading them with
+ *  its own CFileDataSource.  The output of each range is kept in memory
+ *  and the ranges are written to the sink in file order by the thread
+ *  running mainLoop, so the output is what a single filter would have made.
+ *
+ *  Range boundaries and state changes come from the file's index (see
+ *  CEventIndex) if it has one.  Otherwise they are found by walking the
+ *  ring item headers of the file, which costs a sequential read of it.
+ *  Every state change starts a range and, before a clone filters a range,
+ *  it is given the state changes in the ranges it did not filter (its
+ *  output for them is discarded) so that, as with CParallelMediator, each
+ *  clone sees every run boundary.  A range that does not end on an item
+ *  (e.g. the file changed after it was planned) is reported as an error;
+ *  nothing past it is written.
+ *
+ *  Items put directly to the sink by filters should go through putItem,
+ *  which puts them in the output of the range being filtered.
+ */
+class CChunkedFileMediator : public CMediator
+{
+  public:
+    struct Range {
+      size_t   s_file;
+      uint64_t s_begin;
+      uint64_t s_end;            // UINT64_MAX - to the end of the file.
+    };
+
+  private:
+    typedef std::pair<size_t, uint64_t> Position;   // file, offset.
+
+    struct Result {
+      std::vector<uint8_t> s_output;
+      std::exception_ptr   s_error;     // What ended the range early.
+    };
+
+    std::vector<std::string>   m_files;
+    std::vector<uint16_t>      m_exclude;
+    unsigned                   m_nWorkers;
+    uint64_t                   m_chunkSize;
+    std::vector<int>           m_fds;
+    std::vector<Range>         m_ranges;
+    std::vector<Position>      m_stateChanges;
+    std::vector<CFilter*>      m_filters;      // One per worker.
+    std::vector<std::thread>   m_threads;
+
+    std::mutex                 m_lock;         // Guards all below.
+    std::condition_variable    m_workReady;
+    std::condition_variable    m_workDone;
+    size_t                     m_nextRange;    // Next range for a worker.
+    size_t                     m_nextOutput;   // Next range to write.
+    std::map<size_t, Result>   m_output;       // Filtered, waiting to be written.
+    bool                       m_stopping;
+    bool                       m_failed;       // A range ended in an exception.
+
+    std::mutex                 m_sinkLock;
+
+  public:
+    CChunkedFileMediator(const std::vector<std::string>& files,
+                         CFilter* filter, CDataSink* sink, unsigned nWorkers,
+                         std::vector<uint16_t> exclude = std::vector<uint16_t>(),
+                         uint64_t chunkSize = 64*1024*1024);
+
+    virtual ~CChunkedFileMediator();
+
+  private:
+    CChunkedFileMediator(const CChunkedFileMediator&);
+    CChunkedFileMediator& operator=(const CChunkedFileMediator&);
+
+  public:
+    virtual void mainLoop();
+    virtual void initialize();
+    virtual void finalize();
+
+    /**! Put an item to the output of the range being filtered or,
+     *   if not called from a worker, to the sink.
+    */
+    void putItem(const CRingItem& item);
+
+    const std::vector<Range>& getRanges() const { return m_ranges; }
+    unsigned getWorkerCount() const { return m_nWorkers; }
+
+  private:
+    void planRanges(size_t file);
+    void planItem(size_t file, uint64_t offset, uint32_t type, uint64_t& begin);
+    bool planFromIndex(size_t file, uint64_t fileSize);
+    void planFromHeaders(size_t file, uint64_t fileSize);
+
+    void worker(unsigned index);
+    void filterRange(CFilter* pFilter, const Range& range, Position& last);
+    void replayStateChanges(CFilter* pFilter, Position from, Position to);
+    CRingItem* readItem(size_t file, uint64_t offset);
+    void writeRange(const std::vector<uint8_t>& data);
+    void stopWorkers();
+};
+
+#endif
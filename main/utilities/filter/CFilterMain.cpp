@@ -22,6 +22,8 @@ static const char* Copyright = "(C) Copyright Michigan State University 2014, Al
 #include "CMediator.h"
 #include "COneShotMediator.h"
 #include "CInfiniteMediator.h"
+#include "CParallelMediator.h"
+#include "CChunkedFileMediator.h"
 #include "CDataSourceFactory.h"
 #include "CDataSinkFactory.h"
 #include <string>
@@ -55,16 +57,36 @@ CFilterMain::CFilterMain(int argc, char** argv)
 
   try {
 
-    if (m_argsInfo->oneshot_given) {
+    if (m_argsInfo->workers_arg < 1) {
+      throw std::invalid_argument("--workers must be at least 1");
+    }
+    if (m_argsInfo->files_given) {
+      if (m_argsInfo->oneshot_given || m_argsInfo->source_given ||
+          m_argsInfo->skip_given || m_argsInfo->count_given) {
+        throw std::invalid_argument(
+          "--files can't be used with --oneshot, --source, --skip or --count"
+        );
+      }
+      std::vector<std::string> files(
+        m_argsInfo->files_arg, m_argsInfo->files_arg + m_argsInfo->files_given
+      );
+      m_mediator = new CChunkedFileMediator(files, new CCompositeFilter, 0,
+          m_argsInfo->workers_arg, constructExcludesList());
+    } else if (m_argsInfo->oneshot_given) {
       m_mediator = new COneShotMediator(0,new CCompositeFilter,0,
           m_argsInfo->number_of_sources_arg); 
+    } else if (m_argsInfo->workers_arg > 1) {
+      m_mediator = new CParallelMediator(0,new CCompositeFilter,0,
+          m_argsInfo->workers_arg);
     } else {
       m_mediator = new CInfiniteMediator(0,new CCompositeFilter,0);
     }
     
-    // Set up the data source 
-    CDataSource* source = constructDataSource(); 
-    m_mediator->setDataSource(source);
+    // Set up the data source (the chunked mediator reads its files itself)
+    if (!m_argsInfo->files_given) {
+      CDataSource* source = constructDataSource(); 
+      m_mediator->setDataSource(source);
+    }
 
     // Set up the sink source 
     CDataSink* sink = constructDataSink();
@@ -125,12 +147,24 @@ void CFilterMain::registerFilter(const CFilter* filter)
  *    daqdev/NSCLDAQ#804 - support filter elements creating several ring items
  *    per input ring item.
  *
+ *    When the filters run on several threads the put is serialized with
+ *    the mediator's output, or, when filtering files in chunks, goes into
+ *    the output of the chunk being filtered.
+ *
  * @param pRingItem - pointer to the ring item to put to the sink.
  */
  void
  CFilterMain::putRingItem(CRingItem* pRingItem)
  {
-  m_pSink->putItem(*pRingItem);
+  CParallelMediator* pParallel = dynamic_cast<CParallelMediator*>(m_mediator);
+  CChunkedFileMediator* pChunked = dynamic_cast<CChunkedFileMediator*>(m_mediator);
+  if (pParallel) {
+    pParallel->putItem(*pRingItem);
+  } else if (pChunked) {
+    pChunked->putItem(*pRingItem);
+  } else {
+    m_pSink->putItem(*pRingItem);
+  }
  }
 
 /////////////////////////////////////////////////////////
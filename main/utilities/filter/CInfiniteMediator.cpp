@@ -22,6 +22,7 @@ static const char* Copyright = "(C) Copyright Michigan State University 2014, Al
 
 #include <iostream>
 #include <CDataSource.h>
+#include <CFileDataSource.h>
 #include <CDataSink.h>
 #include <CFilter.h>
 
@@ -31,6 +32,8 @@ static const char* Copyright = "(C) Copyright Michigan State University 2014, Al
 #include <CPhysicsEventItem.h>
 #include <CRingPhysicsEventCountItem.h>
 #include <CRingFragmentItem.h>
+#include <DataFormat.h>
+#include <string.h>
 
 /**! Constructor
 
@@ -42,7 +45,7 @@ static const char* Copyright = "(C) Copyright Michigan State University 2014, Al
 
 */
 CInfiniteMediator::CInfiniteMediator(CDataSource* source, CFilter* filter, CDataSink* sink)
-: CMediator(source,filter,sink)
+: CMediator(source,filter,sink), m_pItem(0)
 {}
 
 /**! Destructor
@@ -55,6 +58,7 @@ CInfiniteMediator::CInfiniteMediator(CDataSource* source, CFilter* filter, CData
 */
 CInfiniteMediator::~CInfiniteMediator() 
 {
+  delete m_pItem;
 }
 
 /**! The main loop
@@ -87,7 +91,7 @@ void CInfiniteMediator::mainLoop()
 
     // Get a new item
     // Exit if the item returned is null
-    CRingItem* item = source.getItem();
+    CRingItem* item = getItem(source);
     if (item==0) {
       break;
     }
@@ -119,9 +123,11 @@ void CInfiniteMediator::mainLoop()
     }
     
 
-    // delete original item
+    // delete original item unless it's our reused one.
     // THE FILTER MUST NOT HAVE DELETED THE OBJECT PASSED IT!!!
-    delete item;
+    if (item != m_pItem) {
+      delete item;
+    }
 
     // Increment our counter
     ++tot_iter;
@@ -138,3 +144,46 @@ void CInfiniteMediator::finalize()
 {
   getFilter()->finalize();
 }
+
+/**! Get the next item from the source
+  File data sources can give us their items in place.  Those are copied
+  into m_pItem which is reused so that there's no per item memory
+  allocation.  Other sources give us a new item.
+
+  \param source the data source.
+  \return the item or 0 at the end of the data.
+*/
+CRingItem* CInfiniteMediator::getItem(CDataSource& source)
+{
+  CFileDataSource* pFileSource = dynamic_cast<CFileDataSource*>(&source);
+  if (pFileSource) {
+    return fillItem(pFileSource->getItemPointer());
+  } else {
+    return source.getItem();
+  }
+}
+
+/**! Copy a raw ring item into m_pItem
+  m_pItem is only replaced if it's too small for the item.  The item is
+  copied as is, preserving its byte order.
+
+  \param pItem the raw item (may be null).
+  \return m_pItem or 0 if pItem is null.
+*/
+CRingItem* CInfiniteMediator::fillItem(const RingItem* pItem)
+{
+  if (!pItem) {
+    return 0;
+  }
+  uint32_t size = itemSize(pItem);
+  if (!m_pItem || (m_pItem->getStorageSize() < size)) {
+    delete m_pItem;
+    m_pItem = 0;
+    m_pItem = new CRingItem(1, size);    // Type will get overwritten.
+  }
+  uint8_t* pStorage = reinterpret_cast<uint8_t*>(m_pItem->getItemPointer());
+  memcpy(pStorage, pItem, size);
+  m_pItem->setBodyCursor(pStorage + size);
+
+  return m_pItem;
+}
@@ -26,6 +26,7 @@ class CFilter;
 class CDataSink;
 class CRingItem;
 class CRingStateChangeItem;
+struct _RingItem;
 
 
 /**! \brief A mediator that never quits unless count is satisfied or stream ends.
@@ -37,6 +38,9 @@ class CRingStateChangeItem;
  */
 class CInfiniteMediator : public CMediator
 {
+  private:
+    CRingItem* m_pItem;   // Reused for items a CFileDataSource gives in place.
+
   public:
     // The constructor
     CInfiniteMediator(CDataSource* source, CFilter* filter, CDataSink* sink);
@@ -66,6 +70,10 @@ class CInfiniteMediator : public CMediator
      *  This simply calls the finalize method of the filter.
      */
     virtual void finalize();
+
+  private:
+    CRingItem* getItem(CDataSource& source);
+    CRingItem* fillItem(const _RingItem* pItem);
 };
 
 #endif
@@ -107,6 +107,10 @@ class CMediator : public CBaseMediator
     */
     virtual CRingItem* handleItem(CRingItem* item); 
 
+    /**! Delegate item to proper handler of a specific filter
+    */
+    static CRingItem* dispatchItem(CFilter* pFilter, CRingItem* item);
+
 };
 
 #endif
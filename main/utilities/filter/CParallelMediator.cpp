@@ -0,0 +1,359 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+
+#include "CParallelMediator.h"
+
+#include <CDataSource.h>
+#include <CDataSink.h>
+#include <CFilter.h>
+#include <CRingItem.h>
+#include <DataFormat.h>
+
+// Items that may be in flight for each worker.
+
+static const size_t InFlightPerWorker(256);
+
+// Items put by the filter of the calling worker thread.
+
+static thread_local std::vector<uint8_t>* pEmitted(0);
+
+/**! Constructor
+
+  \param source a pointer to a CDataSource
+  \param filter a pointer to a CFilter; its clones do the filtering.
+  \param sink a pointer to a CDataSink
+  \param nWorkers number of filter threads (at least 1).
+
+*/
+CParallelMediator::CParallelMediator(CDataSource* source, CFilter* filter,
+                                     CDataSink* sink, unsigned nWorkers)
+: CMediator(source, filter, sink),
+  m_nWorkers(nWorkers ? nWorkers : 1),
+  m_maxInFlight(InFlightPerWorker*(nWorkers ? nWorkers : 1)),
+  m_nextSequence(0),
+  m_nextOutput(0),
+  m_stopping(false)
+{}
+
+/**! Destructor
+  Stops the workers if finalize was not called and deletes the clones.
+*/
+CParallelMediator::~CParallelMediator()
+{
+  stopWorkers();
+  for (size_t i = 0; i < m_filters.size(); i++) {
+    delete m_filters[i];
+  }
+}
+
+/**! Initialize operations
+  Clones the filter for each worker, initializes the clones and starts
+  the worker threads.
+*/
+void CParallelMediator::initialize()
+{
+  for (unsigned i = 0; i < m_nWorkers; i++) {
+    CFilter* pFilter = getFilter()->clone();
+    m_filters.push_back(pFilter);
+    pFilter->initialize();
+  }
+  m_stopping = false;
+  for (unsigned i = 0; i < m_nWorkers; i++) {
+    m_threads.push_back(std::thread(&CParallelMediator::worker, this, i));
+  }
+}
+
+/**! Finalization operations
+  Stops the workers and finalizes each filter clone.
+*/
+void CParallelMediator::finalize()
+{
+  stopWorkers();
+  for (size_t i = 0; i < m_filters.size(); i++) {
+    m_filters[i]->finalize();
+  }
+}
+
+/**! The main loop
+  Reads items from the source, honoring the skip and process counts as
+  CInfiniteMediator does, and hands them to the workers or, for barriers,
+  processes them once everything ahead of them has been written.
+
+  If a filter throws, the exception is rethrown here.
+*/
+void CParallelMediator::mainLoop()
+{
+  CDataSource& source = *getDataSource();
+
+  int tot_iter=0, proc_iter=0;
+  int nskip    = getSkipCount();
+  int nprocess = getProcessCount();
+
+  while (1) {
+    if (proc_iter>=nprocess && nprocess>=0) {
+      break;
+    }
+
+    CRingItem* item = source.getItem();
+    if (item==0) {
+      break;
+    }
+
+    if (tot_iter>=nskip) {
+      if (isBarrier(item)) {
+        processBarrier(item);
+      } else {
+        dispatch(item);
+      }
+      ++proc_iter;
+    } else {
+      delete item;
+    }
+    ++tot_iter;
+  }
+  writeCompleted(true);
+}
+
+/**! Put an item to the sink
+  From a worker thread, the item is held until the item being filtered
+  is written.
+
+  \param item the item to write.
+*/
+void CParallelMediator::putItem(const CRingItem& item)
+{
+  if (pEmitted) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(item.getItemPointer());
+    pEmitted->insert(pEmitted->end(), p, p + item.size());
+  } else {
+    std::lock_guard<std::mutex> guard(m_sinkLock);
+    getDataSink()->putItem(item);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Private utilities
+
+/**! Determine if an item is an ordering barrier
+  \param item the item.
+  \return true for state change and scaler items.
+*/
+bool CParallelMediator::isBarrier(const CRingItem* item)
+{
+  switch (item->type()) {
+    case BEGIN_RUN:
+    case END_RUN:
+    case PAUSE_RUN:
+    case RESUME_RUN:
+    case ABNORMAL_ENDRUN:
+    case PERIODIC_SCALERS:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**! Body of a worker thread
+  Filters queued items with this worker's filter clone until stopped.
+
+  \param index which worker this is.
+*/
+void CParallelMediator::worker(unsigned index)
+{
+  CFilter* pFilter = m_filters[index];
+  std::unique_lock<std::mutex> lock(m_lock);
+  while (1) {
+    while (m_input.empty() && !m_stopping) {
+      m_workReady.wait(lock);
+    }
+    if (m_input.empty()) {
+      return;                    // Stopping.
+    }
+    Work work = m_input.front();
+    m_input.pop_front();
+    lock.unlock();
+
+    std::exception_ptr error;
+    pEmitted = &work.s_emitted;
+    try {
+      work.s_pResult = dispatchItem(pFilter, work.s_pItem);
+    }
+    catch (...) {
+      error          = std::current_exception();
+      work.s_pResult = 0;
+    }
+    pEmitted = 0;
+
+    lock.lock();
+    if (error && !m_error) {
+      m_error = error;
+    }
+    m_output[work.s_sequence] = std::move(work);
+    m_workDone.notify_all();
+  }
+}
+
+/**! Queue an item for the workers
+  Writes whatever has been filtered in order, waiting if too many items
+  are in flight.
+
+  \param item the item to queue.
+*/
+void CParallelMediator::dispatch(CRingItem* item)
+{
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    Work work = {m_nextSequence++, item, 0, std::vector<uint8_t>()};
+    m_input.push_back(work);
+  }
+  m_workReady.notify_one();
+  writeCompleted(false);
+}
+
+/**! Handle an ordering barrier
+  Waits until everything ahead of the item has been written, then writes
+  what the first filter clone makes of it.  The remaining clones are then
+  given copies of the original item and their output, including anything
+  they put, is discarded.
+
+  \param item the barrier item.
+*/
+void CParallelMediator::processBarrier(CRingItem* item)
+{
+  writeCompleted(true);
+
+  CRingItem original(*item);             // The filter may modify item.
+  Work work = {m_nextSequence, item, 0, std::vector<uint8_t>()};
+  work.s_pResult = dispatchItem(m_filters[0], item);
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_nextSequence++;
+    m_nextOutput++;
+  }
+  output(work);
+
+  // Items the other clones put go to a scratch buffer and are dropped
+  // with the rest of their output.
+
+  std::vector<uint8_t> discarded;
+  pEmitted = &discarded;
+  try {
+    for (size_t i = 1; i < m_filters.size(); i++) {
+      CRingItem  copy(original);
+      CRingItem* result = dispatchItem(m_filters[i], &copy);
+      if (result != &copy) {
+        delete result;
+      }
+      discarded.clear();
+    }
+  }
+  catch (...) {
+    pEmitted = 0;
+    throw;
+  }
+  pEmitted = 0;
+}
+
+/**! Write filtered items in order
+  \param all if true, wait until every item read has been written.
+             Otherwise only wait while too many items are in flight.
+  \throw the first exception a filter threw.
+*/
+void CParallelMediator::writeCompleted(bool all)
+{
+  std::unique_lock<std::mutex> lock(m_lock);
+  while (1) {
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
+    std::map<uint64_t, Work>::iterator p = m_output.begin();
+    if ((p == m_output.end()) || (p->first != m_nextOutput)) {
+      uint64_t inFlight = m_nextSequence - m_nextOutput;
+      bool mustWait     = all ? (inFlight > 0) : (inFlight >= m_maxInFlight);
+      if (!mustWait) {
+        return;
+      }
+      m_workDone.wait(lock);
+      continue;
+    }
+    Work work = std::move(p->second);
+    m_output.erase(p);
+    m_nextOutput++;
+
+    lock.unlock();
+    output(work);
+    lock.lock();
+  }
+}
+
+/**! Write a filtered item and release its storage
+  Items the filter put come first, as they would have been written while
+  it ran.  As with CInfiniteMediator, a null result means nothing is
+  written and the result is only deleted if it is not the original item.
+
+  \param work the item and its filtered result.
+*/
+void CParallelMediator::output(Work& work)
+{
+  if (!work.s_emitted.empty()) {
+    std::lock_guard<std::mutex> guard(m_sinkLock);
+    size_t pos = 0;
+    while (pos < work.s_emitted.size()) {
+      const RingItem* pItem =
+        reinterpret_cast<const RingItem*>(work.s_emitted.data() + pos);
+      uint32_t size = itemSize(pItem);
+      getDataSink()->put(pItem, size);
+      pos += size;
+    }
+  }
+  if (work.s_pResult) {
+    putItem(*work.s_pResult);
+    if (work.s_pResult != work.s_pItem) {
+      delete work.s_pResult;
+    }
+  }
+  delete work.s_pItem;
+}
+
+/**! Stop the worker threads
+  Items not yet filtered or written are discarded.
+*/
+void CParallelMediator::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stopping = true;
+  }
+  m_workReady.notify_all();
+  for (size_t i = 0; i < m_threads.size(); i++) {
+    m_threads[i].join();
+  }
+  m_threads.clear();
+
+  std::lock_guard<std::mutex> guard(m_lock);
+  for (size_t i = 0; i < m_input.size(); i++) {
+    delete m_input[i].s_pItem;
+  }
+  m_input.clear();
+  std::map<uint64_t, Work>::iterator p = m_output.begin();
+  while (p != m_output.end()) {
+    if (p->second.s_pResult != p->second.s_pItem) {
+      delete p->second.s_pResult;
+    }
+    delete p->second.s_pItem;
+    ++p;
+  }
+  m_output.clear();
+}
@@ -0,0 +1,117 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+
+
+#ifndef CPARALLELMEDIATOR_H
+#define CPARALLELMEDIATOR_H
+
+#include <CMediator.h>
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdint.h>
+
+class CDataSource;
+class CFilter;
+class CDataSink;
+class CRingItem;
+
+
+/**! \brief A CInfiniteMediator that runs the filter on several threads.
+ *
+ *  Each worker thread has its own clone() of the filter, made when the
+ *  mediator is initialized.  Items read from the source are numbered and
+ *  queued to the workers; the filtered items are written to the sink in
+ *  the order they were read.
+ *
+ *  State change and scaler items are barriers.  Before one is handled, all
+ *  of the items ahead of it are filtered and written.  It is then given to
+ *  every filter clone (all but the first get a copy) so that each can see
+ *  run boundaries; what the first clone returns is written.  Only then are
+ *  the items following the barrier queued.
+ *
+ *  Filtered items are written by the thread running mainLoop, between reads
+ *  from the source.  Items put directly to the sink by filters should go
+ *  through putItem.  Those a worker's filter puts are held with the item
+ *  being filtered and written just ahead of its result, so they keep
+ *  their place in the output.
+ *
+ *  Filters that keep state across physics items will see only the items
+ *  their thread filtered, and each clone is initialized and finalized.
+ */
+class CParallelMediator : public CMediator
+{
+  private:
+    struct Work {
+      uint64_t             s_sequence;
+      CRingItem*           s_pItem;    // As read from the source.
+      CRingItem*           s_pResult;  // What the filter gave back.
+      std::vector<uint8_t> s_emitted;  // Items the filter gave putItem.
+    };
+
+    unsigned                   m_nWorkers;
+    size_t                     m_maxInFlight;  // Items queued or unwritten.
+    std::vector<CFilter*>      m_filters;      // One per worker.
+    std::vector<std::thread>   m_threads;
+
+    std::mutex                 m_lock;         // Guards all below.
+    std::condition_variable    m_workReady;
+    std::condition_variable    m_workDone;
+    std::deque<Work>           m_input;
+    std::map<uint64_t, Work>   m_output;       // Filtered, waiting to be written.
+    uint64_t                   m_nextSequence; // Given to the next item read.
+    uint64_t                   m_nextOutput;   // Next sequence to write.
+    bool                       m_stopping;
+    std::exception_ptr         m_error;        // First exception from a worker.
+
+    std::mutex                 m_sinkLock;
+
+  public:
+    CParallelMediator(CDataSource* source, CFilter* filter, CDataSink* sink,
+                      unsigned nWorkers);
+
+    virtual ~CParallelMediator();
+
+  private:
+    CParallelMediator(const CParallelMediator&);
+    CParallelMediator& operator=(const CParallelMediator&);
+
+  public:
+    virtual void mainLoop();
+    virtual void initialize();
+    virtual void finalize();
+
+    /**! Put an item to the sink in order with the mediator's own output
+    */
+    void putItem(const CRingItem& item);
+
+    unsigned getWorkerCount() const { return m_nWorkers; }
+
+  private:
+    static bool isBarrier(const CRingItem* item);
+    void worker(unsigned index);
+    void dispatch(CRingItem* item);
+    void processBarrier(CRingItem* item);
+    void writeCompleted(bool all);
+    void output(Work& work);
+    void stopWorkers();
+};
+
+#endif
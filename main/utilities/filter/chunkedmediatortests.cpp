@@ -0,0 +1,337 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+
+static const char* Copyright = "(C) Copyright Michigan State University 2026, All rights reserved";
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <CRingItem.h>
+#include <CPhysicsEventItem.h>
+#include <CRingStateChangeItem.h>
+#include <CEventIndex.h>
+#include <CEventIndexWriter.h>
+#include <CDataSink.h>
+#include <DataFormat.h>
+#include <CFilter.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#define private public
+#define protected public
+#include "CChunkedFileMediator.h"
+#undef private
+#undef protected
+
+// Filter that counts what it sees.  Physics events whose first word is
+// odd are dropped and a first word of 0xdead throws.
+
+class CChunkedTestFilter : public CFilter
+{
+  public:
+    int  m_nPhysics;
+    int  m_nStateChanges;
+    bool m_sawEnd;
+
+  public:
+    CChunkedTestFilter()
+      : m_nPhysics(0), m_nStateChanges(0), m_sawEnd(false) {}
+    CChunkedTestFilter* clone() const { return new CChunkedTestFilter(*this); }
+
+    CRingItem* handleStateChangeItem(CRingStateChangeItem* item) {
+      ++m_nStateChanges;
+      if (item->type() == END_RUN) {
+        m_sawEnd = true;
+      }
+      return item;
+    }
+    CRingItem* handlePhysicsEventItem(CPhysicsEventItem* item) {
+      ++m_nPhysics;
+      uint32_t value = *reinterpret_cast<uint32_t*>(item->getBodyPointer());
+      if (value == 0xdead) {
+        throw std::string("dead event");
+      }
+      return (value & 1) ? 0 : item;
+    }
+};
+
+// Sink that keeps the bytes put to it.
+
+struct CChunkedTestSink : public CDataSink
+{
+    std::vector<uint8_t> m_data;
+
+    void putItem(const CRingItem& item) {
+      put(item.getItemPointer(), item.size());
+    }
+    void put(const void* pData, size_t nBytes) {
+      const uint8_t* p = static_cast<const uint8_t*>(pData);
+      m_data.insert(m_data.end(), p, p + nBytes);
+    }
+};
+
+// A test suite
+class CChunkedFileMediatorTest : public CppUnit::TestFixture
+{
+
+  private:
+    std::vector<std::string> m_files;
+    std::vector<uint8_t>     m_data;
+    CChunkedTestSink*        m_sink;
+    CChunkedFileMediator*    m_mediator;
+
+  public:
+    CPPUNIT_TEST_SUITE( CChunkedFileMediatorTest );
+    CPPUNIT_TEST ( testIndexed );
+    CPPUNIT_TEST ( testNoIndex );
+    CPPUNIT_TEST ( testFiles );
+    CPPUNIT_TEST ( testException );
+    CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp();
+    void tearDown();
+
+    void testIndexed();
+    void testNoIndex();
+    void testFiles();
+    void testException();
+
+  private:
+    void addEvent(uint32_t value);
+    void addStateChange(uint16_t type);
+    void makeRun(uint32_t first, uint32_t n, bool index, unsigned segment);
+    void run(unsigned nWorkers, uint64_t chunkSize);
+    std::vector<const RingItem*> output();
+    uint32_t eventValue(const RingItem* pItem);
+};
+
+
+// Register it with the test factory
+CPPUNIT_TEST_SUITE_REGISTRATION( CChunkedFileMediatorTest );
+
+
+void CChunkedFileMediatorTest::setUp()
+{
+  m_sink     = new CChunkedTestSink;
+  m_mediator = 0;
+}
+
+void CChunkedFileMediatorTest::tearDown()
+{
+  if (m_mediator) {
+    delete m_mediator;
+  } else {
+    delete m_sink;
+  }
+  m_mediator = 0;
+  for (size_t i = 0; i < m_files.size(); i++) {
+    unlink(m_files[i].c_str());
+    unlink(CEventIndex::indexFile(m_files[i]).c_str());
+  }
+  m_files.clear();
+}
+
+void CChunkedFileMediatorTest::addEvent(uint32_t value)
+{
+  CPhysicsEventItem item;
+  uint32_t* p = reinterpret_cast<uint32_t*>(item.getBodyCursor());
+  *p++ = value;
+  item.setBodyCursor(p);
+  item.updateSize();
+  const uint8_t* pItem = reinterpret_cast<const uint8_t*>(item.getItemPointer());
+  m_data.insert(m_data.end(), pItem, pItem + item.size());
+}
+
+void CChunkedFileMediatorTest::addStateChange(uint16_t type)
+{
+  CRingStateChangeItem item(type);
+  const uint8_t* pItem = reinterpret_cast<const uint8_t*>(item.getItemPointer());
+  m_data.insert(m_data.end(), pItem, pItem + item.size());
+}
+
+// Write a file with a begin run, events first..first+n-1 with a pause
+// and resume in the middle and an end run, indexed if requested.
+
+void CChunkedFileMediatorTest::makeRun(uint32_t first, uint32_t n,
+                                       bool index, unsigned segment)
+{
+  char name[] = "/tmp/chunkedmediatorXXXXXX";
+  int fd = mkstemp(name);
+  close(fd);
+  m_files.push_back(name);
+
+  std::vector<uint8_t> all;
+  all.swap(m_data);
+  addStateChange(BEGIN_RUN);
+  for (uint32_t i = 0; i < n; i++) {
+    if (i == n/2) {
+      addStateChange(PAUSE_RUN);
+      addStateChange(RESUME_RUN);
+    }
+    addEvent(first + i);
+  }
+  addStateChange(END_RUN);
+
+  FILE* fp = fopen(name, "w");
+  fwrite(m_data.data(), 1, m_data.size(), fp);
+  fclose(fp);
+  if (index) {
+    CEventIndexWriter writer(10);
+    writer.open(name, 1, segment);
+    writer.addItems(m_data.data(), m_data.size());
+    writer.close();
+  }
+  all.insert(all.end(), m_data.begin(), m_data.end());
+  m_data.swap(all);
+}
+
+void CChunkedFileMediatorTest::run(unsigned nWorkers, uint64_t chunkSize)
+{
+  m_mediator = new CChunkedFileMediator(m_files, new CChunkedTestFilter,
+                                        m_sink, nWorkers,
+                                        std::vector<uint16_t>(), chunkSize);
+  m_mediator->initialize();
+  m_mediator->mainLoop();
+  m_mediator->finalize();
+}
+
+std::vector<const RingItem*> CChunkedFileMediatorTest::output()
+{
+  std::vector<const RingItem*> result;
+  size_t pos = 0;
+  while (pos < m_sink->m_data.size()) {
+    const RingItem* p = reinterpret_cast<const RingItem*>(&m_sink->m_data[pos]);
+    result.push_back(p);
+    pos += itemSize(p);
+  }
+  CPPUNIT_ASSERT_EQUAL(m_sink->m_data.size(), pos);
+  return result;
+}
+
+uint32_t CChunkedFileMediatorTest::eventValue(const RingItem* pItem)
+{
+  uint32_t value;
+  memcpy(&value, pItem->s_body.u_noBodyHeader.s_body, sizeof(value));
+  return value;
+}
+
+// With an index, ranges start at state changes and every clone that
+// filters the end run has seen every state change before it.  The output
+// is in file order.
+
+void CChunkedFileMediatorTest::testIndexed()
+{
+  makeRun(0, 2000, true, 0);
+  run(4, 1000);
+
+  CPPUNIT_ASSERT(m_mediator->getRanges().size() > 8);
+  std::vector<const RingItem*> items = output();
+  CPPUNIT_ASSERT_EQUAL(size_t(1004), items.size());
+  CPPUNIT_ASSERT_EQUAL(BEGIN_RUN, itemType(items[0]));
+  CPPUNIT_ASSERT_EQUAL(PAUSE_RUN, itemType(items[501]));
+  CPPUNIT_ASSERT_EQUAL(RESUME_RUN, itemType(items[502]));
+  CPPUNIT_ASSERT_EQUAL(END_RUN, itemType(items[1003]));
+  for (size_t i = 1; i < 1003; i++) {
+    if ((i == 501) || (i == 502)) continue;
+    size_t n = (i < 501) ? i - 1 : i - 3;
+    CPPUNIT_ASSERT_EQUAL(uint32_t(2*n), eventValue(items[i]));
+  }
+
+  int total = 0;
+  for (size_t i = 0; i < 4; i++) {
+    CChunkedTestFilter* pFilter =
+      dynamic_cast<CChunkedTestFilter*>(m_mediator->m_filters[i]);
+    total += pFilter->m_nPhysics;
+    if (pFilter->m_sawEnd) {
+      CPPUNIT_ASSERT_EQUAL(4, pFilter->m_nStateChanges);
+    }
+  }
+  CPPUNIT_ASSERT_EQUAL(2000, total);
+}
+
+// Without an index the item headers are walked instead.  The ranges
+// and output are the same and clones still see every state change.
+
+void CChunkedFileMediatorTest::testNoIndex()
+{
+  makeRun(0, 2000, false, 0);
+  run(3, 1000);
+
+  const std::vector<CChunkedFileMediator::Range>& ranges(m_mediator->getRanges());
+  CPPUNIT_ASSERT(ranges.size() > 8);
+  for (size_t i = 1; i < ranges.size(); i++) {
+    CPPUNIT_ASSERT_EQUAL(ranges[i-1].s_end, ranges[i].s_begin);
+  }
+  CPPUNIT_ASSERT_EQUAL(size_t(4), m_mediator->m_stateChanges.size());
+  std::vector<const RingItem*> items = output();
+  CPPUNIT_ASSERT_EQUAL(size_t(1004), items.size());
+  CPPUNIT_ASSERT_EQUAL(END_RUN, itemType(items[1003]));
+  CPPUNIT_ASSERT_EQUAL(uint32_t(1998), eventValue(items[1002]));
+
+  for (size_t i = 0; i < 3; i++) {
+    CChunkedTestFilter* pFilter =
+      dynamic_cast<CChunkedTestFilter*>(m_mediator->m_filters[i]);
+    if (pFilter->m_sawEnd) {
+      CPPUNIT_ASSERT_EQUAL(4, pFilter->m_nStateChanges);
+    }
+  }
+}
+
+// The files are output in the order they're given.
+
+void CChunkedFileMediatorTest::testFiles()
+{
+  makeRun(0, 500, true, 0);
+  makeRun(500, 500, true, 1);
+  run(4, 500);
+
+  std::vector<const RingItem*> items = output();
+  CPPUNIT_ASSERT_EQUAL(size_t(508), items.size());
+  CPPUNIT_ASSERT_EQUAL(END_RUN, itemType(items[253]));
+  CPPUNIT_ASSERT_EQUAL(BEGIN_RUN, itemType(items[254]));
+  CPPUNIT_ASSERT_EQUAL(uint32_t(498), eventValue(items[252]));
+  CPPUNIT_ASSERT_EQUAL(uint32_t(500), eventValue(items[255]));
+  CPPUNIT_ASSERT_EQUAL(uint32_t(998), eventValue(items[506]));
+}
+
+// Exceptions thrown by a filter come out of the main loop after the
+// output of the ranges before the one that threw and what that range
+// made before throwing.  The second file is begin, pause, resume, the
+// bad event and end; the resume starts the range that throws.
+
+void CChunkedFileMediatorTest::testException()
+{
+  makeRun(0, 1000, true, 0);
+  makeRun(0xdead, 1, true, 1);
+
+  m_mediator = new CChunkedFileMediator(m_files, new CChunkedTestFilter,
+                                        m_sink, 4,
+                                        std::vector<uint16_t>(), 500);
+  m_mediator->initialize();
+  CPPUNIT_ASSERT_THROW(m_mediator->mainLoop(), std::string);
+  m_mediator->finalize();
+
+  std::vector<const RingItem*> items = output();
+  CPPUNIT_ASSERT_EQUAL(size_t(507), items.size());
+  CPPUNIT_ASSERT_EQUAL(END_RUN, itemType(items[503]));
+  CPPUNIT_ASSERT_EQUAL(BEGIN_RUN, itemType(items[504]));
+  CPPUNIT_ASSERT_EQUAL(RESUME_RUN, itemType(items[506]));
+}
@@ -56,6 +56,7 @@ class CFilterMainTest : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE( CFilterMainTest );
      CPPUNIT_TEST ( testBadSourceFail );
      CPPUNIT_TEST ( testBadSinkFail );
+     CPPUNIT_TEST ( testBadWorkersFail );
     CPPUNIT_TEST ( testSkipTransmitted );
     CPPUNIT_TEST ( testCountTransmitted );
 //    CPPUNIT_TEST ( testOneShot );
@@ -71,6 +72,7 @@ class CFilterMainTest : public CppUnit::TestFixture
     void testBadSourceFail();  // bad test URL.cpp intervenes
     void testNoSourceFail();
     void testBadSinkFail();   // bad test URL.cpp intervenes.
+    void testBadWorkersFail();
     void testSkipTransmitted();
     void testCountTransmitted();
 
@@ -131,6 +133,19 @@ void CFilterMainTest::testBadSinkFail()
 
 }
 
+void CFilterMainTest::testBadWorkersFail()
+{
+  int argc = 3;
+  const char* argv[] = {"Main",
+                      "--workers=0",
+                      "--files=run-0001-00.evt"};
+  // Ensure that this thing only throws a CFatalException
+  CPPUNIT_ASSERT_THROW( CFilterMain app(argc, 
+                                        const_cast<char**>(argv)), 
+      CFatalException ); 
+
+}
+
 void CFilterMainTest::testSkipTransmitted()
 {
   int argc = 2;
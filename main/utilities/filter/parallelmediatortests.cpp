@@ -0,0 +1,351 @@
+/*
+    This software is Copyright by the Board of Trustees of Michigan
+    State University (c) Copyright 2026.
+
+    You may use this software under the terms of the GNU public license
+    (GPL).  The terms of this license are described at:
+
+     http://www.gnu.org/licenses/gpl.txt
+
+	     FRIB
+	     Michigan State University
+	     East Lansing, MI 48824-1321
+*/
+
+
+static const char* Copyright = "(C) Copyright Michigan State University 2026, All rights reserved";
+
+#include <string>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <CRingItem.h>
+#include <CPhysicsEventItem.h>
+#include <CRingStateChangeItem.h>
+#include <DataFormat.h>
+#include <CFilter.h>
+#include <CFilterTestSource.h>
+#include <CFilterTestSink.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#define private public
+#define protected public
+#include "CParallelMediator.h"
+#undef private
+#undef protected
+
+// Filter that counts what it sees.  Physics events whose first word is
+// odd are dropped, a first word of 0xdead throws and every tenth event
+// is delayed so that items finish out of order.
+
+class CParallelTestFilter : public CFilter
+{
+  public:
+    int  m_nPhysics;
+    int  m_nStateChanges;
+    bool m_initCalled;
+    bool m_finalCalled;
+
+  public:
+    CParallelTestFilter()
+      : m_nPhysics(0), m_nStateChanges(0),
+        m_initCalled(false), m_finalCalled(false) {}
+    CParallelTestFilter* clone() const { return new CParallelTestFilter(*this); }
+
+    CRingItem* handleStateChangeItem(CRingStateChangeItem* item) {
+      ++m_nStateChanges;
+      return item;
+    }
+    CRingItem* handlePhysicsEventItem(CPhysicsEventItem* item) {
+      ++m_nPhysics;
+      uint32_t value = *reinterpret_cast<uint32_t*>(item->getBodyPointer());
+      if (value == 0xdead) {
+        throw std::string("dead event");
+      }
+      if ((value % 10) == 0) {
+        usleep(100);
+      }
+      return (value & 1) ? 0 : item;
+    }
+    void initialize() { m_initCalled = true; }
+    void finalize()   { m_finalCalled = true; }
+};
+
+// Filter that puts a copy of each physics event ahead of itself through
+// the mediator, delaying some so that items finish out of order.
+
+class CEmittingTestFilter : public CFilter
+{
+  public:
+    CParallelMediator* m_pMediator;
+
+  public:
+    CEmittingTestFilter() : m_pMediator(0) {}
+    CEmittingTestFilter* clone() const { return new CEmittingTestFilter(*this); }
+
+    CRingItem* handlePhysicsEventItem(CPhysicsEventItem* item) {
+      uint32_t value = *reinterpret_cast<uint32_t*>(item->getBodyPointer());
+      m_pMediator->putItem(*item);
+      if ((value % 7) == 0) {
+        usleep(100);
+      }
+      return item;
+    }
+};
+
+// Filter that puts a copy of each end run item ahead of itself.
+
+class CEndRunEmittingTestFilter : public CFilter
+{
+  public:
+    CParallelMediator* m_pMediator;
+
+  public:
+    CEndRunEmittingTestFilter() : m_pMediator(0) {}
+    CEndRunEmittingTestFilter* clone() const {
+      return new CEndRunEmittingTestFilter(*this);
+    }
+
+    CRingItem* handleStateChangeItem(CRingStateChangeItem* item) {
+      if (item->type() == END_RUN) {
+        m_pMediator->putItem(*item);
+      }
+      return item;
+    }
+};
+
+// A test suite 
+class CParallelMediatorTest : public CppUnit::TestFixture
+{
+
+  private:
+    CFilterTestSource* m_source;
+    CFilterTestSink*   m_sink;
+    CParallelMediator* m_mediator;
+
+  public:
+    CPPUNIT_TEST_SUITE( CParallelMediatorTest );
+    CPPUNIT_TEST ( testClones );
+    CPPUNIT_TEST ( testOrder );
+    CPPUNIT_TEST ( testBarriers );
+    CPPUNIT_TEST ( testSkipCount );
+    CPPUNIT_TEST ( testException );
+    CPPUNIT_TEST ( testPutItem );
+    CPPUNIT_TEST ( testBarrierPutItem );
+    CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp();
+    void tearDown();
+
+    void testClones();
+    void testOrder();
+    void testBarriers();
+    void testSkipCount();
+    void testException();
+    void testPutItem();
+    void testBarrierPutItem();
+
+  private:
+    void addEvent(uint32_t value);
+    void addStateChange(uint16_t type);
+    uint32_t eventValue(size_t i);
+};
+
+
+// Register it with the test factory
+CPPUNIT_TEST_SUITE_REGISTRATION( CParallelMediatorTest );
+
+
+void CParallelMediatorTest::setUp()
+{
+  m_source   = new CFilterTestSource;
+  m_sink     = new CFilterTestSink;
+  m_mediator = new CParallelMediator(m_source, new CParallelTestFilter,
+                                     m_sink, 4);
+}
+
+void CParallelMediatorTest::tearDown()
+{
+  delete m_mediator; m_mediator=0;
+}
+
+void CParallelMediatorTest::addEvent(uint32_t value)
+{
+  CPhysicsEventItem item;
+  uint32_t* p = reinterpret_cast<uint32_t*>(item.getBodyCursor());
+  *p++ = value;
+  item.setBodyCursor(p);
+  item.updateSize();
+  m_source->addItem(&item);
+}
+
+void CParallelMediatorTest::addStateChange(uint16_t type)
+{
+  CRingStateChangeItem item(type);
+  m_source->addItem(&item);
+}
+
+uint32_t CParallelMediatorTest::eventValue(size_t i)
+{
+  return *reinterpret_cast<uint32_t*>(m_sink->m_sink[i]->getBodyPointer());
+}
+
+// Each worker gets its own initialized and finalized clone.
+
+void CParallelMediatorTest::testClones()
+{
+  m_mediator->initialize();
+  CPPUNIT_ASSERT_EQUAL(size_t(4), m_mediator->m_filters.size());
+  for (size_t i = 0; i < 4; i++) {
+    CParallelTestFilter* pFilter =
+      dynamic_cast<CParallelTestFilter*>(m_mediator->m_filters[i]);
+    CPPUNIT_ASSERT(pFilter != m_mediator->getFilter());
+    CPPUNIT_ASSERT(pFilter->m_initCalled);
+  }
+  m_mediator->finalize();
+  CPPUNIT_ASSERT_EQUAL(size_t(0), m_mediator->m_threads.size());
+  for (size_t i = 0; i < 4; i++) {
+    CParallelTestFilter* pFilter =
+      dynamic_cast<CParallelTestFilter*>(m_mediator->m_filters[i]);
+    CPPUNIT_ASSERT(pFilter->m_finalCalled);
+  }
+}
+
+// Output comes out in input order, less the dropped items.
+
+void CParallelMediatorTest::testOrder()
+{
+  for (uint32_t i = 0; i < 2000; i++) {
+    addEvent(i);
+  }
+  m_mediator->initialize();
+  m_mediator->mainLoop();
+  m_mediator->finalize();
+
+  CPPUNIT_ASSERT_EQUAL(size_t(1000), m_sink->m_sink.size());
+  for (size_t i = 0; i < 1000; i++) {
+    CPPUNIT_ASSERT_EQUAL(uint32_t(2*i), eventValue(i));
+  }
+  int total = 0;
+  for (size_t i = 0; i < 4; i++) {
+    total += dynamic_cast<CParallelTestFilter*>(m_mediator->m_filters[i])->m_nPhysics;
+  }
+  CPPUNIT_ASSERT_EQUAL(2000, total);
+}
+
+// State changes are written once, in place, and seen by every clone.
+
+void CParallelMediatorTest::testBarriers()
+{
+  addStateChange(BEGIN_RUN);
+  for (uint32_t i = 0; i < 100; i += 2) {
+    addEvent(i);
+  }
+  addStateChange(END_RUN);
+
+  m_mediator->initialize();
+  m_mediator->mainLoop();
+  m_mediator->finalize();
+
+  CPPUNIT_ASSERT_EQUAL(size_t(52), m_sink->m_sink.size());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(BEGIN_RUN), m_sink->m_sink[0]->type());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(END_RUN), m_sink->m_sink[51]->type());
+  for (size_t i = 1; i < 51; i++) {
+    CPPUNIT_ASSERT_EQUAL(uint32_t(PHYSICS_EVENT), m_sink->m_sink[i]->type());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(2*(i-1)), eventValue(i));
+  }
+  for (size_t i = 0; i < 4; i++) {
+    CPPUNIT_ASSERT_EQUAL(2,
+      dynamic_cast<CParallelTestFilter*>(m_mediator->m_filters[i])->m_nStateChanges);
+  }
+}
+
+// The skip and process counts work as they do for the infinite mediator.
+
+void CParallelMediatorTest::testSkipCount()
+{
+  for (uint32_t i = 0; i < 100; i += 2) {
+    addEvent(i);
+  }
+  m_mediator->setSkipCount(10);
+  m_mediator->setProcessCount(20);
+  m_mediator->initialize();
+  m_mediator->mainLoop();
+  m_mediator->finalize();
+
+  CPPUNIT_ASSERT_EQUAL(size_t(20), m_sink->m_sink.size());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(20), eventValue(0));
+  CPPUNIT_ASSERT_EQUAL(uint32_t(58), eventValue(19));
+}
+
+// Exceptions thrown by a filter come out of the main loop.
+
+void CParallelMediatorTest::testException()
+{
+  for (uint32_t i = 0; i < 100; i += 2) {
+    addEvent(i);
+  }
+  addEvent(0xdead);
+  for (uint32_t i = 0; i < 100; i += 2) {
+    addEvent(i);
+  }
+  m_mediator->initialize();
+  CPPUNIT_ASSERT_THROW(m_mediator->mainLoop(), std::string);
+  m_mediator->finalize();
+}
+
+// Items a filter puts are written in order, just ahead of its result.
+
+void CParallelMediatorTest::testPutItem()
+{
+  delete m_mediator;
+  m_source   = new CFilterTestSource;
+  m_sink     = new CFilterTestSink;
+  CEmittingTestFilter* pFilter = new CEmittingTestFilter;
+  m_mediator = new CParallelMediator(m_source, pFilter, m_sink, 4);
+  pFilter->m_pMediator = m_mediator;     // The clones copy this.
+
+  for (uint32_t i = 0; i < 500; i++) {
+    addEvent(i);
+  }
+  m_mediator->initialize();
+  m_mediator->mainLoop();
+  m_mediator->finalize();
+
+  CPPUNIT_ASSERT_EQUAL(size_t(1000), m_sink->m_sink.size());
+  for (size_t i = 0; i < 1000; i++) {
+    CPPUNIT_ASSERT_EQUAL(uint32_t(i/2), eventValue(i));
+  }
+}
+
+// Only the first clone's puts of a barrier are written; the other
+// clones see the barrier but what they put is dropped.
+
+void CParallelMediatorTest::testBarrierPutItem()
+{
+  delete m_mediator;
+  m_source   = new CFilterTestSource;
+  m_sink     = new CFilterTestSink;
+  CEndRunEmittingTestFilter* pFilter = new CEndRunEmittingTestFilter;
+  m_mediator = new CParallelMediator(m_source, pFilter, m_sink, 4);
+  pFilter->m_pMediator = m_mediator;
+
+  addStateChange(BEGIN_RUN);
+  for (uint32_t i = 0; i < 10; i++) {
+    addEvent(i);
+  }
+  addStateChange(END_RUN);
+  m_mediator->initialize();
+  m_mediator->mainLoop();
+  m_mediator->finalize();
+
+  CPPUNIT_ASSERT_EQUAL(size_t(13), m_sink->m_sink.size());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(BEGIN_RUN), m_sink->m_sink[0]->type());
+  for (size_t i = 1; i < 11; i++) {
+    CPPUNIT_ASSERT_EQUAL(uint32_t(i-1), eventValue(i));
+  }
+  CPPUNIT_ASSERT_EQUAL(uint32_t(END_RUN), m_sink->m_sink[11]->type());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(END_RUN), m_sink->m_sink[12]->type());
+}
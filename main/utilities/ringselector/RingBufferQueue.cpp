@@ -31,8 +31,10 @@ static  CRingItem* EMPTY(reinterpret_cast<CRingItem*>(0xffffffff));
 /**
  * Constructor
  *  @param nFree - number of queue elements to initially put in the free queue.
+ *                 Neither queue can ever hold more than that.
  */
-Queues::Queues(int nFree) 
+Queues::Queues(int nFree) :
+  m_Free(0, nFree), m_InTransit(0, nFree)
 {
   CRingItem* anItem(EMPTY);
   for (int i =0; i < nFree; i++) {
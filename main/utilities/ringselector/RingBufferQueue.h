@@ -25,15 +25,15 @@
 #ifndef RINGBUFFERQUEUE_H
 #define RINGBUFFERQUEUE_H
 
-#include <CBufferQueue.h>
+#include <CLockFreeQueue.h>
 #include <CRingItem.h>
 
 /*
- *  A RingBuffer queue is a CBufferQueue whose elements are pointers
- *  to CRingItems.
+ *  A RingBuffer queue is a lock free queue whose elements are pointers
+ *  to CRingItems.  Each queue has one thread at each end.
  */
 
-typedef CBufferQueue<CRingItem*> RingBufferQueue, *pRingBufferQueue;
+typedef CSPSCQueue<CRingItem*> RingBufferQueue, *pRingBufferQueue;
 
 /**
  *  @class Queues